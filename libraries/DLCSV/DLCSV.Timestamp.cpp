@@ -0,0 +1,195 @@
+/*
+ * DLCSV.Timestamp.cpp
+ *
+ * Incremental formatting of CSV timestamps
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Time.h"
+#include "DLCSV.Timestamp.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+// Position of each field in "YYYY-MM-DD HH:MM:SS +0000"
+#define YEAR_INDEX (0)
+#define MONTH_INDEX (5)
+#define DAY_INDEX (8)
+#define HOUR_INDEX (11)
+#define MINUTE_INDEX (14)
+#define SECOND_INDEX (17)
+
+// Further than this, it is quicker to work the date out again than step it on a day at a time
+#define MAX_STEP_SECONDS (31UL * S_PER_DAY)
+
+/*
+ * Private Functions
+ */
+
+static void writeTwoDigits(char * p, uint8_t value)
+{
+    p[0] = '0' + (value / 10);
+    p[1] = '0' + (value % 10);
+}
+
+/*
+ * Public Class Functions
+ */
+
+CSVTimestampFormatter::CSVTimestampFormatter()
+{
+    strcpy(m_text, "1970-01-01 00:00:00 +0000");
+    m_timestamp = 0;
+
+    m_year = FIRST_UNIX_YEAR_GR;
+    m_month = JANUARY;
+    m_day = 1;
+    m_secondOfDay = 0;
+}
+
+/*
+ * format
+ *
+ * Returns the CSV timestamp for timestamp, re-writing only what has changed since the last call
+ */
+char const * CSVTimestampFormatter::format(UNIX_TIMESTAMP timestamp)
+{
+    if ((timestamp < m_timestamp) || ((timestamp - m_timestamp) > MAX_STEP_SECONDS))
+    {
+        m_timestamp = timestamp;
+        renderAll();
+        return m_text;
+    }
+
+    return advance((uint32_t)(timestamp - m_timestamp));
+}
+
+/*
+ * advance
+ *
+ * Moves the timestamp on by seconds and returns the new CSV timestamp
+ */
+char const * CSVTimestampFormatter::advance(uint32_t seconds)
+{
+    uint32_t previousSecondOfDay = m_secondOfDay;
+    uint32_t days;
+
+    m_timestamp += seconds;
+
+    if (seconds > MAX_STEP_SECONDS)
+    {
+        renderAll();
+        return m_text;
+    }
+
+    days = (m_secondOfDay + seconds) / S_PER_DAY;
+    m_secondOfDay = (m_secondOfDay + seconds) % S_PER_DAY;
+
+    if (days > 0)
+    {
+        advanceDays(days);
+        renderDate();
+
+        // Every time field needs writing after a date change
+        previousSecondOfDay = S_PER_DAY;
+    }
+
+    renderTime(previousSecondOfDay);
+
+    return m_text;
+}
+
+char const * CSVTimestampFormatter::c_str(void)
+{
+    return m_text;
+}
+
+UNIX_TIMESTAMP CSVTimestampFormatter::timestamp(void)
+{
+    return m_timestamp;
+}
+
+/*
+ * Private Class Functions
+ */
+
+/*
+ * renderAll
+ *
+ * Works out the date from the start of UNIX time and writes every field
+ */
+void CSVTimestampFormatter::renderAll(void)
+{
+    TM time;
+
+    unix_seconds_to_time(m_timestamp, &time);
+
+    m_year = C_TO_GREGORIAN_YEAR(time.tm_year);
+    m_month = time.tm_mon;
+    m_day = time.tm_mday;
+    m_secondOfDay = HRS_MINS_SECS_TO_SECS(time.tm_hour, time.tm_min, time.tm_sec);
+
+    renderDate();
+    renderTime(S_PER_DAY);
+}
+
+void CSVTimestampFormatter::renderDate(void)
+{
+    writeTwoDigits(&m_text[YEAR_INDEX], (m_year / 100) % 100);
+    writeTwoDigits(&m_text[YEAR_INDEX + 2], m_year % 100);
+    writeTwoDigits(&m_text[MONTH_INDEX], m_month + 1);
+    writeTwoDigits(&m_text[DAY_INDEX], m_day);
+}
+
+/*
+ * renderTime
+ *
+ * Writes the seconds, and the minutes and hours if they are different to previousSecondOfDay
+ */
+void CSVTimestampFormatter::renderTime(uint32_t previousSecondOfDay)
+{
+    writeTwoDigits(&m_text[SECOND_INDEX], m_secondOfDay % S_PER_MIN);
+
+    if ((m_secondOfDay / S_PER_MIN) == (previousSecondOfDay / S_PER_MIN)) { return; }
+
+    writeTwoDigits(&m_text[MINUTE_INDEX], (m_secondOfDay / S_PER_MIN) % MINS_PER_HOUR);
+
+    if ((m_secondOfDay / S_PER_HOUR) == (previousSecondOfDay / S_PER_HOUR)) { return; }
+
+    writeTwoDigits(&m_text[HOUR_INDEX], m_secondOfDay / S_PER_HOUR);
+}
+
+void CSVTimestampFormatter::advanceDays(uint32_t days)
+{
+    while (days--)
+    {
+        if (++m_day > days_in_month(m_month, is_leap_year(m_year)))
+        {
+            m_day = 1;
+            if (++m_month > DECEMBER)
+            {
+                m_month = JANUARY;
+                m_year++;
+            }
+        }
+    }
+}
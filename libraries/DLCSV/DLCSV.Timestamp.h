@@ -0,0 +1,44 @@
+#ifndef _DL_CSV_TIMESTAMP_H_
+#define _DL_CSV_TIMESTAMP_H_
+
+/*
+ * CSVTimestampFormatter
+ *
+ * Keeps the CSV timestamp ("YYYY-MM-DD HH:MM:SS +0000") of the last time it formatted,
+ * so the next time only the chars that have changed are re-written.
+ * Rows are usually seconds or minutes apart, so most calls only touch the seconds and minutes.
+ * The date is stepped on from the previous one, rather than worked out from the
+ * start of UNIX time, unless the time has gone backwards or jumped more than a month.
+ * A new formatter starts at the UNIX epoch.
+ */
+
+// "YYYY-MM-DD HH:MM:SS +0000" and terminator
+#define CSV_TIMESTAMP_LENGTH (26)
+
+class CSVTimestampFormatter
+{
+    public:
+        CSVTimestampFormatter();
+
+        char const * format(UNIX_TIMESTAMP timestamp);
+        char const * advance(uint32_t seconds);
+
+        char const * c_str(void);
+        UNIX_TIMESTAMP timestamp(void);
+
+    private:
+        void renderAll(void);
+        void renderDate(void);
+        void renderTime(uint32_t previousSecondOfDay);
+        void advanceDays(uint32_t days);
+
+        char m_text[CSV_TIMESTAMP_LENGTH];
+        UNIX_TIMESTAMP m_timestamp;
+
+        GREGORIAN_YEAR m_year;
+        uint8_t m_month; // 0 to 11
+        uint8_t m_day; // 1 to 31
+        uint32_t m_secondOfDay;
+};
+
+#endif
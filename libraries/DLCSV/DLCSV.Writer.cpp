@@ -0,0 +1,296 @@
+/*
+ * DLCSV.Writer.cpp
+ *
+ * Batched writing of timestamped CSV rows to local storage
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Time.h"
+#include "DLUtility.Strings.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
+#include "DLDataField.Manager.h"
+#include "DLLocalStorage.h"
+#include "DLCSV.Timestamp.h"
+#include "DLCSV.Writer.h"
+
+/*
+ * Public Class Functions
+ */
+
+CSVRowWriter::CSVRowWriter(char * buffer, uint16_t size, uint16_t batchSize) :
+    m_accumulator(buffer, size)
+{
+    m_buffer = buffer;
+
+    // A batch cannot be bigger than the buffer (less the terminator)
+    if (!buffer || (size == 0)) { size = 1; }
+    m_batchSize = ((batchSize == 0) || (batchSize >= size)) ? (size - 1) : batchSize;
+
+    m_storage = NULL;
+    m_filename = NULL;
+    m_decimals = CSV_WRITER_DEFAULT_DECIMALS;
+
+    m_rowCount = 0;
+    m_writeCount = 0;
+
+    m_heldTimestamp = 0;
+    m_hasHeldRow = false;
+}
+
+/*
+ * setFile
+ *
+ * Sets the file that batches are appended to.
+ * Anything waiting in the buffer will go to the new file, so flush() first if that is not wanted.
+ */
+void CSVRowWriter::setFile(LocalStorageInterface * storage, char const * filename)
+{
+    m_storage = storage;
+    m_filename = filename;
+}
+
+void CSVRowWriter::setDecimals(uint8_t decimals)
+{
+    m_decimals = (decimals > FIXED_FORMAT_MAX_DECIMALS) ? FIXED_FORMAT_MAX_DECIMALS : decimals;
+}
+
+/*
+ * writeHeaders
+ *
+ * Adds a header line for the manager's fields, after a timestamp column
+ * Returns false if the line does not fit in the buffer.
+ */
+bool CSVRowWriter::writeHeaders(DataFieldManager * manager)
+{
+    char headers[255];
+    uint16_t start = m_accumulator.length();
+    uint32_t length;
+
+    if (!manager || !m_buffer) { return false; }
+
+    length = manager->writeHeadersToBuffer(headers, sizeof(headers));
+
+    // The manager's headers end in CRLF unless they were too long for the buffer
+    if ((length < 2) || (headers[length - 2] != '\r') || (headers[length - 1] != '\n')) { return false; }
+
+    if (!m_accumulator.appendLiteral("Timestamp, ") || !m_accumulator.append(headers, length))
+    {
+        m_accumulator.remove(m_accumulator.length() - start);
+        return false;
+    }
+
+    return writeFullBatches();
+}
+
+/*
+ * writeRow
+ *
+ * Adds one line ("timestamp,value,value...") to the buffer,
+ * with values that have no data (DATAFIELD_NO_DATA_VALUE) left empty.
+ * Any full batches are then written to storage.
+ * Returns false if the line could not be added (it is too long for the buffer, or the lines
+ * already waiting could not be written out to make room for it), or if a full batch could not
+ * be written (in which case the line is kept, and written with the next batch).
+ */
+bool CSVRowWriter::writeRow(UNIX_TIMESTAMP timestamp, float const * row, uint8_t fieldCount)
+{
+    if (!row || !m_buffer) { return false; }
+
+    if (!addRow(timestamp, row, fieldCount)) { return false; }
+
+    m_rowCount++;
+
+    return writeFullBatches();
+}
+
+/*
+ * writeRows
+ *
+ * Removes up to maxRows of the oldest rows from manager (converted to units if converted is true)
+ * and adds a line for each, starting with any row held from the last call.
+ * Returns the number of rows added to the buffer. Stops early if a row cannot be added
+ * (it is held for the next call, so it is not lost) or a full batch cannot be written.
+ */
+uint32_t CSVRowWriter::writeRows(DataFieldManager * manager, bool converted, uint32_t maxRows)
+{
+    uint32_t rows = 0;
+
+    if (!manager || !m_buffer) { return 0; }
+
+    while (rows < maxRows)
+    {
+        if (!m_hasHeldRow)
+        {
+            if (manager->drainRows(m_heldRow, 1, converted, &m_heldTimestamp) != 1) { break; }
+            m_hasHeldRow = true;
+        }
+
+        if (!addRow(m_heldTimestamp, m_heldRow, manager->fieldCount())) { break; }
+
+        m_hasHeldRow = false;
+        m_rowCount++;
+        rows++;
+
+        if (!writeFullBatches()) { break; }
+    }
+
+    return rows;
+}
+
+/*
+ * flush
+ *
+ * Writes anything waiting in the buffer to storage, even if it is less than a batch.
+ * Returns false if it could not be written (it is kept in the buffer).
+ */
+bool CSVRowWriter::flush(void)
+{
+    if (m_accumulator.length() == 0) { return true; }
+
+    if (!writeBuffer()) { return false; }
+
+    m_accumulator.reset();
+    return true;
+}
+
+uint16_t CSVRowWriter::pendingLength(void)
+{
+    return m_accumulator.length();
+}
+
+uint32_t CSVRowWriter::rowCount(void)
+{
+    return m_rowCount;
+}
+
+/*
+ * writeCount
+ *
+ * Returns the number of times the file has been written to
+ */
+uint32_t CSVRowWriter::writeCount(void)
+{
+    return m_writeCount;
+}
+
+/*
+ * Private Class Functions
+ */
+
+/*
+ * addRow
+ *
+ * Appends the line for one row, writing out the lines already waiting first if there is not
+ * enough space after them. Returns false if the line was not added.
+ */
+bool CSVRowWriter::addRow(UNIX_TIMESTAMP timestamp, float const * row, uint8_t fieldCount)
+{
+    if (formatRow(timestamp, row, fieldCount)) { return true; }
+
+    return flush() && formatRow(timestamp, row, fieldCount);
+}
+
+/*
+ * formatRow
+ *
+ * Appends the line for one row, or nothing (returning false) if it does not fit
+ */
+bool CSVRowWriter::formatRow(UNIX_TIMESTAMP timestamp, float const * row, uint8_t fieldCount)
+{
+    uint16_t start = m_accumulator.length();
+    uint8_t field;
+    bool fits;
+
+    // Consecutive rows are close together, so only the end of the timestamp changes
+    fits = m_accumulator.append(m_timestamps.format(timestamp), CSV_TIMESTAMP_LENGTH - 1);
+
+    for (field = 0; fits && (field < fieldCount); ++field)
+    {
+        fits = m_accumulator.writeChar(',');
+        if (fits && (row[field] != DATAFIELD_NO_DATA_VALUE))
+        {
+            fits = m_accumulator.appendFixed(row[field], m_decimals);
+        }
+    }
+
+    fits = fits && m_accumulator.appendLiteral(CRLF);
+
+    if (!fits)
+    {
+        m_accumulator.remove(m_accumulator.length() - start);
+    }
+
+    return fits;
+}
+
+/*
+ * writeFullBatches
+ *
+ * Writes batchSize chars at a time to storage while there are enough waiting,
+ * and moves whatever is left over to the start of the buffer
+ */
+bool CSVRowWriter::writeFullBatches(void)
+{
+    uint16_t length;
+    char next;
+    bool written;
+
+    while ((m_batchSize > 0) && (m_accumulator.length() >= m_batchSize))
+    {
+        length = m_accumulator.length();
+
+        // Terminate the buffer after the batch while it is written
+        next = m_buffer[m_batchSize];
+        m_buffer[m_batchSize] = '\0';
+        written = writeBuffer();
+        m_buffer[m_batchSize] = next;
+
+        if (!written) { return false; }
+
+        memmove(m_buffer, &m_buffer[m_batchSize], length - m_batchSize);
+        m_accumulator.remove(m_batchSize);
+    }
+
+    return true;
+}
+
+/*
+ * writeBuffer
+ *
+ * Appends the (terminated) buffer to the file
+ */
+bool CSVRowWriter::writeBuffer(void)
+{
+    if (!m_storage || !m_filename) { return false; }
+
+    FILE_HANDLE file = m_storage->openFile(m_filename, true);
+    if (file == INVALID_HANDLE) { return false; }
+
+    m_storage->write(file, m_buffer);
+    m_storage->closeFile(file);
+
+    m_writeCount++;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef _DL_CSV_WRITER_H_
+#define _DL_CSV_WRITER_H_
+
+/*
+ * CSVRowWriter
+ *
+ * Formats timestamped rows of values (from a DataFieldManager, or any float array)
+ * as CSV lines, one pass per row, into a buffer provided by the caller.
+ * Lines are collected in the buffer and only written to storage once batchSize
+ * chars are waiting, in writes of exactly batchSize chars (the rest is kept for the
+ * next batch). Using the card's sector size as batchSize means the SD card sees one
+ * write per sector, rather than one (or more) per row.
+ *
+ * The buffer should have space for a batch, the longest line and a terminating '\0'.
+ * Nothing is written to storage until a batch is full, so call flush() before
+ * the data is needed (e.g. before uploading the file).
+ *
+ * A row taken from a DataFieldManager by writeRows that cannot be added to the buffer
+ * (because storage cannot be written to make room for it) is held by the writer,
+ * and is the first row added by the next call to writeRows.
+ */
+
+#define CSV_SECTOR_SIZE (512)
+#define CSV_WRITER_DEFAULT_DECIMALS (3)
+
+class DataFieldManager;
+
+class CSVRowWriter
+{
+    public:
+        CSVRowWriter(char * buffer, uint16_t size, uint16_t batchSize);
+
+        void setFile(LocalStorageInterface * storage, char const * filename);
+        void setDecimals(uint8_t decimals);
+
+        bool writeHeaders(DataFieldManager * manager);
+        bool writeRow(UNIX_TIMESTAMP timestamp, float const * row, uint8_t fieldCount);
+        uint32_t writeRows(DataFieldManager * manager, bool converted, uint32_t maxRows);
+        bool flush(void);
+
+        uint16_t pendingLength(void);
+        uint32_t rowCount(void);
+        uint32_t writeCount(void);
+
+    private:
+        bool addRow(UNIX_TIMESTAMP timestamp, float const * row, uint8_t fieldCount);
+        bool formatRow(UNIX_TIMESTAMP timestamp, float const * row, uint8_t fieldCount);
+        bool writeFullBatches(void);
+        bool writeBuffer(void);
+
+        char * m_buffer;
+        uint16_t m_batchSize;
+        FixedLengthAccumulator m_accumulator;
+        CSVTimestampFormatter m_timestamps;
+
+        LocalStorageInterface * m_storage;
+        char const * m_filename;
+        uint8_t m_decimals;
+
+        uint32_t m_rowCount;
+        uint32_t m_writeCount;
+
+        // Row taken from a manager but not yet added to the buffer
+        float m_heldRow[MAX_FIELDS];
+        UNIX_TIMESTAMP m_heldTimestamp;
+        bool m_hasHeldRow;
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * DLCSV.Timestamp.Test.cpp
+ *
+ * Tests the CSVTimestampFormatter class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Time.h"
+#include "DLCSV.Timestamp.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+// 2015-12-31 23:58:00
+static const UNIX_TIMESTAMP NEW_YEARS_EVE_2015 = 1451606280;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void formatExpected(UNIX_TIMESTAMP timestamp, char * buffer)
+{
+    TM time;
+    unix_seconds_to_time(timestamp, &time);
+    sprintf(buffer, "%d-%02d-%02d %02d:%02d:%02d +0000",
+        C_TO_GREGORIAN_YEAR(time.tm_year), time.tm_mon + 1, time.tm_mday,
+        time.tm_hour, time.tm_min, time.tm_sec);
+}
+
+static void test_NewFormatterStartsAtTheEpoch(void)
+{
+    CSVTimestampFormatter formatter;
+
+    TEST_ASSERT_EQUAL_STRING("1970-01-01 00:00:00 +0000", formatter.c_str());
+    TEST_ASSERT_EQUAL_STRING("1970-01-01 00:01:05 +0000", formatter.advance(65));
+}
+
+static void test_FormattingMatchesFullConversionForAllStepSizes(void)
+{
+    char expected[CSV_TIMESTAMP_LENGTH];
+    uint32_t steps[] = {1, 7, 59, 60, 61, 3599, 3600, 86399, 86400, 86401, 40 * 86400UL};
+    uint8_t step;
+    uint16_t i;
+    UNIX_TIMESTAMP timestamp;
+
+    for (step = 0; step < sizeof(steps) / sizeof(steps[0]); ++step)
+    {
+        CSVTimestampFormatter formatter;
+        timestamp = NEW_YEARS_EVE_2015;
+
+        // Crosses hours, days, the year end and (for the bigger steps) the 2016 leap day
+        for (i = 0; i < 500; ++i)
+        {
+            formatExpected(timestamp, expected);
+            TEST_ASSERT_EQUAL_STRING(expected, formatter.format(timestamp));
+            timestamp += steps[step];
+        }
+    }
+}
+
+static void test_AdvanceMatchesFormat(void)
+{
+    char expected[CSV_TIMESTAMP_LENGTH];
+    uint16_t i;
+
+    CSVTimestampFormatter formatter;
+    formatter.format(NEW_YEARS_EVE_2015);
+
+    for (i = 1; i <= 200; ++i)
+    {
+        formatter.advance(1800);
+        formatExpected(NEW_YEARS_EVE_2015 + (i * 1800UL), expected);
+        TEST_ASSERT_EQUAL_STRING(expected, formatter.c_str());
+    }
+
+    TEST_ASSERT_EQUAL(NEW_YEARS_EVE_2015 + (200 * 1800UL), formatter.timestamp());
+}
+
+static void test_TimeGoingBackwardsIsFormattedInFull(void)
+{
+    CSVTimestampFormatter formatter;
+
+    TEST_ASSERT_EQUAL_STRING("2016-01-01 00:00:00 +0000", formatter.format(NEW_YEARS_EVE_2015 + 120));
+    TEST_ASSERT_EQUAL_STRING("2015-12-31 23:58:00 +0000", formatter.format(NEW_YEARS_EVE_2015));
+    TEST_ASSERT_EQUAL_STRING("2016-02-29 12:00:00 +0000", formatter.format(1456747200));
+}
+
+int main(void)
+{
+    UnityBegin("DLCSV.Timestamp.Test.cpp");
+
+    RUN_TEST(test_NewFormatterStartsAtTheEpoch);
+    RUN_TEST(test_FormattingMatchesFullConversionForAllStepSizes);
+    RUN_TEST(test_AdvanceMatchesFormat);
+    RUN_TEST(test_TimeGoingBackwardsIsFormattedInFull);
+
+    UnityEnd();
+    return 0;
+}
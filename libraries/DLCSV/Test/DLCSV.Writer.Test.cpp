@@ -0,0 +1,257 @@
+/*
+ * DLCSV.Writer.Test.cpp
+ *
+ * Tests the CSVRowWriter class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Time.h"
+#include "DLUtility.Strings.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
+#include "DLDataField.Manager.h"
+#include "DLLocalStorage.h"
+#include "DLCSV.Timestamp.h"
+#include "DLCSV.Writer.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+// Keeps each write to the file separately, to check how the rows were batched
+class RecordingStorage : public LocalStorageInterface
+{
+    public:
+        bool inError() { return false; }
+        bool fileExists(char const * const) { return true; }
+        bool directoryExists(char const * const) { return true; }
+        bool mkDir(char const * const) { return true; }
+        void write(FILE_HANDLE, char const * const toWrite) { writes.push_back(std::string(toWrite)); }
+        uint32_t readBytes(FILE_HANDLE, char *, uint32_t) { return 0; }
+        uint32_t readLine(FILE_HANDLE, char *, uint32_t, bool) { return 0; }
+        bool seek(FILE_HANDLE, uint32_t) { return false; }
+        uint32_t fileSize(FILE_HANDLE) { return 0; }
+        FILE_HANDLE openFile(char const * const, bool) { return failOpen ? INVALID_HANDLE : 0; }
+        void closeFile(FILE_HANDLE) {}
+        bool endOfFile(FILE_HANDLE) { return true; }
+        void setEcho(bool) {}
+        void removeFile(char const * const) {}
+
+        std::string contents(void)
+        {
+            std::string all;
+            for (size_t i = 0; i < writes.size(); ++i) { all += writes[i]; }
+            return all;
+        }
+
+        std::vector<std::string> writes;
+        bool failOpen;
+};
+
+static RecordingStorage s_storage;
+
+// Space for a 40 char batch and a 33 char line
+static char s_buffer[80];
+
+// 2015-04-03 13:09:34
+static const UNIX_TIMESTAMP TEST_TIME = 1428066574;
+
+void setUp(void)
+{
+    s_storage.writes.clear();
+    s_storage.failOpen = false;
+}
+
+void tearDown(void) {}
+
+static void test_RowsAreFormattedAsCSVLines(void)
+{
+    float row[] = {1.5f, -2.25f, DATAFIELD_NO_DATA_VALUE, 100.0f};
+
+    CSVRowWriter writer(s_buffer, sizeof(s_buffer), 40);
+    writer.setFile(&s_storage, "DATA.CSV");
+    writer.setDecimals(2);
+
+    TEST_ASSERT_TRUE(writer.writeRow(TEST_TIME, row, 4));
+    TEST_ASSERT_TRUE(writer.flush());
+
+    std::string contents = s_storage.contents();
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34 +0000,1.50,-2.25,,100.00\r\n", contents.c_str());
+    TEST_ASSERT_EQUAL(1, writer.rowCount());
+}
+
+static void test_RowsAreWrittenInWholeBatches(void)
+{
+    float row[] = {1.0f};
+    uint8_t i;
+
+    // Each line is 33 chars: 5 lines make 4 full batches of 40 chars with 5 left over
+    CSVRowWriter writer(s_buffer, sizeof(s_buffer), 40);
+    writer.setFile(&s_storage, "DATA.CSV");
+
+    for (i = 0; i < 5; ++i)
+    {
+        TEST_ASSERT_TRUE(writer.writeRow(TEST_TIME + i, row, 1));
+    }
+
+    TEST_ASSERT_EQUAL(4, writer.writeCount());
+    TEST_ASSERT_EQUAL(5, writer.pendingLength());
+    for (i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_EQUAL(40, s_storage.writes[i].length());
+    }
+
+    TEST_ASSERT_TRUE(writer.flush());
+    TEST_ASSERT_EQUAL(5, writer.writeCount());
+    TEST_ASSERT_EQUAL(0, writer.pendingLength());
+
+    std::string contents = s_storage.contents();
+    TEST_ASSERT_EQUAL_STRING(
+        "2015-04-03 13:09:34 +0000,1.000\r\n"
+        "2015-04-03 13:09:35 +0000,1.000\r\n"
+        "2015-04-03 13:09:36 +0000,1.000\r\n"
+        "2015-04-03 13:09:37 +0000,1.000\r\n"
+        "2015-04-03 13:09:38 +0000,1.000\r\n", contents.c_str());
+}
+
+static void test_RowsAreKeptIfStorageCannotBeOpened(void)
+{
+    char buffer[100];
+    float row[] = {1.0f};
+
+    CSVRowWriter writer(buffer, sizeof(buffer), 40);
+    writer.setFile(&s_storage, "DATA.CSV");
+    s_storage.failOpen = true;
+
+    // The second line fills a batch, which cannot be written
+    TEST_ASSERT_TRUE(writer.writeRow(TEST_TIME, row, 1));
+    TEST_ASSERT_FALSE(writer.writeRow(TEST_TIME, row, 1));
+    TEST_ASSERT_EQUAL(66, writer.pendingLength());
+    TEST_ASSERT_FALSE(writer.flush());
+    TEST_ASSERT_EQUAL(0, writer.writeCount());
+
+    s_storage.failOpen = false;
+    TEST_ASSERT_TRUE(writer.flush());
+    TEST_ASSERT_EQUAL(66, s_storage.contents().length());
+}
+
+static void test_LinesTooLongForTheBufferAreRejected(void)
+{
+    float row[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f};
+
+    CSVRowWriter writer(s_buffer, sizeof(s_buffer), 40);
+    writer.setFile(&s_storage, "DATA.CSV");
+
+    TEST_ASSERT_FALSE(writer.writeRow(TEST_TIME, row, 9));
+    TEST_ASSERT_EQUAL(0, writer.pendingLength());
+    TEST_ASSERT_EQUAL(0, writer.rowCount());
+}
+
+static void test_ManagerRowsAreDrainedWithHeaders(void)
+{
+    char buffer[200];
+    int32_t data[] = {5, 7};
+
+    DataFieldManager manager(10, 1);
+    manager.addField(new NumericDataField(VOLTAGE, NULL, 1));
+    manager.addField(new NumericDataField(VOLTAGE, NULL, 2));
+
+    manager.storeDataArray(data, TEST_TIME);
+    data[0] = 6;
+    manager.storeDataArray(data, TEST_TIME + 60);
+
+    CSVRowWriter writer(buffer, sizeof(buffer), CSV_SECTOR_SIZE);
+    writer.setFile(&s_storage, "DATA.CSV");
+    writer.setDecimals(0);
+
+    TEST_ASSERT_TRUE(writer.writeHeaders(&manager));
+    TEST_ASSERT_EQUAL(2, writer.writeRows(&manager, false, 10));
+    TEST_ASSERT_FALSE(manager.hasData());
+    TEST_ASSERT_EQUAL(0, writer.writeCount());
+
+    TEST_ASSERT_TRUE(writer.flush());
+    TEST_ASSERT_EQUAL(1, writer.writeCount());
+
+    std::string contents = s_storage.contents();
+    TEST_ASSERT_EQUAL_STRING(
+        "Timestamp, Voltage (V), Voltage (V)\r\n"
+        "2015-04-03 13:09:34 +0000,5,7\r\n"
+        "2015-04-03 13:10:34 +0000,6,7\r\n", contents.c_str());
+}
+
+static void test_ManagerRowsAreNotLostIfStorageCannotBeWritten(void)
+{
+    int32_t data[] = {5, 7};
+    uint8_t i;
+
+    DataFieldManager manager(10, 1);
+    manager.addField(new NumericDataField(VOLTAGE, NULL, 1));
+    manager.addField(new NumericDataField(VOLTAGE, NULL, 2));
+
+    for (i = 0; i < 5; ++i)
+    {
+        manager.storeDataArray(data, TEST_TIME + i);
+    }
+
+    // Each line is 31 chars, so only two fit in the buffer without writing a batch
+    CSVRowWriter writer(s_buffer, sizeof(s_buffer), 40);
+    writer.setFile(&s_storage, "DATA.CSV");
+    writer.setDecimals(0);
+    s_storage.failOpen = true;
+
+    TEST_ASSERT_EQUAL(2, writer.writeRows(&manager, false, 10));
+    TEST_ASSERT_EQUAL(0, writer.writeRows(&manager, false, 10));
+    TEST_ASSERT_EQUAL(2, writer.rowCount());
+    TEST_ASSERT_TRUE(manager.hasData());
+
+    s_storage.failOpen = false;
+    TEST_ASSERT_EQUAL(3, writer.writeRows(&manager, false, 10));
+    TEST_ASSERT_EQUAL(5, writer.rowCount());
+    TEST_ASSERT_FALSE(manager.hasData());
+    TEST_ASSERT_TRUE(writer.flush());
+
+    std::string contents = s_storage.contents();
+    TEST_ASSERT_EQUAL_STRING(
+        "2015-04-03 13:09:34 +0000,5,7\r\n"
+        "2015-04-03 13:09:35 +0000,5,7\r\n"
+        "2015-04-03 13:09:36 +0000,5,7\r\n"
+        "2015-04-03 13:09:37 +0000,5,7\r\n"
+        "2015-04-03 13:09:38 +0000,5,7\r\n", contents.c_str());
+}
+
+int main(void)
+{
+    UnityBegin("DLCSV.Writer.Test.cpp");
+
+    RUN_TEST(test_RowsAreFormattedAsCSVLines);
+    RUN_TEST(test_RowsAreWrittenInWholeBatches);
+    RUN_TEST(test_RowsAreKeptIfStorageCannotBeOpened);
+    RUN_TEST(test_LinesTooLongForTheBufferAreRejected);
+    RUN_TEST(test_ManagerRowsAreDrainedWithHeaders);
+    RUN_TEST(test_ManagerRowsAreNotLostIfStorageCannotBeWritten);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,21 @@
+SRC_FILES += DLCSV/DLCSV.Timestamp.cpp
+SRC_FILES += DLDataField/DLDataField.cpp DLDataField/DLDataField.String.cpp DLDataField/DLDataField.Derived.cpp
+SRC_FILES += DLDataField/DLDataField.Numeric.cpp DLDataField/DLDataField.Conversion.cpp DLDataField/DLDataField.Template.cpp
+SRC_FILES += DLDataField/DLDataField.Store.cpp DLDataField/DLDataField.Aggregator.cpp DLDataField/DLDataField.Spill.cpp DLDataField/DLDataField.Snapshot.cpp
+SRC_FILES += DLDataField/DLDataField.Manager.cpp
+SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.Strings.cpp DLUtility/DLUtility.Time.cpp
+SRC_FILES += DLUtility/DLUtility.Averager.cpp DLUtility/DLUtility.LookupTable.cpp DLUtility/DLUtility.Arena.cpp DLUtility/DLUtility.CRC.cpp
+
+SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
+SRC_FILES += DLUtility/DLUtility.PD.cpp
+
+SRC_FILES += DLSettings/DLSettings.DataChannels.cpp DLSettings/DLSettings.DataChannels.Helper.cpp
+SRC_FILES += DLSettings/DLSettings.Reader.Errors.cpp DLSettings/DLSettings.Global.cpp
+
+SRC_FILES += DLPlatform/DLPlatform.cpp
+
+INC_DIRS += -IDLUtility -IDLDataField -IDLSettings -IDLSensor -IDLPlatform -IDLLocalStorage
+
+local_setup: ;
+
+local_teardown: ;
@@ -0,0 +1,283 @@
+/*
+ * DLDataField.Aggregator.cpp
+ *
+ * Decimates rows of averaged field data into a coarser-resolution store
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Arena.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Snapshot.h"
+#include "DLUtility.h"
+
+/*
+ * Public Class Functions
+ */
+
+DataFieldAggregator::DataFieldAggregator()
+{
+    m_sum = NULL;
+    m_validCount = NULL;
+    m_keepLast = NULL;
+    m_decimation = 0;
+    m_count = 0;
+    m_columns = 0;
+    m_arena = NULL;
+}
+
+DataFieldAggregator::~DataFieldAggregator()
+{
+    freeSums();
+}
+
+/*
+ * setSize
+ *
+ * Every decimation rows passed to addRow are averaged into one row.
+ * Space for rows of these averages (each with columns values) is allocated,
+ * using the column formats given (or floats if formats is NULL).
+ * If arena is not NULL, the space is taken from it rather than the heap.
+ * Returns true if the storage was allocated.
+ */
+bool DataFieldAggregator::setSize(uint32_t decimation, uint32_t rows, uint8_t columns)
+{
+    return setSize(decimation, rows, columns, NULL, NULL);
+}
+
+bool DataFieldAggregator::setSize(uint32_t decimation, uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats)
+{
+    return setSize(decimation, rows, columns, formats, NULL);
+}
+
+bool DataFieldAggregator::setSize(uint32_t decimation, uint32_t rows, uint8_t columns,
+    DATAFIELD_COLUMN_FORMAT const * formats, Arena * arena)
+{
+    freeSums();
+    m_decimation = 0;
+    m_columns = 0;
+
+    if (decimation == 0) { return false; }
+
+    if (!m_store.setSize(rows, columns, formats, arena)) { return false; }
+
+    m_arena = arena;
+    if (arena)
+    {
+        m_sum = (float*)arena->allocate(columns * sizeof(float));
+        m_validCount = (uint32_t*)arena->allocate(columns * sizeof(uint32_t));
+        m_keepLast = (bool*)arena->allocate(columns * sizeof(bool));
+    }
+    else
+    {
+        m_sum = new float[columns];
+        m_validCount = new uint32_t[columns];
+        m_keepLast = new bool[columns];
+    }
+
+    if (!m_sum || !m_validCount || !m_keepLast) { return false; }
+
+    fillArray(m_keepLast, false, columns);
+
+    m_decimation = decimation;
+    m_columns = columns;
+    resetSums();
+
+    return true;
+}
+
+/*
+ * arenaBytesRequired
+ *
+ * Returns the arena space taken by setSize with the same arguments.
+ * The aggregator object itself is not included.
+ */
+uint32_t DataFieldAggregator::arenaBytesRequired(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats)
+{
+    return DataFieldStore::arenaBytesRequired(rows, columns, formats)
+        + Arena::alignedSize(columns * sizeof(float))
+        + Arena::alignedSize(columns * sizeof(uint32_t))
+        + Arena::alignedSize(columns * sizeof(bool));
+}
+
+bool DataFieldAggregator::isAllocated(void)
+{
+    return (m_sum != NULL) && m_store.isAllocated();
+}
+
+uint32_t DataFieldAggregator::decimation(void)
+{
+    return m_decimation;
+}
+
+/*
+ * keepLastValue
+ *
+ * Rather than being averaged, the column in each aggregated row
+ * is the last value (that is not DATAFIELD_NO_DATA_VALUE) added.
+ */
+bool DataFieldAggregator::keepLastValue(uint8_t column)
+{
+    if (!isAllocated() || (column >= m_columns)) { return false; }
+
+    m_keepLast[column] = true;
+    return true;
+}
+
+/*
+ * addRow
+ *
+ * Adds a row to the running sums. Values of DATAFIELD_NO_DATA_VALUE are ignored.
+ * When decimation rows have been added, the average row is pushed into the store,
+ * also copied to pAverage (if not NULL), and true is returned.
+ * The average row is stamped with the timestamp of the row that completed it.
+ * row and pAverage may be the same buffer.
+ */
+bool DataFieldAggregator::addRow(float const * row, float * pAverage)
+{
+    return addRow(row, pAverage, 0);
+}
+
+bool DataFieldAggregator::addRow(float const * row, float * pAverage, UNIX_TIMESTAMP timestamp)
+{
+    uint8_t column;
+
+    if (!row || !isAllocated()) { return false; }
+
+    for (column = 0; column < m_columns; ++column)
+    {
+        if (row[column] == DATAFIELD_NO_DATA_VALUE) { continue; }
+
+        if (m_keepLast[column])
+        {
+            m_sum[column] = row[column];
+            m_validCount[column] = 1;
+        }
+        else
+        {
+            m_sum[column] += row[column];
+            m_validCount[column]++;
+        }
+    }
+
+    if (++m_count < m_decimation) { return false; }
+
+    // The sums are no longer needed, so the average row is built in place
+    for (column = 0; column < m_columns; ++column)
+    {
+        if (m_validCount[column])
+        {
+            m_sum[column] /= m_validCount[column];
+        }
+        else
+        {
+            m_sum[column] = DATAFIELD_NO_DATA_VALUE;
+        }
+    }
+
+    m_store.pushRow(m_sum, timestamp);
+    if (pAverage) { memcpy(pAverage, m_sum, m_columns * sizeof(float)); }
+
+    resetSums();
+
+    return true;
+}
+
+DataFieldStore * DataFieldAggregator::store(void)
+{
+    return &m_store;
+}
+
+/*
+ * clear
+ *
+ * Removes the stored rows and the rows not yet averaged
+ */
+void DataFieldAggregator::clear(void)
+{
+    m_store.clear();
+    if (isAllocated()) { resetSums(); }
+}
+
+void DataFieldAggregator::writeSnapshot(DataFieldSnapshotWriter * writer)
+{
+    if (!writer) { return; }
+
+    m_store.writeSnapshot(writer);
+    writer->write(&m_count, sizeof(m_count));
+    writer->write(m_sum, m_columns * sizeof(float));
+    writer->write(m_validCount, m_columns * sizeof(uint32_t));
+}
+
+/*
+ * readSnapshot
+ *
+ * Restores the state written by writeSnapshot into an aggregator of the same size.
+ * Returns false (leaving the aggregator empty) if the state could not be read.
+ */
+bool DataFieldAggregator::readSnapshot(DataFieldSnapshotReader * reader)
+{
+    bool valid;
+
+    if (!reader || !isAllocated()) { return false; }
+
+    valid = m_store.readSnapshot(reader);
+    valid = valid && reader->read(&m_count, sizeof(m_count)) && (m_count < m_decimation);
+    valid = valid && reader->read(m_sum, m_columns * sizeof(float));
+    valid = valid && reader->read(m_validCount, m_columns * sizeof(uint32_t));
+
+    if (!valid) { clear(); }
+
+    return valid;
+}
+
+/*
+ * Private Class Functions
+ */
+
+void DataFieldAggregator::resetSums(void)
+{
+    fillArray(m_sum, 0.0f, m_columns);
+    fillArray(m_validCount, (uint32_t)0, m_columns);
+    m_count = 0;
+}
+
+void DataFieldAggregator::freeSums(void)
+{
+    // Arena memory is released with the arena
+    if (!m_arena)
+    {
+        delete[] m_sum;
+        delete[] m_validCount;
+        delete[] m_keepLast;
+    }
+
+    m_arena = NULL;
+    m_sum = NULL;
+    m_validCount = NULL;
+    m_keepLast = NULL;
+}
@@ -0,0 +1,54 @@
+#ifndef _DATAFIELD_AGGREGATOR_H_
+#define _DATAFIELD_AGGREGATOR_H_
+
+/*
+ * DataFieldAggregator
+ *
+ * Averages every N rows of data from a finer-resolution source into
+ * a single row, which is kept in its own DataFieldStore.
+ * Aggregators can be cascaded (e.g. 30s rows -> 60s rows -> 1h rows)
+ * by passing the rows completed by one aggregator into the next.
+ */
+
+class Arena;
+
+class DataFieldAggregator
+{
+    public:
+        DataFieldAggregator();
+        ~DataFieldAggregator();
+
+        bool setSize(uint32_t decimation, uint32_t rows, uint8_t columns);
+        bool setSize(uint32_t decimation, uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats);
+        bool setSize(uint32_t decimation, uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats, Arena * arena);
+        bool isAllocated(void);
+        static uint32_t arenaBytesRequired(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats);
+        uint32_t decimation(void);
+        /* For cumulative values (e.g. integrals), an aggregated row takes the last value */
+        bool keepLastValue(uint8_t column);
+
+        bool addRow(float const * row, float * pAverage);
+        bool addRow(float const * row, float * pAverage, UNIX_TIMESTAMP timestamp);
+
+        DataFieldStore * store(void);
+        void clear(void);
+
+        /* The stored rows and the sums of the rows not yet averaged are saved and restored */
+        void writeSnapshot(DataFieldSnapshotWriter * writer);
+        bool readSnapshot(DataFieldSnapshotReader * reader);
+
+    private:
+        void resetSums(void);
+        void freeSums(void);
+
+        DataFieldStore m_store;
+        float * m_sum;
+        uint32_t * m_validCount;
+        bool * m_keepLast;
+        uint32_t m_decimation;
+        uint32_t m_count;
+        uint8_t m_columns;
+        Arena * m_arena;
+};
+
+#endif
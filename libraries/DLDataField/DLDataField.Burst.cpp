@@ -0,0 +1,262 @@
+/*
+ * DLDataField.Burst.cpp
+ *
+ * Pre/post-trigger capture of raw samples from one channel
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Burst.h"
+#include "DLUtility.Strings.h"
+
+/*
+ * Public Class Functions
+ */
+
+DataFieldBurst::DataFieldBurst(int32_t * buffer, uint16_t size)
+{
+    m_buffer = buffer;
+    m_size = buffer ? size : 0;
+
+    m_field = NULL;
+    m_preTrigger = 0;
+    m_postTrigger = 0;
+    m_capacity = 0;
+    m_threshold = 0;
+    m_edge = BURST_TRIGGER_RISING;
+
+    m_state = BURST_STATE_IDLE;
+    m_head = 0;
+    m_count = 0;
+    m_preTriggerCount = 0;
+    m_postTriggerCount = 0;
+    m_lastSample = 0;
+    m_hasLastSample = false;
+
+    m_written = 0;
+}
+
+/*
+ * setup
+ *
+ * Sets up a capture of up to preTrigger samples before the trigger and postTrigger samples
+ * from the trigger (the sample that crossed threshold) onwards, and arms it.
+ * If field is not NULL, captured samples are written converted to units by the field.
+ * Returns false if the buffer cannot hold preTrigger + postTrigger samples, or postTrigger is 0.
+ */
+bool DataFieldBurst::setup(NumericDataField * field, uint16_t preTrigger, uint16_t postTrigger,
+    int32_t threshold, BURST_TRIGGER edge)
+{
+    if (postTrigger == 0) { return false; }
+    if (((uint32_t)preTrigger + postTrigger) > m_size) { return false; }
+
+    // Stop sampling while the capture is changed
+    m_state = BURST_STATE_IDLE;
+
+    m_field = field;
+    m_preTrigger = preTrigger;
+    m_postTrigger = postTrigger;
+    m_capacity = preTrigger + postTrigger;
+    m_threshold = threshold;
+    m_edge = edge;
+
+    arm();
+    return true;
+}
+
+/*
+ * arm
+ *
+ * Discards any capture and starts filling the ring again
+ */
+void DataFieldBurst::arm(void)
+{
+    if (m_capacity == 0) { return; }
+
+    m_head = 0;
+    m_count = 0;
+    m_preTriggerCount = 0;
+    m_postTriggerCount = 0;
+    m_hasLastSample = false;
+    m_written = 0;
+
+    // Set last, so addSample only sees the ring once it is reset
+    m_state = BURST_STATE_ARMED;
+}
+
+/*
+ * addSample
+ *
+ * Adds one raw sample to the ring and checks it against the trigger.
+ * Samples are ignored until the capture is set up, and while a capture is waiting to be written.
+ * Returns the state after the sample has been added.
+ */
+BURST_STATE DataFieldBurst::addSample(int32_t sample)
+{
+    bool triggered;
+
+    if ((m_state != BURST_STATE_ARMED) && (m_state != BURST_STATE_TRIGGERED)) { return m_state; }
+
+    m_buffer[m_head] = sample;
+    m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+    if (m_count < m_capacity) { m_count++; }
+
+    if (m_state == BURST_STATE_ARMED)
+    {
+        if (m_edge == BURST_TRIGGER_RISING)
+        {
+            triggered = m_hasLastSample && (m_lastSample < m_threshold) && (sample >= m_threshold);
+        }
+        else
+        {
+            triggered = m_hasLastSample && (m_lastSample > m_threshold) && (sample <= m_threshold);
+        }
+
+        m_lastSample = sample;
+        m_hasLastSample = true;
+
+        if (!triggered) { return m_state; }
+
+        // Samples older than preTrigger will be overwritten by the post-trigger samples
+        m_preTriggerCount = ((m_count - 1) < m_preTrigger) ? (m_count - 1) : m_preTrigger;
+        m_postTriggerCount = 0;
+        m_state = BURST_STATE_TRIGGERED;
+    }
+
+    if (++m_postTriggerCount == m_postTrigger)
+    {
+        m_state = BURST_STATE_CAPTURED;
+    }
+
+    return m_state;
+}
+
+BURST_STATE DataFieldBurst::state(void)
+{
+    return m_state;
+}
+
+/*
+ * capturedCount
+ *
+ * Returns the number of samples in the capture (0 until a capture is complete)
+ */
+uint16_t DataFieldBurst::capturedCount(void)
+{
+    return (m_state == BURST_STATE_CAPTURED) ? (m_preTriggerCount + m_postTriggerCount) : 0;
+}
+
+/*
+ * preTriggerCount
+ *
+ * Returns the number of captured samples before the trigger sample
+ * (fewer than preTrigger if the trigger came soon after arming)
+ */
+uint16_t DataFieldBurst::preTriggerCount(void)
+{
+    return (m_state == BURST_STATE_CAPTURED) ? m_preTriggerCount : 0;
+}
+
+/*
+ * getCapturedSample
+ *
+ * Returns captured sample index (0 is the oldest, preTriggerCount() is the trigger sample)
+ */
+int32_t DataFieldBurst::getCapturedSample(uint16_t index)
+{
+    uint16_t count = capturedCount();
+
+    if (index >= count) { return 0; }
+
+    // The capture is the last count samples written to the ring
+    return m_buffer[(m_head + m_capacity - count + index) % m_capacity];
+}
+
+/*
+ * writeCapture
+ *
+ * Appends up to maxSamples of a complete capture to filename, one "offset,value" line per sample,
+ * where offset is the sample's position relative to the trigger sample.
+ * Each capture starts with a header line, so several captures can share a file.
+ * Once the whole capture has been written, the capture is re-armed and true is returned.
+ * Returns false if there is more to write, nothing has been captured or the file could not be opened.
+ */
+bool DataFieldBurst::writeCapture(LocalStorageInterface * storage, char const * filename, uint16_t maxSamples)
+{
+    char line[32];
+    FixedLengthAccumulator accumulator(line, sizeof(line));
+    uint16_t count = capturedCount();
+    uint16_t lines = 0;
+    int32_t sample;
+
+    if (!storage || !filename || (count == 0)) { return false; }
+
+    FILE_HANDLE file = storage->openFile(filename, true);
+    if (file == INVALID_HANDLE) { return false; }
+
+    if (m_written == 0)
+    {
+        if (m_field)
+        {
+            accumulator.writeString("Sample,Channel ");
+            accumulator.appendUInt(m_field->getChannelNumber());
+            accumulator.writeString(CRLF);
+            storage->write(file, line);
+        }
+        else
+        {
+            storage->write(file, "Sample,Raw\r\n");
+        }
+    }
+
+    while ((m_written < count) && (lines < maxSamples))
+    {
+        sample = getCapturedSample(m_written);
+
+        accumulator.reset();
+        accumulator.appendInt((int32_t)m_written - (int32_t)m_preTriggerCount);
+        accumulator.writeChar(',');
+
+        if (m_field)
+        {
+            accumulator.appendFixed(m_field->convertData((float)sample), 3);
+        }
+        else
+        {
+            accumulator.appendInt(sample);
+        }
+
+        accumulator.writeString(CRLF);
+        storage->write(file, line);
+        m_written++;
+        lines++;
+    }
+
+    storage->closeFile(file);
+
+    if (m_written < count) { return false; }
+
+    arm();
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef _DATAFIELD_BURST_H_
+#define _DATAFIELD_BURST_H_
+
+/*
+ * DataFieldBurst
+ *
+ * Captures fast transients (inrush current, motor starts) on one channel,
+ * which the averaged rows would hide.
+ * Raw samples are passed to addSample as fast as the ADC can read them, into a ring
+ * of the last preTrigger + postTrigger samples. When a sample crosses the trigger
+ * threshold, postTrigger more samples are taken and the ring is frozen until
+ * writeCapture has streamed it to local storage, after which the capture re-arms.
+ *
+ * The ring is provided by the caller, so nothing is allocated, and addSample does
+ * a fixed, small amount of work (it can be called from an interrupt).
+ * writeCapture writes a few samples per call, so it can run as a TaskAction
+ * without holding up the rest of the schedule (or the storage interface, which
+ * is only held open during the call).
+ */
+
+enum burst_trigger
+{
+    BURST_TRIGGER_RISING, // Previous sample below threshold, this sample at or above
+    BURST_TRIGGER_FALLING // Previous sample above threshold, this sample at or below
+};
+typedef enum burst_trigger BURST_TRIGGER;
+
+enum burst_state
+{
+    BURST_STATE_IDLE, // Not set up
+    BURST_STATE_ARMED, // Filling the ring, waiting for the trigger
+    BURST_STATE_TRIGGERED, // Taking the post-trigger samples
+    BURST_STATE_CAPTURED // Ring frozen, waiting to be written
+};
+typedef enum burst_state BURST_STATE;
+
+class DataFieldBurst
+{
+    public:
+        DataFieldBurst(int32_t * buffer, uint16_t size);
+
+        bool setup(NumericDataField * field, uint16_t preTrigger, uint16_t postTrigger,
+            int32_t threshold, BURST_TRIGGER edge);
+        void arm(void);
+
+        BURST_STATE addSample(int32_t sample);
+        BURST_STATE state(void);
+
+        uint16_t capturedCount(void);
+        uint16_t preTriggerCount(void);
+        int32_t getCapturedSample(uint16_t index);
+
+        bool writeCapture(LocalStorageInterface * storage, char const * filename, uint16_t maxSamples);
+
+    private:
+        int32_t * m_buffer;
+        uint16_t m_size;
+
+        NumericDataField * m_field;
+        uint16_t m_preTrigger;
+        uint16_t m_postTrigger;
+        uint16_t m_capacity;
+        int32_t m_threshold;
+        BURST_TRIGGER m_edge;
+
+        // Written by addSample (which may be called from an interrupt)
+        volatile BURST_STATE m_state;
+        volatile uint16_t m_head;
+        volatile uint16_t m_count;
+        volatile uint16_t m_preTriggerCount;
+        volatile uint16_t m_postTriggerCount;
+        int32_t m_lastSample;
+        bool m_hasLastSample;
+
+        uint16_t m_written;
+};
+
+#endif
@@ -24,31 +24,19 @@
  * Datalogger Library Includes
  */
 
-#include "DLUtility.Averager.h"
 #include "DLUtility.PD.h"
+#include "DLUtility.Averager.h"
 #include "DLSensor.Thermistor.h"
 #include "DLDataField.Types.h"
+#include "DLDataField.Conversion.h"
 #include "DLDataField.h"
 
 /*
- * Private Functions
+ * Defines and Typedefs
  */
 
-/* 
- * mvToAmps
- *
- * Where a reading in mV represents a current,
- * perform a conversion based on mvPerAmp factor.
- * Since sensors may output at >0V for 0A, allow application of an offset
- *
- * mv: millivolt reading representing current
- * mvPerAmp: conversion factor
- * mvAtZero : Zero offset
- */
-static float mvToAmps(float mV, float mVperAmp, float mvAtZero)
-{
-	return (mV - mvAtZero) / mVperAmp;
-}
+// The raw reading at which the affine conversions are measured (far enough from 0 to keep them accurate)
+#define AFFINE_SAMPLE_RAW (65536.0f)
 
 /*
  * Public Functions
@@ -76,19 +64,9 @@ float CONV_ADCtoMillivolts(float in, float mvPerBit)
  * raw: Raw ADC reading
  * conversionData : Pointer to conversion data to use
  */
-float CONV_VoltsFromRaw(float raw, VOLTAGECHANNEL * conversionData)
+float CONV_VoltsFromRaw(float raw, VOLTAGECHANNEL const * conversionData)
 {
-	if (conversionData)
-	{
-		float volts = CONV_ADCtoMillivolts(raw, conversionData->mvPerBit) / 1000;
-    	volts -= conversionData->offset;
-    	volts *= conversionData->multiplier;
-    	return PD_GetInputVoltage(volts, conversionData->R1, conversionData->R2);
-    }
-    else
-    {
-    	return raw;
-    }
+	return conversionData ? CONV_VoltsFromRaw(raw, *conversionData) : raw;
 }
 
 /* 
@@ -96,21 +74,14 @@ float CONV_VoltsFromRaw(float raw, VOLTAGECHANNEL * conversionData)
  *
  * Convert a raw ADC reading into a current, assuming the current and
  * ADC are described by data in a CURRENTCHANNEL.
+ * Since sensors may output at >0V for 0A, the offset (mV at 0A) is subtracted.
  *
  * raw: Raw ADC reading
  * conversionData : Pointer to conversion data to use
  */
-float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL * conversionData)
+float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL const * conversionData)
 {
-	if (conversionData)
-	{
-		float mv = CONV_ADCtoMillivolts(raw, conversionData->mvPerBit);
-		return mvToAmps(mv,conversionData->mvPerAmp, conversionData->offset);
-	}
-	else
-	{
-		return raw;
-	}
+	return conversionData ? CONV_AmpsFromRaw(raw, *conversionData) : raw;
 }
 
 /* 
@@ -121,8 +92,58 @@ float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL * conversionData)
  * raw: Raw ADC reading
  * conversionData : Pointer to conversion data to use
  */
-float CONV_CelsiusFromRawThermistor(float raw, THERMISTORCHANNEL * conversionData)
+float CONV_CelsiusFromRawThermistor(float raw, THERMISTORCHANNEL const * conversionData)
 {
     Thermistor thermistor = Thermistor(conversionData->B, conversionData->R25, conversionData->highside);
     return thermistor.TemperatureFromADCReading(conversionData->otherR, raw, conversionData->maxADC);
 }
+
+/*
+ * CONV_VoltsAffine
+ *
+ * CONV_VoltsFromRaw is linear in the raw reading, so it can be expressed
+ * as (raw * gain) + offset. Calculate that gain and offset from the conversion itself.
+ *
+ * conversionData : Pointer to conversion data to use
+ * pGain, pOffset : Pointers to the results
+ */
+void CONV_VoltsAffine(VOLTAGECHANNEL const * conversionData, float * pGain, float * pOffset)
+{
+	if (!pGain || !pOffset) { return; }
+
+	if (conversionData)
+	{
+		*pOffset = CONV_VoltsFromRaw(0.0f, *conversionData);
+		*pGain = (CONV_VoltsFromRaw(AFFINE_SAMPLE_RAW, *conversionData) - *pOffset) / AFFINE_SAMPLE_RAW;
+	}
+	else
+	{
+		*pGain = 1.0f;
+		*pOffset = 0.0f;
+	}
+}
+
+/*
+ * CONV_AmpsAffine
+ *
+ * CONV_AmpsFromRaw is linear in the raw reading, so it can be expressed
+ * as (raw * gain) + offset. Calculate that gain and offset from the conversion itself.
+ *
+ * conversionData : Pointer to conversion data to use
+ * pGain, pOffset : Pointers to the results
+ */
+void CONV_AmpsAffine(CURRENTCHANNEL const * conversionData, float * pGain, float * pOffset)
+{
+	if (!pGain || !pOffset) { return; }
+
+	if (conversionData)
+	{
+		*pOffset = CONV_AmpsFromRaw(0.0f, *conversionData);
+		*pGain = (CONV_AmpsFromRaw(AFFINE_SAMPLE_RAW, *conversionData) - *pOffset) / AFFINE_SAMPLE_RAW;
+	}
+	else
+	{
+		*pGain = 1.0f;
+		*pOffset = 0.0f;
+	}
+}
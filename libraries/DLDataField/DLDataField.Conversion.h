@@ -3,8 +3,29 @@
 
 float CONV_ADCtoMillivolts(float in, float mvPerBit);
 
-float CONV_VoltsFromRaw(float raw, VOLTAGECHANNEL * conversionData);
-float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL * conversionData);
-float CONV_CelsiusFromRawThermistor(float raw, THERMISTORCHANNEL * conversionData);
+/*
+ * The conversion formulas themselves.
+ * The pointer versions below, the affine versions and the DataFieldT conversion
+ * policies all use these, so they are inline for the policies.
+ * The potential divider step is PD_GetInputVoltage.
+ */
+inline float CONV_VoltsFromRaw(float raw, VOLTAGECHANNEL const & conversionData)
+{
+    float volts = ((raw * conversionData.mvPerBit) / 1000) - conversionData.offset;
+    volts *= conversionData.multiplier;
+    return PD_GetInputVoltage(volts, conversionData.R1, conversionData.R2);
+}
+
+inline float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL const & conversionData)
+{
+    return ((raw * conversionData.mvPerBit) - conversionData.offset) / conversionData.mvPerAmp;
+}
+
+float CONV_VoltsFromRaw(float raw, VOLTAGECHANNEL const * conversionData);
+float CONV_AmpsFromRaw(float raw, CURRENTCHANNEL const * conversionData);
+float CONV_CelsiusFromRawThermistor(float raw, THERMISTORCHANNEL const * conversionData);
+
+void CONV_VoltsAffine(VOLTAGECHANNEL const * conversionData, float * pGain, float * pOffset);
+void CONV_AmpsAffine(CURRENTCHANNEL const * conversionData, float * pGain, float * pOffset);
 
 #endif
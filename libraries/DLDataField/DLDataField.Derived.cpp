@@ -0,0 +1,142 @@
+/*
+ * DLDataField.Derived.cpp
+ * 
+ * Provides fields calculated from the values of other fields
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else 
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLUtility.h"
+
+/*
+ * Private Variables
+ */
+
+static const float SECONDS_PER_HOUR = 3600.0f;
+
+/*
+ * Public class Functions
+ */
+
+DerivedDataField::DerivedDataField(FIELD_TYPE type, void * fieldData, uint32_t channelNumber) : DataField(type, channelNumber)
+{
+    memset(&m_inputs, 0, sizeof(m_inputs));
+
+    if (fieldData)
+    {
+        m_inputs = *(DERIVEDCHANNEL*)fieldData;
+        if (m_inputs.inputCount > DERIVED_CHANNEL_MAX_INPUTS) { m_inputs.inputCount = DERIVED_CHANNEL_MAX_INPUTS; }
+    }
+
+    m_total = 0.0;
+}
+
+DerivedDataField::~DerivedDataField() {}
+
+uint8_t DerivedDataField::inputCount(void)
+{
+    return m_inputs.inputCount;
+}
+
+uint32_t DerivedDataField::getInputChannel(uint8_t index)
+{
+    return (index < m_inputs.inputCount) ? m_inputs.inputs[index] : 0;
+}
+
+bool DerivedDataField::isLazy(void)
+{
+    return m_fieldType != DERIVED_INTEGRAL;
+}
+
+/*
+ * evaluate
+ *
+ * Returns the product or sum of inputCount() input values,
+ * or DATAFIELD_NO_DATA_VALUE if any input has no data
+ */
+float DerivedDataField::evaluate(float const * inputs)
+{
+    uint8_t i;
+    float result;
+
+    if (!inputs || (m_inputs.inputCount == 0)) { return DATAFIELD_NO_DATA_VALUE; }
+
+    result = (m_fieldType == DERIVED_PRODUCT) ? 1.0f : 0.0f;
+
+    for (i = 0; i < m_inputs.inputCount; ++i)
+    {
+        if (inputs[i] == DATAFIELD_NO_DATA_VALUE) { return DATAFIELD_NO_DATA_VALUE; }
+
+        if (m_fieldType == DERIVED_PRODUCT)
+        {
+            result *= inputs[i];
+        }
+        else
+        {
+            result += inputs[i];
+        }
+    }
+
+    return result;
+}
+
+/*
+ * integrate
+ *
+ * Adds value held for a number of seconds to the running total, and returns the total.
+ * The total is in input units x hours (e.g. Wh for an input in W).
+ * Intervals without data are skipped.
+ */
+float DerivedDataField::integrate(float value, uint32_t seconds)
+{
+    if (value != DATAFIELD_NO_DATA_VALUE)
+    {
+        m_total += (double)value * ((double)seconds / SECONDS_PER_HOUR);
+    }
+
+    return (float)m_total;
+}
+
+float DerivedDataField::getTotal(void)
+{
+    return (float)m_total;
+}
+
+void DerivedDataField::setTotal(float total)
+{
+    m_total = total;
+}
+
+void DerivedDataField::getConfigString(char * buffer)
+{
+    uint8_t i;
+
+    if (!buffer) { return; }
+
+    buffer += sprintf(buffer, "%s of", getTypeString());
+    for (i = 0; i < m_inputs.inputCount; ++i)
+    {
+        buffer += sprintf(buffer, "%s %d", (i == 0) ? "" : ",", m_inputs.inputs[i]);
+    }
+}
@@ -18,8 +18,11 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #endif
 
+#include <new>
+
 #ifdef TEST
 #include <iostream>
 #endif
@@ -28,28 +31,104 @@
  * Datalogger Library Includes
  */
 
+#include "DLUtility.Arena.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Spill.h"
+#include "DLDataField.Snapshot.h"
 #include "DLDataField.Manager.h"
 #include "DLSettings.Reader.Errors.h"
 #include "DLSettings.DataChannels.h"
+#include "DLSettings.Global.h"
 #include "DLUtility.h"
 #include "DLUtility.ArrayFunctions.h"
+#include "DLUtility.CRC.h"
 #include "DLPlatform.h"
 
+/*
+ * Private Variables
+ */
+
+static const uint8_t FIELD_SLOT_NONE = 0xFF;
+
+// With row statistics, the stored values are followed by the minimum,
+// maximum and variance of the raw samples behind each value
+static const uint8_t STATISTICS_PER_COLUMN = 3;
+
+/*
+ * Private Functions
+ */
+
+// Returns the sequence number of the snapshot in filename, or 0 if it has no readable snapshot
+static uint32_t snapshotSequence(LocalStorageInterface * storage, char const * filename)
+{
+    uint32_t sequence;
+    DataFieldSnapshotReader reader(storage);
+
+    if (!reader.open(filename)) { return 0; }
+
+    // Only the header is read, so close() reports the snapshot as incomplete
+    sequence = reader.sequence();
+    reader.close();
+
+    return sequence;
+}
+
 DataFieldManager::DataFieldManager(uint32_t dataSize, uint32_t averagerSize)
 {
     m_dataSize = dataSize;
     m_averagerSize = averagerSize;
     m_fieldCount = 0;
-    m_dataCount = 0;
 
     uint8_t i = 0;
     for (i = 0; i < MAX_FIELDS; i++)
     {
         m_fields[i] = NULL;
     }
+
+    memset(m_rowStats, 0, sizeof(m_rowStats));
+    m_keepRowStatistics = false;
+    m_statsRow = NULL;
+    memset(m_channelSlots, FIELD_SLOT_NONE, sizeof(m_channelSlots));
+    m_gatherCount = 0;
+    m_storedColumnCount = 0;
+
+    m_derivedCount = 0;
+    m_hasIntegrals = false;
+    m_lastRowTime = 0;
+
+    fillArray(m_deadbands, 0.0f, MAX_FIELDS);
+    fillArray(m_lastStoredValues, DATAFIELD_NO_DATA_VALUE, MAX_FIELDS);
+    memset(m_lastStoredTimes, 0, sizeof(m_lastStoredTimes));
+    m_hasDeadbands = false;
+    m_maxSilence = 0;
+    m_suppressedCount = 0;
+
+    m_fieldConversionCount = 0;
+    m_aggregationLevelCount = 0;
+
+    m_spillStorage = NULL;
+    m_spillDirectory = NULL;
+    m_spillBlockRows = 0;
+    m_spill = NULL;
+
+    m_arena = NULL;
+
+    m_snapshotSequence = 0;
+    m_snapshotSlot = 1; // So that the first snapshot is written to slot A
+}
+
+DataFieldManager::~DataFieldManager()
+{
+    destroySpill();
+
+    // Arena memory is released with the arena
+    if (!(m_arena && m_arena->owns(m_statsRow))) { delete[] m_statsRow; }
 }
 
 uint8_t DataFieldManager::fieldCount()
@@ -70,17 +149,31 @@ bool DataFieldManager::addField(NumericDataField * field)
 
     if (m_fieldCount == MAX_FIELDS) { return false; }
 
+    // Once the store is sized, the row width is fixed
+    if (m_store.isAllocated()) { return false; }
+
+    if (m_arena) { field->setArena(m_arena); }
+
     // The field might need extra setup based on the datatype/sensor and platform.
     // The platform interface takes care of that.
     PLATFORM_specialFieldSetup(field);
 
-    field->setDataSizes(m_dataSize, m_averagerSize);
+    // Thermistor conversions are expensive, so precalculate them (after any platform override)
+    field->setupConversionTable(DATAFIELD_THERMISTOR_TABLE_SIZE);
 
-    m_fields[m_fieldCount] = field;
-    m_channelNumbers[m_fieldCount] = field->getChannelNumber();
-    m_fieldCount++;
+    // Averaged data is kept in the manager's store, so the field only needs an averager
+    field->setAveragerSize(m_averagerSize);
 
-    return true;
+    // Channel 0 has no place in the raw data array, so the field is never given data
+    if (field->getChannelNumber() > 0)
+    {
+        m_gatherFields[m_gatherCount] = field;
+        m_gatherSlots[m_gatherCount] = m_fieldCount;
+        m_gatherDataIndexes[m_gatherCount] = field->getChannelNumber() - 1;
+        m_gatherCount++;
+    }
+
+    return addFieldSlot(field);
 }
 
 bool DataFieldManager::addField(StringDataField * field)
@@ -89,55 +182,431 @@ bool DataFieldManager::addField(StringDataField * field)
 
     if (m_fieldCount == MAX_FIELDS) { return false; }
 
-    m_fields[m_fieldCount] = field;
-    m_channelNumbers[m_fieldCount] = field->getChannelNumber();
+    if (m_store.isAllocated()) { return false; }
 
-    m_fieldCount++;
+    return addFieldSlot(field);
+}
+
+/*
+ * addField (DerivedDataField)
+ *
+ * Products and sums take no space in the stores: they are calculated from
+ * their inputs (in units) when a row is read with conversion.
+ * Integrals are updated each time a row is stored, and stored like any other field.
+ * Inputs are looked up by channel when the store is sized, and must be fields
+ * added before this one; inputs that are not found read as DATAFIELD_NO_DATA_VALUE.
+ */
+bool DataFieldManager::addField(DerivedDataField * field)
+{
+    if (!field) { return false; }
+
+    if (m_fieldCount == MAX_FIELDS) { return false; }
+
+    if (m_store.isAllocated()) { return false; }
+
+    m_derivedFields[m_derivedCount] = field;
+    m_derivedSlots[m_derivedCount] = m_fieldCount;
+    m_derivedCount++;
+
+    m_hasIntegrals |= !field->isLazy();
+
+    return addFieldSlot(field);
+}
+
+/*
+ * addAggregationLevel
+ *
+ * Adds a level that averages every decimation rows of the level below into one row,
+ * and keeps the last rows of those averages.
+ * Level 0 is the manager's own store. Returns the new level number, or -1 on failure.
+ */
+int8_t DataFieldManager::addAggregationLevel(uint32_t decimation, uint32_t rows)
+{
+    if ((decimation == 0) || (rows == 0)) { return -1; }
+
+    if (m_aggregationLevelCount == MAX_AGGREGATION_LEVELS) { return -1; }
+
+    if (m_store.isAllocated()) { return -1; }
+
+    m_levelDecimation[m_aggregationLevelCount] = decimation;
+    m_levelRows[m_aggregationLevelCount] = rows;
+    m_aggregationLevelCount++;
+
+    return m_aggregationLevelCount;
+}
+
+uint8_t DataFieldManager::levelCount(void)
+{
+    return m_aggregationLevelCount + 1;
+}
+
+/*
+ * setSpillStorage
+ *
+ * When the base store is full, rather than overwriting the oldest row,
+ * the oldest blockRows rows are written out to a file in directory.
+ * Spilled rows are read back (oldest first) by getDataArray before the rows in RAM.
+ * blockRows must be no larger than the base store size.
+ * The storage interface is used from storeDataArray and getDataArray, so
+ * other files should not be held open across those calls on single-file platforms.
+ */
+bool DataFieldManager::setSpillStorage(LocalStorageInterface * storage, char const * directory, uint32_t blockRows)
+{
+    if (!storage || !directory) { return false; }
+
+    if ((blockRows == 0) || (blockRows > m_dataSize)) { return false; }
+
+    if (m_store.isAllocated()) { return false; }
+
+    m_spillStorage = storage;
+    m_spillDirectory = directory;
+    m_spillBlockRows = blockRows;
+
+    return true;
+}
+
+/*
+ * spilledCount
+ *
+ * Returns the number of rows currently held in spill storage
+ */
+uint32_t DataFieldManager::spilledCount(void)
+{
+    return m_spill ? m_spill->length() : 0;
+}
+
+/*
+ * setDeadband
+ *
+ * Once a channel's value has been stored, later values are only stored if they
+ * differ from it (in units) by more than deadband, or the max silence interval has passed.
+ * Values that are not stored read back as DATAFIELD_NO_DATA_VALUE, and rows where no
+ * value is stored are not stored at all, so slow-moving channels cost little storage or upload.
+ * The aggregation levels still average every row. A deadband of 0 stores every value.
+ * Returns false if no field has the channel, or the deadband is negative.
+ */
+bool DataFieldManager::setDeadband(uint8_t channel, float deadband)
+{
+    uint8_t field;
+
+    if (deadband < 0.0f) { return false; }
+
+    int32_t index = indexOf(m_channelNumbers, (uint32_t)channel, m_fieldCount);
+    if (index < 0) { return false; }
+
+    m_deadbands[index] = deadband;
+
+    m_hasDeadbands = false;
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        m_hasDeadbands |= (m_deadbands[field] > 0.0f);
+    }
+
+    return true;
+}
+
+/*
+ * setMaxSilence
+ *
+ * A value is stored, even if it is within its deadband, once seconds have passed
+ * since the field was last stored (so an unchanging channel is still seen to be alive).
+ * Silence is measured with the timestamps passed to storeDataArray. 0 (the default) for no limit.
+ */
+void DataFieldManager::setMaxSilence(uint32_t seconds)
+{
+    m_maxSilence = seconds;
+}
+
+/*
+ * suppressedCount
+ *
+ * Returns the number of rows that were not stored because every value was within its deadband
+ */
+uint32_t DataFieldManager::suppressedCount(void)
+{
+    return m_suppressedCount;
+}
+
+/*
+ * setRowStatistics
+ *
+ * If keep is true, every base level row is stored with the minimum, maximum and variance
+ * of the raw samples behind each value, and they are returned by the getDataArray and
+ * drainRows overloads that take statistics (and saved in spill blocks and snapshots).
+ * This costs three floats per stored field per row. Aggregated rows have no statistics.
+ */
+bool DataFieldManager::setRowStatistics(bool keep)
+{
+    if (m_store.isAllocated()) { return false; }
+
+    m_keepRowStatistics = keep;
     return true;
 }
 
+/*
+ * storeDataArray
+ *
+ * Pass one set of raw channel data to each field's averager.
+ * When the averagers complete, the new averages are stored as a single row,
+ * stamped with the timestamp of the data that completed it (0 if not given).
+ * If storage has not been allocated (see allocateStorage), it is allocated on the first call.
+ */
 void DataFieldManager::storeDataArray(int32_t * data)
+{
+    storeDataArray(data, 0);
+}
+
+void DataFieldManager::storeDataArray(int32_t * data, UNIX_TIMESTAMP timestamp)
 {
     uint16_t field = 0;
 
+    if (!data) { return; }
+
+    if (!m_store.isAllocated())
+    {
+        if (!allocateStorage()) { return; }
+    }
+
     // The data manager stores only the fields of interest, but 
-    // the incoming data array is for ALL channels for the platform
-    // dataIndex is the correct index for the raw data array
-    uint16_t dataIndex;
+    // the incoming data array is for ALL channels for the platform,
+    // so gather each numeric field's channel from it (non-numeric fields have no data)
+    fillArray(m_newRow, DATAFIELD_NO_DATA_VALUE, m_storedColumnCount);
 
     bool newAverageStored = false;
-    for (field = 0; field < m_fieldCount; field++)
+    for (field = 0; field < m_gatherCount; field++)
     {
-        NumericDataField* pField = (NumericDataField*)m_fields[field];
-        if (pField)
-        {
-            dataIndex = m_channelNumbers[field] - 1;
-            newAverageStored |= pField->storeData( data[dataIndex] );
-        }
+        newAverageStored |= m_gatherFields[field]->averageData(
+            data[m_gatherDataIndexes[field]], &m_newRow[m_gatherColumns[field]], &m_rowStats[m_gatherSlots[field]]);
+    }
+
+    if (!newAverageStored) { return; }
+
+    if (m_hasIntegrals) { updateIntegrals(timestamp); }
+
+    if (!m_hasDeadbands || applyDeadbands(timestamp))
+    {
+        // If spilling fails (e.g. storage is unavailable), the oldest row in RAM is overwritten
+        if (m_store.full() && m_spill) { m_spill->spillRows(&m_store); }
+
+        float const * row = m_hasDeadbands ? m_sparseRow : m_newRow;
+        m_store.pushRow(m_keepRowStatistics ? addRowStatistics(row) : row, timestamp);
     }
 
-    if (newAverageStored) { m_dataCount++; }
+    // Feed each new row up through the levels for as long as rows are completed
+    uint8_t level;
+    for (level = 0; level < m_aggregationLevelCount; ++level)
+    {
+        if (!m_levels[level].addRow(m_newRow, m_newRow, timestamp)) { break; }
+    }
 }
 
+/*
+ * getDataArray
+ *
+ * Copy the oldest row of data into buffer (which must have space for fieldCount() values).
+ * If converted is true, each value is converted to units by its field.
+ * If pTimestamp is not NULL, the row's timestamp is copied there.
+ * If there is no data, buffer is filled with DATAFIELD_NO_DATA_VALUE (and pTimestamp is untouched).
+ */
 void DataFieldManager::getDataArray(float * buffer, bool converted, bool alsoRemove)
 {
-    uint16_t field;
-    for(field = 0; field < m_fieldCount; ++field)
+    getLevelDataArray(0, buffer, converted, alsoRemove, NULL);
+}
+
+void DataFieldManager::getDataArray(float * buffer, bool converted, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp)
+{
+    getLevelDataArray(0, buffer, converted, alsoRemove, pTimestamp);
+}
+
+/*
+ * As above, also copying the statistics of each value into stats (which must have
+ * space for fieldCount() entries). Values with no statistics (row statistics are not kept,
+ * or the value is not a stored average) have n = 0.
+ */
+void DataFieldManager::getDataArray(
+    float * buffer, bool converted, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp, AVERAGER_STATS * stats)
+{
+    readLevelRow(0, buffer, converted, alsoRemove, pTimestamp, stats);
+}
+
+/*
+ * drainRows
+ *
+ * Remove up to maxRows of the oldest rows into out, which must have space
+ * for (maxRows x fieldCount()) values. Rows are copied row-major, oldest first.
+ * If converted is true, each row is converted to units.
+ * If timestamps is not NULL, it must have space for maxRows timestamps,
+ * and each row's timestamp is copied there.
+ * Returns the number of rows copied.
+ */
+uint32_t DataFieldManager::drainRows(float * out, uint32_t maxRows, bool converted)
+{
+    return drainRows(out, maxRows, converted, NULL);
+}
+
+uint32_t DataFieldManager::drainRows(float * out, uint32_t maxRows, bool converted, UNIX_TIMESTAMP * timestamps)
+{
+    return drainRows(out, maxRows, converted, timestamps, NULL);
+}
+
+/*
+ * As above, also copying the statistics of each value into stats (if not NULL),
+ * which must have space for (maxRows x fieldCount()) entries.
+ */
+uint32_t DataFieldManager::drainRows(
+    float * out, uint32_t maxRows, bool converted, UNIX_TIMESTAMP * timestamps, AVERAGER_STATS * stats)
+{
+    uint32_t rows = 0;
+    uint32_t row;
+
+    if (!out) { return 0; }
+
+    // Rows with statistics are wider than the output rows, so are read one at a time
+    if (m_keepRowStatistics)
     {
-        if (converted)
-        {
-            buffer[field] = ((NumericDataField*)m_fields[field])->getConvData(alsoRemove);
-        }
-        else
+        while ((rows < maxRows) && readLevelRow(0, &out[rows * m_fieldCount], converted, true,
+            timestamps ? &timestamps[rows] : NULL, stats ? &stats[rows * m_fieldCount] : NULL))
         {
-            buffer[field] = ((NumericDataField*)m_fields[field])->getRawData(alsoRemove);
+            rows++;
         }
+        return rows;
+    }
+
+    // Spilled rows are older than the rows in RAM, and are paged back one row at a time
+    while (m_spill && (rows < maxRows) &&
+        m_spill->readRow(&out[rows * m_fieldCount], true, timestamps ? &timestamps[rows] : NULL))
+    {
+        expandRow(&out[rows * m_fieldCount], &out[rows * m_fieldCount]);
+        rows++;
+    }
+
+    // Stored rows are read in bulk, then spread out to make room for the fields that are not stored
+    row = m_store.readRows(&out[rows * m_fieldCount], maxRows - rows, timestamps ? &timestamps[rows] : NULL);
+    expandRows(&out[rows * m_fieldCount], row);
+    rows += row;
+
+    for (row = 0; row < rows; ++row)
+    {
+        if (converted) { convertRow(&out[row * m_fieldCount], &out[row * m_fieldCount]); }
+        if (stats) { getRowStatistics(NULL, &stats[row * m_fieldCount]); }
+    }
+
+    return rows;
+}
+
+/*
+ * getLevelDataArray
+ *
+ * As getDataArray, but reads from the requested aggregation level (0 is the base level).
+ * Aggregated rows are stamped with the timestamp of the last row that went into them.
+ */
+void DataFieldManager::getLevelDataArray(uint8_t level, float * buffer, bool converted, bool alsoRemove)
+{
+    getLevelDataArray(level, buffer, converted, alsoRemove, NULL);
+}
+
+void DataFieldManager::getLevelDataArray(
+    uint8_t level, float * buffer, bool converted, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp)
+{
+    readLevelRow(level, buffer, converted, alsoRemove, pTimestamp, NULL);
+}
+
+/*
+ * readLevelRow
+ *
+ * Reads the oldest row of a level into buffer (and its statistics into stats, if not NULL).
+ * Returns false, and fills buffer with DATAFIELD_NO_DATA_VALUE, if the level has no data.
+ */
+bool DataFieldManager::readLevelRow(uint8_t level, float * buffer, bool converted, bool alsoRemove,
+    UNIX_TIMESTAMP * pTimestamp, AVERAGER_STATS * stats)
+{
+    if (!buffer) { return false; }
+
+    DataFieldStore * store = levelStore(level);
+
+    // Base level rows with statistics are read whole, then the values are copied out
+    bool withStatistics = (level == 0) && m_keepRowStatistics;
+    float * stored = withStatistics ? m_statsRow : buffer;
+
+    // The oldest base level rows are the ones that have been spilled
+    bool readFromSpill = (level == 0) && m_spill && m_spill->readRow(stored, alsoRemove, pTimestamp);
+
+    if (!readFromSpill && (!store || !store->readRow(stored, alsoRemove, pTimestamp)))
+    {
+        fillArray(buffer, DATAFIELD_NO_DATA_VALUE, m_fieldCount);
+        if (stats) { getRowStatistics(NULL, stats); }
+        return false;
+    }
+
+    if (stats) { getRowStatistics(withStatistics ? stored : NULL, stats); }
+
+    if (withStatistics) { memcpy(buffer, stored, m_storedColumnCount * sizeof(float)); }
+
+    expandRow(buffer, buffer);
+
+    if (converted) { convertRow(buffer, buffer); }
+
+    return true;
+}
+
+/*
+ * convertRow
+ *
+ * Convert a row of raw data (as returned by getDataArray) into units,
+ * and calculate the derived products and sums (which have no raw value).
+ * Values of DATAFIELD_NO_DATA_VALUE are left as they are.
+ * raw and out may be the same buffer.
+ */
+void DataFieldManager::convertRow(float const * raw, float * out)
+{
+    uint8_t i;
+    uint8_t field;
+
+    if (!raw || !out) { return; }
+
+    for (i = 0; i < m_fieldCount; ++i)
+    {
+        out[i] = (raw[i] == DATAFIELD_NO_DATA_VALUE) ? raw[i] : (raw[i] * m_conversionGain[i]) + m_conversionOffset[i];
+    }
+
+    // Fields that are not affine have gain 1 and offset 0 above, so raw[field] is unchanged
+    for (i = 0; i < m_fieldConversionCount; ++i)
+    {
+        field = m_fieldConversions[i];
+        if (raw[field] == DATAFIELD_NO_DATA_VALUE) { continue; }
+        out[field] = ((NumericDataField*)m_fields[field])->convertData(raw[field]);
     }
-    if (alsoRemove) { m_dataCount--; }
+
+    evaluateDerivedFields(out);
+}
+
+/*
+ * getStatisticsArray
+ *
+ * Copy the mean/min/max/variance of the raw samples that made up the most recently
+ * stored row into buffer (which must have space for fieldCount() entries).
+ * Statistics come from the running-sum averagers, so they cost nothing extra to keep.
+ */
+void DataFieldManager::getStatisticsArray(AVERAGER_STATS * buffer)
+{
+    if (!buffer) { return; }
+
+    memcpy(buffer, m_rowStats, m_fieldCount * sizeof(AVERAGER_STATS));
 }
 
+/*
+ * getChannel
+ *
+ * Returns the field for a channel number, or NULL if no field has that channel
+ */
 DataField * DataFieldManager::getChannel(uint8_t channel)
 {
+    if (channel <= MAX_CHANNEL_NUMBER)
+    {
+        uint8_t slot = m_channelSlots[channel];
+        return (slot != FIELD_SLOT_NONE) ? m_fields[slot] : NULL;
+    }
+
     int32_t actualIndex = indexOf(m_channelNumbers, (uint32_t)channel, m_fieldCount);
     return actualIndex >= 0 ? m_fields[actualIndex] : NULL;
 }
@@ -165,67 +634,951 @@ uint32_t DataFieldManager::writeHeadersToBuffer(char * buffer, uint8_t bufferLen
         headerAccumulator.writeString(m_fields[i]->getTypeString());
         if (!lastinloop(i, m_fieldCount))
         {
-            headerAccumulator.writeString(", ");
+            headerAccumulator.appendLiteral(", ");
         }
     }
 
-    headerAccumulator.writeString("\r\n");
+    headerAccumulator.appendLiteral(CRLF);
 
     return headerAccumulator.length();
 }
 
-void DataFieldManager::setupAllValidChannels(void)
+/*
+ * writeSnapshot
+ *
+ * Writes every stored row (in RAM, at each aggregation level, and the spill position),
+ * the statistics of the last row and the samples of each part-complete average.
+ * Snapshots are written to slotA and slotB alternately, each overwriting the older one,
+ * so if a snapshot is cut short (e.g. by a reset), the other slot still has the one before.
+ * Call on a schedule and before a known shutdown; at startup, readSnapshot restores
+ * the data so that a reset loses at most the rows stored since the last snapshot.
+ * The storage must not have another file open. Returns false if the snapshot could not be written
+ * (the next snapshot is then written to the same slot).
+ */
+bool DataFieldManager::writeSnapshot(LocalStorageInterface * storage, char const * slotA, char const * slotB)
 {
-    uint8_t ch;
-    NumericDataField * field;
-    FIELD_TYPE type;
-    void * data;
+    uint8_t field;
+    uint8_t level;
+    uint16_t sample;
+    uint16_t sampleCount;
+    int32_t value;
+    float total;
+    uint8_t hasSpill;
+    uint32_t sequences[2];
+    char const * slots[2] = {slotA, slotB};
 
-    uint32_t maxChannels = Settings_GetMaxChannels();
-    for (ch = 1; ch < maxChannels; ch++)
+    if (!storage || !slotA || !slotB) { return false; }
+
+    if (!m_store.isAllocated())
     {
-        if (Settings_ChannelSettingIsValid(ch))
+        if (!allocateStorage()) { return false; }
+    }
+
+    // Carry on from any snapshots written before a restart, so that this one is the newest
+    if (m_snapshotSequence == 0)
+    {
+        sequences[0] = snapshotSequence(storage, slotA);
+        sequences[1] = snapshotSequence(storage, slotB);
+        m_snapshotSequence = max(sequences[0], sequences[1]);
+        if (m_snapshotSequence > 0) { m_snapshotSlot = (sequences[1] > sequences[0]) ? 1 : 0; }
+    }
+
+    uint8_t slot = 1 - m_snapshotSlot;
+
+    DataFieldSnapshotWriter writer(storage);
+    if (!writer.open(slots[slot], m_snapshotSequence + 1)) { return false; }
+
+    uint16_t layout = snapshotLayout();
+    writer.write(&layout, sizeof(layout));
+    writer.write(m_rowStats, m_fieldCount * sizeof(AVERAGER_STATS));
+
+    for (field = 0; field < m_gatherCount; ++field)
+    {
+        sampleCount = m_gatherFields[field]->pendingSampleCount();
+        writer.write(&sampleCount, sizeof(sampleCount));
+        for (sample = 0; sample < sampleCount; ++sample)
         {
-            type = Settings_GetChannelType(ch);
-            data = Settings_GetData(ch);
+            value = m_gatherFields[field]->getPendingSample(sample);
+            writer.write(&value, sizeof(value));
+        }
+    }
 
-            switch(type)
-            {
-            case VOLTAGE:
-            case CURRENT:
-            case TEMPERATURE_C:
-            case TEMPERATURE_K:
+    m_store.writeSnapshot(&writer);
+
+    for (level = 0; level < m_aggregationLevelCount; ++level)
+    {
+        m_levels[level].writeSnapshot(&writer);
+    }
+
+    hasSpill = (m_spill != NULL);
+    writer.write(&hasSpill, sizeof(hasSpill));
+    if (m_spill) { m_spill->writeSnapshot(&writer); }
+
+    writer.write(&m_lastRowTime, sizeof(m_lastRowTime));
+    for (field = 0; field < m_derivedCount; ++field)
+    {
+        total = m_derivedFields[field]->getTotal();
+        writer.write(&total, sizeof(total));
+    }
+
+    if (!writer.close()) { return false; }
+
+    m_snapshotSequence++;
+    m_snapshotSlot = slot;
+    return true;
+}
+
+/*
+ * readSnapshot
+ *
+ * Replaces all stored data with the newest snapshot in slotA or slotB that can be restored.
+ * All fields, aggregation levels and spill storage must be set up as they were when
+ * the snapshot was written: a snapshot from a different configuration is rejected
+ * after reading its header, leaving the manager untouched.
+ * If a snapshot turns out to be truncated or corrupt, the data in RAM is cleared
+ * and the other slot is tried.
+ * Once restored, the data is live again, so both slots are removed: a later restart
+ * must not restore the same rows again. Write a new snapshot soon after.
+ * Returns true if a snapshot was restored.
+ */
+bool DataFieldManager::readSnapshot(LocalStorageInterface * storage, char const * slotA, char const * slotB)
+{
+    uint32_t sequences[2];
+    char const * slots[2] = {slotA, slotB};
+    uint8_t newest;
+    uint8_t slot;
+    uint8_t attempt;
+
+    if (!storage || !slotA || !slotB) { return false; }
+
+    if (!m_store.isAllocated())
+    {
+        if (!allocateStorage()) { return false; }
+    }
+
+    sequences[0] = snapshotSequence(storage, slotA);
+    sequences[1] = snapshotSequence(storage, slotB);
+    newest = (sequences[1] > sequences[0]) ? 1 : 0;
+
+    for (attempt = 0; attempt < 2; ++attempt)
+    {
+        slot = (attempt == 0) ? newest : (1 - newest);
+        if ((sequences[slot] > 0) && readSnapshotSlot(storage, slots[slot]))
+        {
+            m_snapshotSequence = sequences[newest];
+            m_snapshotSlot = newest;
+
+            storage->removeFile(slotA);
+            storage->removeFile(slotB);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * setArena
+ *
+ * Fields created by setupAllValidChannels, and the averagers and conversion tables
+ * of all fields added afterwards, are allocated from arena rather than the heap.
+ * Returns false if fields have already been added.
+ */
+bool DataFieldManager::setArena(Arena * arena)
+{
+    if (m_fieldCount > 0) { return false; }
+
+    m_arena = arena;
+    return true;
+}
+
+/*
+ * arenaBytesRequired
+ *
+ * Returns the arena space that setupAllValidChannels needs for the current channel settings:
+ * the fields, and storage for the aggregation levels, spill and row statistics set up so far.
+ * Stored columns are counted as floats, so fixed-point storage will use less.
+ * At startup, this can be checked against the arena (or used to size it) once the
+ * channel settings have been read.
+ */
+uint32_t DataFieldManager::arenaBytesRequired(void)
+{
+    uint8_t ch;
+    uint32_t bytes = 0;
+    uint8_t storedColumns = 0;
+
+    uint32_t maxChannels = Settings_GetMaxChannels();
+    FIELD_TYPE type;
+
+    for (ch = 1; ch < maxChannels; ch++)
+    {
+        if (Settings_ChannelSettingIsValid(ch))
+        {
+            type = Settings_GetChannelType(ch);
+            if (BETWEEN_INC(type, DERIVED_PRODUCT, DERIVED_INTEGRAL))
+            {
+                bytes += Arena::alignedSize(sizeof(DerivedDataField));
+                // Products and sums are calculated when read, so are not stored
+                if (type == DERIVED_INTEGRAL) { storedColumns++; }
+            }
+            else
+            {
+                bytes += NumericDataField::arenaBytesRequired(type, m_averagerSize, DATAFIELD_THERMISTOR_TABLE_SIZE);
+                storedColumns++;
+            }
+        }
+    }
+
+    return bytes + storageArenaBytesRequired(storedColumns);
+}
+
+/*
+ * setupAllValidChannels
+ *
+ * Creates a field for each valid channel in the settings, then allocates storage for them.
+ * If an arena is set and cannot hold every field and its storage, no fields are created
+ * and false is returned, so an oversized configuration fails at startup.
+ * Aggregation levels, spill storage and row statistics must be set up before this is called.
+ * Deadbands and the maximum silence (DATA_MAX_SILENCE_SECS) are taken from the settings.
+ */
+bool DataFieldManager::setupAllValidChannels(void)
+{
+    uint8_t ch;
+    NumericDataField * field;
+    DerivedDataField * derivedField;
+    FIELD_TYPE type;
+    void * data;
+    void * p;
+
+    if (m_arena && (arenaBytesRequired() > m_arena->available())) { return false; }
+
+    uint32_t maxChannels = Settings_GetMaxChannels();
+    for (ch = 1; ch < maxChannels; ch++)
+    {
+        if (Settings_ChannelSettingIsValid(ch))
+        {
+            type = Settings_GetChannelType(ch);
+            data = Settings_GetData(ch);
+
+            switch(type)
+            {
+            case VOLTAGE:
+            case CURRENT:
+            case TEMPERATURE_C:
+            case TEMPERATURE_K:
             case TEMPERATURE_F:
-                field = new NumericDataField(type, data, ch);
+                if (m_arena)
+                {
+                    p = m_arena->allocate(sizeof(NumericDataField));
+                    field = p ? new (p) NumericDataField(type, data, ch) : NULL;
+                }
+                else
+                {
+                    field = new NumericDataField(type, data, ch);
+                }
+
+                if (!field) { return false; }
+
                 #ifdef TEST
                 std::cout << "Adding channel " << (int)ch << ", type " << field->getTypeString() << std::endl;
                 #endif
                 addField(field);
+                setDeadband(ch, Settings_GetChannelDeadband(ch));
+                break;
+            case DERIVED_PRODUCT:
+            case DERIVED_SUM:
+            case DERIVED_INTEGRAL:
+                if (m_arena)
+                {
+                    p = m_arena->allocate(sizeof(DerivedDataField));
+                    derivedField = p ? new (p) DerivedDataField(type, data, ch) : NULL;
+                }
+                else
+                {
+                    derivedField = new DerivedDataField(type, data, ch);
+                }
+
+                if (!derivedField) { return false; }
+
+                addField(derivedField);
+                setDeadband(ch, Settings_GetChannelDeadband(ch));
                 break;
             default:
                 break;
             }
         }
     }
+
+    if (Settings_intIsSet(DATA_MAX_SILENCE_SECS))
+    {
+        setMaxSilence(Settings_getInt(DATA_MAX_SILENCE_SECS));
+    }
+
+    buildConversionPlan();
+
+    if ((m_fieldCount > 0) && !allocateStorage()) { return false; }
+
+    return !(m_arena && m_arena->failed());
 }
 
 bool DataFieldManager::hasData(void)
 {
-    uint8_t i = 0;
-    bool atLeastOneFieldHasData = false;
-    for (i = 0; i < m_fieldCount; i++)
-    {
-        atLeastOneFieldHasData |= m_fields[i]->hasData();
-    }
-    return atLeastOneFieldHasData;
+    return count() > 0;
 }
 
 uint32_t DataFieldManager::count(void)
 {
-    return m_dataCount;
+    return levelLength(0);
+}
+
+uint32_t DataFieldManager::levelLength(uint8_t level)
+{
+    DataFieldStore * store = levelStore(level);
+    uint32_t length = store ? store->length() : 0;
+
+    if ((level == 0) && m_spill) { length += m_spill->length(); }
+
+    return length;
 }
 
 uint32_t * DataFieldManager::getChannelNumbers(void)
 {
     return m_channelNumbers;
-}
\ No newline at end of file
+}
+
+/*
+ * addFieldSlot
+ *
+ * Stores the field in the next free slot and records its channel in the channel lookup.
+ * If two fields share a channel, the lookup returns the first.
+ */
+bool DataFieldManager::addFieldSlot(DataField * field)
+{
+    uint32_t channel = field->getChannelNumber();
+
+    m_fields[m_fieldCount] = field;
+    m_channelNumbers[m_fieldCount] = channel;
+
+    if ((channel <= MAX_CHANNEL_NUMBER) && (m_channelSlots[channel] == FIELD_SLOT_NONE))
+    {
+        m_channelSlots[channel] = m_fieldCount;
+    }
+
+    m_fieldCount++;
+    return true;
+}
+
+/*
+ * buildConversionPlan
+ *
+ * Fold each field's conversion into a single gain and offset where possible.
+ * Fields that cannot be folded (thermistors, alternative conversions)
+ * are listed in m_fieldConversions and converted by the field.
+ */
+void DataFieldManager::buildConversionPlan(void)
+{
+    uint8_t field;
+    NumericDataField * numericField;
+
+    m_fieldConversionCount = 0;
+
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        m_conversionGain[field] = 1.0f;
+        m_conversionOffset[field] = 0.0f;
+
+        if (!m_fields[field]->isNumeric()) { continue; }
+
+        numericField = (NumericDataField*)m_fields[field];
+        if (!numericField->getAffineConversion(&m_conversionGain[field], &m_conversionOffset[field]))
+        {
+            m_conversionGain[field] = 1.0f;
+            m_conversionOffset[field] = 0.0f;
+            m_fieldConversions[m_fieldConversionCount++] = field;
+        }
+    }
+}
+
+/*
+ * allocateStorage
+ *
+ * Called once all fields have been added: sizes the base store, the spill and the
+ * aggregation levels for the number of fields (using each field's storage format),
+ * and builds the conversion plan. If an arena is set, storage is taken from it.
+ * Returns true if storage is allocated.
+ */
+bool DataFieldManager::allocateStorage(void)
+{
+    uint8_t level;
+    uint8_t field;
+    uint8_t column;
+    void * p;
+    DATAFIELD_COLUMN_FORMAT formats[MAX_FIELDS * (1 + STATISTICS_PER_COLUMN)];
+
+    if (m_store.isAllocated()) { return true; }
+
+    buildColumnMap();
+
+    // Statistics columns are always floats
+    for (column = m_storedColumnCount; column < storedRowWidth(); ++column)
+    {
+        formats[column].storage = DATAFIELD_STORAGE_FLOAT;
+        formats[column].scale = 1.0f;
+    }
+
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        column = m_fieldColumns[field];
+        if (column == FIELD_SLOT_NONE) { continue; }
+
+        formats[column].storage = DATAFIELD_STORAGE_FLOAT;
+        formats[column].scale = 1.0f;
+
+        if (m_fields[field]->isNumeric())
+        {
+            formats[column] = ((NumericDataField*)m_fields[field])->getStorageFormat();
+        }
+    }
+
+    if (m_keepRowStatistics && !m_statsRow)
+    {
+        m_statsRow = m_arena ? (float*)m_arena->allocate(storedRowWidth() * sizeof(float)) : new float[storedRowWidth()];
+        if (!m_statsRow) { return false; }
+    }
+
+    if (!m_store.setSize(m_dataSize, storedRowWidth(), formats, m_arena)) { return false; }
+
+    if (m_spillStorage && !m_spill)
+    {
+        if (m_arena)
+        {
+            p = m_arena->allocate(sizeof(DataFieldSpill));
+            m_spill = p ? new (p) DataFieldSpill() : NULL;
+        }
+        else
+        {
+            m_spill = new DataFieldSpill();
+        }
+
+        if (m_spill && !m_spill->setup(m_spillStorage, m_spillDirectory, m_spillBlockRows, storedRowWidth(), m_arena))
+        {
+            // Carry on without spilling
+            destroySpill();
+        }
+    }
+
+    for (level = 0; level < m_aggregationLevelCount; ++level)
+    {
+        if (!m_levels[level].setSize(m_levelDecimation[level], m_levelRows[level], m_storedColumnCount, formats, m_arena))
+        {
+            // Leave the manager unallocated so storage is retried on the next call
+            m_store.setSize(0, 0);
+            return false;
+        }
+
+        // Integrals are running totals, so are not averaged
+        for (field = 0; field < m_derivedCount; ++field)
+        {
+            column = m_fieldColumns[m_derivedSlots[field]];
+            if (column != FIELD_SLOT_NONE) { m_levels[level].keepLastValue(column); }
+        }
+    }
+
+    buildConversionPlan();
+    return true;
+}
+
+/*
+ * storageArenaBytesRequired
+ *
+ * Returns the arena space that allocateStorage takes for rows of storedColumns values
+ * (each counted as a float), with the aggregation levels, spill and row statistics set up so far
+ */
+uint32_t DataFieldManager::storageArenaBytesRequired(uint8_t storedColumns)
+{
+    uint8_t level;
+    uint8_t rowWidth = m_keepRowStatistics ? (storedColumns * (1 + STATISTICS_PER_COLUMN)) : storedColumns;
+    uint32_t bytes;
+
+    if (storedColumns == 0) { return 0; }
+
+    bytes = DataFieldStore::arenaBytesRequired(m_dataSize, rowWidth, NULL);
+
+    if (m_keepRowStatistics) { bytes += Arena::alignedSize(rowWidth * sizeof(float)); }
+
+    if (m_spillStorage) { bytes += DataFieldSpill::arenaBytesRequired(m_spillBlockRows, rowWidth); }
+
+    for (level = 0; level < m_aggregationLevelCount; ++level)
+    {
+        bytes += DataFieldAggregator::arenaBytesRequired(m_levelRows[level], storedColumns, NULL);
+    }
+
+    return bytes;
+}
+
+/*
+ * destroySpill
+ *
+ * A spill in arena memory is destroyed but not freed (the arena releases it)
+ */
+void DataFieldManager::destroySpill(void)
+{
+    if (m_arena && m_arena->owns(m_spill))
+    {
+        m_spill->~DataFieldSpill();
+    }
+    else
+    {
+        delete m_spill;
+    }
+
+    m_spill = NULL;
+}
+
+/*
+ * snapshotLayout
+ *
+ * Returns a checksum of everything that determines the layout of a snapshot
+ * (fields, storage formats, store sizes and levels), so that a snapshot is only
+ * restored into the configuration that wrote it
+ */
+uint16_t DataFieldManager::snapshotLayout(void)
+{
+    uint8_t field;
+    uint32_t value;
+    DATAFIELD_COLUMN_FORMAT format;
+    uint16_t crc = CRC16_INITIAL_VALUE;
+
+    crc = crc16Update(crc, &m_fieldCount, sizeof(m_fieldCount));
+    crc = crc16Update(crc, &m_dataSize, sizeof(m_dataSize));
+    crc = crc16Update(crc, &m_averagerSize, sizeof(m_averagerSize));
+
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        value = (uint32_t)m_fields[field]->getType();
+        crc = crc16Update(crc, &value, sizeof(value));
+        crc = crc16Update(crc, &m_channelNumbers[field], sizeof(uint32_t));
+
+        if (m_fields[field]->isNumeric())
+        {
+            format = ((NumericDataField*)m_fields[field])->getStorageFormat();
+            value = (uint32_t)format.storage;
+            crc = crc16Update(crc, &value, sizeof(value));
+            crc = crc16Update(crc, &format.scale, sizeof(format.scale));
+        }
+    }
+
+    for (field = 0; field < m_derivedCount; ++field)
+    {
+        crc = crc16Update(crc, m_derivedInputs[field], sizeof(m_derivedInputs[field]));
+    }
+
+    crc = crc16Update(crc, &m_aggregationLevelCount, sizeof(m_aggregationLevelCount));
+    crc = crc16Update(crc, m_levelDecimation, m_aggregationLevelCount * sizeof(uint32_t));
+    crc = crc16Update(crc, m_levelRows, m_aggregationLevelCount * sizeof(uint32_t));
+
+    value = m_spill ? m_spill->blockRows() : 0;
+    crc = crc16Update(crc, &value, sizeof(value));
+
+    value = m_keepRowStatistics ? 1 : 0;
+    crc = crc16Update(crc, &value, sizeof(value));
+
+    return crc;
+}
+
+/*
+ * readSnapshotSlot
+ *
+ * Restores the snapshot in filename. A snapshot from a different configuration
+ * leaves the manager untouched; a truncated or corrupt one clears the data in RAM.
+ * Returns true if the snapshot was restored.
+ */
+bool DataFieldManager::readSnapshotSlot(LocalStorageInterface * storage, char const * filename)
+{
+    uint16_t layout = 0;
+    bool valid;
+
+    DataFieldSnapshotReader reader(storage);
+    if (!reader.open(filename)) { return false; }
+
+    if (!reader.read(&layout, sizeof(layout)) || (layout != snapshotLayout()))
+    {
+        reader.close();
+        return false;
+    }
+
+    valid = readSnapshotData(&reader);
+
+    // Data has already been overwritten, so anything short of a complete, matching snapshot is discarded
+    valid = reader.close() && valid;
+    if (!valid) { clearData(); }
+
+    return valid;
+}
+
+/*
+ * readSnapshotData
+ *
+ * Reads everything after the snapshot header, in the order written by writeSnapshot.
+ * Part-complete averages are restored by replaying their samples through each field.
+ */
+bool DataFieldManager::readSnapshotData(DataFieldSnapshotReader * reader)
+{
+    uint8_t field;
+    uint8_t level;
+    uint16_t sample;
+    uint16_t sampleCount;
+    int32_t value;
+    float total;
+    uint8_t hasSpill;
+    bool valid;
+
+    valid = reader->read(m_rowStats, m_fieldCount * sizeof(AVERAGER_STATS));
+
+    for (field = 0; valid && (field < m_gatherCount); ++field)
+    {
+        m_gatherFields[field]->clearPendingSamples();
+
+        // A full window would have completed an average before the snapshot was written
+        valid = reader->read(&sampleCount, sizeof(sampleCount)) && (sampleCount < m_averagerSize);
+        for (sample = 0; valid && (sample < sampleCount); ++sample)
+        {
+            valid = reader->read(&value, sizeof(value));
+            if (valid) { m_gatherFields[field]->averageData(value, NULL, NULL); }
+        }
+    }
+
+    valid = valid && m_store.readSnapshot(reader);
+
+    for (level = 0; valid && (level < m_aggregationLevelCount); ++level)
+    {
+        valid = m_levels[level].readSnapshot(reader);
+    }
+
+    valid = valid && reader->read(&hasSpill, sizeof(hasSpill)) && (hasSpill == (m_spill != NULL));
+    if (valid && m_spill) { valid = m_spill->readSnapshot(reader); }
+
+    valid = valid && reader->read(&m_lastRowTime, sizeof(m_lastRowTime));
+    for (field = 0; valid && (field < m_derivedCount); ++field)
+    {
+        valid = reader->read(&total, sizeof(total));
+        if (valid) { m_derivedFields[field]->setTotal(total); }
+    }
+
+    return valid;
+}
+
+/*
+ * clearData
+ *
+ * Removes all rows in RAM and part-complete averages
+ */
+void DataFieldManager::clearData(void)
+{
+    uint8_t field;
+    uint8_t level;
+
+    m_store.clear();
+
+    for (level = 0; level < m_aggregationLevelCount; ++level)
+    {
+        m_levels[level].clear();
+    }
+
+    // Spilled blocks are still in storage (and are found again by the spill), so they are kept
+    if (m_spill) { m_spill->clearPage(); }
+
+    for (field = 0; field < m_gatherCount; ++field)
+    {
+        m_gatherFields[field]->clearPendingSamples();
+    }
+
+    for (field = 0; field < m_derivedCount; ++field)
+    {
+        m_derivedFields[field]->setTotal(0.0f);
+    }
+
+    m_lastRowTime = 0;
+    memset(m_rowStats, 0, sizeof(m_rowStats));
+
+    fillArray(m_lastStoredValues, DATAFIELD_NO_DATA_VALUE, MAX_FIELDS);
+    memset(m_lastStoredTimes, 0, sizeof(m_lastStoredTimes));
+}
+
+/*
+ * buildColumnMap
+ *
+ * Gives each stored field a column in the stored rows, and looks up the inputs of each derived field
+ */
+void DataFieldManager::buildColumnMap(void)
+{
+    uint8_t field;
+    uint8_t derived;
+    uint8_t input;
+    uint8_t slot;
+    int32_t inputIndex;
+
+    m_storedColumnCount = 0;
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        bool lazy = m_fields[field]->isDerived() && ((DerivedDataField*)m_fields[field])->isLazy();
+        m_fieldColumns[field] = lazy ? FIELD_SLOT_NONE : m_storedColumnCount++;
+    }
+
+    for (field = 0; field < m_gatherCount; ++field)
+    {
+        m_gatherColumns[field] = m_fieldColumns[m_gatherSlots[field]];
+    }
+
+    for (derived = 0; derived < m_derivedCount; ++derived)
+    {
+        slot = m_derivedSlots[derived];
+        for (input = 0; input < DERIVED_CHANNEL_MAX_INPUTS; ++input)
+        {
+            inputIndex = -1;
+            if (input < m_derivedFields[derived]->inputCount())
+            {
+                inputIndex = indexOf(m_channelNumbers, m_derivedFields[derived]->getInputChannel(input), slot);
+            }
+            m_derivedInputs[derived][input] = (inputIndex >= 0) ? (uint8_t)inputIndex : FIELD_SLOT_NONE;
+        }
+    }
+}
+
+/*
+ * storedRowWidth
+ *
+ * Returns the number of columns in a base level row (values, and statistics if they are kept)
+ */
+uint8_t DataFieldManager::storedRowWidth(void)
+{
+    return m_keepRowStatistics ? (m_storedColumnCount * (1 + STATISTICS_PER_COLUMN)) : m_storedColumnCount;
+}
+
+/*
+ * addRowStatistics
+ *
+ * Builds a complete stored row in m_statsRow from a row of values and the statistics
+ * of the averages that were just completed. Values that are not stored averages
+ * (derived values, values within their deadband) have no statistics.
+ */
+float const * DataFieldManager::addRowStatistics(float const * row)
+{
+    uint8_t field;
+    uint8_t column;
+    AVERAGER_STATS * pStats;
+    float * pColumnStats;
+
+    memcpy(m_statsRow, row, m_storedColumnCount * sizeof(float));
+    fillArray(&m_statsRow[m_storedColumnCount], DATAFIELD_NO_DATA_VALUE, m_storedColumnCount * STATISTICS_PER_COLUMN);
+
+    for (field = 0; field < m_gatherCount; ++field)
+    {
+        column = m_gatherColumns[field];
+        if (row[column] == DATAFIELD_NO_DATA_VALUE) { continue; }
+
+        pStats = &m_rowStats[m_gatherSlots[field]];
+        pColumnStats = &m_statsRow[m_storedColumnCount + (column * STATISTICS_PER_COLUMN)];
+        pColumnStats[0] = pStats->minimum;
+        pColumnStats[1] = pStats->maximum;
+        pColumnStats[2] = pStats->variance;
+    }
+
+    return m_statsRow;
+}
+
+/*
+ * getRowStatistics
+ *
+ * Copies the statistics of each field out of a complete stored row.
+ * If stored is NULL (or a value has no statistics), the field's entry has n = 0.
+ */
+void DataFieldManager::getRowStatistics(float const * stored, AVERAGER_STATS * stats)
+{
+    uint8_t field;
+    uint8_t column;
+    float const * pColumnStats;
+
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        stats[field].mean = DATAFIELD_NO_DATA_VALUE;
+        stats[field].minimum = DATAFIELD_NO_DATA_VALUE;
+        stats[field].maximum = DATAFIELD_NO_DATA_VALUE;
+        stats[field].variance = DATAFIELD_NO_DATA_VALUE;
+        stats[field].n = 0;
+
+        column = m_fieldColumns[field];
+        if (!stored || (column == FIELD_SLOT_NONE)) { continue; }
+
+        pColumnStats = &stored[m_storedColumnCount + (column * STATISTICS_PER_COLUMN)];
+        if (pColumnStats[0] == DATAFIELD_NO_DATA_VALUE) { continue; }
+
+        stats[field].mean = stored[column];
+        stats[field].minimum = pColumnStats[0];
+        stats[field].maximum = pColumnStats[1];
+        stats[field].variance = pColumnStats[2];
+        stats[field].n = m_averagerSize;
+    }
+}
+
+/*
+ * expandRow
+ *
+ * Spreads a stored row out to one value per field (DATAFIELD_NO_DATA_VALUE for fields that are not stored).
+ * row may be the same buffer as stored, or start after it.
+ */
+void DataFieldManager::expandRow(float const * stored, float * row)
+{
+    uint8_t field;
+    uint8_t column;
+
+    if ((m_storedColumnCount == m_fieldCount) && (stored == row)) { return; }
+
+    // Working back from the last field means no stored value is overwritten before it is moved
+    field = m_fieldCount;
+    while (field--)
+    {
+        column = m_fieldColumns[field];
+        row[field] = (column == FIELD_SLOT_NONE) ? DATAFIELD_NO_DATA_VALUE : stored[column];
+    }
+}
+
+/*
+ * expandRows
+ *
+ * Spreads count stored rows, packed at the start of rows, out to fieldCount() values per row
+ */
+void DataFieldManager::expandRows(float * rows, uint32_t count)
+{
+    if (m_storedColumnCount == m_fieldCount) { return; }
+
+    while (count--)
+    {
+        expandRow(&rows[count * m_storedColumnCount], &rows[count * m_fieldCount]);
+    }
+}
+
+/*
+ * evaluateDerivedFields
+ *
+ * Calculates the products and sums in a row of converted values
+ */
+void DataFieldManager::evaluateDerivedFields(float * row)
+{
+    uint8_t derived;
+    uint8_t input;
+    uint8_t inputField;
+    float inputs[DERIVED_CHANNEL_MAX_INPUTS];
+    DerivedDataField * field;
+
+    for (derived = 0; derived < m_derivedCount; ++derived)
+    {
+        field = m_derivedFields[derived];
+        if (!field->isLazy()) { continue; }
+
+        for (input = 0; input < field->inputCount(); ++input)
+        {
+            inputField = m_derivedInputs[derived][input];
+            inputs[input] = (inputField != FIELD_SLOT_NONE) ? row[inputField] : DATAFIELD_NO_DATA_VALUE;
+        }
+
+        row[m_derivedSlots[derived]] = field->evaluate(inputs);
+    }
+}
+
+/*
+ * updateIntegrals
+ *
+ * Adds the interval since the last stored row to each integral, using the new row's
+ * (converted) input values, and writes the new totals into the new row.
+ * The first row, and rows without a later timestamp than the last, add nothing.
+ */
+void DataFieldManager::updateIntegrals(UNIX_TIMESTAMP timestamp)
+{
+    uint8_t derived;
+    uint8_t inputField;
+    uint32_t seconds;
+    float value;
+    DerivedDataField * field;
+
+    seconds = ((m_lastRowTime > 0) && (timestamp > m_lastRowTime)) ? (uint32_t)(timestamp - m_lastRowTime) : 0;
+    m_lastRowTime = timestamp;
+
+    expandRow(m_newRow, m_derivedRow);
+    convertRow(m_derivedRow, m_derivedRow);
+
+    for (derived = 0; derived < m_derivedCount; ++derived)
+    {
+        field = m_derivedFields[derived];
+        if (field->isLazy()) { continue; }
+
+        inputField = m_derivedInputs[derived][0];
+        value = (inputField != FIELD_SLOT_NONE) ? m_derivedRow[inputField] : DATAFIELD_NO_DATA_VALUE;
+        m_newRow[m_fieldColumns[m_derivedSlots[derived]]] = field->integrate(value, seconds);
+    }
+}
+
+/*
+ * applyDeadbands
+ *
+ * Copies the new row into m_sparseRow, leaving out the values that are within the deadband
+ * of the value last stored for their field (until the max silence interval has passed).
+ * Returns false if no value is left, in which case the row should not be stored.
+ */
+bool DataFieldManager::applyDeadbands(UNIX_TIMESTAMP timestamp)
+{
+    uint8_t field;
+    uint8_t column;
+    float value;
+    float lastValue;
+    bool withinDeadband;
+    bool silenceExpired;
+    bool anyStored = false;
+
+    // Deadbands are in units, so compare converted values
+    expandRow(m_newRow, m_derivedRow);
+    convertRow(m_derivedRow, m_derivedRow);
+
+    for (field = 0; field < m_fieldCount; ++field)
+    {
+        column = m_fieldColumns[field];
+        if (column == FIELD_SLOT_NONE) { continue; }
+
+        value = m_derivedRow[field];
+        lastValue = m_lastStoredValues[field];
+
+        withinDeadband = (m_deadbands[field] > 0.0f) &&
+            (value != DATAFIELD_NO_DATA_VALUE) && (lastValue != DATAFIELD_NO_DATA_VALUE) &&
+            (fabs(value - lastValue) <= m_deadbands[field]);
+
+        // A clock that has gone backwards also ends the silence
+        silenceExpired = (m_maxSilence > 0) &&
+            ((timestamp < m_lastStoredTimes[field]) || ((timestamp - m_lastStoredTimes[field]) >= m_maxSilence));
+
+        if (withinDeadband && !silenceExpired)
+        {
+            m_sparseRow[column] = DATAFIELD_NO_DATA_VALUE;
+            continue;
+        }
+
+        m_sparseRow[column] = m_newRow[column];
+
+        if (value != DATAFIELD_NO_DATA_VALUE)
+        {
+            m_lastStoredValues[field] = value;
+            m_lastStoredTimes[field] = timestamp;
+            anyStored = true;
+        }
+    }
+
+    if (!anyStored) { m_suppressedCount++; }
+
+    return anyStored;
+}
+
+DataFieldStore * DataFieldManager::levelStore(uint8_t level)
+{
+    if (level == 0) { return &m_store; }
+    if (level > m_aggregationLevelCount) { return NULL; }
+    return m_levels[level - 1].store();
+}
@@ -3,33 +3,174 @@
 
 #define MAX_FIELDS 32
 
+// Highest channel number that can be looked up directly (matches MAX_CHANNELS in settings)
+#define MAX_CHANNEL_NUMBER 32
+
+// Number of aggregation levels that can be added on top of the base level
+#define MAX_AGGREGATION_LEVELS 4
+
+class DataFieldSpill;
+class LocalStorageInterface;
+class Arena;
+
 class DataFieldManager
 {
     public:
         DataFieldManager(uint32_t dataSize, uint32_t averagerSize);
+        ~DataFieldManager();
         uint8_t fieldCount();
+        /* Fields can only be added before storage is allocated */
         bool addField(NumericDataField * field);
         bool addField(StringDataField * field);
+        /* A derived field's inputs must be added before it */
+        bool addField(DerivedDataField * field);
         DataField * getField(uint8_t index);
         DataField * getChannel(uint8_t index);
         DataField ** getFields(void);
 
+        /* Aggregation levels can only be added before storage is allocated */
+        int8_t addAggregationLevel(uint32_t decimation, uint32_t rows);
+        uint8_t levelCount(void);
+
+        /* Spill storage can only be set before storage is allocated */
+        bool setSpillStorage(LocalStorageInterface * storage, char const * directory, uint32_t blockRows);
+        uint32_t spilledCount(void);
+
+        /* Report by exception: the base store only keeps values that have moved out of their deadband */
+        bool setDeadband(uint8_t channel, float deadband);
+        void setMaxSilence(uint32_t seconds);
+        uint32_t suppressedCount(void);
+
+        /* Per-row statistics can only be turned on before storage is allocated */
+        bool setRowStatistics(bool keep);
+
         void storeDataArray(int32_t * data);
+        void storeDataArray(int32_t * data, UNIX_TIMESTAMP timestamp);
         void getDataArray(float * buffer, bool converted, bool alsoRemove);
+        void getDataArray(float * buffer, bool converted, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp);
+        void getDataArray(float * buffer, bool converted, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp, AVERAGER_STATS * stats);
+        uint32_t drainRows(float * out, uint32_t maxRows, bool converted);
+        uint32_t drainRows(float * out, uint32_t maxRows, bool converted, UNIX_TIMESTAMP * timestamps);
+        uint32_t drainRows(float * out, uint32_t maxRows, bool converted, UNIX_TIMESTAMP * timestamps, AVERAGER_STATS * stats);
+        void getLevelDataArray(uint8_t level, float * buffer, bool converted, bool alsoRemove);
+        void getLevelDataArray(uint8_t level, float * buffer, bool converted, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp);
+        uint32_t levelLength(uint8_t level);
+        void convertRow(float const * raw, float * out);
+        /* Spread of the raw samples behind the most recently stored row */
+        void getStatisticsArray(AVERAGER_STATS * buffer);
         uint32_t writeHeadersToBuffer(char * buffer, uint8_t bufferLength);
 
-        void setupAllValidChannels(void);
+        /* Stored rows and part-complete averages, saved (alternately to two slot files) so they survive a restart */
+        bool writeSnapshot(LocalStorageInterface * storage, char const * slotA, char const * slotB);
+        bool readSnapshot(LocalStorageInterface * storage, char const * slotA, char const * slotB);
+
+        /* The arena can only be set before fields are added */
+        bool setArena(Arena * arena);
+        uint32_t arenaBytesRequired(void);
+        bool setupAllValidChannels(void);
+        /* Called by setupAllValidChannels. If fields are added directly, call it once they are all added
+         * (otherwise storage is allocated by the first call to storeDataArray)
+         */
+        bool allocateStorage(void);
         uint32_t * getChannelNumbers(void);
         bool hasData(void);
         uint32_t count(void);
 
     private:
+        bool addFieldSlot(DataField * field);
+        void buildConversionPlan(void);
+        uint32_t storageArenaBytesRequired(uint8_t storedColumns);
+        void destroySpill(void);
+        DataFieldStore * levelStore(uint8_t level);
+        bool readLevelRow(uint8_t level, float * buffer, bool converted, bool alsoRemove,
+            UNIX_TIMESTAMP * pTimestamp, AVERAGER_STATS * stats);
+        uint8_t storedRowWidth(void);
+        float const * addRowStatistics(float const * row);
+        void getRowStatistics(float const * stored, AVERAGER_STATS * stats);
+        uint16_t snapshotLayout(void);
+        bool readSnapshotSlot(LocalStorageInterface * storage, char const * filename);
+        bool readSnapshotData(DataFieldSnapshotReader * reader);
+        void clearData(void);
+        void buildColumnMap(void);
+        void expandRow(float const * stored, float * row);
+        void expandRows(float * rows, uint32_t count);
+        void evaluateDerivedFields(float * row);
+        void updateIntegrals(UNIX_TIMESTAMP timestamp);
+        bool applyDeadbands(UNIX_TIMESTAMP timestamp);
+
         DataField * m_fields[MAX_FIELDS];
+        DataFieldStore m_store;
+        float m_newRow[MAX_FIELDS];
+        AVERAGER_STATS m_rowStats[MAX_FIELDS];
+
+        // If row statistics are kept, each base level row carries the spread of its raw samples,
+        // and m_statsRow holds a complete stored row (values, then statistics)
+        bool m_keepRowStatistics;
+        float * m_statsRow;
+
+        // Coarser levels, each fed by the rows completed at the level below
+        DataFieldAggregator m_levels[MAX_AGGREGATION_LEVELS];
+        uint32_t m_levelDecimation[MAX_AGGREGATION_LEVELS];
+        uint32_t m_levelRows[MAX_AGGREGATION_LEVELS];
+        uint8_t m_aggregationLevelCount;
+
+        // Overflow tier for the base store
+        LocalStorageInterface * m_spillStorage;
+        char const * m_spillDirectory;
+        uint32_t m_spillBlockRows;
+        DataFieldSpill * m_spill;
         uint8_t m_fieldCount;
-        uint32_t m_dataCount;
         uint32_t m_dataSize;
         uint32_t m_averagerSize;
         uint32_t m_channelNumbers[MAX_FIELDS];
+
+        Arena * m_arena;
+
+        // Sequence number of the newest snapshot, and the slot (0 or 1) it is in
+        uint32_t m_snapshotSequence;
+        uint8_t m_snapshotSlot;
+
+        // Direct channel number -> field index lookup (FIELD_SLOT_NONE if the channel has no field)
+        uint8_t m_channelSlots[MAX_CHANNEL_NUMBER + 1];
+
+        // Gather list for storeDataArray: for each numeric field, its field index
+        // and the index of its channel in the raw data array
+        NumericDataField * m_gatherFields[MAX_FIELDS];
+        uint8_t m_gatherSlots[MAX_FIELDS];
+        uint16_t m_gatherDataIndexes[MAX_FIELDS];
+        uint8_t m_gatherColumns[MAX_FIELDS];
+        uint8_t m_gatherCount;
+
+        // Products and sums are not stored, so stored rows only have a column for the
+        // other fields: m_fieldColumns gives each field's column (FIELD_SLOT_NONE if not stored)
+        uint8_t m_fieldColumns[MAX_FIELDS];
+        uint8_t m_storedColumnCount;
+
+        // Derived fields, and the field index of each of their inputs
+        DerivedDataField * m_derivedFields[MAX_FIELDS];
+        uint8_t m_derivedSlots[MAX_FIELDS];
+        uint8_t m_derivedInputs[MAX_FIELDS][DERIVED_CHANNEL_MAX_INPUTS];
+        uint8_t m_derivedCount;
+        bool m_hasIntegrals;
+        UNIX_TIMESTAMP m_lastRowTime;
+        float m_derivedRow[MAX_FIELDS];
+
+        // Deadband of each field (in units, 0 to store every value), and the value
+        // and time each field was last stored (DATAFIELD_NO_DATA_VALUE if never stored)
+        float m_deadbands[MAX_FIELDS];
+        bool m_hasDeadbands;
+        uint32_t m_maxSilence;
+        float m_lastStoredValues[MAX_FIELDS];
+        UNIX_TIMESTAMP m_lastStoredTimes[MAX_FIELDS];
+        float m_sparseRow[MAX_FIELDS];
+        uint32_t m_suppressedCount;
+
+        // Conversion plan: every field is converted as (raw * gain) + offset,
+        // then fields that are not affine are converted by the field itself
+        float m_conversionGain[MAX_FIELDS];
+        float m_conversionOffset[MAX_FIELDS];
+        uint8_t m_fieldConversions[MAX_FIELDS];
+        uint8_t m_fieldConversionCount;
 };
 
 #endif
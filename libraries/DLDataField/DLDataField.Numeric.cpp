@@ -20,6 +20,8 @@
 #include <string.h>
 #endif
 
+#include <new>
+
 #ifdef TEST
 #include <iostream>
 #endif
@@ -28,10 +30,14 @@
  * Local Application Includes
  */
 
+#include "DLUtility.Arena.h"
+#include "DLUtility.PD.h"
 #include "DLUtility.Averager.h"
+#include "DLUtility.LookupTable.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.Conversion.h"
 #include "DLDataField.h"
+#include "DLDataField.Template.h"
 #include "DLUtility.h"
 
 /*
@@ -56,6 +62,41 @@ static void printThermistorData(char * buffer, THERMISTORCHANNEL * data)
         data->otherR, data->R25, data->B, (int)data->maxADC, data->highside ? "highside" : "lowside");
 }
 
+/*
+ * makeConverter
+ *
+ * Constructs the converter for a field's type in the field's own storage (so nothing is allocated)
+ */
+
+// Every DataFieldConverterT is a vtable pointer and a parameters pointer
+typedef char converterFitsStorage[(sizeof(DataFieldConverterT<VoltageConversion>) <= (2 * sizeof(void*))) ? 1 : -1];
+
+template <class CONVERSION>
+static DataFieldConverter * makeConverter(void * storage, void * fieldData)
+{
+    return new (storage) DataFieldConverterT<CONVERSION>((typename CONVERSION::PARAMS const *)fieldData);
+}
+
+/*
+ * destroy
+ *
+ * Objects in arena memory are destroyed but not freed (the arena releases them)
+ */
+template <typename T>
+static void destroy(T * p, Arena * arena)
+{
+    if (!p) { return; }
+
+    if (arena && arena->owns(p))
+    {
+        p->~T();
+    }
+    else
+    {
+        delete p;
+    }
+}
+
 /*
  * Public class Functions
  */
@@ -63,33 +104,173 @@ NumericDataField::NumericDataField(FIELD_TYPE type, void * fieldData, uint32_t c
 {
     m_conversionData = fieldData;
     m_altConversionFn = NULL;
+    m_converter = NULL;
+
+    if (fieldData)
+    {
+        switch (type)
+        {
+        case VOLTAGE:
+            m_converter = makeConverter<VoltageConversion>(m_converterStorage, fieldData);
+            break;
+        case CURRENT:
+            m_converter = makeConverter<CurrentConversion>(m_converterStorage, fieldData);
+            break;
+        case TEMPERATURE_C:
+            m_converter = makeConverter<ThermistorConversion>(m_converterStorage, fieldData);
+            break;
+        default:
+            break;
+        }
+    }
+
+    m_data = NULL;
+    m_averager = NULL;
+    m_conversionTable = NULL;
+    m_arena = NULL;
+    m_storage = DATAFIELD_STORAGE_FLOAT;
+    m_maxRaw = 0;
 }
 
 NumericDataField::~NumericDataField()
 {
-    delete[] m_data;
+    if (!(m_arena && m_arena->owns(m_data))) { delete[] m_data; }
+    destroy(m_averager, m_arena);
+    destroy(m_conversionTable, m_arena);
+}
+
+/*
+ * setArena
+ *
+ * Allocations made by the field after this call come from arena rather than the heap.
+ * Call before setDataSizes, setAveragerSize or setupConversionTable.
+ */
+void NumericDataField::setArena(Arena * arena)
+{
+    m_arena = arena;
+}
+
+/*
+ * arenaBytesRequired
+ *
+ * Returns the arena space needed by a field of the given type (including the field itself)
+ * with an averager of averagerN samples and, for thermistors, a tableSize conversion table
+ */
+uint32_t NumericDataField::arenaBytesRequired(FIELD_TYPE type, uint32_t averagerN, uint16_t tableSize)
+{
+    uint32_t bytes = Arena::alignedSize(sizeof(NumericDataField));
+
+    bytes += Averager<int32_t>::arenaBytesRequired(averagerN);
+
+    if (type == TEMPERATURE_C) { bytes += LookupTable::arenaBytesRequired(tableSize); }
+
+    return bytes;
 }
 
+/*
+ * setDataSizes
+ *
+ * For standalone fields, allocates storage for N averages
+ * and an averager of size averagerN.
+ * Fields owned by a DataFieldManager do not need this: the manager
+ * keeps the data for all its fields and only calls setAveragerSize.
+ */
 void NumericDataField::setDataSizes(uint32_t N, uint32_t averagerN)
 {
     if (N == 0 || averagerN == 0) { return; }
 
     setSize(N);
 
-    m_data = new float[N];
+    m_data = m_arena ? (float*)m_arena->allocate(N * sizeof(float)) : new float[N];
 
     if (m_data)
     {
         fillArray(m_data, 0.0f, N);
     }
 
-    m_averager = new Averager<int32_t>(averagerN);
+    setAveragerSize(averagerN);
+}
+
+void NumericDataField::setAveragerSize(uint32_t averagerN)
+{
+    if (averagerN == 0) { return; }
+
+    destroy(m_averager, m_arena);
+    m_averager = NULL;
+
+    if (m_arena)
+    {
+        void * p = m_arena->allocate(sizeof(Averager<int32_t>));
+        if (p) { m_averager = new (p) Averager<int32_t>(averagerN, AVERAGER_MODE_RUNNING_SUM, m_arena); }
+    }
+    else
+    {
+        m_averager = new Averager<int32_t>(averagerN, AVERAGER_MODE_RUNNING_SUM);
+    }
 }
 
 
 void NumericDataField::setAltConversion(APP_CONVERSION_FN * altConversionFn)
 {
     m_altConversionFn = altConversionFn;
+
+    // An existing table was built from the old conversion
+    if (m_conversionTable)
+    {
+        setupConversionTable(m_conversionTable->size());
+    }
+}
+
+/*
+ * setupConversionTable
+ *
+ * For thermistor fields, samples the conversion (including any alternative conversion)
+ * at size points across the ADC range. Subsequent conversions interpolate from this table
+ * rather than calculating the temperature directly.
+ * The table stops one count short of each end of the range: at 0 and maxADC, the thermistor
+ * resistance is zero or infinite and the temperature is meaningless. Readings in the first and
+ * last intervals (where the curve is too steep to interpolate) are calculated directly.
+ * Returns false (and conversions are calculated directly) if the field is not a thermistor
+ * or the table could not be allocated.
+ */
+bool NumericDataField::setupConversionTable(uint16_t size)
+{
+    uint16_t i;
+
+    destroy(m_conversionTable, m_arena);
+    m_conversionTable = NULL;
+
+    if (!m_conversionData || (m_fieldType != TEMPERATURE_C)) { return false; }
+
+    THERMISTORCHANNEL * pThermistor = (THERMISTORCHANNEL*)m_conversionData;
+
+    LookupTable * table = NULL;
+    if (m_arena)
+    {
+        void * p = m_arena->allocate(sizeof(LookupTable));
+        if (p) { table = new (p) LookupTable(); }
+    }
+    else
+    {
+        table = new LookupTable();
+    }
+
+    if (!table) { return false; }
+
+    if (!table->setSize(size, 1.0f, pThermistor->maxADC - 1.0f, m_arena))
+    {
+        destroy(table, m_arena);
+        return false;
+    }
+
+    // m_conversionTable is still NULL here, so convertData does the full calculation
+    for (i = 0; i < size; ++i)
+    {
+        table->setY(i, convertData(table->xAt(i)));
+    }
+
+    m_conversionTable = table;
+    return true;
 }
 
 float NumericDataField::getRawData(bool alsoRemove)
@@ -108,51 +289,163 @@ float NumericDataField::getRawData(bool alsoRemove)
 
 float NumericDataField::getConvData(bool alsoRemove)
 {
-    float data = getRawData(alsoRemove);
+    return convertData(getRawData(alsoRemove));
+}
 
-    if (m_conversionData)
+/*
+ * convertData
+ *
+ * Converts a raw value (for example one read from a DataFieldStore row)
+ * into units using this field's conversion settings
+ * (or its conversion table, if one has been set up)
+ */
+float NumericDataField::convertData(float data)
+{
+    if (m_conversionTable && inConversionTableRange(data))
     {
-        if (m_altConversionFn)
-        {
-            // Conversion has been overriden for this field
-            data = m_altConversionFn(data, (void*)m_conversionData);
-        }
-        else
-        {
-            switch (m_fieldType)
-            {
-            case VOLTAGE:
-                data = CONV_VoltsFromRaw(data, (VOLTAGECHANNEL*)m_conversionData);
-                break;
-            case CURRENT:
-                data = CONV_AmpsFromRaw(data, (CURRENTCHANNEL*)m_conversionData);
-                break;
-            case TEMPERATURE_C:
-                data = CONV_CelsiusFromRawThermistor(data, (THERMISTORCHANNEL*)m_conversionData);
-            default:
-                break;
-            }
-        }
+        return m_conversionTable->interpolate(data);
+    }
+
+    if (m_conversionData && m_altConversionFn)
+    {
+        // Conversion has been overriden for this field
+        return m_altConversionFn(data, m_conversionData);
     }
 
-    return data;
+    // Conversion policy for this field type (chosen in the constructor)
+    return m_converter ? m_converter->convert(data) : data;
+}
+
+/*
+ * inConversionTableRange
+ *
+ * True if data is between the second and second to last points of the conversion table
+ */
+bool NumericDataField::inConversionTableRange(float data)
+{
+    uint16_t last = m_conversionTable->size() - 1;
+    return (data >= m_conversionTable->xAt(1)) && (data <= m_conversionTable->xAt(last - 1));
+}
+
+/*
+ * setStorage
+ *
+ * Sets how averages for this field are stored by a DataFieldManager.
+ * maxRaw is the largest magnitude raw reading expected (e.g. 1023 for a 10-bit ADC),
+ * which, with the averager size, sets the fixed-point scale (see getStorageFormat).
+ * Must be called before the field is added to a manager.
+ */
+void NumericDataField::setStorage(DATAFIELD_STORAGE storage, int32_t maxRaw)
+{
+    m_storage = storage;
+    m_maxRaw = (maxRaw < 0) ? -maxRaw : maxRaw;
+}
+
+/*
+ * getStorageFormat
+ *
+ * An average of N integer readings is an exact multiple of 1/N, so fixed-point
+ * values are scaled by the averager size where the range allows it.
+ * Where N * maxRaw would overflow the fixed-point type, the scale is reduced to fit.
+ */
+DATAFIELD_COLUMN_FORMAT NumericDataField::getStorageFormat(void)
+{
+    DATAFIELD_COLUMN_FORMAT format = {DATAFIELD_STORAGE_FLOAT, 1.0f};
+
+    if ((m_storage == DATAFIELD_STORAGE_FLOAT) || (m_maxRaw == 0)) { return format; }
+
+    float limit = (m_storage == DATAFIELD_STORAGE_FIXED16) ? 32767.0f : 2147483520.0f;
+    float averagerSize = m_averager ? (float)m_averager->size() : 1.0f;
+
+    format.storage = m_storage;
+    format.scale = averagerSize;
+
+    if (((float)m_maxRaw * averagerSize) > limit)
+    {
+        format.scale = limit / (float)m_maxRaw;
+    }
+
+    return format;
+}
+
+/*
+ * getAffineConversion
+ *
+ * If this field's conversion is just (raw * gain) + offset, writes the gain
+ * and offset and returns true. Returns false if the conversion must be done
+ * with convertData (alternative conversions, thermistors).
+ */
+bool NumericDataField::getAffineConversion(float * pGain, float * pOffset)
+{
+    if (!pGain || !pOffset) { return false; }
+
+    if (m_altConversionFn || m_conversionTable) { return false; }
+
+    *pGain = 1.0f;
+    *pOffset = 0.0f;
+
+    // No conversion for fields without conversion data or of other types
+    return m_converter ? m_converter->getAffine(pGain, pOffset) : true;
 }
 
 bool NumericDataField::storeData(int32_t data)
 {
-    bool dataStored = false;
-    m_averager->newData(data);
-    if (m_averager->full())
+    float average;
+    bool dataStored = averageData(data, &average, NULL) && m_data;
+
+    if (dataStored)
     {
         prePush();
-        m_data[getWriteIndex()] = (float)m_averager->getFloatAverage();
+        m_data[getWriteIndex()] = average;
         postPush();
-        m_averager->reset(NULL);
-        dataStored = true;
     }
     return dataStored;
 }
 
+/*
+ * averageData
+ *
+ * Adds data to the averager. When the averager is full, the average is
+ * written to pAverage (and the spread of the raw samples to pStats, if given),
+ * the averager is reset and true is returned.
+ */
+bool NumericDataField::averageData(int32_t data, float * pAverage, AVERAGER_STATS * pStats)
+{
+    if (!m_averager) { return false; }
+
+    bool averageComplete = false;
+    m_averager->newData(data);
+    if (m_averager->full())
+    {
+        if (pAverage) { *pAverage = m_averager->getFloatAverage(); }
+        if (pStats) { m_averager->getStatistics(pStats); }
+        m_averager->reset(NULL);
+        averageComplete = true;
+    }
+    return averageComplete;
+}
+
+/*
+ * pendingSampleCount, getPendingSample, clearPendingSamples
+ *
+ * The samples in the averager can be saved, cleared and replayed through averageData,
+ * so a part-complete average survives a restart.
+ */
+uint16_t NumericDataField::pendingSampleCount(void)
+{
+    return m_averager ? m_averager->sampleCount() : 0;
+}
+
+int32_t NumericDataField::getPendingSample(uint16_t index)
+{
+    return m_averager ? m_averager->getSample(index) : 0;
+}
+
+void NumericDataField::clearPendingSamples(void)
+{
+    if (m_averager) { m_averager->reset(NULL); }
+}
+
 void NumericDataField::getRawDataAsString(char * buf, char const * const fmt, bool alsoRemove)
 {
     float data = getRawData(alsoRemove);
@@ -165,6 +458,18 @@ void NumericDataField::getConvDataAsString(char * buf, char const * const fmt, b
     sprintf(buf, fmt, data); // Write data point to buffer
 }
 
+void NumericDataField::getRawDataAsString(char * buf, uint8_t bufLength, uint8_t decimals, bool alsoRemove)
+{
+    FixedLengthAccumulator accumulator(buf, bufLength);
+    accumulator.appendFixed(getRawData(alsoRemove), decimals);
+}
+
+void NumericDataField::getConvDataAsString(char * buf, uint8_t bufLength, uint8_t decimals, bool alsoRemove)
+{
+    FixedLengthAccumulator accumulator(buf, bufLength);
+    accumulator.appendFixed(getConvData(alsoRemove), decimals);
+}
+
 
 void NumericDataField::getConfigString(char * buffer)
 {
@@ -0,0 +1,317 @@
+/*
+ * DLDataField.Snapshot.cpp
+ *
+ * Writes and reads checked binary snapshots of field data through local storage
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLLocalStorage.h"
+#include "DLDataField.Snapshot.h"
+#include "DLUtility.CRC.h"
+#include "DLUtility.h"
+
+/*
+ * Public Class Functions
+ */
+
+DataFieldSnapshotWriter::DataFieldSnapshotWriter(LocalStorageInterface * storage)
+{
+    m_storage = storage;
+    m_file = INVALID_HANDLE;
+    m_lineBytes = 0;
+    m_crc = CRC16_INITIAL_VALUE;
+    m_length = 0;
+}
+
+DataFieldSnapshotWriter::~DataFieldSnapshotWriter()
+{
+    if (m_file != INVALID_HANDLE) { m_storage->closeFile(m_file); }
+}
+
+/*
+ * open
+ *
+ * Starts a new snapshot in filename (replacing any file already there)
+ * and writes the magic number, version and sequence number.
+ * Returns false if the file could not be opened.
+ */
+bool DataFieldSnapshotWriter::open(char const * filename)
+{
+    return open(filename, 0);
+}
+
+bool DataFieldSnapshotWriter::open(char const * filename, uint32_t sequence)
+{
+    uint32_t magic = DATAFIELD_SNAPSHOT_MAGIC;
+    uint16_t version = DATAFIELD_SNAPSHOT_VERSION;
+
+    if (!m_storage || !filename || (m_file != INVALID_HANDLE)) { return false; }
+
+    // Files open for write are appended to, so clear out the old snapshot first
+    if (m_storage->fileExists(filename)) { m_storage->removeFile(filename); }
+
+    m_file = m_storage->openFile(filename, true);
+    if (m_file == INVALID_HANDLE) { return false; }
+
+    m_lineBytes = 0;
+    m_crc = CRC16_INITIAL_VALUE;
+    m_length = 0;
+
+    write(&magic, sizeof(magic));
+    write(&version, sizeof(version));
+    write(&sequence, sizeof(sequence));
+
+    return true;
+}
+
+/*
+ * write
+ *
+ * Adds length bytes of data to the snapshot
+ */
+void DataFieldSnapshotWriter::write(void const * data, uint32_t length)
+{
+    uint8_t const * pData = (uint8_t const *)data;
+
+    if ((m_file == INVALID_HANDLE) || !pData) { return; }
+
+    m_crc = crc16Update(m_crc, pData, length);
+    m_length += length;
+
+    while (length--)
+    {
+        writeByte(*pData++);
+    }
+}
+
+/*
+ * close
+ *
+ * Writes the length and CRC of everything written since open, and closes the file.
+ * Returns false if no snapshot was open.
+ */
+bool DataFieldSnapshotWriter::close(void)
+{
+    uint8_t i;
+    uint32_t length = m_length;
+    uint16_t crc = m_crc;
+
+    if (m_file == INVALID_HANDLE) { return false; }
+
+    for (i = 0; i < sizeof(length); ++i) { writeByte(((uint8_t *)&length)[i]); }
+    for (i = 0; i < sizeof(crc); ++i) { writeByte(((uint8_t *)&crc)[i]); }
+
+    flushLine();
+
+    m_storage->closeFile(m_file);
+    m_file = INVALID_HANDLE;
+
+    return !m_storage->inError();
+}
+
+DataFieldSnapshotReader::DataFieldSnapshotReader(LocalStorageInterface * storage)
+{
+    m_storage = storage;
+    m_file = INVALID_HANDLE;
+    m_chunkLength = 0;
+    m_chunkPosition = 0;
+    m_crc = CRC16_INITIAL_VALUE;
+    m_length = 0;
+    m_sequence = 0;
+    m_failed = false;
+}
+
+DataFieldSnapshotReader::~DataFieldSnapshotReader()
+{
+    if (m_file != INVALID_HANDLE) { m_storage->closeFile(m_file); }
+}
+
+/*
+ * open
+ *
+ * Opens the snapshot in filename, checks its magic number and version
+ * and reads its sequence number.
+ * Returns false (with the file closed) if the file could not be opened
+ * or was written by a different snapshot version.
+ */
+bool DataFieldSnapshotReader::open(char const * filename)
+{
+    uint32_t magic = 0;
+    uint16_t version = 0;
+
+    if (!m_storage || !filename || (m_file != INVALID_HANDLE)) { return false; }
+
+    if (!m_storage->fileExists(filename)) { return false; }
+
+    m_file = m_storage->openFile(filename, false);
+    if (m_file == INVALID_HANDLE) { return false; }
+
+    m_chunkLength = 0;
+    m_chunkPosition = 0;
+    m_crc = CRC16_INITIAL_VALUE;
+    m_length = 0;
+    m_sequence = 0;
+    m_failed = false;
+
+    bool valid = read(&magic, sizeof(magic)) && read(&version, sizeof(version));
+    valid = valid && (magic == DATAFIELD_SNAPSHOT_MAGIC) && (version == DATAFIELD_SNAPSHOT_VERSION);
+    valid = valid && read(&m_sequence, sizeof(m_sequence));
+
+    if (!valid)
+    {
+        m_storage->closeFile(m_file);
+        m_file = INVALID_HANDLE;
+    }
+
+    return valid;
+}
+
+/*
+ * read
+ *
+ * Copies the next length bytes of the snapshot into data.
+ * Returns false if the snapshot ends early or cannot be decoded
+ * (after which every read fails, and close() reports the snapshot as invalid).
+ */
+bool DataFieldSnapshotReader::read(void * data, uint32_t length)
+{
+    uint8_t * pData = (uint8_t *)data;
+    uint32_t i;
+
+    if ((m_file == INVALID_HANDLE) || m_failed) { return false; }
+    if (!pData) { return length == 0; }
+
+    for (i = 0; i < length; ++i)
+    {
+        if (!readByte(&pData[i]))
+        {
+            m_failed = true;
+            return false;
+        }
+    }
+
+    m_crc = crc16Update(m_crc, pData, length);
+    m_length += length;
+
+    return true;
+}
+
+/*
+ * close
+ *
+ * Reads the length and CRC at the end of the snapshot and closes the file.
+ * Returns true only if every read succeeded and everything after the
+ * header has been read, with a matching CRC.
+ */
+bool DataFieldSnapshotReader::close(void)
+{
+    uint8_t i;
+    uint32_t length = 0;
+    uint16_t crc = 0;
+    bool valid;
+
+    if (m_file == INVALID_HANDLE) { return false; }
+
+    valid = !m_failed;
+    for (i = 0; valid && (i < sizeof(length)); ++i) { valid = readByte(&((uint8_t *)&length)[i]); }
+    for (i = 0; valid && (i < sizeof(crc)); ++i) { valid = readByte(&((uint8_t *)&crc)[i]); }
+
+    valid = valid && (length == m_length) && (crc == m_crc);
+
+    m_storage->closeFile(m_file);
+    m_file = INVALID_HANDLE;
+
+    return valid;
+}
+
+/*
+ * sequence
+ *
+ * Returns the sequence number of the open snapshot
+ */
+uint32_t DataFieldSnapshotReader::sequence(void)
+{
+    return m_sequence;
+}
+
+/*
+ * Private Class Functions
+ */
+
+void DataFieldSnapshotWriter::writeByte(uint8_t byte)
+{
+    writeHex(&m_line[m_lineBytes * 2], byte, 2);
+
+    if (++m_lineBytes == DATAFIELD_SNAPSHOT_LINE_BYTES) { flushLine(); }
+}
+
+void DataFieldSnapshotWriter::flushLine(void)
+{
+    if (m_lineBytes == 0) { return; }
+
+    m_line[m_lineBytes * 2] = '\r';
+    m_line[(m_lineBytes * 2) + 1] = '\n';
+    m_line[(m_lineBytes * 2) + 2] = '\0';
+
+    m_storage->write(m_file, m_line);
+    m_lineBytes = 0;
+}
+
+bool DataFieldSnapshotReader::readByte(uint8_t * pByte)
+{
+    uint8_t high;
+    uint8_t low;
+
+    if (!readHexDigit(&high) || !readHexDigit(&low)) { return false; }
+
+    *pByte = (uint8_t)((high << 4) | low);
+    return true;
+}
+
+/*
+ * readHexDigit
+ *
+ * Returns the value of the next hex digit in the file (skipping line endings),
+ * reading the file a chunk at a time
+ */
+bool DataFieldSnapshotReader::readHexDigit(uint8_t * pDigit)
+{
+    char c;
+    uint32_t digit;
+
+    do
+    {
+        if (m_chunkPosition == m_chunkLength)
+        {
+            m_chunkLength = (uint8_t)m_storage->readBytes(m_file, m_chunk, sizeof(m_chunk));
+            m_chunkPosition = 0;
+            if (m_chunkLength == 0) { return false; }
+        }
+
+        c = m_chunk[m_chunkPosition++];
+    } while ((c == '\r') || (c == '\n'));
+
+    if (!readHex(&c, 1, &digit)) { return false; }
+
+    *pDigit = (uint8_t)digit;
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef _DATAFIELD_SNAPSHOT_H_
+#define _DATAFIELD_SNAPSHOT_H_
+
+/*
+ * DataFieldSnapshotWriter, DataFieldSnapshotReader
+ *
+ * Sequential binary image of in-memory data (see DataFieldManager::writeSnapshot),
+ * written and read back through a LocalStorageInterface.
+ * Since the storage interface writes strings, each byte is written as two hex digits,
+ * in lines of DATAFIELD_SNAPSHOT_LINE_BYTES bytes.
+ *
+ * The image starts with a magic number and format version, so a snapshot from other
+ * firmware is rejected as soon as it is opened, then a sequence number so that the newer
+ * of two snapshots can be found. It ends with the number of bytes written
+ * and a CRC-16 of those bytes, which close() checks once everything has been read.
+ * Values are written in the byte order of the platform: snapshots are not portable.
+ */
+
+#define DATAFIELD_SNAPSHOT_MAGIC (0x53534644UL) // "DFSS"
+#define DATAFIELD_SNAPSHOT_VERSION (2)
+
+#define DATAFIELD_SNAPSHOT_LINE_BYTES (32)
+
+class DataFieldSnapshotWriter
+{
+    public:
+        DataFieldSnapshotWriter(LocalStorageInterface * storage);
+        ~DataFieldSnapshotWriter();
+
+        bool open(char const * filename);
+        bool open(char const * filename, uint32_t sequence);
+        void write(void const * data, uint32_t length);
+        bool close(void);
+
+    private:
+        void writeByte(uint8_t byte);
+        void flushLine(void);
+
+        LocalStorageInterface * m_storage;
+        FILE_HANDLE m_file;
+        char m_line[(DATAFIELD_SNAPSHOT_LINE_BYTES * 2) + 3];
+        uint8_t m_lineBytes;
+        uint16_t m_crc;
+        uint32_t m_length;
+};
+
+class DataFieldSnapshotReader
+{
+    public:
+        DataFieldSnapshotReader(LocalStorageInterface * storage);
+        ~DataFieldSnapshotReader();
+
+        bool open(char const * filename);
+        bool read(void * data, uint32_t length);
+        bool close(void);
+        uint32_t sequence(void);
+
+    private:
+        bool readByte(uint8_t * pByte);
+        bool readHexDigit(uint8_t * pDigit);
+
+        LocalStorageInterface * m_storage;
+        FILE_HANDLE m_file;
+        char m_chunk[DATAFIELD_SNAPSHOT_LINE_BYTES * 2];
+        uint8_t m_chunkLength;
+        uint8_t m_chunkPosition;
+        uint16_t m_crc;
+        uint32_t m_length;
+        uint32_t m_sequence;
+        bool m_failed;
+};
+
+#endif
@@ -0,0 +1,573 @@
+/*
+ * DLDataField.Spill.cpp
+ *
+ * Spills rows of field data to local storage when RAM is full,
+ * and pages them back in when they are read
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Arena.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Store.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Spill.h"
+#include "DLDataField.Snapshot.h"
+#include "DLUtility.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+// Each line starts with the row timestamp as 16 hex digits,
+// then each value is written as 8 hex digits (the bits of the float)
+#define HEX_DIGITS_PER_TIMESTAMP (16)
+#define HEX_DIGITS_PER_VALUE (8)
+
+// Lines are collected and written to storage about a sector at a time
+#define SPILL_WRITE_SIZE (512)
+
+// Each line of the index file is the number of the oldest unread block
+#define HEX_DIGITS_PER_INDEX (8)
+
+/*
+ * Private Functions
+ */
+
+// Each line is the timestamp, the values, CRLF and terminator
+static uint16_t spillLineLength(uint8_t columns)
+{
+    return HEX_DIGITS_PER_TIMESTAMP + (columns * HEX_DIGITS_PER_VALUE) + 3;
+}
+
+// Whole lines (without terminators) are collected up to about a sector, plus one terminator
+static uint16_t spillLinesPerWrite(uint16_t lineLength)
+{
+    return max(SPILL_WRITE_SIZE / (lineLength - 1), 1);
+}
+
+static uint32_t spillWriteBufferSize(uint16_t lineLength)
+{
+    return (spillLinesPerWrite(lineLength) * (lineLength - 1)) + 1;
+}
+
+// The timestamp is written as two 8 digit halves, since the hex functions are 32-bit
+static void writeHexTimestamp(char * buffer, UNIX_TIMESTAMP timestamp)
+{
+    uint64_t bits = (uint64_t)timestamp;
+
+    writeHex(buffer, (uint32_t)(bits >> 32), HEX_DIGITS_PER_TIMESTAMP / 2);
+    writeHex(&buffer[HEX_DIGITS_PER_TIMESTAMP / 2], (uint32_t)bits, HEX_DIGITS_PER_TIMESTAMP / 2);
+}
+
+static bool readHexTimestamp(char const * buffer, UNIX_TIMESTAMP * pTimestamp)
+{
+    uint32_t high;
+    uint32_t low;
+
+    if (!readHex(buffer, HEX_DIGITS_PER_TIMESTAMP / 2, &high)) { return false; }
+    if (!readHex(&buffer[HEX_DIGITS_PER_TIMESTAMP / 2], HEX_DIGITS_PER_TIMESTAMP / 2, &low)) { return false; }
+
+    *pTimestamp = (UNIX_TIMESTAMP)(((uint64_t)high << 32) | low);
+    return true;
+}
+
+static void writeHexValue(char * buffer, float value)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(float));
+    writeHex(buffer, bits, HEX_DIGITS_PER_VALUE);
+}
+
+static bool readHexValue(char const * buffer, float * pValue)
+{
+    uint32_t bits;
+
+    if (!readHex(buffer, HEX_DIGITS_PER_VALUE, &bits)) { return false; }
+
+    memcpy(pValue, &bits, sizeof(float));
+    return true;
+}
+
+/*
+ * Public Class Functions
+ */
+
+DataFieldSpill::DataFieldSpill()
+{
+    m_storage = NULL;
+    m_directory[0] = '\0';
+    m_row = NULL;
+    m_line = NULL;
+    m_lineLength = 0;
+    m_writeBuffer = NULL;
+    m_linesPerWrite = 0;
+    m_blockRows = 0;
+    m_firstBlock = 0;
+    m_nextBlock = 0;
+    m_columns = 0;
+    m_arena = NULL;
+}
+
+DataFieldSpill::~DataFieldSpill()
+{
+    freeBuffers();
+}
+
+/*
+ * setup
+ *
+ * Rows will be spilled blockRows at a time into files in directory
+ * (which is created if it does not exist).
+ * Blocks already in the directory (spilled before a restart) are read back first.
+ * If arena is not NULL, the page and line buffers are taken from it rather than the heap.
+ * Returns true if the spill is ready to use.
+ */
+bool DataFieldSpill::setup(LocalStorageInterface * storage, char const * directory, uint32_t blockRows, uint8_t columns)
+{
+    return setup(storage, directory, blockRows, columns, NULL);
+}
+
+bool DataFieldSpill::setup(LocalStorageInterface * storage, char const * directory, uint32_t blockRows, uint8_t columns,
+    Arena * arena)
+{
+    if (!storage || !directory || (blockRows == 0) || (columns == 0)) { return false; }
+
+    if (strlen(directory) >= sizeof(m_directory)) { return false; }
+
+    if (!storage->directoryExists(directory))
+    {
+        if (!storage->mkDir(directory)) { return false; }
+    }
+
+    freeBuffers();
+
+    m_lineLength = spillLineLength(columns);
+    m_linesPerWrite = spillLinesPerWrite(m_lineLength);
+
+    m_arena = arena;
+    if (arena)
+    {
+        m_row = (float*)arena->allocate(columns * sizeof(float));
+        m_line = (char*)arena->allocate(m_lineLength);
+        m_writeBuffer = (char*)arena->allocate(spillWriteBufferSize(m_lineLength));
+    }
+    else
+    {
+        m_row = new float[columns];
+        m_line = new char[m_lineLength];
+        m_writeBuffer = new char[spillWriteBufferSize(m_lineLength)];
+    }
+
+    if (!m_row || !m_line || !m_writeBuffer || !m_page.setSize(blockRows, columns, NULL, arena)) { return false; }
+
+    strncpy_safe(m_directory, directory, sizeof(m_directory));
+    m_storage = storage;
+    m_blockRows = blockRows;
+    m_columns = columns;
+
+    // Carry on after any blocks left in storage before a restart
+    m_firstBlock = readFirstBlock();
+    m_nextBlock = m_firstBlock;
+    findNextBlock();
+
+    return true;
+}
+
+/*
+ * arenaBytesRequired
+ *
+ * Returns the arena space taken by a spill of blockRows rows of columns values
+ * (the spill object, its page and its line buffers)
+ */
+uint32_t DataFieldSpill::arenaBytesRequired(uint32_t blockRows, uint8_t columns)
+{
+    uint16_t lineLength = spillLineLength(columns);
+
+    return Arena::alignedSize(sizeof(DataFieldSpill))
+        + Arena::alignedSize(columns * sizeof(float))
+        + Arena::alignedSize(lineLength)
+        + Arena::alignedSize(spillWriteBufferSize(lineLength))
+        + DataFieldStore::arenaBytesRequired(blockRows, columns, NULL);
+}
+
+bool DataFieldSpill::isEnabled(void)
+{
+    return m_storage != NULL;
+}
+
+uint32_t DataFieldSpill::blockRows(void)
+{
+    return m_blockRows;
+}
+
+/*
+ * spillRows
+ *
+ * Moves the oldest blockRows rows from source into a new block file.
+ * Rows are only removed from source once the file has been opened.
+ * Lines are written a few at a time (about a sector per write).
+ * Returns false if nothing was spilled (source does not hold a full block,
+ * or the file could not be opened).
+ */
+bool DataFieldSpill::spillRows(DataFieldStore * source)
+{
+    char filename[48];
+    uint32_t row;
+    uint8_t column;
+    uint16_t lines = 0;
+    uint16_t lineChars = m_lineLength - 1;
+    char * pLine;
+    UNIX_TIMESTAMP timestamp;
+
+    if (!isEnabled() || !source) { return false; }
+    if (source->columns() != m_columns) { return false; }
+    if (source->length() < m_blockRows) { return false; }
+
+    // Files open for write are appended to, so a block file that is already there
+    // (and has not been read) is kept, and this block goes after it
+    findNextBlock();
+    getBlockFilename(filename, m_nextBlock);
+
+    FILE_HANDLE file = m_storage->openFile(filename, true);
+    if (file == INVALID_HANDLE) { return false; }
+
+    for (row = 0; row < m_blockRows; ++row)
+    {
+        pLine = &m_writeBuffer[lines * lineChars];
+
+        source->readRow(m_row, true, &timestamp);
+        writeHexTimestamp(pLine, timestamp);
+        for (column = 0; column < m_columns; ++column)
+        {
+            writeHexValue(&pLine[HEX_DIGITS_PER_TIMESTAMP + (column * HEX_DIGITS_PER_VALUE)], m_row[column]);
+        }
+        pLine[lineChars - 2] = '\r';
+        pLine[lineChars - 1] = '\n';
+
+        if ((++lines == m_linesPerWrite) || (row == (m_blockRows - 1)))
+        {
+            m_writeBuffer[lines * lineChars] = '\0';
+            m_storage->write(file, m_writeBuffer);
+            lines = 0;
+        }
+    }
+
+    m_storage->closeFile(file);
+    m_nextBlock++;
+
+    return true;
+}
+
+/*
+ * readRow
+ *
+ * Copies the oldest spilled row into row (optionally removing it),
+ * and its timestamp into pTimestamp if not NULL,
+ * loading the next block from storage when needed.
+ * Returns false if there are no spilled rows.
+ */
+bool DataFieldSpill::readRow(float * row, bool alsoRemove)
+{
+    return readRow(row, alsoRemove, NULL);
+}
+
+bool DataFieldSpill::readRow(float * row, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp)
+{
+    if (!row) { return false; }
+
+    if (!m_page.hasData())
+    {
+        if (!loadOldestBlock()) { return false; }
+    }
+
+    return m_page.readRow(row, alsoRemove, pTimestamp);
+}
+
+/*
+ * length
+ *
+ * Returns the number of rows in storage and in the page
+ */
+uint32_t DataFieldSpill::length(void)
+{
+    return ((m_nextBlock - m_firstBlock) * m_blockRows) + m_page.length();
+}
+
+bool DataFieldSpill::hasData(void)
+{
+    return length() > 0;
+}
+
+/*
+ * blockCount
+ *
+ * Returns the number of block files not yet read back
+ */
+uint32_t DataFieldSpill::blockCount(void)
+{
+    return m_nextBlock - m_firstBlock;
+}
+
+/*
+ * clear
+ *
+ * Forgets every spilled row, and removes the block files (and index) from storage
+ */
+void DataFieldSpill::clear(void)
+{
+    char filename[48];
+
+    m_page.clear();
+
+    if (isEnabled())
+    {
+        for (; m_firstBlock < m_nextBlock; ++m_firstBlock)
+        {
+            getBlockFilename(filename, m_firstBlock);
+            m_storage->removeFile(filename);
+        }
+
+        getIndexFilename(filename);
+        m_storage->removeFile(filename);
+    }
+
+    m_firstBlock = 0;
+    m_nextBlock = 0;
+}
+
+/*
+ * clearPage
+ *
+ * Forgets the rows paged in from storage, leaving the block files in storage
+ */
+void DataFieldSpill::clearPage(void)
+{
+    m_page.clear();
+}
+
+void DataFieldSpill::writeSnapshot(DataFieldSnapshotWriter * writer)
+{
+    if (!writer) { return; }
+
+    writer->write(&m_firstBlock, sizeof(m_firstBlock));
+    writer->write(&m_nextBlock, sizeof(m_nextBlock));
+    m_page.writeSnapshot(writer);
+}
+
+/*
+ * readSnapshot
+ *
+ * Restores the page written by writeSnapshot. The blocks still to be read are those
+ * found in storage by setup (the index and block files are kept up to date as blocks are
+ * written and read, so they are newer than any snapshot); the snapshot's block numbers
+ * are only used to tell whether the page is still current. If a block has been paged in
+ * since the snapshot was written, the saved page had already been read, so it is dropped.
+ * Returns false (leaving the page empty) if the state could not be read.
+ */
+bool DataFieldSpill::readSnapshot(DataFieldSnapshotReader * reader)
+{
+    uint32_t firstBlock;
+    uint32_t nextBlock;
+    bool valid;
+
+    if (!reader || !isEnabled()) { return false; }
+
+    valid = reader->read(&firstBlock, sizeof(firstBlock));
+    valid = valid && reader->read(&nextBlock, sizeof(nextBlock));
+    valid = valid && (firstBlock <= nextBlock);
+    valid = valid && m_page.readSnapshot(reader);
+
+    if (!valid || (firstBlock != m_firstBlock)) { m_page.clear(); }
+
+    return valid;
+}
+
+/*
+ * Private Class Functions
+ */
+
+void DataFieldSpill::getBlockFilename(char * buffer, uint32_t block)
+{
+    sprintf(buffer, "%s/%08lu.SPL", m_directory, (unsigned long)block);
+}
+
+void DataFieldSpill::getIndexFilename(char * buffer)
+{
+    sprintf(buffer, "%s/INDEX.SPL", m_directory);
+}
+
+/*
+ * loadOldestBlock
+ *
+ * Reads the oldest block file into the page and removes the file.
+ * Lines that cannot be parsed are skipped. Blocks that are missing from storage,
+ * or have no rows that can be parsed, are skipped so they do not hold up later blocks.
+ * Returns false if no rows could be loaded (no blocks are left, or the storage is
+ * not available, in which case the block is tried again on the next read).
+ */
+bool DataFieldSpill::loadOldestBlock(void)
+{
+    char filename[48];
+    uint32_t row;
+    uint8_t column;
+    UNIX_TIMESTAMP timestamp;
+    bool valid;
+    char const * pValues = &m_line[HEX_DIGITS_PER_TIMESTAMP];
+
+    if (!isEnabled()) { return false; }
+
+    while (blockCount() > 0)
+    {
+        getBlockFilename(filename, m_firstBlock);
+
+        if (!m_storage->fileExists(filename))
+        {
+            advanceFirstBlock();
+            continue;
+        }
+
+        FILE_HANDLE file = m_storage->openFile(filename, false);
+        if (file == INVALID_HANDLE) { return false; }
+
+        for (row = 0; (row < m_blockRows) && !m_storage->endOfFile(file); ++row)
+        {
+            valid = m_storage->readLine(file, m_line, m_lineLength, true) == (uint32_t)(m_lineLength - 3);
+            valid = valid && readHexTimestamp(m_line, &timestamp);
+            for (column = 0; valid && (column < m_columns); ++column)
+            {
+                valid = readHexValue(&pValues[column * HEX_DIGITS_PER_VALUE], &m_row[column]);
+            }
+
+            if (valid) { m_page.pushRow(m_row, timestamp); }
+        }
+
+        m_storage->closeFile(file);
+        m_storage->removeFile(filename);
+        advanceFirstBlock();
+
+        if (m_page.hasData()) { return true; }
+    }
+
+    return false;
+}
+
+/*
+ * advanceFirstBlock
+ *
+ * Moves on from the oldest block once it has been read (or skipped) and records the
+ * new oldest block in the index file. When every block has been read, block numbers
+ * start again from 0 and the index file is removed.
+ */
+void DataFieldSpill::advanceFirstBlock(void)
+{
+    char filename[48];
+    char line[HEX_DIGITS_PER_INDEX + 3];
+
+    m_firstBlock++;
+    getIndexFilename(filename);
+
+    if (blockCount() == 0)
+    {
+        m_firstBlock = 0;
+        m_nextBlock = 0;
+        m_storage->removeFile(filename);
+        return;
+    }
+
+    FILE_HANDLE file = m_storage->openFile(filename, true);
+    if (file == INVALID_HANDLE) { return; }
+
+    writeHex(line, m_firstBlock, HEX_DIGITS_PER_INDEX);
+    strcpy(&line[HEX_DIGITS_PER_INDEX], "\r\n");
+    m_storage->write(file, line);
+    m_storage->closeFile(file);
+}
+
+/*
+ * readFirstBlock
+ *
+ * Returns the oldest unread block recorded in the index file (the last complete line),
+ * or 0 if there is no index file
+ */
+uint32_t DataFieldSpill::readFirstBlock(void)
+{
+    char filename[48];
+    char line[HEX_DIGITS_PER_INDEX + 3];
+    uint32_t block;
+    uint32_t length;
+    uint32_t firstBlock = 0;
+
+    getIndexFilename(filename);
+    if (!m_storage->fileExists(filename)) { return 0; }
+
+    FILE_HANDLE file = m_storage->openFile(filename, false);
+    if (file == INVALID_HANDLE) { return 0; }
+
+    while (!m_storage->endOfFile(file))
+    {
+        length = m_storage->readLine(file, line, sizeof(line), true);
+        if ((length == HEX_DIGITS_PER_INDEX) && readHex(line, HEX_DIGITS_PER_INDEX, &block))
+        {
+            firstBlock = block;
+        }
+    }
+
+    m_storage->closeFile(file);
+
+    return firstBlock;
+}
+
+void DataFieldSpill::freeBuffers(void)
+{
+    // Arena memory is released with the arena
+    if (!m_arena)
+    {
+        delete[] m_row;
+        delete[] m_line;
+        delete[] m_writeBuffer;
+    }
+
+    m_arena = NULL;
+    m_row = NULL;
+    m_line = NULL;
+    m_writeBuffer = NULL;
+}
+
+/*
+ * findNextBlock
+ *
+ * Moves m_nextBlock past any block files that already exist in storage
+ */
+void DataFieldSpill::findNextBlock(void)
+{
+    char filename[48];
+
+    getBlockFilename(filename, m_nextBlock);
+    while (m_storage->fileExists(filename))
+    {
+        getBlockFilename(filename, ++m_nextBlock);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef _DATAFIELD_SPILL_H_
+#define _DATAFIELD_SPILL_H_
+
+/*
+ * DataFieldSpill
+ *
+ * Overflow tier for a DataFieldStore.
+ * When the store in RAM is full, its oldest rows are written out as a block
+ * (one file per block) through a LocalStorageInterface. Rows are read back
+ * oldest-first, one block at a time, into a small page in RAM.
+ * Rows (with their timestamps) are written as hexadecimal text, since the storage interface writes strings.
+ * The number of the oldest unread block is appended to an index file as blocks are read,
+ * so the blocks left in storage are found again after a restart.
+ */
+
+class Arena;
+
+class DataFieldSpill
+{
+    public:
+        DataFieldSpill();
+        ~DataFieldSpill();
+
+        bool setup(LocalStorageInterface * storage, char const * directory, uint32_t blockRows, uint8_t columns);
+        bool setup(LocalStorageInterface * storage, char const * directory, uint32_t blockRows, uint8_t columns, Arena * arena);
+        static uint32_t arenaBytesRequired(uint32_t blockRows, uint8_t columns);
+        bool isEnabled(void);
+        uint32_t blockRows(void);
+
+        bool spillRows(DataFieldStore * source);
+        bool readRow(float * row, bool alsoRemove);
+        bool readRow(float * row, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp);
+
+        uint32_t length(void);
+        bool hasData(void);
+        uint32_t blockCount(void);
+        void clear(void);
+        void clearPage(void);
+
+        /* The page is saved and restored; the blocks to read are always taken from storage */
+        void writeSnapshot(DataFieldSnapshotWriter * writer);
+        bool readSnapshot(DataFieldSnapshotReader * reader);
+
+    private:
+        void getBlockFilename(char * buffer, uint32_t block);
+        void getIndexFilename(char * buffer);
+        bool loadOldestBlock(void);
+        void advanceFirstBlock(void);
+        uint32_t readFirstBlock(void);
+        void findNextBlock(void);
+        void freeBuffers(void);
+
+        LocalStorageInterface * m_storage;
+        char m_directory[32];
+        DataFieldStore m_page;
+        float * m_row;
+        char * m_line;
+        uint16_t m_lineLength;
+        char * m_writeBuffer;
+        uint16_t m_linesPerWrite;
+        uint32_t m_blockRows;
+        uint32_t m_firstBlock;
+        uint32_t m_nextBlock;
+        uint8_t m_columns;
+        Arena * m_arena;
+};
+
+#endif
@@ -0,0 +1,678 @@
+/*
+ * DLDataField.Store.cpp
+ *
+ * Provides a single contiguous store for the averaged data of a set of fields
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Arena.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Store.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Snapshot.h"
+#include "DLUtility.h"
+
+/*
+ * Private Variables
+ */
+
+// Fixed-point values are clamped to +/-limit; the most negative value marks missing data
+static const int32_t FIXED16_LIMIT = 32767;
+static const int32_t FIXED32_LIMIT = 2147483647;
+
+// A timestamp delta of this value means the row's timestamp is the next rebase point
+static const uint16_t TIME_DELTA_REBASE = 0xFFFF;
+static const uint16_t TIME_DELTA_MAX = 0xFFFE;
+
+/*
+ * Private Functions
+ */
+
+static uint8_t storageSize(DATAFIELD_STORAGE storage)
+{
+    switch (storage)
+    {
+    case DATAFIELD_STORAGE_FIXED16:
+        return sizeof(int16_t);
+    case DATAFIELD_STORAGE_FIXED32:
+        return sizeof(int32_t);
+    case DATAFIELD_STORAGE_FLOAT:
+    default:
+        return sizeof(float);
+    }
+}
+
+static uint16_t formatsRowSize(uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats)
+{
+    uint8_t column;
+    uint16_t size = 0;
+
+    for (column = 0; column < columns; ++column)
+    {
+        size += storageSize(formats ? formats[column].storage : DATAFIELD_STORAGE_FLOAT);
+    }
+
+    return size;
+}
+
+static int32_t toFixed(float value, float scale, int32_t limit)
+{
+    if (value == DATAFIELD_NO_DATA_VALUE) { return -limit - 1; }
+
+    float scaled = value * scale;
+    scaled += (scaled >= 0.0f) ? 0.5f : -0.5f;
+
+    if (scaled >= (float)limit) { return limit; }
+    if (scaled <= -(float)limit) { return -limit; }
+
+    return (int32_t)scaled;
+}
+
+static float fromFixed(int32_t value, float scale, int32_t limit)
+{
+    if (value == (-limit - 1)) { return DATAFIELD_NO_DATA_VALUE; }
+
+    return (float)value / scale;
+}
+
+/*
+ * Public Class Functions
+ */
+
+DataFieldStore::DataFieldStore()
+{
+    m_data = NULL;
+    m_formats = NULL;
+    m_columnOffsets = NULL;
+    m_rowSize = 0;
+    m_allFloat = true;
+    m_head = 0;
+    m_tail = 0;
+    m_count = 0;
+    m_rows = 0;
+    m_columns = 0;
+    m_arena = NULL;
+    m_timeDeltas = NULL;
+    m_tailTime = 0;
+    m_headTime = 0;
+    m_rebaseHead = 0;
+    m_rebaseCount = 0;
+}
+
+DataFieldStore::~DataFieldStore()
+{
+    freeData();
+}
+
+/*
+ * setSize
+ *
+ * Allocates storage for (rows x columns) values.
+ * If formats is not NULL, it gives the storage format for each column,
+ * otherwise all columns are stored as floats.
+ * If arena is not NULL, the storage is taken from it rather than the heap.
+ * Any data already in the store is discarded.
+ * Returns true if the storage was allocated.
+ */
+bool DataFieldStore::setSize(uint32_t rows, uint8_t columns)
+{
+    return setSize(rows, columns, NULL, NULL);
+}
+
+bool DataFieldStore::setSize(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats)
+{
+    return setSize(rows, columns, formats, NULL);
+}
+
+bool DataFieldStore::setSize(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats, Arena * arena)
+{
+    uint8_t column;
+
+    freeData();
+
+    if (rows == 0 || columns == 0) { return false; }
+
+    m_arena = arena;
+    if (arena)
+    {
+        m_formats = (DATAFIELD_COLUMN_FORMAT*)arena->allocate(columns * sizeof(DATAFIELD_COLUMN_FORMAT));
+        m_columnOffsets = (uint16_t*)arena->allocate(columns * sizeof(uint16_t));
+    }
+    else
+    {
+        m_formats = new DATAFIELD_COLUMN_FORMAT[columns];
+        m_columnOffsets = new uint16_t[columns];
+    }
+
+    if (!m_formats || !m_columnOffsets)
+    {
+        freeData();
+        return false;
+    }
+
+    m_rowSize = 0;
+    m_allFloat = true;
+    for (column = 0; column < columns; ++column)
+    {
+        m_formats[column].storage = formats ? formats[column].storage : DATAFIELD_STORAGE_FLOAT;
+        m_formats[column].scale = formats ? formats[column].scale : 1.0f;
+
+        if (m_formats[column].scale == 0.0f) { m_formats[column].storage = DATAFIELD_STORAGE_FLOAT; }
+
+        m_allFloat &= (m_formats[column].storage == DATAFIELD_STORAGE_FLOAT);
+
+        m_columnOffsets[column] = m_rowSize;
+        m_rowSize += storageSize(m_formats[column].storage);
+    }
+
+    if (arena)
+    {
+        m_data = (uint8_t*)arena->allocate(rows * m_rowSize);
+        m_timeDeltas = (uint16_t*)arena->allocate(rows * sizeof(uint16_t));
+    }
+    else
+    {
+        m_data = new uint8_t[rows * m_rowSize];
+        m_timeDeltas = new uint16_t[rows];
+    }
+
+    if (!m_data || !m_timeDeltas)
+    {
+        freeData();
+        return false;
+    }
+
+    m_rows = rows;
+    m_columns = columns;
+
+    return true;
+}
+
+/*
+ * arenaBytesRequired
+ *
+ * Returns the arena space taken by setSize with the same arguments.
+ * The store object itself is not included.
+ */
+uint32_t DataFieldStore::arenaBytesRequired(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats)
+{
+    if (rows == 0 || columns == 0) { return 0; }
+
+    return Arena::alignedSize(columns * sizeof(DATAFIELD_COLUMN_FORMAT))
+        + Arena::alignedSize(columns * sizeof(uint16_t))
+        + Arena::alignedSize(rows * formatsRowSize(columns, formats))
+        + Arena::alignedSize(rows * sizeof(uint16_t));
+}
+
+bool DataFieldStore::isAllocated(void)
+{
+    return m_data != NULL;
+}
+
+uint32_t DataFieldStore::capacity(void)
+{
+    return m_rows;
+}
+
+uint8_t DataFieldStore::columns(void)
+{
+    return m_columns;
+}
+
+/*
+ * rowSize
+ *
+ * Returns the number of bytes used to store each row
+ */
+uint16_t DataFieldStore::rowSize(void)
+{
+    return m_rowSize;
+}
+
+/*
+ * pushRow
+ *
+ * Copies a complete row into the store, with its timestamp.
+ * Without a timestamp, the row takes the timestamp of the newest row.
+ * If the store is full, the oldest row is overwritten.
+ */
+void DataFieldStore::pushRow(float const * row)
+{
+    pushRow(row, m_headTime);
+}
+
+void DataFieldStore::pushRow(float const * row, UNIX_TIMESTAMP timestamp)
+{
+    uint8_t column;
+
+    if (!m_data || !row) { return; }
+
+    if (full()) { removeOldest(); }
+
+    m_timeDeltas[m_head] = encodeTimestamp(timestamp);
+
+    uint8_t * pRow = rowPointer(m_head);
+
+    if (m_allFloat)
+    {
+        memcpy(pRow, row, m_rowSize);
+    }
+    else
+    {
+        for (column = 0; column < m_columns; ++column)
+        {
+            writeValue(pRow, column, row[column]);
+        }
+    }
+
+    incrementwithrollover(m_head, m_rows - 1);
+    m_count++;
+}
+
+/*
+ * readRow
+ *
+ * Copies the oldest row out of the store (optionally removing it),
+ * and its timestamp into pTimestamp if not NULL.
+ * Returns false (and leaves row untouched) if there is no data.
+ */
+bool DataFieldStore::readRow(float * row, bool alsoRemove)
+{
+    return readRow(row, alsoRemove, NULL);
+}
+
+bool DataFieldStore::readRow(float * row, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp)
+{
+    uint8_t column;
+
+    if (!hasData() || !row) { return false; }
+
+    if (pTimestamp) { *pTimestamp = m_tailTime; }
+
+    uint8_t * pRow = rowPointer(m_tail);
+
+    if (m_allFloat)
+    {
+        memcpy(row, pRow, m_rowSize);
+    }
+    else
+    {
+        for (column = 0; column < m_columns; ++column)
+        {
+            row[column] = readValue(pRow, column);
+        }
+    }
+
+    if (alsoRemove) { removeOldest(); }
+
+    return true;
+}
+
+/*
+ * readRows
+ *
+ * Removes up to maxRows of the oldest rows into rows (row-major, columns() values per row),
+ * and their timestamps into timestamps if not NULL.
+ * Returns the number of rows copied.
+ * When all columns are floats, each contiguous run of the buffer is copied at once.
+ */
+uint32_t DataFieldStore::readRows(float * rows, uint32_t maxRows)
+{
+    return readRows(rows, maxRows, NULL);
+}
+
+uint32_t DataFieldStore::readRows(float * rows, uint32_t maxRows, UNIX_TIMESTAMP * timestamps)
+{
+    uint32_t toRead;
+    uint32_t run;
+    uint32_t row;
+    uint8_t column;
+
+    if (!rows || !m_data) { return 0; }
+
+    toRead = (maxRows < m_count) ? maxRows : m_count;
+
+    if (timestamps)
+    {
+        // Timestamps are decoded by walking the deltas, so remove rows one at a time
+        for (row = 0; row < toRead; ++row)
+        {
+            readRow(&rows[row * m_columns], true, &timestamps[row]);
+        }
+    }
+    else if (m_allFloat)
+    {
+        // The oldest rows may wrap around the end of the buffer, so copy in at most two runs
+        run = m_rows - m_tail;
+        if (run > toRead) { run = toRead; }
+
+        memcpy(rows, rowPointer(m_tail), run * m_rowSize);
+        memcpy(rows + (run * m_columns), rowPointer(0), (toRead - run) * m_rowSize);
+
+        for (row = 0; row < toRead; ++row)
+        {
+            removeOldest();
+        }
+    }
+    else
+    {
+        for (row = 0; row < toRead; ++row)
+        {
+            for (column = 0; column < m_columns; ++column)
+            {
+                rows[column] = readValue(rowPointer(m_tail), column);
+            }
+            rows += m_columns;
+            removeOldest();
+        }
+    }
+
+    return toRead;
+}
+
+/*
+ * getValue
+ *
+ * Returns a single column from the oldest row
+ */
+float DataFieldStore::getValue(uint8_t column)
+{
+    if (!hasData() || (column >= m_columns)) { return DATAFIELD_NO_DATA_VALUE; }
+
+    return readValue(rowPointer(m_tail), column);
+}
+
+/*
+ * oldestTimestamp
+ *
+ * Returns the timestamp of the oldest row (or of the last row removed if the store is empty)
+ */
+UNIX_TIMESTAMP DataFieldStore::oldestTimestamp(void)
+{
+    return m_tailTime;
+}
+
+void DataFieldStore::removeOldest(void)
+{
+    if (m_count > 0)
+    {
+        incrementwithrollover(m_tail, m_rows - 1);
+        m_count--;
+
+        // Move the oldest timestamp on to the new oldest row
+        if (m_count > 0)
+        {
+            if (m_timeDeltas[m_tail] == TIME_DELTA_REBASE)
+            {
+                m_tailTime = m_rebases[m_rebaseHead];
+                incrementwithrollover(m_rebaseHead, DATAFIELD_STORE_MAX_REBASES - 1);
+                m_rebaseCount--;
+            }
+            else
+            {
+                m_tailTime += m_timeDeltas[m_tail];
+            }
+        }
+    }
+}
+
+/*
+ * clear
+ *
+ * Removes every row, keeping the storage
+ */
+void DataFieldStore::clear(void)
+{
+    m_head = 0;
+    m_tail = 0;
+    m_count = 0;
+    m_tailTime = 0;
+    m_headTime = 0;
+    m_rebaseHead = 0;
+    m_rebaseCount = 0;
+}
+
+/*
+ * writeSnapshot
+ *
+ * Writes the rows (oldest first, as stored) and their timestamp deltas and rebase points.
+ * Only the rows in use are written, so a part-full store makes a small snapshot.
+ */
+void DataFieldStore::writeSnapshot(DataFieldSnapshotWriter * writer)
+{
+    uint8_t i;
+    uint32_t run;
+
+    if (!writer) { return; }
+
+    writer->write(&m_count, sizeof(m_count));
+    writer->write(&m_tailTime, sizeof(m_tailTime));
+    writer->write(&m_headTime, sizeof(m_headTime));
+    writer->write(&m_rebaseCount, sizeof(m_rebaseCount));
+
+    for (i = 0; i < m_rebaseCount; ++i)
+    {
+        writer->write(&m_rebases[(m_rebaseHead + i) % DATAFIELD_STORE_MAX_REBASES], sizeof(UNIX_TIMESTAMP));
+    }
+
+    if (m_count == 0) { return; }
+
+    // The rows may wrap around the end of the buffer, so write in at most two runs
+    run = m_rows - m_tail;
+    if (run > m_count) { run = m_count; }
+
+    writer->write(rowPointer(m_tail), run * m_rowSize);
+    writer->write(rowPointer(0), (m_count - run) * m_rowSize);
+    writer->write(&m_timeDeltas[m_tail], run * sizeof(uint16_t));
+    writer->write(&m_timeDeltas[0], (m_count - run) * sizeof(uint16_t));
+}
+
+/*
+ * readSnapshot
+ *
+ * Replaces the rows in the store with those written by writeSnapshot.
+ * The store must already be sized for at least as many rows, with the same row format.
+ * Returns false (leaving the store empty) if the rows could not be read.
+ */
+bool DataFieldStore::readSnapshot(DataFieldSnapshotReader * reader)
+{
+    uint32_t count;
+    bool valid;
+
+    clear();
+
+    if (!reader || !reader->read(&count, sizeof(count))) { return false; }
+
+    if (count > m_rows) { return false; }
+
+    valid = reader->read(&m_tailTime, sizeof(m_tailTime));
+    valid = valid && reader->read(&m_headTime, sizeof(m_headTime));
+    valid = valid && reader->read(&m_rebaseCount, sizeof(m_rebaseCount));
+    valid = valid && (m_rebaseCount <= DATAFIELD_STORE_MAX_REBASES);
+    valid = valid && reader->read(m_rebases, m_rebaseCount * sizeof(UNIX_TIMESTAMP));
+
+    // Restored rows start at the beginning of the buffer
+    valid = valid && ((count == 0) || reader->read(m_data, count * m_rowSize));
+    valid = valid && ((count == 0) || reader->read(m_timeDeltas, count * sizeof(uint16_t)));
+
+    if (!valid)
+    {
+        clear();
+        return false;
+    }
+
+    m_count = count;
+    m_head = (count == m_rows) ? 0 : count;
+
+    return true;
+}
+
+uint32_t DataFieldStore::length(void)
+{
+    return m_count;
+}
+
+bool DataFieldStore::hasData(void)
+{
+    return m_count > 0;
+}
+
+bool DataFieldStore::full(void)
+{
+    return (m_rows > 0) && (m_count == m_rows);
+}
+
+/*
+ * Private Class Functions
+ */
+
+uint8_t * DataFieldStore::rowPointer(uint32_t row)
+{
+    return &m_data[row * m_rowSize];
+}
+
+void DataFieldStore::freeData(void)
+{
+    // Arena memory is released with the arena
+    if (!m_arena)
+    {
+        delete[] m_data;
+        delete[] m_formats;
+        delete[] m_columnOffsets;
+        delete[] m_timeDeltas;
+    }
+
+    m_arena = NULL;
+    m_data = NULL;
+    m_timeDeltas = NULL;
+    m_tailTime = 0;
+    m_headTime = 0;
+    m_rebaseHead = 0;
+    m_rebaseCount = 0;
+    m_formats = NULL;
+    m_columnOffsets = NULL;
+    m_rowSize = 0;
+    m_allFloat = true;
+
+    m_head = 0;
+    m_tail = 0;
+    m_count = 0;
+    m_rows = 0;
+    m_columns = 0;
+}
+
+/*
+ * writeValue, readValue
+ *
+ * Values are copied with memcpy, since columns of different sizes
+ * mean values are not necessarily aligned within a row
+ */
+void DataFieldStore::writeValue(uint8_t * pRow, uint8_t column, float value)
+{
+    uint8_t * pValue = pRow + m_columnOffsets[column];
+    float scale = m_formats[column].scale;
+    int16_t value16;
+    int32_t value32;
+
+    switch (m_formats[column].storage)
+    {
+    case DATAFIELD_STORAGE_FIXED16:
+        value16 = (int16_t)toFixed(value, scale, FIXED16_LIMIT);
+        memcpy(pValue, &value16, sizeof(int16_t));
+        break;
+    case DATAFIELD_STORAGE_FIXED32:
+        value32 = toFixed(value, scale, FIXED32_LIMIT);
+        memcpy(pValue, &value32, sizeof(int32_t));
+        break;
+    case DATAFIELD_STORAGE_FLOAT:
+    default:
+        memcpy(pValue, &value, sizeof(float));
+        break;
+    }
+}
+
+float DataFieldStore::readValue(uint8_t * pRow, uint8_t column)
+{
+    uint8_t * pValue = pRow + m_columnOffsets[column];
+    float scale = m_formats[column].scale;
+    float value;
+    int16_t value16;
+    int32_t value32;
+
+    switch (m_formats[column].storage)
+    {
+    case DATAFIELD_STORAGE_FIXED16:
+        memcpy(&value16, pValue, sizeof(int16_t));
+        return fromFixed(value16, scale, FIXED16_LIMIT);
+    case DATAFIELD_STORAGE_FIXED32:
+        memcpy(&value32, pValue, sizeof(int32_t));
+        return fromFixed(value32, scale, FIXED32_LIMIT);
+    case DATAFIELD_STORAGE_FLOAT:
+    default:
+        memcpy(&value, pValue, sizeof(float));
+        return value;
+    }
+}
+
+/*
+ * encodeTimestamp
+ *
+ * Returns the delta to store for a new row with this timestamp,
+ * queueing a rebase point if the step from the newest row does not fit in the delta.
+ */
+uint16_t DataFieldStore::encodeTimestamp(UNIX_TIMESTAMP timestamp)
+{
+    uint8_t rebaseIndex;
+
+    if (m_count == 0)
+    {
+        // The first row's timestamp is held in full
+        m_tailTime = timestamp;
+        m_headTime = timestamp;
+        return 0;
+    }
+
+    if ((timestamp >= m_headTime) && ((timestamp - m_headTime) <= TIME_DELTA_MAX))
+    {
+        uint16_t delta = (uint16_t)(timestamp - m_headTime);
+        m_headTime = timestamp;
+        return delta;
+    }
+
+    if (m_rebaseCount < DATAFIELD_STORE_MAX_REBASES)
+    {
+        rebaseIndex = (m_rebaseHead + m_rebaseCount) % DATAFIELD_STORE_MAX_REBASES;
+        m_rebases[rebaseIndex] = timestamp;
+        m_rebaseCount++;
+        m_headTime = timestamp;
+        return TIME_DELTA_REBASE;
+    }
+
+    // No rebase points left: clamp to the nearest timestamp that can be represented
+    if (timestamp < m_headTime) { return 0; }
+
+    m_headTime += TIME_DELTA_MAX;
+    return TIME_DELTA_MAX;
+}
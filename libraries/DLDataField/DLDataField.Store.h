@@ -0,0 +1,89 @@
+#ifndef _DATAFIELD_STORE_H_
+#define _DATAFIELD_STORE_H_
+
+/*
+ * DataFieldStore
+ *
+ * Row-major (rows x columns) circular buffer of averaged field data.
+ * Every column shares a single head/tail index, so a complete row
+ * is always read or written in one pass (a single copy when all columns are floats).
+ * Columns can be stored as scaled 16 or 32-bit integers to save memory;
+ * they are converted back to float when read.
+ *
+ * Each row also carries a timestamp, stored as a 16-bit delta from the row before it
+ * (the oldest row's timestamp is kept in full). Steps that do not fit (backwards, or
+ * a gap of more than ~18 hours) are kept in full in a small queue of rebase points.
+ */
+
+// Number of out-of-range timestamp steps that can be held at once.
+// Beyond this, a row's timestamp is clamped to the nearest representable value.
+#define DATAFIELD_STORE_MAX_REBASES (8)
+
+class DataFieldSnapshotWriter;
+class DataFieldSnapshotReader;
+class Arena;
+
+class DataFieldStore
+{
+    public:
+        DataFieldStore();
+        ~DataFieldStore();
+
+        bool setSize(uint32_t rows, uint8_t columns);
+        bool setSize(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats);
+        bool setSize(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats, Arena * arena);
+        bool isAllocated(void);
+        static uint32_t arenaBytesRequired(uint32_t rows, uint8_t columns, DATAFIELD_COLUMN_FORMAT const * formats);
+
+        uint32_t capacity(void);
+        uint8_t columns(void);
+        uint16_t rowSize(void);
+
+        void pushRow(float const * row);
+        void pushRow(float const * row, UNIX_TIMESTAMP timestamp);
+        bool readRow(float * row, bool alsoRemove);
+        bool readRow(float * row, bool alsoRemove, UNIX_TIMESTAMP * pTimestamp);
+        uint32_t readRows(float * rows, uint32_t maxRows);
+        uint32_t readRows(float * rows, uint32_t maxRows, UNIX_TIMESTAMP * timestamps);
+        UNIX_TIMESTAMP oldestTimestamp(void);
+        float getValue(uint8_t column);
+        void removeOldest(void);
+        void clear(void);
+
+        /* The rows in the store (not its size or formats) are saved and restored */
+        void writeSnapshot(DataFieldSnapshotWriter * writer);
+        bool readSnapshot(DataFieldSnapshotReader * reader);
+
+        uint32_t length(void);
+        bool hasData(void);
+        bool full(void);
+
+    private:
+        uint8_t * rowPointer(uint32_t row);
+        void freeData(void);
+        void writeValue(uint8_t * pRow, uint8_t column, float value);
+        float readValue(uint8_t * pRow, uint8_t column);
+        uint16_t encodeTimestamp(UNIX_TIMESTAMP timestamp);
+
+        uint8_t * m_data;
+        DATAFIELD_COLUMN_FORMAT * m_formats;
+        uint16_t * m_columnOffsets;
+        uint16_t m_rowSize;
+        bool m_allFloat;
+        uint32_t m_head;
+        uint32_t m_tail;
+        uint32_t m_count;
+        uint32_t m_rows;
+        uint8_t m_columns;
+        Arena * m_arena;
+
+        // Timestamps: m_tailTime is the oldest row's, m_headTime the newest row's
+        uint16_t * m_timeDeltas;
+        UNIX_TIMESTAMP m_tailTime;
+        UNIX_TIMESTAMP m_headTime;
+        UNIX_TIMESTAMP m_rebases[DATAFIELD_STORE_MAX_REBASES];
+        uint8_t m_rebaseHead;
+        uint8_t m_rebaseCount;
+};
+
+#endif
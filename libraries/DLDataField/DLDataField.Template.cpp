@@ -0,0 +1,41 @@
+/*
+ * DLDataField.Template.cpp
+ *
+ * Numeric datafields with conversions specialised at compile time
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.PD.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.Conversion.h"
+#include "DLDataField.h"
+#include "DLDataField.Template.h"
+
+/*
+ * DataFieldT is defined in full in DLDataField.Template.h so that conversions inline
+ * at the call site. Instantiating it here for every policy checks that each one builds.
+ */
+
+template class DataFieldT<VoltageConversion>;
+template class DataFieldT<CurrentConversion>;
+template class DataFieldT<ThermistorConversion>;
@@ -0,0 +1,129 @@
+#ifndef _DATAFIELD_TEMPLATE_H_
+#define _DATAFIELD_TEMPLATE_H_
+
+/*
+ * Conversion policies
+ *
+ * Each policy names its parameter struct and field type, and provides
+ * an inline convert function (using the formulas in DLDataField.Conversion.h)
+ * and the equivalent affine conversion, if there is one.
+ * A DataFieldT<POLICY> converts with the policy directly, so there is no switch
+ * on field type or cast of conversion data.
+ */
+
+struct VoltageConversion
+{
+    typedef VOLTAGECHANNEL PARAMS;
+    static const FIELD_TYPE TYPE = VOLTAGE;
+
+    static inline float convert(float raw, PARAMS const & params)
+    {
+        return CONV_VoltsFromRaw(raw, params);
+    }
+
+    static inline bool getAffine(PARAMS const & params, float * pGain, float * pOffset)
+    {
+        CONV_VoltsAffine(&params, pGain, pOffset);
+        return true;
+    }
+};
+
+struct CurrentConversion
+{
+    typedef CURRENTCHANNEL PARAMS;
+    static const FIELD_TYPE TYPE = CURRENT;
+
+    static inline float convert(float raw, PARAMS const & params)
+    {
+        return CONV_AmpsFromRaw(raw, params);
+    }
+
+    static inline bool getAffine(PARAMS const & params, float * pGain, float * pOffset)
+    {
+        CONV_AmpsAffine(&params, pGain, pOffset);
+        return true;
+    }
+};
+
+struct ThermistorConversion
+{
+    typedef THERMISTORCHANNEL PARAMS;
+    static const FIELD_TYPE TYPE = TEMPERATURE_C;
+
+    static inline float convert(float raw, PARAMS const & params)
+    {
+        return CONV_CelsiusFromRawThermistor(raw, &params);
+    }
+
+    // Thermistor conversion is not linear
+    static inline bool getAffine(PARAMS const & params, float * pGain, float * pOffset)
+    {
+        (void)params; (void)pGain; (void)pOffset;
+        return false;
+    }
+};
+
+/*
+ * DataFieldConverter
+ *
+ * Conversion through a policy, for a field whose type is only known at runtime.
+ * NumericDataField picks a DataFieldConverterT<POLICY> for its field type once,
+ * when it is created, so converting a value is one virtual call on typed parameters.
+ */
+
+class DataFieldConverter
+{
+    public:
+        virtual float convert(float raw) = 0;
+        virtual bool getAffine(float * pGain, float * pOffset) = 0;
+};
+
+template <class CONVERSION>
+class DataFieldConverterT : public DataFieldConverter
+{
+    public:
+        DataFieldConverterT(typename CONVERSION::PARAMS const * params) : m_params(params) {}
+
+        float convert(float raw) { return CONVERSION::convert(raw, *m_params); }
+        bool getAffine(float * pGain, float * pOffset) { return CONVERSION::getAffine(*m_params, pGain, pOffset); }
+
+    private:
+        typename CONVERSION::PARAMS const * m_params;
+};
+
+/*
+ * DataFieldT
+ *
+ * A numeric field whose conversion is fixed at compile time by CONVERSION.
+ * Defined here in full so the conversion can be inlined at each call site.
+ */
+
+template <class CONVERSION>
+class DataFieldT : public DataField
+{
+    public:
+        DataFieldT(typename CONVERSION::PARAMS const & params, uint32_t channelNumber) :
+            DataField(CONVERSION::TYPE, channelNumber), m_params(params) {}
+
+        float convertData(float raw) { return CONVERSION::convert(raw, m_params); }
+
+        /* Converts n raw values. raw and out may be the same buffer. */
+        void convertArray(float const * raw, float * out, uint32_t n)
+        {
+            uint32_t i;
+
+            if (!raw || !out) { return; }
+
+            for (i = 0; i < n; ++i)
+            {
+                out[i] = CONVERSION::convert(raw[i], m_params);
+            }
+        }
+
+        typename CONVERSION::PARAMS const & getParams(void) { return m_params; }
+
+    private:
+        typename CONVERSION::PARAMS m_params;
+};
+
+#endif
@@ -20,6 +20,11 @@ enum field_type
     CARDINAL_DIRECTION, //N, NE, E, etc.
     DEGREES_DIRECTION,
 
+    // Derived values (calculated from other channels, see DERIVEDCHANNEL)
+    DERIVED_PRODUCT,
+    DERIVED_SUM,
+    DERIVED_INTEGRAL,
+
     INVALID_TYPE
 };
 typedef enum field_type FIELD_TYPE;
@@ -56,4 +61,16 @@ struct thermistorchannel
 }; 
 typedef struct thermistorchannel THERMISTORCHANNEL;
 
+/* Derived channels are calculated from the converted values of other channels:
+ * DERIVED_PRODUCT and DERIVED_SUM combine two or more inputs,
+ * DERIVED_INTEGRAL accumulates one input over time (in input units x hours) */
+#define DERIVED_CHANNEL_MAX_INPUTS (4)
+
+struct derivedchannel
+{
+    uint8_t inputs[DERIVED_CHANNEL_MAX_INPUTS]; // Input channel numbers
+    uint8_t inputCount;
+};
+typedef struct derivedchannel DERIVEDCHANNEL;
+
 #endif
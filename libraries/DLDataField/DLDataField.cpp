@@ -59,10 +59,14 @@ static char const * _getTypeString(FIELD_TYPE type)
     	"Irradiance (W/m2)", // IRRADIANCE_WpM2
 
     	"Wind Direction", // CARDINAL_DIRECTION
-    	"Wind Direction" // DEGREES_DIRECTION
+    	"Wind Direction", // DEGREES_DIRECTION
+
+    	"Product", // DERIVED_PRODUCT
+    	"Sum", // DERIVED_SUM
+    	"Integral (h)" // DERIVED_INTEGRAL
 	};
 
-	return (type <= DEGREES_DIRECTION) ? fieldtypestrings[type] : "";
+	return (type <= DERIVED_INTEGRAL) ? fieldtypestrings[type] : "";
 }
 
 /*
@@ -4,8 +4,34 @@
 // A datafield should return this value if data is requested when none exists
 #define DATAFIELD_NO_DATA_VALUE (float)(0xFFFFFFFF)
 
+// Number of points in the lookup table used for thermistor conversions.
+// 65 points keeps the error below 0.1C between -20C and 80C (see DLUtility.LookupTable.Test)
+#define DATAFIELD_THERMISTOR_TABLE_SIZE 65
+
 typedef float (APP_CONVERSION_FN)(float, void *);
 
+class DataFieldConverter;
+
+/* Averaged data can be stored as floats, or as scaled integers to save memory */
+enum datafield_storage
+{
+    DATAFIELD_STORAGE_FLOAT,
+    DATAFIELD_STORAGE_FIXED16,
+    DATAFIELD_STORAGE_FIXED32
+};
+typedef enum datafield_storage DATAFIELD_STORAGE;
+
+/* For fixed-point storage, values are stored as round(value * scale) */
+struct datafield_column_format
+{
+    DATAFIELD_STORAGE storage;
+    float scale;
+};
+typedef struct datafield_column_format DATAFIELD_COLUMN_FORMAT;
+
+class LookupTable;
+class Arena;
+
 class DataField
 {
     public:
@@ -23,6 +49,10 @@ class DataField
 
         uint32_t getChannelNumber(void);
 
+        virtual bool isString(void) { return false; }
+        virtual bool isNumeric(void) { return false; }
+        virtual bool isDerived(void) { return false; }
+
     protected:
 
         //void incrementIndexes(void);
@@ -53,16 +83,35 @@ class NumericDataField : public DataField
         NumericDataField(FIELD_TYPE type, void * fieldData, uint32_t channelNumber);
         ~NumericDataField();
 
+        /* If set, the averager, data and conversion table are allocated from the arena */
+        void setArena(Arena * arena);
+        static uint32_t arenaBytesRequired(FIELD_TYPE type, uint32_t averagerN, uint16_t tableSize);
+
         void setDataSizes(uint32_t N, uint32_t averagerN);
+        void setAveragerSize(uint32_t averagerN);
 
         bool storeData(int32_t data);
+        bool averageData(int32_t data, float * pAverage, AVERAGER_STATS * pStats);
+        /* Samples passed to averageData that are not yet part of an average, oldest first */
+        uint16_t pendingSampleCount(void);
+        int32_t getPendingSample(uint16_t index);
+        void clearPendingSamples(void);
+        float convertData(float raw);
+        bool getAffineConversion(float * pGain, float * pOffset);
 
         void setAltConversion(APP_CONVERSION_FN * altConversionFn);
+        bool setupConversionTable(uint16_t size);
+
+        void setStorage(DATAFIELD_STORAGE storage, int32_t maxRaw);
+        DATAFIELD_COLUMN_FORMAT getStorageFormat(void);
 
         float getRawData(bool alsoRemove);
         float getConvData(bool alsoRemove);
         void getRawDataAsString(char * buf, char const * const fmt, bool alsoRemove);
         void getConvDataAsString(char * buf, char const * const fmt, bool alsoRemove);
+        /* As above, but formatted without sprintf (as "%.<decimals>f") into a buffer of bufLength chars */
+        void getRawDataAsString(char * buf, uint8_t bufLength, uint8_t decimals, bool alsoRemove);
+        void getConvDataAsString(char * buf, uint8_t bufLength, uint8_t decimals, bool alsoRemove);
         void getConfigString(char * buffer);
 
         bool isString(void) { return false; }
@@ -70,9 +119,17 @@ class NumericDataField : public DataField
 
         void * getConversionParams(void) { return m_conversionData; }
     private:
+        bool inConversionTableRange(float data);
+
         float * m_data;
         void * m_conversionData;
         APP_CONVERSION_FN * m_altConversionFn;
+        DataFieldConverter * m_converter; // Constructed in m_converterStorage
+        void * m_converterStorage[2];
+        LookupTable * m_conversionTable;
+        Arena * m_arena;
+        DATAFIELD_STORAGE m_storage;
+        int32_t m_maxRaw;
         #ifdef TEST
         void printContents(void);
         #endif
@@ -98,6 +155,36 @@ class StringDataField : public DataField
         uint8_t m_maxLength;
 };
 
+class DerivedDataField : public DataField
+{
+    public:
+        /* type: DERIVED_PRODUCT, DERIVED_SUM or DERIVED_INTEGRAL
+         * fieldData: Pointer to DERIVEDCHANNEL with the input channels
+         */
+        DerivedDataField(FIELD_TYPE type, void * fieldData, uint32_t channelNumber);
+        ~DerivedDataField();
+
+        uint8_t inputCount(void);
+        uint32_t getInputChannel(uint8_t index);
+
+        /* Products and sums are calculated when a row is read, integrals as rows are stored */
+        bool isLazy(void);
+        float evaluate(float const * inputs);
+        float integrate(float value, uint32_t seconds);
+        float getTotal(void);
+        void setTotal(float total);
+
+        void getConfigString(char * buffer);
+
+        bool isString(void) { return false; }
+        bool isNumeric(void) { return false; }
+        bool isDerived(void) { return true; }
+
+    private:
+        DERIVEDCHANNEL m_inputs;
+        double m_total;
+};
+
 /* These functions are in-progress and don't really do the job they say they do quite right.
 uint32_t DataField_writeNumericDataToBuffer(
     char * buffer, NumericDataField datafields[], char const * const format, uint8_t arrayLength, uint8_t bufferLength);
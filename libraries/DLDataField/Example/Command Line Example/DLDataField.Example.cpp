@@ -1,7 +1,11 @@
 #include <iostream>
 
 #include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
 #include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
 #include "DLDataField.Manager.h"
 
 static DataFieldManager * s_dataManager;
@@ -33,7 +37,7 @@ int main(int argc, char * argv[])
     std::cout << "Adding 4 voltage fields... ";
     for (i = 0; i < 4; ++i)
     {
-        field = new NumericDataField(VOLTAGE, &s_voltageChannelSettings);
+        field = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, i + 1);
         s_dataManager->addField(field);
     }
     std::cout << "the manager count is now " << (int)s_dataManager->count() << "." << std::endl;
@@ -41,7 +45,7 @@ int main(int argc, char * argv[])
     std::cout << "Adding 4 current fields... ";
     for (i = 0; i < 8; ++i)
     {
-        field = new NumericDataField(CURRENT, &s_currentChannelSettings);
+        field = new NumericDataField(CURRENT, &s_currentChannelSettings, i + 5);
         s_dataManager->addField(field);
     }
     std::cout << "the manager count is now " << (int)s_dataManager->count() << "." << std::endl;
@@ -53,30 +57,36 @@ int main(int argc, char * argv[])
     
     std::cout << csvHeaders << std::endl;
 
-    std::cout << "The DataField manager can return its fields for adding data:" << std::endl;
+    std::cout << "The DataField manager stores one row of averages for all fields at a time:" << std::endl;
 
-    for (i = 0; i < 12; ++i)
+    int32_t rawData[12];
+    float rawRow[12];
+    float convertedRow[12];
+
+    for (j = 0; j < 10; j++)
     {
-        for (j = 0; j < 10; j++)
-        {
-            field = (NumericDataField*)s_dataManager->getField(i);
-            field->storeData(512);
-        }
+        for (i = 0; i < 12; ++i) { rawData[i] = 512; }
+        s_dataManager->storeDataArray(rawData);
+    }
 
-        std::cout << "Field" << (int)i << " Data: Raw=" << field->getRawData(0);
-        std::cout << ", Converted=" << field->getConvData(0) << std::endl;
+    for (j = 0; j < 10; j++)
+    {
+        for (i = 0; i < 12; ++i) { rawData[i] = 1024; }
+        s_dataManager->storeDataArray(rawData);
     }
 
-    for (i = 0; i < 12; ++i)
+    std::cout << "the manager count is now " << (int)s_dataManager->count() << "." << std::endl;
+
+    while (s_dataManager->hasData())
     {
-        for (j = 0; j < 10; j++)
+        s_dataManager->getDataArray(rawRow, false, false);
+        s_dataManager->getDataArray(convertedRow, true, true);
+
+        for (i = 0; i < 12; ++i)
         {
-            field = (NumericDataField*)s_dataManager->getField(i);
-            field->storeData(1024);
+            std::cout << "Field" << (int)i << " Data: Raw=" << rawRow[i];
+            std::cout << ", Converted=" << convertedRow[i] << std::endl;
         }
-
-        std::cout << "Field" << (int)i << " Data: Raw=" << field->getRawData(1);
-        std::cout << ", Converted=" << field->getConvData(1) << std::endl;
     }
     
     return 0;
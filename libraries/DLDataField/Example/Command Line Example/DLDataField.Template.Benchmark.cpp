@@ -0,0 +1,112 @@
+/*
+ * DLDataField.Template.Benchmark.cpp
+ *
+ * Times voltage conversion through NumericDataField::convertData
+ * against DataFieldT<VoltageConversion>::convertData (value by value, like for like)
+ * and DataFieldT<VoltageConversion>::convertArray
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Local Includes
+ */
+
+#include "DLUtility.PD.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.Conversion.h"
+#include "DLDataField.h"
+#include "DLDataField.Template.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+#define VALUES (1024)
+#define REPEATS (20000UL)
+
+/*
+ * Private Variables
+ */
+
+static VOLTAGECHANNEL s_voltageChannelSettings = {
+    .mvPerBit = 0.125f,
+    .offset = 0.1f,
+    .multiplier = 2.0f,
+    .R1 = 200000.0f,
+    .R2 = 10000.0f,
+};
+
+static float s_raw[VALUES];
+static float s_converted[VALUES];
+
+/*
+ * Private Functions
+ */
+
+static double secondsSince(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(void)
+{
+    NumericDataField numeric(VOLTAGE, &s_voltageChannelSettings, 1);
+    DataFieldT<VoltageConversion> templated(s_voltageChannelSettings, 1);
+
+    uint32_t i;
+    uint32_t repeat;
+    float total;
+    clock_t start;
+    double numericTime;
+    double templatedTime;
+    double arrayTime;
+    double conversions = (double)VALUES * REPEATS;
+
+    for (i = 0; i < VALUES; ++i) { s_raw[i] = (float)i; }
+
+    // The totals are printed so the loops cannot be optimised away
+    start = clock();
+    for (total = 0.0f, repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (i = 0; i < VALUES; ++i) { s_converted[i] = numeric.convertData(s_raw[i]); }
+        total += s_converted[repeat % VALUES];
+    }
+    numericTime = secondsSince(start);
+    printf("NumericDataField::convertData:  %.3fs (%.1fM conversions/s, total %.1f)\n",
+        numericTime, conversions / numericTime / 1e6, total);
+
+    start = clock();
+    for (total = 0.0f, repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        for (i = 0; i < VALUES; ++i) { s_converted[i] = templated.convertData(s_raw[i]); }
+        total += s_converted[repeat % VALUES];
+    }
+    templatedTime = secondsSince(start);
+    printf("DataFieldT::convertData:        %.3fs (%.1fM conversions/s, total %.1f, %.1fx faster)\n",
+        templatedTime, conversions / templatedTime / 1e6, total, numericTime / templatedTime);
+
+    start = clock();
+    for (total = 0.0f, repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        templated.convertArray(s_raw, s_converted, VALUES);
+        total += s_converted[repeat % VALUES];
+    }
+    arrayTime = secondsSince(start);
+    printf("DataFieldT::convertArray:       %.3fs (%.1fM conversions/s, total %.1f, %.1fx faster)\n",
+        arrayTime, conversions / arrayTime / 1e6, total, numericTime / arrayTime);
+
+    return 0;
+}
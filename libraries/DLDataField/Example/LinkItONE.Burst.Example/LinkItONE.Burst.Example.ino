@@ -0,0 +1,126 @@
+/*
+ * LinkItONE.Burst.Example
+ *
+ * Burst capture example on the LinkItONE platform.
+ *
+ * Basic summary:
+ *
+ * - Reads a current sensor on onboard ADC A0 (or channel 0 of an ADS1115) as fast as loop() runs
+ * - Each reading goes to a DataFieldBurst, which triggers when the reading rises past 1A
+ * - A TaskAction writes the capture (64 samples before the trigger, 192 after) to the SD card,
+ *   a few samples at a time, then the burst re-arms itself
+ */
+
+/*
+ * Standard Library Includes
+ */
+
+#include <stdint.h>
+
+/*
+ * Arduino Library Includes
+ */
+
+#include <Wire.h>
+
+/*
+ * LinkIt One Includes
+ */
+
+#include <LSD.h>
+
+/*
+ * DataLogger Includes
+ */
+
+#include "TaskAction.h"
+
+#include "DLUtility.h"
+#include "DLUtility.Averager.h"
+#include "DLUtility.Strings.h"
+#include "DLLocalStorage.h"
+#include "DLSensor.LinkItONE.h"
+#include "DLSensor.ADS1x1x.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLDataField.Burst.h"
+
+// Use 1 to read from an ADS1115 instead of the onboard ADC
+#define USE_ADS1115 0
+
+#define PRE_TRIGGER (64)
+#define POST_TRIGGER (192)
+
+#define WRITE_INTERVAL_MS (100)
+#define SAMPLES_PER_WRITE (32)
+
+static char const s_captureFile[] = "BURST.CSV";
+
+// 10-bit ADC reading 0 to 5V, 2.5V at 0A, 100mV per A
+static CURRENTCHANNEL s_currentChannel = {
+    .mvPerBit = 5000.0f / 1024.0f,
+    .offset = 2500.0f,
+    .mvPerAmp = 100.0f,
+};
+
+#if USE_ADS1115
+static ADS1115 s_adc(0x48);
+#else
+static LinkItONEADC s_adc(A0);
+#endif
+
+static NumericDataField s_field(CURRENT, &s_currentChannel, 1);
+
+static int32_t s_burstBuffer[PRE_TRIGGER + POST_TRIGGER];
+static DataFieldBurst s_burst(s_burstBuffer, PRE_TRIGGER + POST_TRIGGER);
+
+static LocalStorageInterface * s_sdCard;
+
+static int32_t readADC(void)
+{
+    #if USE_ADS1115
+    return s_adc.readADC_SingleEnded(0);
+    #else
+    return s_adc.read();
+    #endif
+}
+
+static void writeCaptureTaskFn(void)
+{
+    if (s_burst.state() != BURST_STATE_CAPTURED) { return; }
+
+    if (s_burst.writeCapture(s_sdCard, s_captureFile, SAMPLES_PER_WRITE))
+    {
+        Serial.println("Burst written");
+    }
+}
+static TaskAction writeCaptureTask(writeCaptureTaskFn, WRITE_INTERVAL_MS, INFINITE_TICKS);
+
+void setup()
+{
+    int32_t threshold;
+
+    // setup Serial port
+    Serial.begin(115200);
+
+    delay(10000);
+
+    #if USE_ADS1115
+    s_adc.begin();
+    #endif
+
+    s_sdCard = LocalStorage_GetLocalStorageInterface(LINKITONE_SD_CARD);
+
+    // The trigger threshold is a raw reading, so work out the reading for 1A
+    threshold = (int32_t)(((1.0f * s_currentChannel.mvPerAmp) + s_currentChannel.offset) / s_currentChannel.mvPerBit);
+
+    s_burst.setup(&s_field, PRE_TRIGGER, POST_TRIGGER, threshold, BURST_TRIGGER_RISING);
+}
+
+void loop()
+{
+    if (s_burst.addSample(readADC()) == BURST_STATE_CAPTURED)
+    {
+        writeCaptureTask.tick();
+    }
+}
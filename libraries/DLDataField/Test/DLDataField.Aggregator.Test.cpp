@@ -0,0 +1,131 @@
+/*
+ * DLDataField.Aggregator.Test.cpp
+ *
+ * Tests the DataFieldAggregator class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+static DataFieldAggregator * s_aggregator;
+
+void setUp(void)
+{
+    s_aggregator = new DataFieldAggregator();
+}
+
+void tearDown(void)
+{
+    delete s_aggregator;
+}
+
+static void test_AggregatorIsNotAllocatedUntilSized(void)
+{
+    float row[] = {1.0f};
+
+    TEST_ASSERT_FALSE(s_aggregator->isAllocated());
+    TEST_ASSERT_FALSE(s_aggregator->addRow(row, NULL));
+    TEST_ASSERT_FALSE(s_aggregator->setSize(0, 10, 1));
+    TEST_ASSERT_FALSE(s_aggregator->setSize(2, 0, 1));
+
+    TEST_ASSERT_TRUE(s_aggregator->setSize(2, 10, 1));
+    TEST_ASSERT_TRUE(s_aggregator->isAllocated());
+    TEST_ASSERT_EQUAL(2, s_aggregator->decimation());
+}
+
+static void test_AggregatorAveragesEveryNRows(void)
+{
+    float row[2];
+    float average[2];
+    uint8_t i;
+
+    s_aggregator->setSize(3, 10, 2);
+
+    for (i = 0; i < 6; ++i)
+    {
+        row[0] = i;
+        row[1] = i * 10;
+        TEST_ASSERT_EQUAL((i % 3) == 2, s_aggregator->addRow(row, average));
+    }
+
+    TEST_ASSERT_EQUAL(2, s_aggregator->store()->length());
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, average[0]);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, average[1]);
+
+    s_aggregator->store()->readRow(average, true);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, average[0]);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, average[1]);
+}
+
+static void test_AggregatorIgnoresMissingData(void)
+{
+    float rows[][2] = {
+        {1.0f, DATAFIELD_NO_DATA_VALUE},
+        {DATAFIELD_NO_DATA_VALUE, DATAFIELD_NO_DATA_VALUE},
+        {3.0f, DATAFIELD_NO_DATA_VALUE}
+    };
+    float average[2];
+    uint8_t i;
+
+    s_aggregator->setSize(3, 10, 2);
+
+    for (i = 0; i < 3; ++i)
+    {
+        s_aggregator->addRow(rows[i], average);
+    }
+
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, average[0]);
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, average[1]);
+}
+
+static void test_AggregatorAveragesInPlace(void)
+{
+    float row[1];
+
+    s_aggregator->setSize(2, 10, 1);
+
+    row[0] = 5.0f;
+    s_aggregator->addRow(row, row);
+    row[0] = 7.0f;
+    TEST_ASSERT_TRUE(s_aggregator->addRow(row, row));
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, row[0]);
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Aggregator.Test.cpp");
+
+    RUN_TEST(test_AggregatorIsNotAllocatedUntilSized);
+    RUN_TEST(test_AggregatorAveragesEveryNRows);
+    RUN_TEST(test_AggregatorIgnoresMissingData);
+    RUN_TEST(test_AggregatorAveragesInPlace);
+
+    return (UnityEnd());
+}
@@ -0,0 +1,172 @@
+/*
+ * DLDataField.Burst.Test.cpp
+ *
+ * Tests the DataFieldBurst class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Burst.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+#define xstr(s) str(s)
+#define str(s) #s
+#define QUOTED_DL_PATH xstr(DL_PATH)
+
+#define BURST_DIRECTORY QUOTED_DL_PATH "/DLDataField/Test/Burst"
+#define BURST_FILE BURST_DIRECTORY "/BURST.CSV"
+
+static LocalStorageInterface * s_storage;
+static int32_t s_buffer[16];
+
+void setUp(void)
+{
+    if (!s_storage) { s_storage = LocalStorage_GetLocalStorageInterface(LOCAL_STORAGE_TYPE(0)); }
+    if (!s_storage->directoryExists(BURST_DIRECTORY)) { s_storage->mkDir(BURST_DIRECTORY); }
+    s_storage->removeFile(BURST_FILE);
+}
+
+void tearDown(void) {}
+
+static std::string readBurstFile(void)
+{
+    std::ifstream file(BURST_FILE);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void test_SetupFailsIfBufferIsTooSmall(void)
+{
+    DataFieldBurst burst(s_buffer, 16);
+
+    TEST_ASSERT_FALSE(burst.setup(NULL, 10, 7, 5, BURST_TRIGGER_RISING));
+    TEST_ASSERT_FALSE(burst.setup(NULL, 10, 0, 5, BURST_TRIGGER_RISING));
+    TEST_ASSERT_EQUAL(BURST_STATE_IDLE, burst.state());
+    TEST_ASSERT_EQUAL(BURST_STATE_IDLE, burst.addSample(10));
+
+    TEST_ASSERT_TRUE(burst.setup(NULL, 10, 6, 5, BURST_TRIGGER_RISING));
+    TEST_ASSERT_EQUAL(BURST_STATE_ARMED, burst.state());
+}
+
+static void test_RisingTriggerCapturesSamplesAroundTrigger(void)
+{
+    int32_t sample;
+    uint16_t i;
+
+    DataFieldBurst burst(s_buffer, 16);
+    TEST_ASSERT_TRUE(burst.setup(NULL, 3, 2, 5, BURST_TRIGGER_RISING));
+
+    // 5 is the first sample at or above the threshold
+    for (sample = 0; sample < 5; ++sample)
+    {
+        TEST_ASSERT_EQUAL(BURST_STATE_ARMED, burst.addSample(sample));
+    }
+    TEST_ASSERT_EQUAL(BURST_STATE_TRIGGERED, burst.addSample(5));
+    TEST_ASSERT_EQUAL(BURST_STATE_CAPTURED, burst.addSample(6));
+
+    // Frozen until written
+    TEST_ASSERT_EQUAL(BURST_STATE_CAPTURED, burst.addSample(7));
+
+    TEST_ASSERT_EQUAL(5, burst.capturedCount());
+    TEST_ASSERT_EQUAL(3, burst.preTriggerCount());
+    for (i = 0; i < 5; ++i)
+    {
+        TEST_ASSERT_EQUAL(i + 2, burst.getCapturedSample(i));
+    }
+}
+
+static void test_EarlyTriggerCapturesFewerPreTriggerSamples(void)
+{
+    DataFieldBurst burst(s_buffer, 16);
+    TEST_ASSERT_TRUE(burst.setup(NULL, 4, 3, 100, BURST_TRIGGER_FALLING));
+
+    // The first sample cannot trigger, as there is no previous sample to cross from
+    burst.addSample(50);
+    burst.addSample(150);
+    burst.addSample(90);
+    burst.addSample(80);
+    TEST_ASSERT_EQUAL(BURST_STATE_CAPTURED, burst.addSample(70));
+
+    TEST_ASSERT_EQUAL(5, burst.capturedCount());
+    TEST_ASSERT_EQUAL(2, burst.preTriggerCount());
+    TEST_ASSERT_EQUAL(50, burst.getCapturedSample(0));
+    TEST_ASSERT_EQUAL(90, burst.getCapturedSample(2));
+    TEST_ASSERT_EQUAL(70, burst.getCapturedSample(4));
+}
+
+static void test_CaptureIsWrittenInChunksAndRearmed(void)
+{
+    int32_t sample;
+
+    DataFieldBurst burst(s_buffer, 16);
+    TEST_ASSERT_TRUE(burst.setup(NULL, 2, 3, 10, BURST_TRIGGER_RISING));
+
+    // Nothing to write until a capture completes
+    TEST_ASSERT_FALSE(burst.writeCapture(s_storage, BURST_FILE, 2));
+
+    for (sample = 0; sample < 30; sample += 3) { burst.addSample(sample); }
+    TEST_ASSERT_EQUAL(BURST_STATE_CAPTURED, burst.state());
+
+    TEST_ASSERT_FALSE(burst.writeCapture(s_storage, BURST_FILE, 2));
+    TEST_ASSERT_FALSE(burst.writeCapture(s_storage, BURST_FILE, 2));
+    TEST_ASSERT_TRUE(burst.writeCapture(s_storage, BURST_FILE, 2));
+
+    TEST_ASSERT_EQUAL(BURST_STATE_ARMED, burst.state());
+
+    std::string contents = readBurstFile();
+    TEST_ASSERT_EQUAL_STRING("Sample,Raw\r\n-2,6\r\n-1,9\r\n0,12\r\n1,15\r\n2,18\r\n", contents.c_str());
+}
+
+static void test_CaptureIsWrittenConvertedByField(void)
+{
+    NumericDataField field(VOLTAGE, NULL, 3);
+
+    DataFieldBurst burst(s_buffer, 16);
+    TEST_ASSERT_TRUE(burst.setup(&field, 1, 1, 10, BURST_TRIGGER_RISING));
+
+    burst.addSample(9);
+    TEST_ASSERT_EQUAL(BURST_STATE_CAPTURED, burst.addSample(11));
+    TEST_ASSERT_TRUE(burst.writeCapture(s_storage, BURST_FILE, 10));
+
+    std::string contents = readBurstFile();
+    TEST_ASSERT_EQUAL_STRING("Sample,Channel 3\r\n-1,9.000\r\n0,11.000\r\n", contents.c_str());
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Burst.Test.cpp");
+
+    RUN_TEST(test_SetupFailsIfBufferIsTooSmall);
+    RUN_TEST(test_RisingTriggerCapturesSamplesAroundTrigger);
+    RUN_TEST(test_EarlyTriggerCapturesFewerPreTriggerSamples);
+    RUN_TEST(test_CaptureIsWrittenInChunksAndRearmed);
+    RUN_TEST(test_CaptureIsWrittenConvertedByField);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,18 @@
+SRC_FILES += DLDataField/DLDataField.cpp DLDataField/DLDataField.String.cpp DLDataField/DLDataField.Numeric.cpp
+SRC_FILES += DLDataField/DLDataField.Conversion.cpp DLDataField/DLDataField.Template.cpp
+SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.Strings.cpp
+SRC_FILES += DLUtility/DLUtility.Averager.cpp DLUtility/DLUtility.LookupTable.cpp DLUtility/DLUtility.Arena.cpp
+
+SRC_FILES += DLUtility/DLUtility.PD.cpp
+
+SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
+
+SRC_FILES += DLTest/DLTest.Mock.LocalStorage.cpp DLUtility/DLUtility.Readline.cpp
+
+INC_DIRS += -IDLUtility -IDLSensor -IDLLocalStorage
+
+local_setup:
+	rm -rf ./DLDataField/Test/Burst
+
+local_teardown:
+	rm -rf ./DLDataField/Test/Burst
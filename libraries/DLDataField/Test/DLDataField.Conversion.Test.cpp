@@ -28,6 +28,7 @@
  * Local Application Includes
  */
 
+#include "DLUtility.PD.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.Conversion.h"
 
@@ -109,6 +110,49 @@ void test_ConversionHighsideThermistorToTemperatureIsCorrect(void)
 	TEST_ASSERT_FLOAT_WITHIN_MESSAGE(expected, actual, expected/100, message);
 }
 
+void test_VoltsAffineMatchesConversionToVolts(void)
+{
+	VOLTAGECHANNEL testChannel = 
+	{
+	    .mvPerBit = 0.125,
+	    .offset = 0.1,
+	    .multiplier = 2.0,
+	    .R1 = 200000,
+	    .R2 = 10000
+	};
+
+	float gain;
+	float offset;
+	float raw;
+
+	CONV_VoltsAffine(&testChannel, &gain, &offset);
+
+	for (raw = -2000.0f; raw < 30000.0f; raw += 1000.0f)
+	{
+		TEST_ASSERT_FLOAT_WITHIN(0.0001f, CONV_VoltsFromRaw(raw, &testChannel), (raw * gain) + offset);
+	}
+}
+
+void test_AmpsAffineMatchesConversionToAmps(void)
+{
+	CURRENTCHANNEL testChannel = {
+    	.mvPerBit = 0.125,
+    	.offset = 600,
+    	.mvPerAmp = 60
+    };
+
+	float gain;
+	float offset;
+	float raw;
+
+	CONV_AmpsAffine(&testChannel, &gain, &offset);
+
+	for (raw = -2000.0f; raw < 30000.0f; raw += 1000.0f)
+	{
+		TEST_ASSERT_FLOAT_WITHIN(0.0001f, CONV_AmpsFromRaw(raw, &testChannel), (raw * gain) + offset);
+	}
+}
+
 int main(void)
 {
     UnityBegin("DLDataField.Conversion.cpp");
@@ -116,6 +160,8 @@ int main(void)
     RUN_TEST(test_ConversionToVoltsIsCorrect);
     RUN_TEST(test_ConversionToAmpsIsCorrect);
     RUN_TEST(test_ConversionHighsideThermistorToTemperatureIsCorrect);
+    RUN_TEST(test_VoltsAffineMatchesConversionToVolts);
+    RUN_TEST(test_AmpsAffineMatchesConversionToAmps);
 
     UnityEnd();
     return 0;
@@ -13,6 +13,7 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <iostream>
@@ -21,10 +22,19 @@
  * Local Application Includes
  */
 
+#include "DLUtility.Arena.h"
+#include "DLUtility.PD.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
+#include "DLDataField.Conversion.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
 #include "DLDataField.Manager.h"
+#include "DLSettings.Reader.Errors.h"
+#include "DLSettings.DataChannels.h"
+#include "DLSettings.Global.h"
 
 /*
  * Unity Test Framework
@@ -46,6 +56,34 @@ static CURRENTCHANNEL s_currentChannelSettings = {
     .mvPerAmp = 600.0f,
 };
 
+static THERMISTORCHANNEL s_thermistorChannelSettings = {
+    .R25 = 10000.0f,
+    .B = 3950.0f,
+    .otherR = 10000.0f,
+    .maxADC = 1023.0f,
+    .highside = true
+};
+
+static void parseCurrentChannel(char const * channel)
+{
+    char setting[32];
+
+    sprintf(setting, "%s.type = current", channel);
+    Settings_parseDataChannelSetting(setting, 1);
+    sprintf(setting, "%s.mvperbit = 0.125", channel);
+    Settings_parseDataChannelSetting(setting, 2);
+    sprintf(setting, "%s.offset = 60", channel);
+    Settings_parseDataChannelSetting(setting, 3);
+    sprintf(setting, "%s.mvperamp = 600", channel);
+    Settings_parseDataChannelSetting(setting, 4);
+}
+
+static float doubleConversion(float in, void * data)
+{
+    (void)data;
+    return in * 2;
+}
+
 void setUp(void)
 {
     s_manager = new DataFieldManager(10, 1);
@@ -106,23 +144,26 @@ static void test_writeHeadersToBufferWritesCorrectFields(void)
     TEST_ASSERT_EQUAL_STRING("Voltage (V), Current (A), Wind Direction\r\n", buffer);
 }
 
-static void test_hasDataRemainingReturnsTrueWhenAtLeastOneFieldHasData(void)
+static void test_hasDataReturnsTrueWhenAtLeastOneRowIsStored(void)
 {
     TEST_ASSERT_FALSE(s_manager->hasData());
-    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 0) );
-    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 0) );
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 2) );
     TEST_ASSERT_FALSE(s_manager->hasData());
 
-    ((NumericDataField*)(s_manager->getField(0)))->storeData(0);
+    int32_t input[] = {0, 0};
+    float output[2];
+
+    s_manager->storeDataArray(input);
     TEST_ASSERT_TRUE(s_manager->hasData());
 
-    ((NumericDataField*)(s_manager->getField(1)))->storeData(0);
+    s_manager->storeDataArray(input);
     TEST_ASSERT_TRUE(s_manager->hasData());
 
-    ((NumericDataField*)(s_manager->getField(0)))->getRawData(true);
+    s_manager->getDataArray(output, false, true);
     TEST_ASSERT_TRUE(s_manager->hasData());
 
-    ((NumericDataField*)(s_manager->getField(1)))->getRawData(true);
+    s_manager->getDataArray(output, false, true);
     TEST_ASSERT_FALSE(s_manager->hasData());
 }
 
@@ -138,6 +179,27 @@ void test_managerReturnsCorrectArrayOfChannelNumbers(void)
     TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, s_manager->getChannelNumbers(), 4);
 }
 
+void test_managerLooksUpFieldsByChannel(void)
+{
+    NumericDataField * fields[] = {
+        new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 12),
+        new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 3),
+        new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 32),
+    };
+
+    uint8_t i;
+    for (i = 0; i < 3; ++i)
+    {
+        s_manager->addField(fields[i]);
+    }
+
+    TEST_ASSERT_EQUAL_PTR(fields[0], s_manager->getChannel(12));
+    TEST_ASSERT_EQUAL_PTR(fields[1], s_manager->getChannel(3));
+    TEST_ASSERT_EQUAL_PTR(fields[2], s_manager->getChannel(32));
+    TEST_ASSERT_EQUAL_PTR(NULL, s_manager->getChannel(1));
+    TEST_ASSERT_EQUAL_PTR(NULL, s_manager->getChannel(33));
+}
+
 void test_managerDataArrayCanBeAdded(void)
 {
     s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
@@ -145,7 +207,7 @@ void test_managerDataArrayCanBeAdded(void)
     s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 7) );
     s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 12) );
 
-    int32_t input[] = {34, 5432, 632, -532};
+    int32_t input[] = {34, 0, 5432, 0, 0, 0, 632, 0, 0, 0, 0, -532};
     s_manager->storeDataArray(input);
 
     float actualFloats[] = {0.0, 0.0, 0.0, 0.0};
@@ -161,6 +223,588 @@ void test_managerDataArrayCanBeAdded(void)
     TEST_ASSERT_EQUAL_FLOAT_ARRAY_MESSAGE(expectedFloats, actualFloats, 4, message);
 }
 
+void test_managerRowsAreReturnedOldestFirstAndCounted(void)
+{
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 2) );
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+
+    int32_t input[2];
+    float actual[2];
+    int32_t i;
+
+    for (i = 0; i < 3; ++i)
+    {
+        input[0] = i;
+        input[1] = i * 10;
+        s_manager->storeDataArray(input);
+    }
+
+    TEST_ASSERT_EQUAL(3, s_manager->count());
+
+    for (i = 0; i < 3; ++i)
+    {
+        s_manager->getDataArray(actual, false, true);
+        // Fields are in the order they were added, not in channel order
+        TEST_ASSERT_EQUAL_FLOAT(i * 10, actual[0]);
+        TEST_ASSERT_EQUAL_FLOAT(i, actual[1]);
+    }
+
+    TEST_ASSERT_EQUAL(0, s_manager->count());
+
+    s_manager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, actual[1]);
+    TEST_ASSERT_EQUAL(0, s_manager->count());
+}
+
+void test_managerDrainsRowsInBulk(void)
+{
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    s_manager->addField( new NumericDataField(CURRENT, &s_currentChannelSettings, 2) );
+
+    int32_t input[2];
+    float actual[8];
+    int32_t i;
+
+    for (i = 0; i < 6; ++i)
+    {
+        input[0] = i;
+        input[1] = i * 1000;
+        s_manager->storeDataArray(input);
+    }
+
+    TEST_ASSERT_EQUAL(4, s_manager->drainRows(actual, 4, true));
+    for (i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(CONV_VoltsFromRaw(i, &s_voltageChannelSettings), actual[i * 2]);
+        TEST_ASSERT_EQUAL_FLOAT(CONV_AmpsFromRaw(i * 1000, &s_currentChannelSettings), actual[(i * 2) + 1]);
+    }
+
+    TEST_ASSERT_EQUAL(2, s_manager->count());
+
+    TEST_ASSERT_EQUAL(2, s_manager->drainRows(actual, 4, false));
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(5000.0f, actual[3]);
+
+    TEST_ASSERT_EQUAL(0, s_manager->drainRows(actual, 4, false));
+    TEST_ASSERT_FALSE(s_manager->hasData());
+}
+
+void test_managerStampsRowsWhenTheAveragerCompletes(void)
+{
+    DataFieldManager manager(10, 2);
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    TEST_ASSERT_EQUAL(1, manager.addAggregationLevel(2, 4));
+
+    int32_t input;
+    float actual[4];
+    UNIX_TIMESTAMP timestamp = 0;
+    UNIX_TIMESTAMP timestamps[4];
+
+    // Averager of 2, so rows complete on every second sample
+    for (input = 0; input < 8; ++input)
+    {
+        manager.storeDataArray(&input, 1600000000ULL + (input * 30));
+    }
+
+    manager.getDataArray(actual, false, false, &timestamp);
+    TEST_ASSERT_TRUE(timestamp == 1600000030ULL);
+
+    TEST_ASSERT_EQUAL(4, manager.drainRows(actual, 4, false, timestamps));
+    TEST_ASSERT_TRUE(timestamps[0] == 1600000030ULL);
+    TEST_ASSERT_TRUE(timestamps[3] == 1600000210ULL);
+
+    // Aggregated rows take the timestamp of the last row averaged into them
+    manager.getLevelDataArray(1, actual, false, true, &timestamp);
+    TEST_ASSERT_TRUE(timestamp == 1600000090ULL);
+}
+
+void test_managerOverwritesOldestRowWhenFull(void)
+{
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+
+    int32_t input;
+    float actual;
+
+    // Manager has space for 10 rows
+    for (input = 0; input < 13; ++input)
+    {
+        s_manager->storeDataArray(&input);
+    }
+
+    TEST_ASSERT_EQUAL(10, s_manager->count());
+
+    for (input = 3; input < 13; ++input)
+    {
+        s_manager->getDataArray(&actual, false, true);
+        TEST_ASSERT_EQUAL_FLOAT(input, actual);
+    }
+
+    TEST_ASSERT_FALSE(s_manager->hasData());
+}
+
+void test_managerConvertsDataArrayWithFieldConversion(void)
+{
+    s_manager->addField( new NumericDataField(CURRENT, &s_currentChannelSettings, 1) );
+
+    int32_t input[] = {1000};
+    float actual;
+    s_manager->storeDataArray(input);
+
+    s_manager->getDataArray(&actual, true, false);
+    TEST_ASSERT_EQUAL_FLOAT(CONV_AmpsFromRaw(1000.0f, &s_currentChannelSettings), actual);
+}
+
+void test_managerConvertRowMatchesFieldConversions(void)
+{
+    NumericDataField * fields[] = {
+        new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1),
+        new NumericDataField(CURRENT, &s_currentChannelSettings, 2),
+        new NumericDataField(TEMPERATURE_C, &s_thermistorChannelSettings, 3),
+        new NumericDataField(CURRENT, &s_currentChannelSettings, 4),
+    };
+    fields[3]->setAltConversion(doubleConversion);
+
+    uint8_t i;
+    for (i = 0; i < 4; ++i) { s_manager->addField(fields[i]); }
+    s_manager->addField( new StringDataField(CARDINAL_DIRECTION, 10, 10, 5) );
+
+    int32_t input[] = {1000, 2000, 500, 300, 0};
+    s_manager->storeDataArray(input);
+
+    float raw[5];
+    float converted[5];
+    s_manager->getDataArray(raw, false, false);
+    s_manager->convertRow(raw, converted);
+
+    for (i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(0.0001f, fields[i]->convertData(raw[i]), converted[i]);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(600.0f, converted[3]);
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, converted[4]);
+
+    // Conversion in place gives the same result
+    s_manager->convertRow(raw, raw);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(converted, raw, 5);
+}
+
+void test_managerFeedsRowsThroughAggregationLevels(void)
+{
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+
+    TEST_ASSERT_EQUAL(1, s_manager->addAggregationLevel(2, 10));
+    TEST_ASSERT_EQUAL(2, s_manager->addAggregationLevel(3, 10));
+    TEST_ASSERT_EQUAL(3, s_manager->levelCount());
+
+    int32_t input;
+    float actual;
+
+    for (input = 1; input <= 12; ++input)
+    {
+        s_manager->storeDataArray(&input);
+    }
+
+    TEST_ASSERT_EQUAL(10, s_manager->levelLength(0));
+    TEST_ASSERT_EQUAL(6, s_manager->levelLength(1));
+    TEST_ASSERT_EQUAL(2, s_manager->levelLength(2));
+    TEST_ASSERT_EQUAL(0, s_manager->levelLength(3));
+
+    // Level 1 averages pairs of rows: 1.5, 3.5, 5.5...
+    s_manager->getLevelDataArray(1, &actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, actual);
+
+    // Level 2 averages triples of level 1 rows: (1.5 + 3.5 + 5.5) / 3, (7.5 + 9.5 + 11.5) / 3
+    s_manager->getLevelDataArray(2, &actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(3.5f, actual);
+    s_manager->getLevelDataArray(2, &actual, true, true);
+    TEST_ASSERT_EQUAL_FLOAT(CONV_VoltsFromRaw(9.5f, &s_voltageChannelSettings), actual);
+
+    s_manager->getLevelDataArray(3, &actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, actual);
+}
+
+void test_aggregationLevelsCannotBeAddedOnceDataIsStored(void)
+{
+    int32_t input[] = {0};
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    s_manager->storeDataArray(input);
+
+    TEST_ASSERT_EQUAL(-1, s_manager->addAggregationLevel(2, 10));
+    TEST_ASSERT_EQUAL(1, s_manager->levelCount());
+}
+
+void test_managerStoresFixedPointFieldsExactly(void)
+{
+    DataFieldManager manager(10, 3);
+    NumericDataField * fixed16 = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1);
+    NumericDataField * fixed32 = new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 2);
+
+    fixed16->setStorage(DATAFIELD_STORAGE_FIXED16, 1023);
+    fixed32->setStorage(DATAFIELD_STORAGE_FIXED32, 65535);
+    manager.addField(fixed16);
+    manager.addField(fixed32);
+
+    int32_t inputs[3][2] = {{1023, 65535}, {1022, -65535}, {0, 1}};
+    float actual[2];
+    uint8_t i;
+
+    for (i = 0; i < 3; ++i)
+    {
+        manager.storeDataArray(inputs[i]);
+    }
+
+    manager.getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(2045.0f / 3.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f / 3.0f, actual[1]);
+}
+
+void test_fieldsCannotBeAddedOnceDataIsStored(void)
+{
+    int32_t input[] = {0};
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    s_manager->storeDataArray(input);
+
+    TEST_ASSERT_FALSE(s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) ));
+    TEST_ASSERT_EQUAL(1, s_manager->fieldCount());
+}
+
+void test_managerReportsStatisticsForLastStoredRow(void)
+{
+    DataFieldManager manager(10, 4);
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 2) );
+
+    int32_t inputs[4][2] = {{2, 10}, {4, 10}, {6, 10}, {8, 10}};
+    AVERAGER_STATS stats[2];
+    float actual[2];
+    uint8_t i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        manager.storeDataArray(inputs[i]);
+    }
+
+    manager.getDataArray(actual, false, false);
+    manager.getStatisticsArray(stats);
+
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(actual[0], stats[0].mean);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, stats[0].minimum);
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, stats[0].maximum);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, stats[0].variance);
+    TEST_ASSERT_EQUAL(4, stats[0].n);
+
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, stats[1].minimum);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, stats[1].maximum);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, stats[1].variance);
+}
+
+void test_managerStoresStatisticsWithEachRowWhenEnabled(void)
+{
+    DataFieldManager manager(10, 2);
+    manager.addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    TEST_ASSERT_TRUE(manager.setRowStatistics(true));
+
+    int32_t inputs[4][1] = {{2}, {4}, {10}, {30}};
+    AVERAGER_STATS stats[2];
+    float actual[2];
+    uint8_t i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        manager.storeDataArray(inputs[i]);
+    }
+
+    TEST_ASSERT_FALSE(manager.setRowStatistics(false));
+
+    TEST_ASSERT_EQUAL(2, manager.drainRows(actual, 2, false, NULL, stats));
+
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, stats[0].mean);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, stats[0].minimum);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, stats[0].maximum);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, stats[0].variance);
+    TEST_ASSERT_EQUAL(2, stats[0].n);
+
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, actual[1]);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, stats[1].minimum);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, stats[1].maximum);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, stats[1].variance);
+    TEST_ASSERT_EQUAL(2, stats[1].n);
+
+    // Rows without statistics report n = 0
+    s_manager->addField( new NumericDataField(VOLTAGE, &s_voltageChannelSettings, 1) );
+    s_manager->storeDataArray(inputs[0]);
+    s_manager->getDataArray(actual, false, true, NULL, stats);
+    TEST_ASSERT_EQUAL(0, stats[0].n);
+}
+
+void test_managerAllocatesChannelsAndFieldsFromArena(void)
+{
+    static uint64_t memory[128];
+    Arena arena;
+    arena.setBuffer(memory, sizeof(memory));
+
+    Settings_InitDataChannels();
+    Settings_SetDataChannelArena(&arena);
+    parseCurrentChannel("CH1");
+    parseCurrentChannel("CH2");
+    Settings_SetDataChannelArena(NULL);
+
+    uint32_t settingsBytes = arena.used();
+    TEST_ASSERT_EQUAL(2 * Arena::alignedSize(sizeof(CURRENTCHANNEL)), settingsBytes);
+
+    TEST_ASSERT_TRUE(s_manager->setArena(&arena));
+    uint32_t fieldBytes = s_manager->arenaBytesRequired();
+
+    TEST_ASSERT_TRUE(s_manager->setupAllValidChannels());
+    TEST_ASSERT_EQUAL(2, s_manager->fieldCount());
+    TEST_ASSERT_TRUE(arena.owns(s_manager->getField(0)));
+    TEST_ASSERT_TRUE(arena.owns(s_manager->getField(1)));
+    TEST_ASSERT_EQUAL(settingsBytes + fieldBytes, arena.used());
+    TEST_ASSERT_EQUAL(arena.used(), arena.highWater());
+
+    int32_t input[] = {1000, 2000};
+    float actual[2];
+    s_manager->storeDataArray(input);
+    s_manager->getDataArray(actual, true, true);
+    TEST_ASSERT_EQUAL_FLOAT(CONV_AmpsFromRaw(2000.0f, &s_currentChannelSettings), actual[1]);
+}
+
+void test_managerFailsFastWhenChannelsDoNotFitArena(void)
+{
+    static uint64_t memory[4];
+    Arena arena;
+    arena.setBuffer(memory, sizeof(memory));
+
+    Settings_InitDataChannels();
+    parseCurrentChannel("CH1");
+
+    TEST_ASSERT_TRUE(s_manager->setArena(&arena));
+    TEST_ASSERT_TRUE(s_manager->arenaBytesRequired() > arena.size());
+    TEST_ASSERT_FALSE(s_manager->setupAllValidChannels());
+    TEST_ASSERT_EQUAL(0, s_manager->fieldCount());
+    TEST_ASSERT_EQUAL(0, arena.used());
+}
+
+void test_managerAllocatesStorageFromArenaAtSetup(void)
+{
+    static uint64_t memory[256];
+    Arena arena;
+    arena.setBuffer(memory, sizeof(memory));
+
+    Settings_InitDataChannels();
+    parseCurrentChannel("CH1");
+    parseCurrentChannel("CH2");
+
+    TEST_ASSERT_TRUE(s_manager->setArena(&arena));
+    TEST_ASSERT_EQUAL(1, s_manager->addAggregationLevel(2, 5));
+    TEST_ASSERT_TRUE(s_manager->setRowStatistics(true));
+    uint32_t requiredBytes = s_manager->arenaBytesRequired();
+
+    // The store, aggregation level and statistics row are all taken from the arena at setup
+    TEST_ASSERT_TRUE(s_manager->setupAllValidChannels());
+    TEST_ASSERT_EQUAL(requiredBytes, arena.used());
+    TEST_ASSERT_FALSE(s_manager->setRowStatistics(false));
+
+    int32_t input[] = {1000, 2000};
+    float actual[2];
+    s_manager->storeDataArray(input);
+    s_manager->storeDataArray(input);
+    TEST_ASSERT_EQUAL(2, s_manager->count());
+    TEST_ASSERT_EQUAL(1, s_manager->levelLength(1));
+    s_manager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(2000.0f, actual[1]);
+    TEST_ASSERT_EQUAL(requiredBytes, arena.used());
+}
+
+void test_managerFailsFastWhenStorageDoesNotFitArena(void)
+{
+    static uint64_t memory[64];
+    Arena arena;
+    arena.setBuffer(memory, sizeof(memory));
+
+    Settings_InitDataChannels();
+    parseCurrentChannel("CH1");
+
+    TEST_ASSERT_TRUE(s_manager->setArena(&arena));
+    uint32_t fieldBytes = s_manager->arenaBytesRequired();
+    TEST_ASSERT_TRUE(fieldBytes <= arena.size());
+
+    // The field fits, but not with a much larger aggregation level
+    TEST_ASSERT_EQUAL(1, s_manager->addAggregationLevel(2, 1000));
+    TEST_ASSERT_TRUE(s_manager->arenaBytesRequired() > arena.size());
+    TEST_ASSERT_FALSE(s_manager->setupAllValidChannels());
+    TEST_ASSERT_EQUAL(0, s_manager->fieldCount());
+    TEST_ASSERT_EQUAL(0, arena.used());
+}
+
+void test_managerCalculatesProductsAndSumsWhenRowsAreRead(void)
+{
+    DERIVEDCHANNEL inputs = {{1, 2}, 2};
+
+    s_manager->addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    s_manager->addField( new NumericDataField(CURRENT, NULL, 2) );
+    s_manager->addField( new DerivedDataField(DERIVED_PRODUCT, &inputs, 3) );
+    s_manager->addField( new DerivedDataField(DERIVED_SUM, &inputs, 4) );
+
+    int32_t input[2];
+    float actual[12];
+    int32_t i;
+
+    for (i = 1; i <= 4; ++i)
+    {
+        input[0] = i;
+        input[1] = i * 10;
+        s_manager->storeDataArray(input);
+    }
+
+    // Products and sums have no raw value
+    s_manager->getDataArray(actual, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, actual[1]);
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, actual[2]);
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, actual[3]);
+
+    TEST_ASSERT_EQUAL(3, s_manager->drainRows(actual, 3, true));
+    for (i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT_EQUAL_FLOAT((float)(i + 2), actual[i * 4]);
+        TEST_ASSERT_EQUAL_FLOAT((float)((i + 2) * 10), actual[(i * 4) + 1]);
+        TEST_ASSERT_EQUAL_FLOAT((float)((i + 2) * (i + 2) * 10), actual[(i * 4) + 2]);
+        TEST_ASSERT_EQUAL_FLOAT((float)((i + 2) * 11), actual[(i * 4) + 3]);
+    }
+}
+
+void test_managerIntegratesDerivedChannelsAsRowsAreStored(void)
+{
+    DERIVEDCHANNEL power = {{1, 2}, 2};
+    DERIVEDCHANNEL energy = {{3}, 1};
+
+    DataFieldManager manager(10, 1);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    manager.addField( new NumericDataField(CURRENT, NULL, 2) );
+    manager.addField( new DerivedDataField(DERIVED_PRODUCT, &power, 3) );
+    manager.addField( new DerivedDataField(DERIVED_INTEGRAL, &energy, 4) );
+    TEST_ASSERT_EQUAL(1, manager.addAggregationLevel(2, 4));
+
+    // 20W for half an hour between each row
+    int32_t input[] = {10, 2};
+    float actual[4];
+    int32_t i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        manager.storeDataArray(input, 1000 + (i * 1800));
+    }
+
+    for (i = 0; i < 4; ++i)
+    {
+        manager.getDataArray(actual, true, true);
+        TEST_ASSERT_EQUAL_FLOAT(20.0f, actual[2]);
+        TEST_ASSERT_EQUAL_FLOAT(i * 10.0f, actual[3]);
+    }
+
+    // Aggregated rows take the running total at the end of the period
+    manager.getLevelDataArray(1, actual, true, true);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, actual[2]);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, actual[3]);
+    manager.getLevelDataArray(1, actual, true, true);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, actual[3]);
+}
+
+void test_managerOnlyStoresValuesOutsideTheirDeadband(void)
+{
+    DataFieldManager manager(10, 1);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 2) );
+    TEST_ASSERT_EQUAL(1, manager.addAggregationLevel(4, 1));
+
+    TEST_ASSERT_TRUE(manager.setDeadband(1, 2.0f));
+    TEST_ASSERT_TRUE(manager.setDeadband(2, 2.0f));
+    TEST_ASSERT_FALSE(manager.setDeadband(3, 2.0f));
+    TEST_ASSERT_FALSE(manager.setDeadband(1, -1.0f));
+
+    int32_t input[4][2] = {{10, 20}, {11, 20}, {12, 23}, {13, 22}};
+    float expected[3][2] = {
+        {10.0f, 20.0f},
+        {DATAFIELD_NO_DATA_VALUE, 23.0f}, // 12 is within 2 of 10
+        {13.0f, DATAFIELD_NO_DATA_VALUE} // 22 is within 2 of 23
+    };
+    float actual[2];
+    uint8_t i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        manager.storeDataArray(input[i]);
+    }
+
+    // The second row is entirely within the deadbands
+    TEST_ASSERT_EQUAL(3, manager.count());
+    TEST_ASSERT_EQUAL(1, manager.suppressedCount());
+
+    for (i = 0; i < 3; ++i)
+    {
+        manager.getDataArray(actual, true, true);
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected[i], actual, 2);
+    }
+
+    // Aggregation levels still average every row
+    manager.getLevelDataArray(1, actual, true, true);
+    TEST_ASSERT_EQUAL_FLOAT(11.5f, actual[0]);
+    TEST_ASSERT_EQUAL_FLOAT(21.25f, actual[1]);
+}
+
+void test_managerStoresValuesWithinDeadbandAfterMaxSilence(void)
+{
+    DataFieldManager manager(10, 1);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(manager.setDeadband(1, 5.0f));
+    manager.setMaxSilence(60);
+
+    int32_t input = 10;
+    float actual;
+    UNIX_TIMESTAMP timestamp;
+    uint8_t i;
+
+    for (i = 0; i < 5; ++i)
+    {
+        manager.storeDataArray(&input, 1000 + (i * 30));
+    }
+
+    TEST_ASSERT_EQUAL(3, manager.count());
+    for (i = 0; i < 3; ++i)
+    {
+        manager.getDataArray(&actual, true, true, &timestamp);
+        TEST_ASSERT_EQUAL_FLOAT(10.0f, actual);
+        TEST_ASSERT_TRUE(timestamp == (UNIX_TIMESTAMP)(1000 + (i * 60)));
+    }
+}
+
+void test_managerTakesMaxSilenceFromSettings(void)
+{
+    Settings_InitDataChannels();
+    parseCurrentChannel("CH1");
+    Settings_parseDataChannelSetting("CH1.deadband = 5", 5);
+    Settings_setInt(DATA_MAX_SILENCE_SECS, 60);
+
+    TEST_ASSERT_TRUE(s_manager->setupAllValidChannels());
+    Settings_resetInt(DATA_MAX_SILENCE_SECS);
+
+    int32_t input = 1000;
+    uint8_t i;
+
+    // Every value is within the deadband, so rows are only stored once 60 seconds have passed
+    for (i = 0; i < 5; ++i)
+    {
+        s_manager->storeDataArray(&input, 1000 + (i * 30));
+    }
+
+    TEST_ASSERT_EQUAL(3, s_manager->count());
+    TEST_ASSERT_EQUAL(2, s_manager->suppressedCount());
+}
+
 int main(void)
 {
     UnityBegin("DLDataField.Manager.Test.cpp");
@@ -170,9 +814,31 @@ int main(void)
     RUN_TEST(test_numericDataFieldCanBeAdded);
     RUN_TEST(test_writeHeadersToBufferWritesCorrectFields);
 
-    RUN_TEST(test_hasDataRemainingReturnsTrueWhenAtLeastOneFieldHasData);
+    RUN_TEST(test_hasDataReturnsTrueWhenAtLeastOneRowIsStored);
     RUN_TEST(test_managerReturnsCorrectArrayOfChannelNumbers);
+    RUN_TEST(test_managerLooksUpFieldsByChannel);
     RUN_TEST(test_managerDataArrayCanBeAdded);
+    RUN_TEST(test_managerRowsAreReturnedOldestFirstAndCounted);
+    RUN_TEST(test_managerDrainsRowsInBulk);
+    RUN_TEST(test_managerStampsRowsWhenTheAveragerCompletes);
+    RUN_TEST(test_managerOverwritesOldestRowWhenFull);
+    RUN_TEST(test_managerConvertsDataArrayWithFieldConversion);
+    RUN_TEST(test_managerConvertRowMatchesFieldConversions);
+    RUN_TEST(test_fieldsCannotBeAddedOnceDataIsStored);
+    RUN_TEST(test_managerStoresFixedPointFieldsExactly);
+    RUN_TEST(test_managerFeedsRowsThroughAggregationLevels);
+    RUN_TEST(test_aggregationLevelsCannotBeAddedOnceDataIsStored);
+    RUN_TEST(test_managerReportsStatisticsForLastStoredRow);
+    RUN_TEST(test_managerStoresStatisticsWithEachRowWhenEnabled);
+    RUN_TEST(test_managerAllocatesChannelsAndFieldsFromArena);
+    RUN_TEST(test_managerFailsFastWhenChannelsDoNotFitArena);
+    RUN_TEST(test_managerAllocatesStorageFromArenaAtSetup);
+    RUN_TEST(test_managerFailsFastWhenStorageDoesNotFitArena);
+    RUN_TEST(test_managerCalculatesProductsAndSumsWhenRowsAreRead);
+    RUN_TEST(test_managerIntegratesDerivedChannelsAsRowsAreStored);
+    RUN_TEST(test_managerOnlyStoresValuesOutsideTheirDeadband);
+    RUN_TEST(test_managerStoresValuesWithinDeadbandAfterMaxSilence);
+    RUN_TEST(test_managerTakesMaxSilenceFromSettings);
 
     UnityEnd();
     return 0;
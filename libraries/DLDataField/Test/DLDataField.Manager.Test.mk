@@ -1,15 +1,18 @@
-SRC_FILES += DLDataField/DLDataField.cpp DLDataField/DLDataField.String.cpp
-SRC_FILES += DLDataField/DLDataField.Numeric.cpp DLDataField/DLDataField.Conversion.cpp
+SRC_FILES += DLDataField/DLDataField.cpp DLDataField/DLDataField.String.cpp DLDataField/DLDataField.Derived.cpp
+SRC_FILES += DLDataField/DLDataField.Numeric.cpp DLDataField/DLDataField.Conversion.cpp DLDataField/DLDataField.Template.cpp
+SRC_FILES += DLDataField/DLDataField.Store.cpp DLDataField/DLDataField.Aggregator.cpp DLDataField/DLDataField.Spill.cpp DLDataField/DLDataField.Snapshot.cpp
 SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.Strings.cpp
-SRC_FILES += DLUtility/DLUtility.Averager.cpp
+SRC_FILES += DLUtility/DLUtility.Averager.cpp DLUtility/DLUtility.LookupTable.cpp DLUtility/DLUtility.Arena.cpp DLUtility/DLUtility.CRC.cpp
 
 SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
+SRC_FILES += DLUtility/DLUtility.PD.cpp
 
 SRC_FILES += DLSettings/DLSettings.DataChannels.cpp DLSettings/DLSettings.DataChannels.Helper.cpp
+SRC_FILES += DLSettings/DLSettings.Reader.Errors.cpp DLSettings/DLSettings.Global.cpp
 
 SRC_FILES += DLPlatform/DLPlatform.cpp
 
-INC_DIRS += -IDLUtility -IDLSettings -IDLSensor -IDLSettings -IDLPlatform
+INC_DIRS += -IDLUtility -IDLSettings -IDLSensor -IDLSettings -IDLPlatform -IDLLocalStorage
 
 local_setup: ;
 
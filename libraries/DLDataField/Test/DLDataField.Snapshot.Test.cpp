@@ -0,0 +1,404 @@
+/*
+ * DLDataField.Snapshot.Test.cpp
+ *
+ * Tests snapshots of field data, and saving/restoring a DataFieldManager
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Spill.h"
+#include "DLDataField.Snapshot.h"
+#include "DLDataField.Manager.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+#define xstr(s) str(s)
+#define str(s) #s
+#define QUOTED_DL_PATH xstr(DL_PATH)
+
+#define SNAPSHOT_DIRECTORY QUOTED_DL_PATH "/DLDataField/Test/Snapshot"
+#define SNAPSHOT_FILE SNAPSHOT_DIRECTORY "/STATE.SNP"
+#define SNAPSHOT_FILE_B SNAPSHOT_DIRECTORY "/STATEB.SNP"
+#define SPILL_DIRECTORY SNAPSHOT_DIRECTORY "/SPL"
+
+static LocalStorageInterface * s_storage;
+
+void setUp(void)
+{
+    if (!s_storage) { s_storage = LocalStorage_GetLocalStorageInterface(LOCAL_STORAGE_TYPE(0)); }
+    if (!s_storage->directoryExists(SNAPSHOT_DIRECTORY)) { s_storage->mkDir(SNAPSHOT_DIRECTORY); }
+    s_storage->removeFile(SNAPSHOT_FILE);
+    s_storage->removeFile(SNAPSHOT_FILE_B);
+}
+
+void tearDown(void) {}
+
+static std::string readSnapshotFile(char const * filename)
+{
+    std::ifstream file(filename);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static std::string readSnapshotFile(void)
+{
+    return readSnapshotFile(SNAPSHOT_FILE);
+}
+
+static void writeSnapshotFile(char const * filename, std::string const & contents)
+{
+    std::ofstream file(filename, std::ios::trunc);
+    file << contents;
+}
+
+static void writeSnapshotFile(std::string const & contents)
+{
+    writeSnapshotFile(SNAPSHOT_FILE, contents);
+}
+
+static DataFieldManager * createManager(uint32_t dataSize, uint32_t averagerSize)
+{
+    DataFieldManager * manager = new DataFieldManager(dataSize, averagerSize);
+    manager->addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    manager->addField( new NumericDataField(VOLTAGE, NULL, 2) );
+    return manager;
+}
+
+static void storeSamples(DataFieldManager * manager, int32_t first, int32_t count)
+{
+    int32_t sample;
+    int32_t data[2];
+
+    for (sample = first; sample < first + count; ++sample)
+    {
+        data[0] = sample;
+        data[1] = -sample * 2;
+        manager->storeDataArray(data, 1000000 + (sample * 10));
+    }
+}
+
+static void test_SnapshotBytesAreReadBackExactly(void)
+{
+    uint32_t values[40];
+    uint32_t readValues[40];
+    uint8_t i;
+
+    for (i = 0; i < 40; ++i) { values[i] = 0x01010101UL * i; }
+
+    DataFieldSnapshotWriter writer(s_storage);
+    TEST_ASSERT_TRUE(writer.open(SNAPSHOT_FILE));
+    writer.write(values, sizeof(values));
+    TEST_ASSERT_TRUE(writer.close());
+
+    DataFieldSnapshotReader reader(s_storage);
+    TEST_ASSERT_TRUE(reader.open(SNAPSHOT_FILE));
+    TEST_ASSERT_TRUE(reader.read(readValues, sizeof(readValues)));
+    TEST_ASSERT_TRUE(reader.close());
+
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(values, readValues, 40);
+}
+
+static void test_SnapshotIsInvalidIfNotAllRead(void)
+{
+    uint32_t value = 1234;
+
+    DataFieldSnapshotWriter writer(s_storage);
+    TEST_ASSERT_TRUE(writer.open(SNAPSHOT_FILE));
+    writer.write(&value, sizeof(value));
+    writer.write(&value, sizeof(value));
+    TEST_ASSERT_TRUE(writer.close());
+
+    DataFieldSnapshotReader reader(s_storage);
+    TEST_ASSERT_TRUE(reader.open(SNAPSHOT_FILE));
+    TEST_ASSERT_TRUE(reader.read(&value, sizeof(value)));
+    TEST_ASSERT_FALSE(reader.close());
+}
+
+static void test_CorruptSnapshotFailsChecksum(void)
+{
+    uint32_t values[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    DataFieldSnapshotWriter writer(s_storage);
+    TEST_ASSERT_TRUE(writer.open(SNAPSHOT_FILE));
+    writer.write(values, sizeof(values));
+    TEST_ASSERT_TRUE(writer.close());
+
+    // Flip a digit in the middle of the values
+    std::string contents = readSnapshotFile();
+    contents[20] = (contents[20] == '0') ? '1' : '0';
+    writeSnapshotFile(contents);
+
+    DataFieldSnapshotReader reader(s_storage);
+    TEST_ASSERT_TRUE(reader.open(SNAPSHOT_FILE));
+    TEST_ASSERT_TRUE(reader.read(values, sizeof(values)));
+    TEST_ASSERT_FALSE(reader.close());
+}
+
+static void test_SnapshotWithWrongVersionIsRejectedOnOpen(void)
+{
+    DataFieldSnapshotWriter writer(s_storage);
+    TEST_ASSERT_TRUE(writer.open(SNAPSHOT_FILE));
+    TEST_ASSERT_TRUE(writer.close());
+
+    // The version follows the 4-byte magic number
+    std::string contents = readSnapshotFile();
+    contents[8] = 'F';
+    writeSnapshotFile(contents);
+
+    DataFieldSnapshotReader reader(s_storage);
+    TEST_ASSERT_FALSE(reader.open(SNAPSHOT_FILE));
+
+    s_storage->removeFile(SNAPSHOT_FILE);
+    TEST_ASSERT_FALSE(reader.open(SNAPSHOT_FILE));
+}
+
+static void test_ManagerRowsAndAveragesSurviveARestart(void)
+{
+    uint8_t i;
+    float row[2];
+    float expected[2];
+    UNIX_TIMESTAMP timestamp;
+
+    DataFieldManager * before = createManager(8, 4);
+    before->addAggregationLevel(2, 4);
+
+    // 5 complete rows, and 3 samples towards the next
+    storeSamples(before, 0, 23);
+    TEST_ASSERT_EQUAL(5, before->count());
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    DataFieldManager * after = createManager(8, 4);
+    after->addAggregationLevel(2, 4);
+    TEST_ASSERT_TRUE(after->readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    TEST_ASSERT_EQUAL(5, after->count());
+    TEST_ASSERT_EQUAL(2, after->levelLength(1));
+
+    // The sample that completes the next row averages with the samples from before the restart
+    storeSamples(before, 23, 1);
+    storeSamples(after, 23, 1);
+
+    for (i = 0; i < 6; ++i)
+    {
+        before->getDataArray(expected, false, true);
+        after->getDataArray(row, false, true, &timestamp);
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected, row, 2);
+        TEST_ASSERT_TRUE(timestamp == (UNIX_TIMESTAMP)(1000000 + (((i * 4) + 3) * 10)));
+    }
+
+    before->getLevelDataArray(1, expected, false, true);
+    after->getLevelDataArray(1, row, false, true);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected, row, 2);
+
+    delete before;
+    delete after;
+}
+
+static void test_SnapshotFromDifferentConfigurationIsRejected(void)
+{
+    DataFieldManager * before = createManager(8, 4);
+    storeSamples(before, 0, 8);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    DataFieldManager * after = createManager(8, 2);
+    storeSamples(after, 0, 4);
+
+    TEST_ASSERT_FALSE(after->readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    TEST_ASSERT_EQUAL(2, after->count());
+
+    delete before;
+    delete after;
+}
+
+static void test_TruncatedSnapshotLeavesManagerEmpty(void)
+{
+    DataFieldManager * before = createManager(8, 1);
+    storeSamples(before, 0, 6);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    std::string contents = readSnapshotFile();
+    writeSnapshotFile(contents.substr(0, contents.length() - 20));
+
+    DataFieldManager * after = createManager(8, 1);
+    TEST_ASSERT_FALSE(after->readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    TEST_ASSERT_FALSE(after->hasData());
+
+    delete before;
+    delete after;
+}
+
+static void test_SpilledRowsAreReadBackAfterARestart(void)
+{
+    int32_t input;
+    float output;
+
+    DataFieldManager before(4, 1);
+    before.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(before.setSpillStorage(s_storage, SPILL_DIRECTORY, 2));
+
+    for (input = 0; input < 10; ++input) { before.storeDataArray(&input); }
+    TEST_ASSERT_TRUE(before.spilledCount() > 0);
+    TEST_ASSERT_TRUE(before.writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    DataFieldManager after(4, 1);
+    after.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(after.setSpillStorage(s_storage, SPILL_DIRECTORY, 2));
+    TEST_ASSERT_TRUE(after.readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    TEST_ASSERT_EQUAL(10, after.count());
+    for (input = 0; input < 10; ++input)
+    {
+        after.getDataArray(&output, false, true);
+        TEST_ASSERT_EQUAL_FLOAT((float)input, output);
+    }
+}
+
+static void test_SnapshotsAlternateBetweenSlots(void)
+{
+    DataFieldSnapshotReader reader(s_storage);
+    DataFieldManager * before = createManager(8, 1);
+
+    storeSamples(before, 0, 2);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    storeSamples(before, 2, 2);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    TEST_ASSERT_TRUE(reader.open(SNAPSHOT_FILE));
+    TEST_ASSERT_EQUAL(1, reader.sequence());
+    reader.close();
+    TEST_ASSERT_TRUE(reader.open(SNAPSHOT_FILE_B));
+    TEST_ASSERT_EQUAL(2, reader.sequence());
+    reader.close();
+
+    // A new manager (after a restart) carries on the sequence, overwriting the older slot
+    DataFieldManager * after = createManager(8, 1);
+    storeSamples(after, 0, 1);
+    TEST_ASSERT_TRUE(after->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    TEST_ASSERT_TRUE(reader.open(SNAPSHOT_FILE));
+    TEST_ASSERT_EQUAL(3, reader.sequence());
+    reader.close();
+
+    delete before;
+    delete after;
+}
+
+static void test_OlderSnapshotIsRestoredIfNewestIsCorrupt(void)
+{
+    DataFieldManager * before = createManager(8, 1);
+    storeSamples(before, 0, 3);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    storeSamples(before, 3, 2);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    // The newest snapshot (in slot B) was cut short
+    std::string contents = readSnapshotFile(SNAPSHOT_FILE_B);
+    writeSnapshotFile(SNAPSHOT_FILE_B, contents.substr(0, contents.length() - 20));
+
+    DataFieldManager * after = createManager(8, 1);
+    TEST_ASSERT_TRUE(after->readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    TEST_ASSERT_EQUAL(3, after->count());
+
+    delete before;
+    delete after;
+}
+
+static void test_SnapshotIsOnlyRestoredOnce(void)
+{
+    DataFieldManager * before = createManager(8, 1);
+    storeSamples(before, 0, 3);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    storeSamples(before, 3, 2);
+    TEST_ASSERT_TRUE(before->writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    DataFieldManager * after = createManager(8, 1);
+    TEST_ASSERT_TRUE(after->readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    TEST_ASSERT_EQUAL(5, after->count());
+    TEST_ASSERT_FALSE(s_storage->fileExists(SNAPSHOT_FILE));
+    TEST_ASSERT_FALSE(s_storage->fileExists(SNAPSHOT_FILE_B));
+
+    // Another restart before the next snapshot does not restore the same rows again
+    DataFieldManager * again = createManager(8, 1);
+    TEST_ASSERT_FALSE(again->readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+    TEST_ASSERT_FALSE(again->hasData());
+
+    delete before;
+    delete after;
+    delete again;
+}
+
+static void test_BlocksSpilledAfterTheSnapshotAreKept(void)
+{
+    int32_t input;
+    float output;
+    bool readLastSpilledRow = false;
+
+    DataFieldManager before(4, 1);
+    before.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(before.setSpillStorage(s_storage, SPILL_DIRECTORY, 2));
+
+    for (input = 0; input < 6; ++input) { before.storeDataArray(&input); }
+    TEST_ASSERT_TRUE(before.writeSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    // Rows 6 to 13 push rows 2 to 9 out to new blocks, which the snapshot knows nothing about
+    for (input = 6; input < 14; ++input) { before.storeDataArray(&input); }
+
+    DataFieldManager after(4, 1);
+    after.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    TEST_ASSERT_TRUE(after.setSpillStorage(s_storage, SPILL_DIRECTORY, 2));
+    TEST_ASSERT_TRUE(after.readSnapshot(s_storage, SNAPSHOT_FILE, SNAPSHOT_FILE_B));
+
+    while (after.hasData())
+    {
+        after.getDataArray(&output, false, true);
+        readLastSpilledRow |= (output == 7.0f);
+    }
+    TEST_ASSERT_TRUE(readLastSpilledRow);
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Snapshot.Test.cpp");
+
+    RUN_TEST(test_SnapshotBytesAreReadBackExactly);
+    RUN_TEST(test_SnapshotIsInvalidIfNotAllRead);
+    RUN_TEST(test_CorruptSnapshotFailsChecksum);
+    RUN_TEST(test_SnapshotWithWrongVersionIsRejectedOnOpen);
+    RUN_TEST(test_ManagerRowsAndAveragesSurviveARestart);
+    RUN_TEST(test_SnapshotFromDifferentConfigurationIsRejected);
+    RUN_TEST(test_TruncatedSnapshotLeavesManagerEmpty);
+    RUN_TEST(test_SpilledRowsAreReadBackAfterARestart);
+    RUN_TEST(test_SnapshotsAlternateBetweenSlots);
+    RUN_TEST(test_OlderSnapshotIsRestoredIfNewestIsCorrupt);
+    RUN_TEST(test_SnapshotIsOnlyRestoredOnce);
+    RUN_TEST(test_BlocksSpilledAfterTheSnapshotAreKept);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,414 @@
+/*
+ * DLDataField.Spill.Test.cpp
+ *
+ * Tests the DataFieldSpill class and spilling from a DataFieldManager
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <iostream>
+#include <new>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Arena.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
+#include "DLLocalStorage.h"
+#include "DLDataField.Spill.h"
+#include "DLDataField.Manager.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+#define xstr(s) str(s)
+#define str(s) #s
+#define QUOTED_DL_PATH xstr(DL_PATH)
+
+#define SPILL_DIRECTORY QUOTED_DL_PATH "/DLDataField/Test/Spill"
+
+static LocalStorageInterface * s_storage;
+static DataFieldSpill * s_spill;
+static DataFieldStore * s_store;
+
+// Tests share the spill directory, so blocks left by one test would be read back by the next
+static void removeSpillFiles(void)
+{
+    char filename[64];
+    uint32_t block;
+
+    for (block = 0; block < 64; ++block)
+    {
+        sprintf(filename, SPILL_DIRECTORY "/%08lu.SPL", (unsigned long)block);
+        s_storage->removeFile(filename);
+    }
+    s_storage->removeFile(SPILL_DIRECTORY "/INDEX.SPL");
+}
+
+void setUp(void)
+{
+    if (!s_storage) { s_storage = LocalStorage_GetLocalStorageInterface(LOCAL_STORAGE_TYPE(0)); }
+    removeSpillFiles();
+    s_spill = new DataFieldSpill();
+    s_store = new DataFieldStore();
+}
+
+void tearDown(void)
+{
+    delete s_store;
+    delete s_spill;
+}
+
+static void pushRows(uint32_t first, uint32_t count)
+{
+    uint32_t i;
+    float row[2];
+
+    for (i = first; i < first + count; ++i)
+    {
+        row[0] = (float)i;
+        row[1] = -(float)i / 3.0f;
+        s_store->pushRow(row);
+    }
+}
+
+static void test_SpillSetupRequiresValidParameters(void)
+{
+    TEST_ASSERT_FALSE(s_spill->setup(NULL, SPILL_DIRECTORY, 4, 2));
+    TEST_ASSERT_FALSE(s_spill->setup(s_storage, NULL, 4, 2));
+    TEST_ASSERT_FALSE(s_spill->setup(s_storage, SPILL_DIRECTORY, 0, 2));
+    TEST_ASSERT_FALSE(s_spill->isEnabled());
+
+    TEST_ASSERT_TRUE(s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2));
+    TEST_ASSERT_TRUE(s_spill->isEnabled());
+    TEST_ASSERT_TRUE(s_storage->directoryExists(SPILL_DIRECTORY));
+}
+
+static void test_SpillOnlyWritesFullBlocks(void)
+{
+    s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2);
+    s_store->setSize(8, 2);
+
+    pushRows(0, 3);
+    TEST_ASSERT_FALSE(s_spill->spillRows(s_store));
+    TEST_ASSERT_EQUAL(3, s_store->length());
+
+    pushRows(3, 3);
+    TEST_ASSERT_TRUE(s_spill->spillRows(s_store));
+    TEST_ASSERT_EQUAL(2, s_store->length());
+    TEST_ASSERT_EQUAL(4, s_spill->length());
+    TEST_ASSERT_EQUAL(1, s_spill->blockCount());
+}
+
+static void test_SpilledRowsAreReadBackExactlyInOrder(void)
+{
+    float row[2];
+    uint32_t i;
+
+    s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2);
+    s_store->setSize(8, 2);
+
+    pushRows(0, 8);
+    s_spill->spillRows(s_store);
+    s_spill->spillRows(s_store);
+
+    TEST_ASSERT_EQUAL(8, s_spill->length());
+    TEST_ASSERT_EQUAL(2, s_spill->blockCount());
+
+    for (i = 0; i < 8; ++i)
+    {
+        TEST_ASSERT_TRUE(s_spill->readRow(row, true));
+        TEST_ASSERT_EQUAL_FLOAT((float)i, row[0]);
+        TEST_ASSERT_EQUAL_FLOAT(-(float)i / 3.0f, row[1]);
+    }
+
+    TEST_ASSERT_FALSE(s_spill->hasData());
+    TEST_ASSERT_FALSE(s_spill->readRow(row, true));
+}
+
+static void test_BlockFilesAreRemovedOnceRead(void)
+{
+    float row[2];
+
+    s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2);
+    s_store->setSize(4, 2);
+
+    pushRows(0, 4);
+    s_spill->spillRows(s_store);
+    TEST_ASSERT_TRUE(s_storage->fileExists(SPILL_DIRECTORY "/00000000.SPL"));
+
+    s_spill->readRow(row, false);
+    TEST_ASSERT_FALSE(s_storage->fileExists(SPILL_DIRECTORY "/00000000.SPL"));
+    TEST_ASSERT_EQUAL(4, s_spill->length());
+}
+
+static void test_SpilledBlocksAreReadBackAfterARestart(void)
+{
+    float row[2];
+    uint32_t i;
+
+    s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2);
+    s_store->setSize(12, 2);
+
+    pushRows(0, 12);
+    s_spill->spillRows(s_store);
+    s_spill->spillRows(s_store);
+    s_spill->spillRows(s_store);
+
+    // Read the first block, then restart
+    for (i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_TRUE(s_spill->readRow(row, true));
+    }
+
+    delete s_spill;
+    s_spill = new DataFieldSpill();
+    TEST_ASSERT_TRUE(s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2));
+
+    TEST_ASSERT_EQUAL(8, s_spill->length());
+    TEST_ASSERT_EQUAL(2, s_spill->blockCount());
+
+    // A block spilled after the restart goes after the blocks already in storage
+    pushRows(12, 4);
+    TEST_ASSERT_TRUE(s_spill->spillRows(s_store));
+
+    for (i = 4; i < 16; ++i)
+    {
+        TEST_ASSERT_TRUE(s_spill->readRow(row, true));
+        TEST_ASSERT_EQUAL_FLOAT((float)i, row[0]);
+    }
+
+    TEST_ASSERT_FALSE(s_spill->hasData());
+    TEST_ASSERT_FALSE(s_storage->fileExists(SPILL_DIRECTORY "/INDEX.SPL"));
+}
+
+static void test_MissingBlockIsSkipped(void)
+{
+    float row[2];
+    uint32_t i;
+
+    s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2);
+    s_store->setSize(12, 2);
+
+    pushRows(0, 12);
+    s_spill->spillRows(s_store);
+    s_spill->spillRows(s_store);
+    s_spill->spillRows(s_store);
+
+    s_storage->removeFile(SPILL_DIRECTORY "/00000001.SPL");
+
+    for (i = 0; i < 4; ++i)
+    {
+        TEST_ASSERT_TRUE(s_spill->readRow(row, true));
+        TEST_ASSERT_EQUAL_FLOAT((float)i, row[0]);
+    }
+
+    for (i = 8; i < 12; ++i)
+    {
+        TEST_ASSERT_TRUE(s_spill->readRow(row, true));
+        TEST_ASSERT_EQUAL_FLOAT((float)i, row[0]);
+    }
+
+    TEST_ASSERT_EQUAL(0, s_spill->length());
+    TEST_ASSERT_FALSE(s_spill->readRow(row, true));
+}
+
+static void test_CorruptBlockIsSkipped(void)
+{
+    float row[2];
+    uint32_t i;
+
+    s_spill->setup(s_storage, SPILL_DIRECTORY, 4, 2);
+    s_store->setSize(8, 2);
+
+    pushRows(0, 8);
+    s_spill->spillRows(s_store);
+    s_spill->spillRows(s_store);
+
+    s_storage->removeFile(SPILL_DIRECTORY "/00000000.SPL");
+    FILE_HANDLE file = s_storage->openFile(SPILL_DIRECTORY "/00000000.SPL", true);
+    s_storage->write(file, "not a spilled row\r\n");
+    s_storage->closeFile(file);
+
+    for (i = 4; i < 8; ++i)
+    {
+        TEST_ASSERT_TRUE(s_spill->readRow(row, true));
+        TEST_ASSERT_EQUAL_FLOAT((float)i, row[0]);
+    }
+
+    TEST_ASSERT_EQUAL(0, s_spill->length());
+    TEST_ASSERT_FALSE(s_storage->fileExists(SPILL_DIRECTORY "/00000000.SPL"));
+}
+
+static void test_ManagerKeepsAllDataThroughA48HourOutageAt1Hz(void)
+{
+    // One row per second for 48 hours, with only 512 rows in RAM
+    const uint32_t samples = 48UL * 60UL * 60UL;
+    int32_t input[2];
+    float output[2];
+    uint32_t i;
+    bool allCorrect = true;
+
+    DataFieldManager manager(512, 1);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+    manager.addField( new NumericDataField(CURRENT, NULL, 2) );
+
+    TEST_ASSERT_TRUE(manager.setSpillStorage(s_storage, SPILL_DIRECTORY, 256));
+
+    for (i = 0; i < samples; ++i)
+    {
+        input[0] = i;
+        input[1] = -(int32_t)i;
+        manager.storeDataArray(input);
+    }
+
+    TEST_ASSERT_EQUAL(samples, manager.count());
+    TEST_ASSERT_TRUE(manager.spilledCount() >= (samples - 512));
+
+    for (i = 0; i < samples; ++i)
+    {
+        manager.getDataArray(output, false, true);
+        allCorrect &= (output[0] == (float)i) && (output[1] == -(float)i);
+    }
+
+    TEST_ASSERT_TRUE(allCorrect);
+    TEST_ASSERT_EQUAL(0, manager.count());
+    TEST_ASSERT_EQUAL(0, manager.spilledCount());
+    TEST_ASSERT_FALSE(s_storage->fileExists(SPILL_DIRECTORY "/00000000.SPL"));
+}
+
+static void test_ManagerDrainsSpilledRowsBeforeRowsInRAM(void)
+{
+    int32_t input;
+    float output[16];
+    uint32_t i;
+
+    DataFieldManager manager(8, 1);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+
+    TEST_ASSERT_TRUE(manager.setSpillStorage(s_storage, SPILL_DIRECTORY, 4));
+
+    for (input = 0; input < 14; ++input)
+    {
+        manager.storeDataArray(&input);
+    }
+
+    TEST_ASSERT_TRUE(manager.spilledCount() > 0);
+
+    TEST_ASSERT_EQUAL(14, manager.drainRows(output, 16, false));
+    for (i = 0; i < 14; ++i)
+    {
+        TEST_ASSERT_EQUAL_FLOAT((float)i, output[i]);
+    }
+
+    TEST_ASSERT_EQUAL(0, manager.count());
+}
+
+static void test_SpilledRowsKeepTheirTimestamps(void)
+{
+    int32_t input;
+    float output;
+    UNIX_TIMESTAMP timestamp;
+    UNIX_TIMESTAMP expected;
+
+    DataFieldManager manager(4, 1);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+
+    TEST_ASSERT_TRUE(manager.setSpillStorage(s_storage, SPILL_DIRECTORY, 2));
+
+    for (input = 0; input < 10; ++input)
+    {
+        manager.storeDataArray(&input, 5000000000ULL + (input * 600));
+    }
+
+    TEST_ASSERT_TRUE(manager.spilledCount() > 0);
+
+    for (input = 0; input < 10; ++input)
+    {
+        manager.getDataArray(&output, false, true, &timestamp);
+        expected = 5000000000ULL + (input * 600);
+        TEST_ASSERT_EQUAL_FLOAT((float)input, output);
+        TEST_ASSERT_TRUE(timestamp == expected);
+    }
+}
+
+static void test_ManagerWithoutSpillOverwritesOldestRows(void)
+{
+    int32_t input;
+    float output;
+
+    DataFieldManager manager(4, 1);
+    manager.addField( new NumericDataField(VOLTAGE, NULL, 1) );
+
+    for (input = 0; input < 10; ++input)
+    {
+        manager.storeDataArray(&input);
+    }
+
+    TEST_ASSERT_EQUAL(4, manager.count());
+    manager.getDataArray(&output, false, true);
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, output);
+}
+
+static void test_SpillCanBeAllocatedFromArena(void)
+{
+    static uint64_t memory[256];
+    Arena arena;
+    float row[2];
+
+    arena.setBuffer(memory, sizeof(memory));
+    void * p = arena.allocate(sizeof(DataFieldSpill));
+    DataFieldSpill * spill = new (p) DataFieldSpill();
+
+    TEST_ASSERT_TRUE(spill->setup(s_storage, SPILL_DIRECTORY, 4, 2, &arena));
+    TEST_ASSERT_EQUAL(DataFieldSpill::arenaBytesRequired(4, 2), arena.used());
+
+    s_store->setSize(8, 2);
+    pushRows(0, 4);
+    TEST_ASSERT_TRUE(spill->spillRows(s_store));
+    TEST_ASSERT_TRUE(spill->readRow(row, true));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, row[0]);
+
+    spill->clear();
+    spill->~DataFieldSpill();
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Spill.Test.cpp");
+
+    RUN_TEST(test_SpillSetupRequiresValidParameters);
+    RUN_TEST(test_SpillOnlyWritesFullBlocks);
+    RUN_TEST(test_SpilledRowsAreReadBackExactlyInOrder);
+    RUN_TEST(test_BlockFilesAreRemovedOnceRead);
+    RUN_TEST(test_SpilledBlocksAreReadBackAfterARestart);
+    RUN_TEST(test_MissingBlockIsSkipped);
+    RUN_TEST(test_CorruptBlockIsSkipped);
+    RUN_TEST(test_ManagerKeepsAllDataThroughA48HourOutageAt1Hz);
+    RUN_TEST(test_ManagerDrainsSpilledRowsBeforeRowsInRAM);
+    RUN_TEST(test_SpilledRowsKeepTheirTimestamps);
+    RUN_TEST(test_ManagerWithoutSpillOverwritesOldestRows);
+    RUN_TEST(test_SpillCanBeAllocatedFromArena);
+
+    UnityEnd();
+    return 0;
+}
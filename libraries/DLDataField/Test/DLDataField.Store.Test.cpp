@@ -0,0 +1,389 @@
+/*
+ * DLDataField.Store.Test.cpp
+ *
+ * Tests the DataFieldStore class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Averager.h"
+#include "DLUtility.Arena.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+static DataFieldStore * s_store;
+
+void setUp(void)
+{
+    s_store = new DataFieldStore();
+}
+
+void tearDown(void)
+{
+    delete s_store;
+}
+
+static void fillRow(float * row, float start, uint8_t columns)
+{
+    uint8_t i;
+    for (i = 0; i < columns; ++i)
+    {
+        row[i] = start + i;
+    }
+}
+
+static void test_StoreIsEmptyUntilSized(void)
+{
+    float row[3];
+
+    TEST_ASSERT_FALSE(s_store->isAllocated());
+    TEST_ASSERT_EQUAL(0, s_store->length());
+    TEST_ASSERT_FALSE(s_store->readRow(row, false));
+
+    TEST_ASSERT_FALSE(s_store->setSize(0, 3));
+    TEST_ASSERT_FALSE(s_store->setSize(5, 0));
+
+    TEST_ASSERT_TRUE(s_store->setSize(5, 3));
+    TEST_ASSERT_TRUE(s_store->isAllocated());
+    TEST_ASSERT_EQUAL(5, s_store->capacity());
+    TEST_ASSERT_EQUAL(3, s_store->columns());
+    TEST_ASSERT_FALSE(s_store->hasData());
+}
+
+static void test_RowsAreReadBackInOrder(void)
+{
+    float in[3];
+    float out[3];
+
+    s_store->setSize(5, 3);
+
+    fillRow(in, 1.0f, 3);
+    s_store->pushRow(in);
+    fillRow(in, 10.0f, 3);
+    s_store->pushRow(in);
+
+    TEST_ASSERT_EQUAL(2, s_store->length());
+
+    TEST_ASSERT_TRUE(s_store->readRow(out, false));
+    fillRow(in, 1.0f, 3);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, out, 3);
+    TEST_ASSERT_EQUAL(2, s_store->length());
+
+    TEST_ASSERT_TRUE(s_store->readRow(out, true));
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, out, 3);
+    TEST_ASSERT_EQUAL(1, s_store->length());
+
+    TEST_ASSERT_TRUE(s_store->readRow(out, true));
+    fillRow(in, 10.0f, 3);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, out, 3);
+    TEST_ASSERT_FALSE(s_store->hasData());
+}
+
+static void test_GetValueReturnsColumnFromOldestRow(void)
+{
+    float in[3];
+
+    s_store->setSize(5, 3);
+
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, s_store->getValue(0));
+
+    fillRow(in, 4.0f, 3);
+    s_store->pushRow(in);
+    fillRow(in, 8.0f, 3);
+    s_store->pushRow(in);
+
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, s_store->getValue(0));
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, s_store->getValue(2));
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, s_store->getValue(3));
+}
+
+static void test_StoreOverwritesOldestRowsWhenFull(void)
+{
+    float in[2];
+    float out[2];
+    uint8_t i;
+
+    s_store->setSize(4, 2);
+
+    for (i = 0; i < 7; ++i)
+    {
+        fillRow(in, i * 10.0f, 2);
+        s_store->pushRow(in);
+    }
+
+    TEST_ASSERT_TRUE(s_store->full());
+    TEST_ASSERT_EQUAL(4, s_store->length());
+
+    for (i = 3; i < 7; ++i)
+    {
+        s_store->readRow(out, true);
+        fillRow(in, i * 10.0f, 2);
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, out, 2);
+    }
+
+    TEST_ASSERT_FALSE(s_store->hasData());
+}
+
+static void test_ReadRowsCopiesAcrossTheEndOfTheBuffer(void)
+{
+    float in[2];
+    float out[8];
+    uint8_t i;
+
+    s_store->setSize(4, 2);
+
+    // Rows 3 to 6 are kept, with the oldest two at the end of the buffer
+    for (i = 0; i < 7; ++i)
+    {
+        fillRow(in, i * 10.0f, 2);
+        s_store->pushRow(in);
+    }
+
+    TEST_ASSERT_EQUAL(3, s_store->readRows(out, 3));
+    for (i = 0; i < 3; ++i)
+    {
+        fillRow(in, (i + 3) * 10.0f, 2);
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, &out[i * 2], 2);
+    }
+
+    TEST_ASSERT_EQUAL(1, s_store->readRows(out, 3));
+    fillRow(in, 60.0f, 2);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, out, 2);
+
+    TEST_ASSERT_EQUAL(0, s_store->readRows(out, 3));
+    TEST_ASSERT_FALSE(s_store->hasData());
+}
+
+static void test_ReadRowsConvertsFixedPointColumns(void)
+{
+    DATAFIELD_COLUMN_FORMAT formats[] = {
+        {DATAFIELD_STORAGE_FIXED16, 10.0f},
+        {DATAFIELD_STORAGE_FLOAT, 1.0f}
+    };
+    float in[2] = {1.5f, 2.25f};
+    float out[4];
+
+    s_store->setSize(4, 2, formats);
+    s_store->pushRow(in);
+    s_store->pushRow(in);
+
+    TEST_ASSERT_EQUAL(2, s_store->readRows(out, 4));
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, &out[0], 2);
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(in, &out[2], 2);
+    TEST_ASSERT_EQUAL(0, s_store->length());
+}
+
+static void test_TimestampsAreReturnedWithRows(void)
+{
+    float in[1] = {1.0f};
+    float out[1];
+    UNIX_TIMESTAMP timestamp;
+    UNIX_TIMESTAMP timestamps[3];
+
+    s_store->setSize(4, 1);
+    s_store->pushRow(in, 1500000000ULL);
+    s_store->pushRow(in, 1500000060ULL);
+    s_store->pushRow(in, 1500000120ULL);
+
+    TEST_ASSERT_TRUE(s_store->readRow(out, true, &timestamp));
+    TEST_ASSERT_TRUE(timestamp == 1500000000ULL);
+    TEST_ASSERT_TRUE(s_store->oldestTimestamp() == 1500000060ULL);
+
+    float rows[3];
+    TEST_ASSERT_EQUAL(2, s_store->readRows(rows, 3, timestamps));
+    TEST_ASSERT_TRUE(timestamps[0] == 1500000060ULL);
+    TEST_ASSERT_TRUE(timestamps[1] == 1500000120ULL);
+}
+
+static void test_TimestampsSurviveLargeGapsAndStepsBackwards(void)
+{
+    float in[1] = {1.0f};
+    float out[1];
+    UNIX_TIMESTAMP expected[] = {1000ULL, 1000ULL + 100000ULL, 500ULL, 600ULL, 5000000000ULL};
+    UNIX_TIMESTAMP timestamp;
+    uint8_t i;
+
+    s_store->setSize(3, 1);
+
+    // The store wraps, so rebase points are also dropped with the rows that used them
+    for (i = 0; i < 5; ++i)
+    {
+        s_store->pushRow(in, expected[i]);
+    }
+
+    for (i = 2; i < 5; ++i)
+    {
+        s_store->readRow(out, true, &timestamp);
+        TEST_ASSERT_TRUE(timestamp == expected[i]);
+    }
+}
+
+static void test_TimestampsAreClampedWhenRebasePointsRunOut(void)
+{
+    float in[1] = {1.0f};
+    float out[1];
+    UNIX_TIMESTAMP timestamp;
+    uint8_t i;
+
+    s_store->setSize(DATAFIELD_STORE_MAX_REBASES + 3, 1);
+
+    s_store->pushRow(in, 100000ULL);
+    for (i = 0; i < DATAFIELD_STORE_MAX_REBASES; ++i)
+    {
+        s_store->pushRow(in, 100000ULL - i - 1);
+    }
+
+    // Backwards steps with no rebase points left keep the newest timestamp
+    s_store->pushRow(in, 10ULL);
+
+    for (i = 0; i <= DATAFIELD_STORE_MAX_REBASES; ++i)
+    {
+        s_store->readRow(out, true, &timestamp);
+        TEST_ASSERT_TRUE(timestamp == (100000ULL - i));
+    }
+
+    s_store->readRow(out, true, &timestamp);
+    TEST_ASSERT_TRUE(timestamp == (100000ULL - DATAFIELD_STORE_MAX_REBASES));
+}
+
+static void test_RemoveOldestStopsAtZero(void)
+{
+    float in[1] = {1.0f};
+
+    s_store->setSize(2, 1);
+    s_store->pushRow(in);
+    s_store->removeOldest();
+    s_store->removeOldest();
+
+    TEST_ASSERT_EQUAL(0, s_store->length());
+
+    s_store->pushRow(in);
+    TEST_ASSERT_EQUAL(1, s_store->length());
+}
+
+static void test_FixedPointColumnsUseLessMemory(void)
+{
+    DATAFIELD_COLUMN_FORMAT formats[] = {
+        {DATAFIELD_STORAGE_FIXED16, 10.0f},
+        {DATAFIELD_STORAGE_FIXED32, 10.0f},
+        {DATAFIELD_STORAGE_FLOAT, 1.0f}
+    };
+
+    TEST_ASSERT_TRUE(s_store->setSize(5, 3, formats));
+    TEST_ASSERT_EQUAL(10, s_store->rowSize());
+
+    TEST_ASSERT_TRUE(s_store->setSize(5, 3));
+    TEST_ASSERT_EQUAL(12, s_store->rowSize());
+}
+
+static void test_FixedPointColumnsAreReadBackAsScaledFloats(void)
+{
+    DATAFIELD_COLUMN_FORMAT formats[] = {
+        {DATAFIELD_STORAGE_FIXED16, 4.0f},
+        {DATAFIELD_STORAGE_FIXED32, 30.0f},
+        {DATAFIELD_STORAGE_FLOAT, 1.0f}
+    };
+    float in[] = {-12.25f, 1000.5f / 30.0f, 1.2345f};
+    float out[3];
+
+    s_store->setSize(5, 3, formats);
+    s_store->pushRow(in);
+
+    TEST_ASSERT_TRUE(s_store->readRow(out, false));
+    TEST_ASSERT_EQUAL_FLOAT(-12.25f, out[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1000.0f / 30.0f, out[1]);
+    TEST_ASSERT_EQUAL_FLOAT(1.2345f, out[2]);
+
+    TEST_ASSERT_EQUAL_FLOAT(-12.25f, s_store->getValue(0));
+}
+
+static void test_FixedPointColumnsKeepMissingDataAndClampRange(void)
+{
+    DATAFIELD_COLUMN_FORMAT formats[] = {
+        {DATAFIELD_STORAGE_FIXED16, 1.0f},
+        {DATAFIELD_STORAGE_FIXED16, 1.0f},
+        {DATAFIELD_STORAGE_FIXED32, 1.0f}
+    };
+    float in[] = {DATAFIELD_NO_DATA_VALUE, -40000.0f, 3.0e10f};
+    float out[3];
+
+    s_store->setSize(5, 3, formats);
+    s_store->pushRow(in);
+    s_store->readRow(out, true);
+
+    TEST_ASSERT_EQUAL_FLOAT(DATAFIELD_NO_DATA_VALUE, out[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-32767.0f, out[1]);
+    TEST_ASSERT_EQUAL_FLOAT(2147483647.0f, out[2]);
+}
+
+static void test_StoreCanBeAllocatedFromArena(void)
+{
+    static uint64_t memory[32];
+    Arena arena;
+    arena.setBuffer(memory, sizeof(memory));
+
+    DATAFIELD_COLUMN_FORMAT formats[] = {
+        {DATAFIELD_STORAGE_FIXED16, 10.0f},
+        {DATAFIELD_STORAGE_FLOAT, 1.0f}
+    };
+    float in[] = {1.5f, 2.5f};
+    float out[2];
+
+    TEST_ASSERT_TRUE(s_store->setSize(5, 2, formats, &arena));
+    TEST_ASSERT_EQUAL(DataFieldStore::arenaBytesRequired(5, 2, formats), arena.used());
+
+    s_store->pushRow(in);
+    TEST_ASSERT_TRUE(s_store->readRow(out, true));
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, out[0]);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, out[1]);
+
+    // Too large for what is left: fails without using the heap
+    TEST_ASSERT_FALSE(s_store->setSize(100, 2, NULL, &arena));
+    TEST_ASSERT_FALSE(s_store->isAllocated());
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Store.Test.cpp");
+
+    RUN_TEST(test_StoreIsEmptyUntilSized);
+    RUN_TEST(test_RowsAreReadBackInOrder);
+    RUN_TEST(test_GetValueReturnsColumnFromOldestRow);
+    RUN_TEST(test_StoreOverwritesOldestRowsWhenFull);
+    RUN_TEST(test_ReadRowsCopiesAcrossTheEndOfTheBuffer);
+    RUN_TEST(test_ReadRowsConvertsFixedPointColumns);
+    RUN_TEST(test_TimestampsAreReturnedWithRows);
+    RUN_TEST(test_TimestampsSurviveLargeGapsAndStepsBackwards);
+    RUN_TEST(test_TimestampsAreClampedWhenRebasePointsRunOut);
+    RUN_TEST(test_RemoveOldestStopsAtZero);
+    RUN_TEST(test_FixedPointColumnsUseLessMemory);
+    RUN_TEST(test_FixedPointColumnsAreReadBackAsScaledFloats);
+    RUN_TEST(test_FixedPointColumnsKeepMissingDataAndClampRange);
+    RUN_TEST(test_StoreCanBeAllocatedFromArena);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,9 @@
+SRC_FILES += DLDataField/DLDataField.Snapshot.cpp
+SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.CRC.cpp DLUtility/DLUtility.Strings.cpp
+SRC_FILES += DLUtility/DLUtility.Arena.cpp
+
+INC_DIRS += -IDLUtility -IDLLocalStorage
+
+local_setup: ;
+
+local_teardown: ;
@@ -0,0 +1,155 @@
+/*
+ * DLDataField.Template.Test.cpp
+ *
+ * Tests the DataFieldT class and conversion policies
+ * (see Example/Command Line Example for a throughput benchmark)
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.PD.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.Conversion.h"
+#include "DLDataField.h"
+#include "DLDataField.Template.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+static VOLTAGECHANNEL s_voltageChannelSettings = {
+    .mvPerBit = 0.125f,
+    .offset = 0.1f,
+    .multiplier = 2.0f,
+    .R1 = 200000.0f,
+    .R2 = 10000.0f,
+};
+
+static CURRENTCHANNEL s_currentChannelSettings = {
+    .mvPerBit = 0.125f,
+    .offset = 60.0f,
+    .mvPerAmp = 600.0f,
+};
+
+static THERMISTORCHANNEL s_thermistorChannelSettings = {
+    .R25 = 10000.0f,
+    .B = 3950.0f,
+    .otherR = 10000.0f,
+    .maxADC = 1023.0f,
+    .highside = true
+};
+
+static void test_VoltagePolicyMatchesConversionFunction(void)
+{
+    DataFieldT<VoltageConversion> field(s_voltageChannelSettings, 3);
+    float raw;
+
+    TEST_ASSERT_EQUAL(VOLTAGE, field.getType());
+    TEST_ASSERT_EQUAL(3, field.getChannelNumber());
+
+    for (raw = -1000.0f; raw < 30000.0f; raw += 500.0f)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(CONV_VoltsFromRaw(raw, &s_voltageChannelSettings), field.convertData(raw));
+    }
+}
+
+static void test_CurrentPolicyMatchesConversionFunction(void)
+{
+    DataFieldT<CurrentConversion> field(s_currentChannelSettings, 1);
+    float raw;
+
+    TEST_ASSERT_EQUAL(CURRENT, field.getType());
+
+    for (raw = -1000.0f; raw < 30000.0f; raw += 500.0f)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(CONV_AmpsFromRaw(raw, &s_currentChannelSettings), field.convertData(raw));
+    }
+}
+
+static void test_ThermistorPolicyMatchesConversionFunction(void)
+{
+    DataFieldT<ThermistorConversion> field(s_thermistorChannelSettings, 13);
+    float raw;
+
+    TEST_ASSERT_EQUAL(TEMPERATURE_C, field.getType());
+
+    for (raw = 100.0f; raw < 1000.0f; raw += 50.0f)
+    {
+        TEST_ASSERT_EQUAL_FLOAT(
+            CONV_CelsiusFromRawThermistor(raw, &s_thermistorChannelSettings), field.convertData(raw));
+    }
+}
+
+static void test_ConvertArrayConvertsInPlace(void)
+{
+    DataFieldT<CurrentConversion> field(s_currentChannelSettings, 1);
+    float values[] = {480.0f, 3360.0f};
+
+    field.convertArray(values, values, 2);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, values[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.6f, values[1]);
+}
+
+static void test_NumericDataFieldUsesConversionPolicy(void)
+{
+    NumericDataField numeric(VOLTAGE, &s_voltageChannelSettings, 1);
+    DataFieldT<VoltageConversion> templated(s_voltageChannelSettings, 1);
+
+    TEST_ASSERT_EQUAL_FLOAT(templated.convertData(12345.0f), numeric.convertData(12345.0f));
+}
+
+static void test_NumericDataFieldAffineConversionMatchesPolicy(void)
+{
+    NumericDataField voltage(VOLTAGE, &s_voltageChannelSettings, 1);
+    NumericDataField current(CURRENT, &s_currentChannelSettings, 2);
+    NumericDataField thermistor(TEMPERATURE_C, &s_thermistorChannelSettings, 3);
+    float gain;
+    float offset;
+    float raw;
+
+    TEST_ASSERT_TRUE(voltage.getAffineConversion(&gain, &offset));
+    for (raw = 0.0f; raw < 30000.0f; raw += 1000.0f)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, CONV_VoltsFromRaw(raw, s_voltageChannelSettings), (raw * gain) + offset);
+    }
+
+    TEST_ASSERT_TRUE(current.getAffineConversion(&gain, &offset));
+    for (raw = 0.0f; raw < 30000.0f; raw += 1000.0f)
+    {
+        TEST_ASSERT_FLOAT_WITHIN(0.0001f, CONV_AmpsFromRaw(raw, s_currentChannelSettings), (raw * gain) + offset);
+    }
+
+    TEST_ASSERT_FALSE(thermistor.getAffineConversion(&gain, &offset));
+}
+
+int main(void)
+{
+    UnityBegin("DLDataField.Template.Test.cpp");
+
+    RUN_TEST(test_VoltagePolicyMatchesConversionFunction);
+    RUN_TEST(test_CurrentPolicyMatchesConversionFunction);
+    RUN_TEST(test_ThermistorPolicyMatchesConversionFunction);
+    RUN_TEST(test_ConvertArrayConvertsInPlace);
+    RUN_TEST(test_NumericDataFieldUsesConversionPolicy);
+    RUN_TEST(test_NumericDataFieldAffineConversionMatchesPolicy);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,14 @@
+SRC_FILES += DLDataField/DLDataField.cpp DLDataField/DLDataField.Numeric.cpp
+SRC_FILES += DLDataField/DLDataField.Conversion.cpp
+SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.Strings.cpp
+SRC_FILES += DLUtility/DLUtility.Averager.cpp DLUtility/DLUtility.LookupTable.cpp DLUtility/DLUtility.Arena.cpp
+
+SRC_FILES += DLUtility/DLUtility.PD.cpp
+
+SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
+
+INC_DIRS += -IDLUtility -IDLSensor
+
+local_setup: ;
+
+local_teardown: ;
@@ -21,6 +21,7 @@
  * Local Application Includes
  */
 
+#include "DLUtility.PD.h"
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
@@ -49,6 +50,14 @@ static CURRENTCHANNEL s_currentChannelSettings = {
 	.mvPerAmp = 600.0f,
 };
 
+static THERMISTORCHANNEL s_thermistorChannelSettings = {
+	.R25 = 10000.0f,
+	.B = 3950.0f,
+	.otherR = 10000.0f,
+	.maxADC = 1023.0f,
+	.highside = true
+};
+
 static float sampleConversionFunction(float in, void * data)
 {
 	(void)data;
@@ -93,6 +102,10 @@ static void test_DatafieldStoreInts_CorrectlyFormattedAsStrings(void)
 
 	dataField.getRawDataAsString(buffer, "%.0f", true);
 	TEST_ASSERT_EQUAL_STRING("100", buffer);
+
+	dataField.storeData(-25);
+	dataField.getRawDataAsString(buffer, sizeof(buffer), 2, true);
+	TEST_ASSERT_EQUAL_STRING("-25.00", buffer);
 }
 
 static void test_DatafieldStoreAsString_ReturnsZeroLengthStringAsDefaultValue(void)
@@ -230,7 +243,10 @@ static void test_GetFieldTypeString_ReturnsStringforValidIndexAndEmptyOtherwise(
 	StringDataField dataField = StringDataField(DEGREES_DIRECTION, 3, 5, 0);
 	TEST_ASSERT_EQUAL_STRING("Wind Direction", dataField.getTypeString());
 
-	StringDataField invalidDataField = StringDataField((FIELD_TYPE)(DEGREES_DIRECTION+1), 3, 5, 0);
+	StringDataField productDataField = StringDataField(DERIVED_PRODUCT, 3, 5, 0);
+	TEST_ASSERT_EQUAL_STRING("Product", productDataField.getTypeString());
+
+	StringDataField invalidDataField = StringDataField((FIELD_TYPE)(DERIVED_INTEGRAL+1), 3, 5, 0);
 	TEST_ASSERT_EQUAL_STRING("", invalidDataField.getTypeString());
 }
 
@@ -364,6 +380,83 @@ static void test_DatafieldUsesAlternativeConversionFunction(void)
 	TEST_ASSERT_EQUAL_FLOAT(s_expectedAverage * 2, voltsDataField.getConvData(0));
 }
 
+static void test_DatafieldConversionTableOnlyForThermistors(void)
+{
+	NumericDataField voltsDataField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 0);
+	NumericDataField thermistorDataField = NumericDataField(TEMPERATURE_C, (void*)&s_thermistorChannelSettings, 0);
+
+	TEST_ASSERT_FALSE(voltsDataField.setupConversionTable(DATAFIELD_THERMISTOR_TABLE_SIZE));
+	TEST_ASSERT_TRUE(thermistorDataField.setupConversionTable(DATAFIELD_THERMISTOR_TABLE_SIZE));
+}
+
+static void test_DatafieldConversionTableMatchesThermistorConversion(void)
+{
+	NumericDataField thermistorDataField = NumericDataField(TEMPERATURE_C, (void*)&s_thermistorChannelSettings, 0);
+	thermistorDataField.setupConversionTable(DATAFIELD_THERMISTOR_TABLE_SIZE);
+
+	float raw;
+	for (raw = 200.0f; raw < 900.0f; raw += 12.5f)
+	{
+		TEST_ASSERT_FLOAT_WITHIN(0.1f,
+			CONV_CelsiusFromRawThermistor(raw, &s_thermistorChannelSettings), thermistorDataField.convertData(raw));
+	}
+}
+
+static void test_DatafieldConversionTableIsAccurateNearTheEndsOfTheADCRange(void)
+{
+	NumericDataField thermistorDataField = NumericDataField(TEMPERATURE_C, (void*)&s_thermistorChannelSettings, 0);
+	thermistorDataField.setupConversionTable(DATAFIELD_THERMISTOR_TABLE_SIZE);
+
+	float raw;
+
+	// Down to about -60C...
+	for (raw = 1.0f; raw < 100.0f; raw += 0.5f)
+	{
+		TEST_ASSERT_FLOAT_WITHIN(1.0f,
+			CONV_CelsiusFromRawThermistor(raw, &s_thermistorChannelSettings), thermistorDataField.convertData(raw));
+	}
+
+	// ...and the last interval of the table is calculated directly (about 180C up)
+	for (raw = 1010.0f; raw < 1023.0f; raw += 0.5f)
+	{
+		TEST_ASSERT_EQUAL_FLOAT(
+			CONV_CelsiusFromRawThermistor(raw, &s_thermistorChannelSettings), thermistorDataField.convertData(raw));
+	}
+}
+
+static void test_DatafieldConversionTableIsRebuiltForAlternativeConversion(void)
+{
+	NumericDataField thermistorDataField = NumericDataField(TEMPERATURE_C, (void*)&s_thermistorChannelSettings, 0);
+	thermistorDataField.setupConversionTable(DATAFIELD_THERMISTOR_TABLE_SIZE);
+	thermistorDataField.setAltConversion(sampleConversionFunction);
+
+	TEST_ASSERT_EQUAL_FLOAT(200.0f, thermistorDataField.convertData(100.0f));
+	TEST_ASSERT_EQUAL_FLOAT(1001.0f, thermistorDataField.convertData(500.5f));
+}
+
+static void test_DatafieldFixedPointScaleIsAveragerSizeWhereRangeAllows(void)
+{
+	NumericDataField voltsDataField = NumericDataField(VOLTAGE, (void*)&s_voltageChannelSettings, 0);
+	voltsDataField.setAveragerSize(30);
+
+	DATAFIELD_COLUMN_FORMAT format = voltsDataField.getStorageFormat();
+	TEST_ASSERT_EQUAL(DATAFIELD_STORAGE_FLOAT, format.storage);
+
+	voltsDataField.setStorage(DATAFIELD_STORAGE_FIXED16, 1023);
+	format = voltsDataField.getStorageFormat();
+	TEST_ASSERT_EQUAL(DATAFIELD_STORAGE_FIXED16, format.storage);
+	TEST_ASSERT_EQUAL_FLOAT(30.0f, format.scale);
+
+	// 4095 * 30 does not fit in 16 bits
+	voltsDataField.setStorage(DATAFIELD_STORAGE_FIXED16, 4095);
+	format = voltsDataField.getStorageFormat();
+	TEST_ASSERT_EQUAL_FLOAT(32767.0f / 4095.0f, format.scale);
+
+	voltsDataField.setStorage(DATAFIELD_STORAGE_FIXED32, 4095);
+	format = voltsDataField.getStorageFormat();
+	TEST_ASSERT_EQUAL_FLOAT(30.0f, format.scale);
+}
+
 /*static void test_writeNumericDataFieldsToBuffer_WritesCorrectValues(void)
 {
 	NumericDataField fieldArray[] = {
@@ -427,6 +520,11 @@ int main(void)
     RUN_TEST(test_GetFieldTypeString_ReturnsStringforValidIndexAndEmptyOtherwise);
 
     RUN_TEST(test_DatafieldUsesAlternativeConversionFunction);
+    RUN_TEST(test_DatafieldConversionTableOnlyForThermistors);
+    RUN_TEST(test_DatafieldConversionTableMatchesThermistorConversion);
+    RUN_TEST(test_DatafieldConversionTableIsAccurateNearTheEndsOfTheADCRange);
+    RUN_TEST(test_DatafieldConversionTableIsRebuiltForAlternativeConversion);
+    RUN_TEST(test_DatafieldFixedPointScaleIsAveragerSizeWhereRangeAllows);
     
     //RUN_TEST(test_writeNumericDataFieldsToBuffer_WritesCorrectValues);
     //RUN_TEST(test_writeStringDataFieldsToBuffer_WritesCorrectValues);
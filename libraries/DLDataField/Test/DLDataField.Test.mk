@@ -1,7 +1,7 @@
 SRC_FILES += DLDataField/DLDataField.String.cpp DLDataField/DLDataField.Numeric.cpp 
-SRC_FILES += DLDataField/DLDataField.Conversion.cpp
+SRC_FILES += DLDataField/DLDataField.Conversion.cpp DLDataField/DLDataField.Template.cpp
 SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp DLUtility/DLUtility.Strings.cpp
-SRC_FILES += DLUtility/DLUtility.Averager.cpp
+SRC_FILES += DLUtility/DLUtility.Averager.cpp DLUtility/DLUtility.LookupTable.cpp DLUtility/DLUtility.Arena.cpp
 
 SRC_FILES += DLUtility/DLUtility.PD.cpp
 
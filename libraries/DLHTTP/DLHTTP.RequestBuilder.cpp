@@ -95,12 +95,13 @@ void RequestBuilder::putBody(const char * body)
     m_body = body;
 }
 
-void RequestBuilder::writeToBuffer(char * buf, uint16_t maxLength, bool addContentLengthHeader)
+/* Returns false if the request could not be written, or was truncated to fit maxLength */
+bool RequestBuilder::writeToBuffer(char * buf, uint16_t maxLength, bool addContentLengthHeader)
 {
 
     uint8_t i = 0;
 
-    if (!m_method || !m_url || !buf) { return; }
+    if (!m_method || !m_url || !buf) { return false; }
     
     accumulator.detach();
     accumulator.attach(buf, maxLength); 
@@ -127,9 +128,7 @@ void RequestBuilder::writeToBuffer(char * buf, uint16_t maxLength, bool addConte
         }
     }
 
-    accumulator.writeChar(' ');
-    accumulator.writeString("HTTP/1.1");
-    accumulator.writeString(CRLF);
+    accumulator.appendLiteral(" HTTP/1.1" CRLF);
     
     /* Write header lines */
     
@@ -137,28 +136,30 @@ void RequestBuilder::writeToBuffer(char * buf, uint16_t maxLength, bool addConte
     for (i = 0; i < m_headerCount; i++)
     {
         accumulator.writeString(m_headers[i].getName());
-        accumulator.writeString(": ");
+        accumulator.appendLiteral(": ");
         accumulator.writeString(m_headers[i].getValue());
-        accumulator.writeString(CRLF);
+        accumulator.appendLiteral(CRLF);
     }
     
+    // The body length is needed twice, so only measure it once
+    size_t bodyLength = m_body ? strlen(m_body) : 0;
+
     if (addContentLengthHeader && m_body)
     {
-        char lengthStr[5];
-        sprintf(lengthStr, "%d", (int)strlen(m_body));
-        
-        accumulator.writeString("Content-Length: ");
-        accumulator.writeString(lengthStr);
-        accumulator.writeString(CRLF);
+        accumulator.appendLiteral("Content-Length: ");
+        accumulator.appendUInt(bodyLength);
+        accumulator.appendLiteral(CRLF);
     }
     
     /* Write body */ 
     if (m_body)
     {
-        accumulator.writeString(CRLF);
-        accumulator.writeString(m_body);
-        accumulator.writeString(CRLF);
+        accumulator.appendLiteral(CRLF);
+        accumulator.append(m_body, bodyLength);
+        accumulator.appendLiteral(CRLF);
     }
+
+    return !accumulator.truncated();
 }
 
 void RequestBuilder::reset(void)
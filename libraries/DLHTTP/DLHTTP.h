@@ -233,7 +233,7 @@ class RequestBuilder
         void putHeader(const char* name, const char* value);
         void putBody(const char * body);
         
-        void writeToBuffer(char * buf, uint16_t maxLength, bool addContentLengthHeader = false);
+        bool writeToBuffer(char * buf, uint16_t maxLength, bool addContentLengthHeader = false);
         
         void reset(void);
         
@@ -86,7 +86,11 @@ int main(int argc, char * argv[])
         builder.putBody(body);
     }
     
-    builder.writeToBuffer(request_buffer, 2048, true);
+    if (!builder.writeToBuffer(request_buffer, 2048, true))
+    {
+        std::cout << "Request did not fit in the buffer" << std::endl;
+        return 1;
+    }
     
     std::cout << request_buffer << std::endl;
     
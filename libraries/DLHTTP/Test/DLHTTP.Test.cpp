@@ -45,7 +45,7 @@ void test_header_isSuccessfulyParsed(void)
 void test_requestbuilder_BuildsWithMethodAndURLOnly(void)
 {
     builder.setMethodAndURL("GET", "/");   
-    builder.writeToBuffer(requestBuffer, 512);
+    TEST_ASSERT_TRUE(builder.writeToBuffer(requestBuffer, 512));
     TEST_ASSERT_EQUAL_STRING("GET / HTTP/1.1\r\n", requestBuffer);
 }
 
@@ -54,7 +54,7 @@ void test_requestbuilder_BuildsWithHeaders(void)
     builder.putHeader("Host", "www.example.com");
     builder.putHeader("Content-Type", "text/html");
     builder.putHeader("Some-Other-Header", "Some-Other-Value");
-    builder.writeToBuffer(requestBuffer, 512);
+    TEST_ASSERT_TRUE(builder.writeToBuffer(requestBuffer, 512));
     TEST_ASSERT_EQUAL_STRING(
         "GET / HTTP/1.1\r\n"
         "Host: www.example.com\r\n"
@@ -65,7 +65,7 @@ void test_requestbuilder_BuildsWithHeaders(void)
 void test_requestbuilder_BuildsWithBodyContent(void)
 {
     builder.putBody("This is some data in the body.");
-    builder.writeToBuffer(requestBuffer, 512);
+    TEST_ASSERT_TRUE(builder.writeToBuffer(requestBuffer, 512));
     TEST_ASSERT_EQUAL_STRING(
         "GET / HTTP/1.1\r\n"
         "Host: www.example.com\r\n"
@@ -77,7 +77,7 @@ void test_requestbuilder_BuildsWithBodyContent(void)
 
 void test_requestbuilder_BuildsWithContentLengthHeader(void)
 {
-    builder.writeToBuffer(requestBuffer, 512, true);
+    TEST_ASSERT_TRUE(builder.writeToBuffer(requestBuffer, 512, true));
     TEST_ASSERT_EQUAL_STRING(
         "GET / HTTP/1.1\r\n"
         "Host: www.example.com\r\n"
@@ -97,13 +97,27 @@ void test_requestbuilder_BuildsWithURLParameters(void)
     builder.putHeader("Host", "www.example.com");
     builder.putBody(NULL);
 
-    builder.writeToBuffer(requestBuffer, 512);
+    TEST_ASSERT_TRUE(builder.writeToBuffer(requestBuffer, 512));
 
     TEST_ASSERT_EQUAL_STRING(
         "GET /update?Param1=Param1Value&Param2=Param2Value HTTP/1.1\r\n"
         "Host: www.example.com\r\n", requestBuffer); 
 }
 
+void test_requestbuilder_ReportsTruncatedRequest(void)
+{
+    char smallBuffer[20];
+
+    builder.reset();
+    builder.setMethodAndURL("GET", "/");
+    builder.putHeader("Host", "www.example.com");
+
+    TEST_ASSERT_FALSE(builder.writeToBuffer(smallBuffer, 20));
+    TEST_ASSERT_EQUAL_STRING("GET / HTTP/1.1\r\nHos", smallBuffer);
+
+    TEST_ASSERT_TRUE(builder.writeToBuffer(requestBuffer, 512));
+}
+
 void test_responseparser_ReadsHTTPStatusLine(void)
 {
     char response[] = "HTTP/1.0 200 OK\r\n";
@@ -149,6 +163,7 @@ int main(void)
     RUN_TEST(test_requestbuilder_BuildsWithBodyContent);
     RUN_TEST(test_requestbuilder_BuildsWithContentLengthHeader);
     RUN_TEST(test_requestbuilder_BuildsWithURLParameters);
+    RUN_TEST(test_requestbuilder_ReportsTruncatedRequest);
 
     RUN_TEST(test_responseparser_ReadsHTTPStatusLine);
     RUN_TEST(test_responseparser_ReadsHTTPHeaders);
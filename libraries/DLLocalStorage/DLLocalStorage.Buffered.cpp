@@ -0,0 +1,377 @@
+/*
+ * DLLocalStorage.Buffered.cpp
+ *
+ * Write-back buffering for any local storage interface
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.Buffered.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+// The only file handle given out for write: writes go to the buffer, not to a backend file
+#define BUFFERED_WRITE_HANDLE ((FILE_HANDLE)0)
+
+/*
+ * Private Functions
+ */
+
+/*
+ * sectorsTouched
+ *
+ * Returns the number of sectors that writing length bytes at offset into a file would program
+ */
+static uint32_t sectorsTouched(uint32_t offset, uint32_t length)
+{
+    if (length == 0) { return 0; }
+    return ((offset + length - 1) / BUFFERED_STORAGE_BLOCK_SIZE) - (offset / BUFFERED_STORAGE_BLOCK_SIZE) + 1;
+}
+
+/*
+ * Public Class Functions
+ */
+
+BufferedStorage::BufferedStorage(LocalStorageInterface * backend, BUFFERED_STORAGE_CLOCK clock)
+{
+    m_backend = backend;
+    m_clock = clock;
+
+    m_filename[0] = '\0';
+    m_length = 0;
+    m_capacity = BUFFERED_STORAGE_BLOCK_SIZE;
+    m_fileOffset = 0;
+    m_pendingSince = 0;
+
+    m_openForWrite = false;
+    m_readHandle = INVALID_HANDLE;
+    m_flushOnClose = true;
+    m_maxAge = 0;
+
+    resetStats();
+}
+
+bool BufferedStorage::inError()
+{
+    return !m_backend || m_backend->inError();
+}
+
+/*
+ * fileExists
+ *
+ * A file that has only been written to the buffer so far is treated as existing
+ */
+bool BufferedStorage::fileExists(char const * const filePath)
+{
+    if (isPendingFile(filePath) && (m_length > 0)) { return true; }
+    return m_backend->fileExists(filePath);
+}
+
+bool BufferedStorage::directoryExists(char const * const dirPath)
+{
+    return m_backend->directoryExists(dirPath);
+}
+
+bool BufferedStorage::mkDir(char const * const dirPath)
+{
+    return m_backend->mkDir(dirPath);
+}
+
+/*
+ * write
+ *
+ * Copies toWrite into the buffer, writing the buffer out each time it reaches a block boundary.
+ * If the buffer cannot be written out, the rest of toWrite is dropped.
+ */
+void BufferedStorage::write(FILE_HANDLE file, char const * const toWrite)
+{
+    (void)file; // Only one file can be open for write
+
+    if (!m_openForWrite || !toWrite) { return; }
+
+    char const * pSource = toWrite;
+    uint32_t remaining = strlen(toWrite);
+    uint32_t count;
+
+    m_stats.writeCalls++;
+    m_stats.bytes += remaining;
+    m_stats.unbufferedSectors += sectorsTouched(m_fileOffset + m_length, remaining);
+
+    while (remaining > 0)
+    {
+        if (m_length == 0) { m_pendingSince = now(); }
+
+        count = m_capacity - m_length;
+        if (count > remaining) { count = remaining; }
+
+        memcpy(&m_block[m_length], pSource, count);
+        m_length += count;
+        pSource += count;
+        remaining -= count;
+
+        if ((m_length == m_capacity) && !writeBlock())
+        {
+            m_stats.droppedBytes += remaining;
+            return;
+        }
+    }
+
+    service();
+}
+
+uint32_t BufferedStorage::readBytes(FILE_HANDLE file, char * buffer, uint32_t n)
+{
+    return m_backend->readBytes(file, buffer, n);
+}
+
+uint32_t BufferedStorage::readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF)
+{
+    return m_backend->readLine(file, buffer, n, stripCRLF);
+}
+
+bool BufferedStorage::seek(FILE_HANDLE file, uint32_t position)
+{
+    if (m_readHandle == INVALID_HANDLE) { return false; }
+    return m_backend->seek(file, position);
+}
+
+uint32_t BufferedStorage::fileSize(FILE_HANDLE file)
+{
+    if (m_readHandle == INVALID_HANDLE) { return 0; }
+    return m_backend->fileSize(file);
+}
+
+/*
+ * openFile
+ *
+ * Files opened for write are only opened on the backend when the buffer is written out.
+ * Opening a different file for write writes out the buffer for the previous one first.
+ * Opening any file for read writes out the buffer first, so that the backend has all the data.
+ */
+FILE_HANDLE BufferedStorage::openFile(char const * const filename, bool forWrite)
+{
+    if (!filename || !m_backend) { return INVALID_HANDLE; }
+
+    // Like the backends, opening a file closes any other open file
+    if (m_readHandle != INVALID_HANDLE)
+    {
+        m_backend->closeFile(m_readHandle);
+        m_readHandle = INVALID_HANDLE;
+    }
+    m_openForWrite = false;
+
+    if (forWrite)
+    {
+        if (!isPendingFile(filename))
+        {
+            if (!flush()) { return INVALID_HANDLE; }
+            if (strlen(filename) >= BUFFERED_STORAGE_MAX_PATH) { return INVALID_HANDLE; }
+
+            strcpy(m_filename, filename);
+            m_fileOffset = backendFileSize(filename);
+            m_capacity = BUFFERED_STORAGE_BLOCK_SIZE - (m_fileOffset % BUFFERED_STORAGE_BLOCK_SIZE);
+        }
+
+        m_openForWrite = true;
+        return BUFFERED_WRITE_HANDLE;
+    }
+
+    flush();
+
+    m_readHandle = m_backend->openFile(filename, false);
+    return m_readHandle;
+}
+
+/*
+ * closeFile
+ *
+ * Closing a file opened for write also writes out the buffer, unless setFlushOnClose(false)
+ */
+void BufferedStorage::closeFile(FILE_HANDLE file)
+{
+    if (m_openForWrite)
+    {
+        m_openForWrite = false;
+        if (m_flushOnClose) { flush(); }
+    }
+    else if (m_readHandle != INVALID_HANDLE)
+    {
+        m_backend->closeFile(file);
+        m_readHandle = INVALID_HANDLE;
+    }
+}
+
+bool BufferedStorage::endOfFile(FILE_HANDLE file)
+{
+    return m_backend->endOfFile(file);
+}
+
+void BufferedStorage::setEcho(bool set)
+{
+    m_backend->setEcho(set);
+}
+
+/*
+ * removeFile
+ *
+ * Anything buffered for the removed file is discarded
+ */
+void BufferedStorage::removeFile(char const * const dirPath)
+{
+    if (isPendingFile(dirPath))
+    {
+        m_length = 0;
+        m_fileOffset = 0;
+        m_capacity = BUFFERED_STORAGE_BLOCK_SIZE;
+    }
+
+    m_backend->removeFile(dirPath);
+}
+
+void BufferedStorage::setMaxAge(uint32_t maxAgeMs)
+{
+    m_maxAge = maxAgeMs;
+}
+
+void BufferedStorage::setFlushOnClose(bool set)
+{
+    m_flushOnClose = set;
+}
+
+/*
+ * flush
+ *
+ * Writes out anything in the buffer. Returns false if it could not be written (it is kept).
+ */
+bool BufferedStorage::flush(void)
+{
+    return writeBlock();
+}
+
+/*
+ * service
+ *
+ * Writes out the buffer if the oldest data in it is older than the maximum age.
+ * Call this regularly (e.g. from a TaskAction) so data is not held indefinitely between writes.
+ * Nothing is written while a file is open for read, since that would close it on the backend.
+ * Returns false if the buffer needed writing out but could not be.
+ */
+bool BufferedStorage::service(void)
+{
+    if ((m_maxAge == 0) || (m_length == 0) || (m_readHandle != INVALID_HANDLE)) { return true; }
+    if (elapsedMs(m_pendingSince) < m_maxAge) { return true; }
+
+    return writeBlock();
+}
+
+uint16_t BufferedStorage::pendingLength(void)
+{
+    return m_length;
+}
+
+void BufferedStorage::getStats(BUFFERED_STORAGE_STATS * stats)
+{
+    if (stats) { *stats = m_stats; }
+}
+
+void BufferedStorage::resetStats(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/*
+ * Private Class Functions
+ */
+
+/*
+ * writeBlock
+ *
+ * Appends the buffer to the file on the backend, with one open/write/close.
+ * The next block then ends at the next block boundary of the file.
+ */
+bool BufferedStorage::writeBlock(void)
+{
+    unsigned long start;
+    uint32_t elapsed;
+
+    if (m_length == 0) { return true; }
+
+    start = now();
+
+    FILE_HANDLE file = m_backend->openFile(m_filename, true);
+    if (file == INVALID_HANDLE) { return false; }
+
+    m_block[m_length] = '\0';
+    m_backend->write(file, m_block);
+    m_backend->closeFile(file);
+
+    elapsed = elapsedMs(start);
+    m_stats.flushMs += elapsed;
+    if (elapsed > m_stats.maxFlushMs) { m_stats.maxFlushMs = elapsed; }
+
+    m_stats.backendWrites++;
+    if (m_length == BUFFERED_STORAGE_BLOCK_SIZE) { m_stats.fullBlocks++; }
+    m_stats.sectors += sectorsTouched(m_fileOffset, m_length);
+
+    m_fileOffset += m_length;
+    m_length = 0;
+    m_capacity = BUFFERED_STORAGE_BLOCK_SIZE - (m_fileOffset % BUFFERED_STORAGE_BLOCK_SIZE);
+
+    return true;
+}
+
+/*
+ * backendFileSize
+ *
+ * Returns the size of filename on the backend (0 if it does not exist), which is where new blocks start
+ */
+uint32_t BufferedStorage::backendFileSize(char const * const filename)
+{
+    FILE_HANDLE file;
+    uint32_t size;
+
+    if (!m_backend->fileExists(filename)) { return 0; }
+
+    file = m_backend->openFile(filename, false);
+    if (file == INVALID_HANDLE) { return 0; }
+
+    size = m_backend->fileSize(file);
+    m_backend->closeFile(file);
+
+    return size;
+}
+
+bool BufferedStorage::isPendingFile(char const * const filename)
+{
+    return filename && (m_filename[0] != '\0') && (strcmp(filename, m_filename) == 0);
+}
+
+unsigned long BufferedStorage::now(void)
+{
+    return m_clock ? m_clock() : 0;
+}
+
+uint32_t BufferedStorage::elapsedMs(unsigned long since)
+{
+    return (uint32_t)(now() - since);
+}
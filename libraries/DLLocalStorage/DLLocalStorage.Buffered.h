@@ -0,0 +1,101 @@
+#ifndef _LOCAL_STORAGE_BUFFERED_H_
+#define _LOCAL_STORAGE_BUFFERED_H_
+
+/*
+ * BufferedStorage
+ *
+ * Write-back buffer over any other LocalStorageInterface.
+ * Writes to a file are collected in RAM and written to the backend a block at a time,
+ * so logging code that writes a row in several pieces costs one backend write per block,
+ * not one per piece.
+ *
+ * Blocks end on BUFFERED_STORAGE_BLOCK_SIZE boundaries of the file, so a file is written in whole
+ * sectors. When a file that already has data is opened for write (e.g. after a restart), the
+ * boundaries are counted from its size on the backend, so appending to it stays aligned.
+ * The buffer is written out when it reaches a block boundary, on flush(), when a file is opened for
+ * read, when another file is opened for write, and when the oldest buffered data is older than
+ * the maximum age (checked by write() and service()). By default it is also written out on
+ * closeFile, which still saves a backend write per piece of each row: turn this off with
+ * setFlushOnClose(false) to only write whole blocks, at the cost of losing up to a block
+ * (or the maximum age) of data if power is lost.
+ *
+ * Like the backends, only one file should be open at a time.
+ */
+
+#define BUFFERED_STORAGE_BLOCK_SIZE (512)
+#define BUFFERED_STORAGE_MAX_PATH (64)
+
+// Returns milliseconds (matches millis(), so that can be passed in directly)
+typedef unsigned long (*BUFFERED_STORAGE_CLOCK)(void);
+
+struct buffered_storage_stats
+{
+    uint32_t writeCalls; // Calls to write()
+    uint32_t bytes; // Bytes passed to write()
+    uint32_t unbufferedSectors; // Sectors that would have been programmed if each write() went straight to the backend
+    uint32_t backendWrites; // Blocks written to the backend
+    uint32_t fullBlocks; // ...of which were whole blocks
+    uint32_t sectors; // Sectors programmed by the backend writes
+    uint32_t droppedBytes; // Bytes lost because the buffer was full and could not be written out
+    uint32_t flushMs; // Total time spent writing to the backend
+    uint32_t maxFlushMs; // Longest single write to the backend
+};
+typedef struct buffered_storage_stats BUFFERED_STORAGE_STATS;
+
+class BufferedStorage : public LocalStorageInterface
+{
+    public:
+        BufferedStorage(LocalStorageInterface * backend, BUFFERED_STORAGE_CLOCK clock);
+
+        bool inError();
+        bool fileExists(char const * const filePath);
+        bool directoryExists(char const * const dirPath);
+        bool mkDir(char const * const dirPath);
+        void write(FILE_HANDLE file, char const * const toWrite);
+        uint32_t readBytes(FILE_HANDLE file, char * buffer, uint32_t n);
+        uint32_t readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF);
+        bool seek(FILE_HANDLE file, uint32_t position);
+        uint32_t fileSize(FILE_HANDLE file);
+        FILE_HANDLE openFile(char const * const filename, bool forWrite);
+        void closeFile(FILE_HANDLE file);
+        bool endOfFile(FILE_HANDLE file);
+        void setEcho(bool set);
+        void removeFile(char const * const dirPath);
+
+        /* maxAgeMs of 0 (the default) never writes out the buffer because of its age */
+        void setMaxAge(uint32_t maxAgeMs);
+        void setFlushOnClose(bool set);
+
+        bool flush(void);
+        bool service(void);
+
+        uint16_t pendingLength(void);
+        void getStats(BUFFERED_STORAGE_STATS * stats);
+        void resetStats(void);
+
+    private:
+        bool writeBlock(void);
+        uint32_t backendFileSize(char const * const filename);
+        bool isPendingFile(char const * const filename);
+        unsigned long now(void);
+        uint32_t elapsedMs(unsigned long since);
+
+        LocalStorageInterface * m_backend;
+        BUFFERED_STORAGE_CLOCK m_clock;
+
+        char m_filename[BUFFERED_STORAGE_MAX_PATH];
+        char m_block[BUFFERED_STORAGE_BLOCK_SIZE + 1];
+        uint16_t m_length;
+        uint16_t m_capacity;
+        uint32_t m_fileOffset;
+        unsigned long m_pendingSince;
+
+        bool m_openForWrite;
+        FILE_HANDLE m_readHandle;
+        bool m_flushOnClose;
+        uint32_t m_maxAge;
+
+        BUFFERED_STORAGE_STATS m_stats;
+};
+
+#endif
@@ -0,0 +1,402 @@
+/*
+ * DLLocalStorage.LogStore.cpp
+ *
+ * Crash-safe append-only record log on local storage
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.CRC.h"
+#include "DLUtility.Strings.h"
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.LogStore.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+// Chars of a commit marker covered by its CRC ("C", offset and record count)
+#define MARKER_CRC_LENGTH (17)
+
+/*
+ * Private Functions
+ */
+
+/*
+ * isRecord
+ *
+ * Returns true if line (length chars, including the line feed) is a whole record with a good CRC
+ */
+static bool isRecord(char const * line, uint32_t length)
+{
+    uint32_t payloadLength;
+    uint32_t crc;
+
+    if (length < (LOG_STORE_RECORD_HEADER_LENGTH + 1)) { return false; }
+    if ((line[0] != 'R') || (line[LOG_STORE_RECORD_HEADER_LENGTH - 1] != ' ') || (line[length - 1] != '\n')) { return false; }
+    if (!readHex(&line[1], 4, &payloadLength) || !readHex(&line[5], 4, &crc)) { return false; }
+    if (payloadLength != (length - LOG_STORE_RECORD_HEADER_LENGTH - 1)) { return false; }
+
+    return crc16Update(CRC16_INITIAL_VALUE, &line[LOG_STORE_RECORD_HEADER_LENGTH], payloadLength) == crc;
+}
+
+/*
+ * isMarker
+ *
+ * Returns true if there is a commit marker for offset at buffer, and gets its record count
+ */
+static bool isMarker(char const * buffer, uint32_t offset, uint32_t * pRecordCount)
+{
+    uint32_t markerOffset;
+    uint32_t crc;
+
+    if ((buffer[0] != 'C') || (buffer[LOG_STORE_MARKER_LENGTH - 1] != '\n')) { return false; }
+    if (!readHex(&buffer[1], 8, &markerOffset) || (markerOffset != offset)) { return false; }
+    if (!readHex(&buffer[9], 8, pRecordCount) || !readHex(&buffer[MARKER_CRC_LENGTH], 4, &crc)) { return false; }
+
+    return crc16Update(CRC16_INITIAL_VALUE, buffer, MARKER_CRC_LENGTH) == crc;
+}
+
+/*
+ * Public Class Functions
+ */
+
+LogStore::LogStore(LocalStorageInterface * storage, uint16_t commitInterval)
+{
+    m_storage = storage;
+    m_commitInterval = commitInterval;
+
+    m_filename[0] = '\0';
+    m_size = 0;
+    m_committedSize = 0;
+    m_recordCount = 0;
+    m_uncommitted = 0;
+    m_discardedBytes = 0;
+}
+
+/*
+ * open
+ *
+ * Recovers the state of the log from the end of the file (or starts a new log if there is no file).
+ * Returns false if the file could not be read, or the end of a torn write could not be committed.
+ */
+bool LogStore::open(char const * const filename)
+{
+    FILE_HANDLE file;
+    uint32_t fileSize;
+    char last = '\n';
+
+    if (!filename || !m_storage || (strlen(filename) >= LOG_STORE_MAX_PATH)) { return false; }
+
+    strcpy(m_filename, filename);
+    m_size = 0;
+    m_committedSize = 0;
+    m_recordCount = 0;
+    m_uncommitted = 0;
+    m_discardedBytes = 0;
+
+    if (!m_storage->fileExists(filename)) { return true; }
+
+    file = m_storage->openFile(filename, false);
+    if (file == INVALID_HANDLE) { return false; }
+
+    fileSize = m_storage->fileSize(file);
+    m_committedSize = findLastMarker(file, fileSize);
+    m_size = checkRecordsAfter(file, m_committedSize);
+    m_discardedBytes = fileSize - m_size;
+
+    if ((m_discardedBytes > 0) && m_storage->seek(file, fileSize - 1))
+    {
+        m_storage->readBytes(file, &last, 1);
+    }
+
+    m_storage->closeFile(file);
+
+    if (m_discardedBytes == 0) { return true; }
+
+    // Start new records on a clean line, and commit past the torn data so it is not checked again
+    m_size = fileSize;
+    if ((last != '\n') && !writeLine("\n")) { return false; }
+
+    return writeMarker();
+}
+
+/*
+ * append
+ *
+ * Adds a record to the end of the log, writing a commit marker after every commitInterval records.
+ * Returns false if the payload is too long or contains a line feed, or the file could not be opened.
+ */
+bool LogStore::append(char const * const payload)
+{
+    uint32_t length;
+
+    if (!payload) { return false; }
+
+    length = strlen(payload);
+    if ((length > LOG_STORE_MAX_PAYLOAD) || memchr(payload, '\n', length)) { return false; }
+
+    m_line[0] = 'R';
+    writeHex(&m_line[1], length, 4);
+    writeHex(&m_line[5], crc16Update(CRC16_INITIAL_VALUE, payload, length), 4);
+    m_line[LOG_STORE_RECORD_HEADER_LENGTH - 1] = ' ';
+    memcpy(&m_line[LOG_STORE_RECORD_HEADER_LENGTH], payload, length);
+    m_line[LOG_STORE_RECORD_HEADER_LENGTH + length] = '\n';
+    m_line[LOG_STORE_RECORD_HEADER_LENGTH + length + 1] = '\0';
+
+    if (!writeLine(m_line)) { return false; }
+
+    m_recordCount++;
+    m_uncommitted++;
+
+    if ((m_commitInterval > 0) && (m_uncommitted >= m_commitInterval)) { return writeMarker(); }
+
+    return true;
+}
+
+/*
+ * commit
+ *
+ * Writes a commit marker if anything has been written since the last one
+ */
+bool LogStore::commit(void)
+{
+    if (m_size == m_committedSize) { return true; }
+    return writeMarker();
+}
+
+/*
+ * startReading
+ *
+ * Opens the log for pReader at offset (0, or an offset from a reader of this log)
+ */
+bool LogStore::startReading(LOG_STORE_READER * pReader, uint32_t offset)
+{
+    if (!pReader || (m_filename[0] == '\0')) { return false; }
+
+    pReader->file = m_storage->openFile(m_filename, false);
+    if (pReader->file == INVALID_HANDLE) { return false; }
+
+    if ((offset > 0) && !m_storage->seek(pReader->file, offset))
+    {
+        stopReading(pReader);
+        return false;
+    }
+
+    pReader->offset = offset;
+    pReader->recordOffset = offset;
+    return true;
+}
+
+/*
+ * next
+ *
+ * Returns the payload of the next good record (skipping markers and torn or corrupt lines),
+ * or NULL at the end of the log. The payload is only valid until the next call.
+ */
+char const * LogStore::next(LOG_STORE_READER * pReader)
+{
+    uint32_t length;
+
+    if (!pReader || (pReader->file == INVALID_HANDLE)) { return NULL; }
+
+    while (true)
+    {
+        length = m_storage->readLine(pReader->file, pReader->line, LOG_STORE_LINE_SIZE - 1, false);
+
+        if (length == 0) { return NULL; }
+
+        pReader->offset += length;
+
+        if (isRecord(pReader->line, length))
+        {
+            pReader->recordOffset = pReader->offset - length;
+            pReader->line[length - 1] = '\0';
+            return &pReader->line[LOG_STORE_RECORD_HEADER_LENGTH];
+        }
+    }
+}
+
+void LogStore::stopReading(LOG_STORE_READER * pReader)
+{
+    if (!pReader || (pReader->file == INVALID_HANDLE)) { return; }
+
+    m_storage->closeFile(pReader->file);
+    pReader->file = INVALID_HANDLE;
+}
+
+/*
+ * exportTo
+ *
+ * Appends the payloads of the records from offset onwards to filename as CRLF-terminated lines
+ * (after header, if not NULL). This has the log and filename open at the same time, so needs
+ * storage that allows that (e.g. MultiplexedStorage). Returns the number of records exported.
+ */
+uint32_t LogStore::exportTo(char const * const filename, uint32_t offset, char const * const header)
+{
+    LOG_STORE_READER reader;
+    FILE_HANDLE file;
+    char const * payload;
+    uint32_t count = 0;
+
+    if (!filename || !startReading(&reader, offset)) { return 0; }
+
+    file = m_storage->openFile(filename, true);
+    if (file == INVALID_HANDLE)
+    {
+        stopReading(&reader);
+        return 0;
+    }
+
+    if (header)
+    {
+        m_storage->write(file, header);
+        m_storage->write(file, "\r\n");
+    }
+
+    while ((payload = next(&reader)))
+    {
+        m_storage->write(file, payload);
+        m_storage->write(file, "\r\n");
+        count++;
+    }
+
+    m_storage->closeFile(file);
+    stopReading(&reader);
+
+    return count;
+}
+
+uint32_t LogStore::size(void) { return m_size; }
+uint32_t LogStore::committedSize(void) { return m_committedSize; }
+uint32_t LogStore::recordCount(void) { return m_recordCount; }
+
+/* Bytes of torn data found at the end of the file by open() */
+uint32_t LogStore::discardedBytes(void) { return m_discardedBytes; }
+
+/*
+ * Private Class Functions
+ */
+
+/*
+ * findLastMarker
+ *
+ * Scans backward from the end of the file a line-buffer at a time for the last commit marker.
+ * Returns the offset just after it (0 if there isn't one) and sets the record count from it.
+ */
+uint32_t LogStore::findLastMarker(FILE_HANDLE file, uint32_t fileSize)
+{
+    uint32_t end = fileSize;
+    uint32_t start;
+    uint32_t length;
+    uint32_t i;
+    uint32_t recordCount;
+
+    while (end >= LOG_STORE_MARKER_LENGTH)
+    {
+        start = (end > LOG_STORE_LINE_SIZE) ? (end - LOG_STORE_LINE_SIZE) : 0;
+        length = end - start;
+
+        if (!m_storage->seek(file, start)) { break; }
+        if (m_storage->readBytes(file, m_line, length) != length) { break; }
+
+        for (i = length - LOG_STORE_MARKER_LENGTH + 1; i-- > 0; )
+        {
+            if (isMarker(&m_line[i], start + i, &recordCount))
+            {
+                m_recordCount = recordCount;
+                return start + i + LOG_STORE_MARKER_LENGTH;
+            }
+        }
+
+        if (start == 0) { break; }
+
+        // Overlap the next window so that a marker across the boundary is still found
+        end = start + LOG_STORE_MARKER_LENGTH - 1;
+    }
+
+    m_recordCount = 0;
+    return 0;
+}
+
+/*
+ * checkRecordsAfter
+ *
+ * Counts the good records from offset, stopping at the first line that isn't one.
+ * Returns the offset just after the last good record.
+ */
+uint32_t LogStore::checkRecordsAfter(FILE_HANDLE file, uint32_t offset)
+{
+    uint32_t length;
+
+    if ((offset > 0) && !m_storage->seek(file, offset)) { return offset; }
+
+    while (true)
+    {
+        length = m_storage->readLine(file, m_line, LOG_STORE_LINE_SIZE - 1, false);
+
+        if (!isRecord(m_line, length)) { break; }
+
+        offset += length;
+        m_recordCount++;
+        m_uncommitted++;
+    }
+
+    return offset;
+}
+
+/*
+ * writeLine
+ *
+ * Appends line to the log file with one open/write/close
+ */
+bool LogStore::writeLine(char const * const line)
+{
+    FILE_HANDLE file;
+
+    if (m_filename[0] == '\0') { return false; }
+
+    file = m_storage->openFile(m_filename, true);
+    if (file == INVALID_HANDLE) { return false; }
+
+    m_storage->write(file, line);
+    m_storage->closeFile(file);
+
+    m_size += strlen(line);
+
+    return true;
+}
+
+bool LogStore::writeMarker(void)
+{
+    m_line[0] = 'C';
+    writeHex(&m_line[1], m_size, 8);
+    writeHex(&m_line[9], m_recordCount, 8);
+    writeHex(&m_line[MARKER_CRC_LENGTH], crc16Update(CRC16_INITIAL_VALUE, m_line, MARKER_CRC_LENGTH), 4);
+    m_line[LOG_STORE_MARKER_LENGTH - 1] = '\n';
+    m_line[LOG_STORE_MARKER_LENGTH] = '\0';
+
+    if (!writeLine(m_line)) { return false; }
+
+    m_committedSize = m_size;
+    m_uncommitted = 0;
+
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef _LOCAL_STORAGE_LOG_STORE_H_
+#define _LOCAL_STORAGE_LOG_STORE_H_
+
+/*
+ * LogStore
+ *
+ * Append-only record log on local storage that survives power being lost part way through a write.
+ *
+ * Each record is one line: "R", the payload length and CRC16 (4 hex chars each), a space,
+ * then the payload. Every commitInterval records (and on commit()) a commit marker is written:
+ * "C", its own offset in the file, the number of records before it (8 hex chars each) and a CRC16
+ * of those. Since the marker holds its own offset, it cannot be confused with record data.
+ *
+ * Opening the log only reads the end of the file: it scans backward from the end for the last
+ * commit marker, then checks the (at most commitInterval) records after it. Anything after the
+ * last good record (a torn write) is ended with a line feed and a commit marker, so new records
+ * start on a clean line and the torn data is never scanned again. Readers skip any line that is
+ * not a valid record, so torn lines in the middle of the file are harmless.
+ *
+ * Payloads are text (the storage interface writes strings) and cannot contain line feeds.
+ *
+ * The file is opened and closed for each append, so on storage that can only have one file open
+ * at a time, do not append while reading unless the storage is a MultiplexedStorage.
+ */
+
+#define LOG_STORE_LINE_SIZE (256)
+#define LOG_STORE_RECORD_HEADER_LENGTH (10)
+#define LOG_STORE_MARKER_LENGTH (22)
+#define LOG_STORE_MAX_PAYLOAD (LOG_STORE_LINE_SIZE - LOG_STORE_RECORD_HEADER_LENGTH - 2)
+#define LOG_STORE_MAX_PATH (64)
+
+struct log_store_reader
+{
+    FILE_HANDLE file;
+    uint32_t offset; // Start of the next line to read
+    uint32_t recordOffset; // Start of the last record returned
+    char line[LOG_STORE_LINE_SIZE];
+};
+typedef struct log_store_reader LOG_STORE_READER;
+
+class LogStore
+{
+    public:
+        LogStore(LocalStorageInterface * storage, uint16_t commitInterval);
+
+        bool open(char const * const filename);
+
+        bool append(char const * const payload);
+        bool commit(void);
+
+        bool startReading(LOG_STORE_READER * pReader, uint32_t offset);
+        char const * next(LOG_STORE_READER * pReader);
+        void stopReading(LOG_STORE_READER * pReader);
+
+        uint32_t exportTo(char const * const filename, uint32_t offset, char const * const header);
+
+        uint32_t size(void);
+        uint32_t committedSize(void);
+        uint32_t recordCount(void);
+        uint32_t discardedBytes(void);
+
+    private:
+        uint32_t findLastMarker(FILE_HANDLE file, uint32_t fileSize);
+        uint32_t checkRecordsAfter(FILE_HANDLE file, uint32_t offset);
+        bool writeLine(char const * const line);
+        bool writeMarker(void);
+
+        LocalStorageInterface * m_storage;
+        uint16_t m_commitInterval;
+
+        char m_filename[LOG_STORE_MAX_PATH];
+        char m_line[LOG_STORE_LINE_SIZE];
+
+        uint32_t m_size;
+        uint32_t m_committedSize;
+        uint32_t m_recordCount;
+        uint16_t m_uncommitted;
+        uint32_t m_discardedBytes;
+};
+
+#endif
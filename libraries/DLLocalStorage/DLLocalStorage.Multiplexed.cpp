@@ -0,0 +1,359 @@
+/*
+ * DLLocalStorage.Multiplexed.cpp
+ *
+ * Several open files over local storage that can only have one file open at a time
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Readline.h"
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.Multiplexed.h"
+
+/*
+ * Public Class Functions
+ */
+
+MultiplexedStorage::MultiplexedStorage(LocalStorageInterface * backend)
+{
+    uint8_t i;
+
+    m_backend = backend;
+
+    for (i = 0; i < MULTIPLEXED_STORAGE_MAX_FILES; ++i)
+    {
+        m_files[i].storage = this;
+        m_files[i].inUse = false;
+    }
+
+    m_active = INVALID_HANDLE;
+    m_backendHandle = INVALID_HANDLE;
+    m_switchCount = 0;
+}
+
+bool MultiplexedStorage::inError()
+{
+    return !m_backend || m_backend->inError();
+}
+
+/*
+ * fileExists
+ *
+ * A file that has only been written to a handle's buffer so far is treated as existing
+ */
+bool MultiplexedStorage::fileExists(char const * const filePath)
+{
+    uint8_t i;
+
+    if (!filePath) { return false; }
+
+    for (i = 0; i < MULTIPLEXED_STORAGE_MAX_FILES; ++i)
+    {
+        if (m_files[i].inUse && m_files[i].forWrite && (m_files[i].writeLength > 0) &&
+            (strcmp(m_files[i].path, filePath) == 0))
+        {
+            return true;
+        }
+    }
+
+    return m_backend->fileExists(filePath);
+}
+
+bool MultiplexedStorage::directoryExists(char const * const dirPath)
+{
+    return m_backend->directoryExists(dirPath);
+}
+
+bool MultiplexedStorage::mkDir(char const * const dirPath)
+{
+    return m_backend->mkDir(dirPath);
+}
+
+/*
+ * write
+ *
+ * Copies toWrite into the handle's buffer, appending the buffer to the file each time it fills.
+ * If the buffer cannot be appended, the rest of toWrite is dropped.
+ */
+void MultiplexedStorage::write(FILE_HANDLE file, char const * const toWrite)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile || !pFile->forWrite || !toWrite) { return; }
+
+    char const * pSource = toWrite;
+    uint32_t remaining = strlen(toWrite);
+    uint32_t count;
+
+    while (remaining > 0)
+    {
+        count = MULTIPLEXED_STORAGE_BLOCK_SIZE - pFile->writeLength;
+        if (count > remaining) { count = remaining; }
+
+        memcpy(&pFile->data[pFile->writeLength], pSource, count);
+        pFile->writeLength += count;
+        pSource += count;
+        remaining -= count;
+
+        if ((pFile->writeLength == MULTIPLEXED_STORAGE_BLOCK_SIZE) && !flush(file)) { return; }
+    }
+}
+
+uint32_t MultiplexedStorage::readBytes(FILE_HANDLE file, char * buffer, uint32_t n)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile || pFile->forWrite || !buffer) { return 0; }
+
+    return readBytesWithReadAhead(&pFile->readAhead, readFromFile, buffer, n);
+}
+
+uint32_t MultiplexedStorage::readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile || pFile->forWrite || !buffer) { return 0; }
+
+    return readLineWithReadAhead(&pFile->readAhead, readFromFile, buffer, n, stripCRLF);
+}
+
+/*
+ * seek
+ *
+ * Only seeks the backend if the file is the one it has open: otherwise, it seeks
+ * to the new position when it next opens the file.
+ */
+bool MultiplexedStorage::seek(FILE_HANDLE file, uint32_t position)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile || pFile->forWrite) { return false; }
+
+    readAheadReset(&pFile->readAhead);
+    pFile->position = position;
+
+    return (m_active == file) ? m_backend->seek(m_backendHandle, position) : true;
+}
+
+uint32_t MultiplexedStorage::fileSize(FILE_HANDLE file)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile || pFile->forWrite || !activate(file)) { return 0; }
+
+    return m_backend->fileSize(m_backendHandle);
+}
+
+/*
+ * openFile
+ *
+ * Gives out a handle for filename, without opening it on the backend until it is needed.
+ * Returns INVALID_HANDLE if all the handles are in use, or a file to read does not exist.
+ */
+FILE_HANDLE MultiplexedStorage::openFile(char const * const filename, bool forWrite)
+{
+    FILE_HANDLE file;
+    MULTIPLEXED_FILE * pFile;
+
+    if (!filename || !m_backend) { return INVALID_HANDLE; }
+    if (strlen(filename) >= MULTIPLEXED_STORAGE_MAX_PATH) { return INVALID_HANDLE; }
+    if (!forWrite && !m_backend->fileExists(filename)) { return INVALID_HANDLE; }
+
+    for (file = 0; file < MULTIPLEXED_STORAGE_MAX_FILES; ++file)
+    {
+        if (!m_files[file].inUse) { break; }
+    }
+
+    if (file == MULTIPLEXED_STORAGE_MAX_FILES) { return INVALID_HANDLE; }
+
+    pFile = &m_files[file];
+    pFile->inUse = true;
+    pFile->forWrite = forWrite;
+    strcpy(pFile->path, filename);
+    pFile->position = 0;
+    pFile->writeLength = 0;
+    readAheadInit(&pFile->readAhead, pFile->data, MULTIPLEXED_STORAGE_BLOCK_SIZE, pFile);
+
+    return file;
+}
+
+/*
+ * closeFile
+ *
+ * Appends anything still buffered for a file opened for write, and frees the handle
+ */
+void MultiplexedStorage::closeFile(FILE_HANDLE file)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile) { return; }
+
+    if (pFile->forWrite) { flush(file); }
+
+    if (m_active == file) { deactivate(); }
+
+    pFile->inUse = false;
+}
+
+/*
+ * endOfFile
+ *
+ * Reads the next block into the handle's buffer if it is empty, to find out if there is any more
+ */
+bool MultiplexedStorage::endOfFile(FILE_HANDLE file)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile || pFile->forWrite) { return true; }
+
+    if (!readAheadIsEmpty(&pFile->readAhead)) { return false; }
+
+    pFile->readAhead.start = 0;
+    pFile->readAhead.end = readFromFile(pFile->data, MULTIPLEXED_STORAGE_BLOCK_SIZE, pFile);
+
+    return readAheadIsEmpty(&pFile->readAhead);
+}
+
+void MultiplexedStorage::setEcho(bool set)
+{
+    m_backend->setEcho(set);
+}
+
+/*
+ * removeFile
+ *
+ * Anything buffered for the removed file is discarded, and handles reading it go back to the start
+ */
+void MultiplexedStorage::removeFile(char const * const dirPath)
+{
+    FILE_HANDLE file;
+    MULTIPLEXED_FILE * pFile;
+
+    if (!dirPath) { return; }
+
+    for (file = 0; file < MULTIPLEXED_STORAGE_MAX_FILES; ++file)
+    {
+        pFile = &m_files[file];
+        if (!pFile->inUse || (strcmp(pFile->path, dirPath) != 0)) { continue; }
+
+        if (m_active == file) { deactivate(); }
+
+        pFile->writeLength = 0;
+        pFile->position = 0;
+        readAheadReset(&pFile->readAhead);
+    }
+
+    m_backend->removeFile(dirPath);
+}
+
+/*
+ * flush
+ *
+ * Appends anything buffered for a file opened for write.
+ * Returns false if it could not be appended (it is kept).
+ */
+bool MultiplexedStorage::flush(FILE_HANDLE file)
+{
+    MULTIPLEXED_FILE * pFile = getFile(file);
+
+    if (!pFile || !pFile->forWrite) { return false; }
+    if (pFile->writeLength == 0) { return true; }
+    if (!activate(file)) { return false; }
+
+    pFile->data[pFile->writeLength] = '\0';
+    m_backend->write(m_backendHandle, pFile->data);
+    pFile->writeLength = 0;
+
+    return true;
+}
+
+uint32_t MultiplexedStorage::switchCount(void)
+{
+    return m_switchCount;
+}
+
+/*
+ * Private Class Functions
+ */
+
+MULTIPLEXED_FILE * MultiplexedStorage::getFile(FILE_HANDLE file)
+{
+    if ((file < 0) || (file >= MULTIPLEXED_STORAGE_MAX_FILES)) { return NULL; }
+    return m_files[file].inUse ? &m_files[file] : NULL;
+}
+
+/*
+ * activate
+ *
+ * Makes the backend have file open (closing whatever it had open before) at the file's position
+ */
+bool MultiplexedStorage::activate(FILE_HANDLE file)
+{
+    MULTIPLEXED_FILE * pFile = &m_files[file];
+
+    if (m_active == file) { return true; }
+
+    deactivate();
+
+    m_backendHandle = m_backend->openFile(pFile->path, pFile->forWrite);
+    if (m_backendHandle == INVALID_HANDLE) { return false; }
+
+    m_switchCount++;
+
+    if (!pFile->forWrite && (pFile->position > 0) && !m_backend->seek(m_backendHandle, pFile->position))
+    {
+        m_backend->closeFile(m_backendHandle);
+        return false;
+    }
+
+    m_active = file;
+    return true;
+}
+
+void MultiplexedStorage::deactivate(void)
+{
+    if (m_active == INVALID_HANDLE) { return; }
+
+    m_backend->closeFile(m_backendHandle);
+    m_active = INVALID_HANDLE;
+}
+
+/*
+ * readFromFile
+ *
+ * READBLOCKFN for the handles' read-ahead buffers (context is the handle's MULTIPLEXED_FILE):
+ * makes the backend have the handle's file open and reads the next block of it
+ */
+uint32_t MultiplexedStorage::readFromFile(char * buffer, uint32_t n, void * context)
+{
+    MULTIPLEXED_FILE * pFile = (MULTIPLEXED_FILE *)context;
+    MultiplexedStorage * pStorage;
+    uint32_t count;
+
+    if (!pFile || !pFile->storage) { return 0; }
+
+    pStorage = pFile->storage;
+    if (!pStorage->activate(pFile - pStorage->m_files)) { return 0; }
+
+    count = pStorage->m_backend->readBytes(pStorage->m_backendHandle, buffer, n);
+    pFile->position += count;
+
+    return count;
+}
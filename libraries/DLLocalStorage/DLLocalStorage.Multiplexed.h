@@ -0,0 +1,81 @@
+#ifndef _LOCAL_STORAGE_MULTIPLEXED_H_
+#define _LOCAL_STORAGE_MULTIPLEXED_H_
+
+/*
+ * MultiplexedStorage
+ *
+ * Gives out real file handles over a backend that can only have one file open at a time
+ * (such as LinkItOneSD, where opening a file closes the last one).
+ * Each handle keeps its own path, mode and read position, so e.g. an upload can read
+ * through one file while the logger appends to another.
+ *
+ * The backend only has one of the files open at a time. Another file is only opened
+ * (and seeked back to its read position) when a handle that is not the open one needs
+ * the backend, and each handle has a block buffer so that this is as rare as possible:
+ * reads are made a block at a time, and writes are collected and appended a block at a time
+ * (or when the handle is flushed or closed).
+ *
+ * Files opened for write are always appended to.
+ */
+
+#define MULTIPLEXED_STORAGE_MAX_FILES (4)
+#define MULTIPLEXED_STORAGE_BLOCK_SIZE (512)
+#define MULTIPLEXED_STORAGE_MAX_PATH (64)
+
+class MultiplexedStorage;
+
+struct multiplexed_file
+{
+    MultiplexedStorage * storage; // The storage the handle belongs to (for reads through readAhead)
+    bool inUse;
+    bool forWrite;
+    char path[MULTIPLEXED_STORAGE_MAX_PATH];
+    uint32_t position; // For read: where the backend should be in the file for the next read
+    char data[MULTIPLEXED_STORAGE_BLOCK_SIZE + 1];
+    READ_AHEAD readAhead; // For read: data read from the file but not yet returned
+    uint16_t writeLength; // For write: data waiting to be appended
+};
+typedef struct multiplexed_file MULTIPLEXED_FILE;
+
+class MultiplexedStorage : public LocalStorageInterface
+{
+    public:
+        MultiplexedStorage(LocalStorageInterface * backend);
+
+        bool inError();
+        bool fileExists(char const * const filePath);
+        bool directoryExists(char const * const dirPath);
+        bool mkDir(char const * const dirPath);
+        void write(FILE_HANDLE file, char const * const toWrite);
+        uint32_t readBytes(FILE_HANDLE file, char * buffer, uint32_t n);
+        uint32_t readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF);
+        bool seek(FILE_HANDLE file, uint32_t position);
+        uint32_t fileSize(FILE_HANDLE file);
+        FILE_HANDLE openFile(char const * const filename, bool forWrite);
+        void closeFile(FILE_HANDLE file);
+        bool endOfFile(FILE_HANDLE file);
+        void setEcho(bool set);
+        void removeFile(char const * const dirPath);
+
+        bool flush(FILE_HANDLE file);
+
+        /* Number of times the backend has had to open a different file */
+        uint32_t switchCount(void);
+
+    private:
+        MULTIPLEXED_FILE * getFile(FILE_HANDLE file);
+        bool activate(FILE_HANDLE file);
+        void deactivate(void);
+        static uint32_t readFromFile(char * buffer, uint32_t n, void * context);
+
+        LocalStorageInterface * m_backend;
+        MULTIPLEXED_FILE m_files[MULTIPLEXED_STORAGE_MAX_FILES];
+
+        // The handle whose file the backend has open, and the backend's handle for it
+        FILE_HANDLE m_active;
+        FILE_HANDLE m_backendHandle;
+
+        uint32_t m_switchCount;
+};
+
+#endif
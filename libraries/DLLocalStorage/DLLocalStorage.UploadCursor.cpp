@@ -0,0 +1,271 @@
+/*
+ * DLLocalStorage.UploadCursor.cpp
+ *
+ * Persistent record of how far stored data has been uploaded
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Arduino/C++ Library Includes
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.CRC.h"
+#include "DLUtility.Strings.h"
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.UploadCursor.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+// Chars of the header covered by the CRC (sequence, offset and row), before the filename
+#define CRC_START (1)
+#define CRC_LENGTH (24)
+#define CRC_POSITION (CRC_START + CRC_LENGTH)
+
+/*
+ * Private Functions
+ */
+
+static uint16_t cursorCRC(char const * line, char const * filename, uint32_t filenameLength)
+{
+    uint16_t crc = crc16Update(CRC16_INITIAL_VALUE, &line[CRC_START], CRC_LENGTH);
+    return crc16Update(crc, filename, filenameLength);
+}
+
+/*
+ * Public Class Functions
+ */
+
+UploadCursor::UploadCursor(LocalStorageInterface * storage, char const * const slotA, char const * const slotB)
+{
+    m_storage = storage;
+    m_slots[0] = slotA;
+    m_slots[1] = slotB;
+
+    memset(&m_position, 0, sizeof(m_position));
+    m_slot = 1; // So that the first save is to slot A
+}
+
+/*
+ * load
+ *
+ * Gets the newest good cursor from the slots. Returns false if neither slot has one.
+ */
+bool UploadCursor::load(void)
+{
+    UPLOAD_CURSOR_POSITION positions[2];
+    bool valid[2];
+    uint8_t newest;
+
+    valid[0] = readSlot(0, &positions[0]);
+    valid[1] = readSlot(1, &positions[1]);
+
+    if (!valid[0] && !valid[1]) { return false; }
+
+    if (valid[0] && valid[1])
+    {
+        newest = (positions[1].sequence > positions[0].sequence) ? 1 : 0;
+    }
+    else
+    {
+        newest = valid[1] ? 1 : 0;
+    }
+
+    m_position = positions[newest];
+    m_slot = newest;
+    return true;
+}
+
+bool UploadCursor::isSet(void)
+{
+    return m_position.sequence > 0;
+}
+
+/*
+ * save
+ *
+ * Writes the cursor to the older slot and reads it back. If that fails, the cursor is not changed,
+ * and the next save goes to the same slot (the other slot still has the last good cursor).
+ */
+bool UploadCursor::save(char const * const filename, uint32_t offset, uint32_t row)
+{
+    UPLOAD_CURSOR_POSITION saved;
+    uint32_t filenameLength;
+    uint8_t slot = 1 - m_slot;
+    FILE_HANDLE file;
+
+    if (!filename || !m_storage) { return false; }
+
+    filenameLength = strlen(filename);
+    if (filenameLength >= UPLOAD_CURSOR_MAX_PATH) { return false; }
+
+    m_line[0] = 'U';
+    writeHex(&m_line[1], m_position.sequence + 1, 8);
+    writeHex(&m_line[9], offset, 8);
+    writeHex(&m_line[17], row, 8);
+    writeHex(&m_line[CRC_POSITION], cursorCRC(m_line, filename, filenameLength), 4);
+    m_line[UPLOAD_CURSOR_HEADER_LENGTH - 1] = ' ';
+    memcpy(&m_line[UPLOAD_CURSOR_HEADER_LENGTH], filename, filenameLength);
+    m_line[UPLOAD_CURSOR_HEADER_LENGTH + filenameLength] = '\n';
+    m_line[UPLOAD_CURSOR_HEADER_LENGTH + filenameLength + 1] = '\0';
+
+    // Files are appended to, so the slot has to be removed to overwrite it
+    m_storage->removeFile(m_slots[slot]);
+
+    file = m_storage->openFile(m_slots[slot], true);
+    if (file == INVALID_HANDLE) { return false; }
+
+    m_storage->write(file, m_line);
+    m_storage->closeFile(file);
+
+    if (!readSlot(slot, &saved) || (saved.sequence != (m_position.sequence + 1))) { return false; }
+
+    m_position = saved;
+    m_slot = slot;
+    return true;
+}
+
+/*
+ * advance
+ *
+ * Moves the cursor on by the length and rows given by readRows, once they have been uploaded
+ */
+bool UploadCursor::advance(uint32_t length, uint32_t rows)
+{
+    if (!isSet()) { return false; }
+    if ((length == 0) && (rows == 0)) { return true; }
+
+    return save(m_position.filename, m_position.offset + length, m_position.row + rows);
+}
+
+/*
+ * rollover
+ *
+ * Moves the cursor to the start of nextFilename, once the current file has been uploaded
+ */
+bool UploadCursor::rollover(char const * const nextFilename)
+{
+    return save(nextFilename, 0, m_position.row);
+}
+
+/*
+ * openAtCursor
+ *
+ * Opens the cursor's file for read, at the cursor's offset
+ */
+FILE_HANDLE UploadCursor::openAtCursor(void)
+{
+    FILE_HANDLE file;
+
+    if (!isSet() || !m_storage) { return INVALID_HANDLE; }
+
+    file = m_storage->openFile(m_position.filename, false);
+    if (file == INVALID_HANDLE) { return INVALID_HANDLE; }
+
+    if ((m_position.offset > 0) && !m_storage->seek(file, m_position.offset))
+    {
+        m_storage->closeFile(file);
+        return INVALID_HANDLE;
+    }
+
+    return file;
+}
+
+/*
+ * readRows
+ *
+ * Reads up to maxRows whole lines from the cursor into buffer, without moving the cursor.
+ * A line without a line feed (not finished being written, or too long for the rest of buffer)
+ * is left for the next call, so buffer must have space for the longest row.
+ * Returns the number of rows read, and their total length in pLength (to pass to advance()).
+ */
+uint16_t UploadCursor::readRows(char * buffer, uint16_t size, uint16_t maxRows, uint32_t * pLength)
+{
+    FILE_HANDLE file;
+    uint16_t rows = 0;
+    uint32_t used = 0;
+    uint32_t length;
+
+    if (pLength) { *pLength = 0; }
+    if (!buffer || (size < 2)) { return 0; }
+
+    buffer[0] = '\0';
+
+    file = openAtCursor();
+    if (file == INVALID_HANDLE) { return 0; }
+
+    while ((rows < maxRows) && ((size - used) > 1))
+    {
+        length = m_storage->readLine(file, &buffer[used], size - used - 1, false);
+
+        // A partial row (the end of the file, or one too long for the buffer) is left for next time
+        if ((length == 0) || (buffer[used + length - 1] != '\n')) { break; }
+
+        used += length;
+        rows++;
+    }
+
+    buffer[used] = '\0';
+    m_storage->closeFile(file);
+
+    if (pLength) { *pLength = used; }
+    return rows;
+}
+
+char const * UploadCursor::filename(void) { return m_position.filename; }
+uint32_t UploadCursor::offset(void) { return m_position.offset; }
+uint32_t UploadCursor::row(void) { return m_position.row; }
+uint32_t UploadCursor::sequence(void) { return m_position.sequence; }
+
+/*
+ * Private Class Functions
+ */
+
+bool UploadCursor::readSlot(uint8_t slot, UPLOAD_CURSOR_POSITION * pPosition)
+{
+    FILE_HANDLE file;
+    uint32_t length;
+    uint32_t filenameLength;
+    uint32_t crc;
+
+    if (!m_slots[slot] || !m_storage->fileExists(m_slots[slot])) { return false; }
+
+    file = m_storage->openFile(m_slots[slot], false);
+    if (file == INVALID_HANDLE) { return false; }
+
+    length = m_storage->readLine(file, m_line, UPLOAD_CURSOR_LINE_SIZE - 1, false);
+    m_storage->closeFile(file);
+
+    if ((length < (UPLOAD_CURSOR_HEADER_LENGTH + 2)) || (m_line[length - 1] != '\n')) { return false; }
+    if ((m_line[0] != 'U') || (m_line[UPLOAD_CURSOR_HEADER_LENGTH - 1] != ' ')) { return false; }
+
+    filenameLength = length - UPLOAD_CURSOR_HEADER_LENGTH - 1;
+    if (filenameLength >= UPLOAD_CURSOR_MAX_PATH) { return false; }
+
+    if (!readHex(&m_line[1], 8, &pPosition->sequence)) { return false; }
+    if (!readHex(&m_line[9], 8, &pPosition->offset)) { return false; }
+    if (!readHex(&m_line[17], 8, &pPosition->row)) { return false; }
+    if (!readHex(&m_line[CRC_POSITION], 4, &crc)) { return false; }
+
+    if (cursorCRC(m_line, &m_line[UPLOAD_CURSOR_HEADER_LENGTH], filenameLength) != crc) { return false; }
+
+    memcpy(pPosition->filename, &m_line[UPLOAD_CURSOR_HEADER_LENGTH], filenameLength);
+    pPosition->filename[filenameLength] = '\0';
+
+    return pPosition->sequence > 0;
+}
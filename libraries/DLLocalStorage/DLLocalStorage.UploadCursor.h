@@ -0,0 +1,67 @@
+#ifndef _LOCAL_STORAGE_UPLOAD_CURSOR_H_
+#define _LOCAL_STORAGE_UPLOAD_CURSOR_H_
+
+/*
+ * UploadCursor
+ *
+ * Persistent record of how far stored data has been uploaded: the file, the byte offset
+ * of the next row to upload in that file, and the number of rows uploaded so far.
+ * After a restart, load() gets the cursor back and uploads carry on from the offset
+ * (with a seek, not by reading the file from the start).
+ *
+ * The cursor is kept in two slot files, written alternately, each holding one line:
+ * "U", a sequence number, the offset and the row count (8 hex chars each), a CRC16 of
+ * those and the filename (4 hex chars), a space, then the filename.
+ * Each save overwrites the older slot, so if power is lost while it is written, the other
+ * slot still has the previous cursor. load() takes the newest slot with a good CRC.
+ *
+ * When a file has been uploaded to the end, rollover() moves the cursor to the start of the next
+ * file, keeping the row count.
+ */
+
+#define UPLOAD_CURSOR_MAX_PATH (64)
+#define UPLOAD_CURSOR_HEADER_LENGTH (30)
+#define UPLOAD_CURSOR_LINE_SIZE (UPLOAD_CURSOR_HEADER_LENGTH + UPLOAD_CURSOR_MAX_PATH + 2)
+
+struct upload_cursor_position
+{
+    uint32_t sequence; // Incremented on each save, 0 if nothing has been saved
+    uint32_t offset;
+    uint32_t row;
+    char filename[UPLOAD_CURSOR_MAX_PATH];
+};
+typedef struct upload_cursor_position UPLOAD_CURSOR_POSITION;
+
+class UploadCursor
+{
+    public:
+        UploadCursor(LocalStorageInterface * storage, char const * const slotA, char const * const slotB);
+
+        bool load(void);
+        bool isSet(void);
+
+        bool save(char const * const filename, uint32_t offset, uint32_t row);
+        bool advance(uint32_t length, uint32_t rows);
+        bool rollover(char const * const nextFilename);
+
+        FILE_HANDLE openAtCursor(void);
+        uint16_t readRows(char * buffer, uint16_t size, uint16_t maxRows, uint32_t * pLength);
+
+        char const * filename(void);
+        uint32_t offset(void);
+        uint32_t row(void);
+        uint32_t sequence(void);
+
+    private:
+        bool readSlot(uint8_t slot, UPLOAD_CURSOR_POSITION * pPosition);
+
+        LocalStorageInterface * m_storage;
+        char const * m_slots[2];
+
+        UPLOAD_CURSOR_POSITION m_position;
+        uint8_t m_slot; // The slot holding m_position
+
+        char m_line[UPLOAD_CURSOR_LINE_SIZE];
+};
+
+#endif
@@ -18,13 +18,17 @@ typedef int8_t FILE_HANDLE;
 class LocalStorageInterface
 {
     public:
-        virtual bool inError();
+        virtual bool inError() = 0;
         virtual bool fileExists(char const * const filePath) = 0;
         virtual bool directoryExists(char const * const dirPath) = 0;
         virtual bool mkDir(char const * const dirPath) = 0;
         virtual void write(FILE_HANDLE file, char const * const toWrite) = 0;
         virtual uint32_t readBytes(FILE_HANDLE file, char * buffer, uint32_t n) = 0;
         virtual uint32_t readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF) = 0;
+        /* Moves to position (from the start) of a file open for read */
+        virtual bool seek(FILE_HANDLE file, uint32_t position) = 0;
+        /* Size in bytes of a file open for read */
+        virtual uint32_t fileSize(FILE_HANDLE file) = 0;
         virtual FILE_HANDLE openFile(char const * const filename, bool forWrite) = 0;
         virtual void closeFile(FILE_HANDLE file) = 0;
         virtual bool endOfFile(FILE_HANDLE file) = 0;
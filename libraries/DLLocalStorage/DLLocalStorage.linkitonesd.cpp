@@ -40,6 +40,10 @@ static LFile s_file;
 static bool s_fileIsOpenForRead = false;
 static bool s_fileIsOpenForWrite = false;
 
+// Reads are made a block at a time into here, rather than one byte at a time from the file
+static char s_readAheadData[512];
+static READ_AHEAD s_readAhead = {s_readAheadData, sizeof(s_readAheadData), 0, 0, NULL};
+
 /*
  * Public Functions
  */
@@ -72,14 +76,17 @@ bool LinkItOneSD::mkDir(char const * const dirPath)
     return LSD.mkdir((char*)dirPath);
 }
 
-static char readOneByteFromFile(void)
+static uint32_t readBlockFromFile(char * buffer, uint32_t n, void * context)
 {
-	return s_file.available() ? s_file.read() : '\0';
+	(void)context; // There is only one file
+	int readCount = s_file.read(buffer, n);
+	return (readCount > 0) ? readCount : 0;
 }
 
 FILE_HANDLE LinkItOneSD::openFile(char const * const filename, bool forWrite)
 {
     s_file.close(); // Ensure previous file (if any) is closed
+    readAheadReset(&s_readAhead);
     s_file = LSD.open(filename, forWrite ? FILE_WRITE : FILE_READ);
 
     if (s_file)
@@ -137,8 +144,10 @@ uint32_t LinkItOneSD::readBytes(FILE_HANDLE file, char * buffer, uint32_t n)
 
 	if (fileAvailableForRead && buffer)
 	{
-		return s_file.read(buffer, n);
+		return readBytesWithReadAhead(&s_readAhead, readBlockFromFile, buffer, n);
 	}
+
+	return 0;
 }
 
 uint32_t LinkItOneSD::readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF)
@@ -149,26 +158,43 @@ uint32_t LinkItOneSD::readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool
 	fileAvailableForRead &= s_fileIsOpenForRead;
 
 	uint32_t readCount = 0;
-	bool eol = false;
 
 	if (fileAvailableForRead && buffer)
 	{
-		readCount = readLineWithReadFunction(readOneByteFromFile, buffer, n, stripCRLF);
+		readCount = readLineWithReadAhead(&s_readAhead, readBlockFromFile, buffer, n, stripCRLF);
 	}
 
 	return readCount;
 }
 
+bool LinkItOneSD::seek(FILE_HANDLE file, uint32_t position)
+{
+	(void)file; // The LinkIt ONE can only support one open file at a time, so discard handle
+
+	if (!s_fileIsOpenForRead) { return false; }
+
+	readAheadReset(&s_readAhead);
+	return s_file.seek(position);
+}
+
+uint32_t LinkItOneSD::fileSize(FILE_HANDLE file)
+{
+	(void)file; // The LinkIt ONE can only support one open file at a time, so discard handle
+
+	return s_fileIsOpenForRead ? s_file.size() : 0;
+}
+
 bool LinkItOneSD::endOfFile(FILE_HANDLE file)
 {
 	(void)file; // The LinkIt ONE can only support one open file at a time, so discard handle
-	return !s_file.available();
+	return readAheadIsEmpty(&s_readAhead) && !s_file.available();
 }
 
 void LinkItOneSD::closeFile(FILE_HANDLE file)
 {
     (void)file; // The LinkIt ONE can only support one open file at a time, so discard handle
     s_file.close();
+    readAheadReset(&s_readAhead);
     s_fileIsOpenForWrite = false;
     s_fileIsOpenForRead = false;
 }
@@ -16,6 +16,8 @@ class LinkItOneSD : public LocalStorageInterface
         void write(FILE_HANDLE file, char const * const toWrite);
         uint32_t readBytes(FILE_HANDLE file, char * buffer, uint32_t n);
         uint32_t readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF);
+        bool seek(FILE_HANDLE file, uint32_t position);
+        uint32_t fileSize(FILE_HANDLE file);
         FILE_HANDLE openFile(char const * const filename, bool forWrite = false);
         bool endOfFile(FILE_HANDLE file);
         void closeFile(FILE_HANDLE file);
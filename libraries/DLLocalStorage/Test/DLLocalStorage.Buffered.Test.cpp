@@ -0,0 +1,274 @@
+/*
+ * DLLocalStorage.Buffered.Test.cpp
+ *
+ * Tests the BufferedStorage class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.Buffered.h"
+#include "DLTest.Mock.LocalStorage.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+#define xstr(s) str(s)
+#define str(s) #s
+#define QUOTED_DL_PATH xstr(DL_PATH)
+
+#define BUFFERED_DIRECTORY QUOTED_DL_PATH "/DLLocalStorage/Test/Buffered"
+#define LOG_FILE BUFFERED_DIRECTORY "/LOG.CSV"
+#define OTHER_FILE BUFFERED_DIRECTORY "/OTHER.CSV"
+
+// Records the length of each write that reaches the files
+class CountingStorage : public TestStorageInterface
+{
+    public:
+        void write(FILE_HANDLE file, char const * const toWrite)
+        {
+            writeLengths.push_back(strlen(toWrite));
+            TestStorageInterface::write(file, toWrite);
+        }
+
+        std::vector<size_t> writeLengths;
+};
+
+static CountingStorage s_backend;
+static unsigned long s_time;
+
+static unsigned long testClock(void)
+{
+    return s_time;
+}
+
+void setUp(void)
+{
+    if (!s_backend.directoryExists(BUFFERED_DIRECTORY)) { s_backend.mkDir(BUFFERED_DIRECTORY); }
+    s_backend.removeFile(LOG_FILE);
+    s_backend.removeFile(OTHER_FILE);
+    s_backend.writeLengths.clear();
+    s_time = 0;
+}
+
+void tearDown(void) {}
+
+static std::string readFile(char const * filename)
+{
+    std::ifstream file(filename);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// One row written in pieces, as logging code does
+static void writeRow(LocalStorageInterface * storage)
+{
+    FILE_HANDLE file = storage->openFile(LOG_FILE, true);
+    storage->write(file, "2015-04-03 13:09:34 +0000");
+    storage->write(file, ",12.345");
+    storage->write(file, "\r\n");
+    storage->closeFile(file);
+}
+
+static void test_PiecesOfARowAreWrittenTogetherOnClose(void)
+{
+    BufferedStorage storage(&s_backend, testClock);
+
+    writeRow(&storage);
+    writeRow(&storage);
+
+    TEST_ASSERT_EQUAL(2, s_backend.writeLengths.size());
+    TEST_ASSERT_EQUAL(34, s_backend.writeLengths[0]);
+
+    std::string contents = readFile(LOG_FILE);
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34 +0000,12.345\r\n2015-04-03 13:09:34 +0000,12.345\r\n", contents.c_str());
+}
+
+static void test_OnlyWholeBlocksAreWrittenWithoutFlushOnClose(void)
+{
+    uint16_t i;
+
+    BufferedStorage storage(&s_backend, testClock);
+    storage.setFlushOnClose(false);
+
+    // 34 byte rows: 16 rows is one block and 32 bytes
+    for (i = 0; i < 16; ++i) { writeRow(&storage); }
+
+    TEST_ASSERT_EQUAL(1, s_backend.writeLengths.size());
+    TEST_ASSERT_EQUAL(BUFFERED_STORAGE_BLOCK_SIZE, s_backend.writeLengths[0]);
+    TEST_ASSERT_EQUAL(32, storage.pendingLength());
+    TEST_ASSERT_TRUE(storage.fileExists(LOG_FILE));
+
+    TEST_ASSERT_TRUE(storage.flush());
+    TEST_ASSERT_EQUAL(2, s_backend.writeLengths.size());
+    TEST_ASSERT_EQUAL(16 * 34, readFile(LOG_FILE).length());
+}
+
+static void test_BlocksStayAlignedAfterAPartialFlush(void)
+{
+    std::string data(600, 'A');
+
+    BufferedStorage storage(&s_backend, testClock);
+    storage.setFlushOnClose(false);
+
+    FILE_HANDLE file = storage.openFile(LOG_FILE, true);
+    storage.write(file, data.substr(0, 100).c_str());
+    TEST_ASSERT_TRUE(storage.flush());
+
+    // The next write to the backend finishes the first block
+    storage.write(file, data.c_str());
+    TEST_ASSERT_EQUAL(2, s_backend.writeLengths.size());
+    TEST_ASSERT_EQUAL(412, s_backend.writeLengths[1]);
+    TEST_ASSERT_EQUAL(188, storage.pendingLength());
+
+    BUFFERED_STORAGE_STATS stats;
+    storage.getStats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.backendWrites);
+    TEST_ASSERT_EQUAL(2, stats.sectors);
+    TEST_ASSERT_EQUAL(3, stats.unbufferedSectors);
+}
+
+static void test_BlocksStayAlignedWhenAppendingToAnExistingFile(void)
+{
+    std::string data(600, 'A');
+
+    // 100 bytes already in the file, e.g. from before a restart
+    FILE_HANDLE file = s_backend.openFile(LOG_FILE, true);
+    s_backend.write(file, data.substr(0, 100).c_str());
+    s_backend.closeFile(file);
+    s_backend.writeLengths.clear();
+
+    BufferedStorage storage(&s_backend, testClock);
+    storage.setFlushOnClose(false);
+
+    // The first write to the backend finishes the file's first block
+    file = storage.openFile(LOG_FILE, true);
+    storage.write(file, data.c_str());
+    TEST_ASSERT_EQUAL(1, s_backend.writeLengths.size());
+    TEST_ASSERT_EQUAL(412, s_backend.writeLengths[0]);
+    TEST_ASSERT_EQUAL(188, storage.pendingLength());
+
+    TEST_ASSERT_TRUE(storage.flush());
+
+    BUFFERED_STORAGE_STATS stats;
+    storage.getStats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.backendWrites);
+    TEST_ASSERT_EQUAL(2, stats.sectors);
+    TEST_ASSERT_EQUAL(2, stats.unbufferedSectors);
+    TEST_ASSERT_EQUAL(700, readFile(LOG_FILE).length());
+}
+
+static void test_OldDataIsWrittenOutByService(void)
+{
+    BufferedStorage storage(&s_backend, testClock);
+    storage.setFlushOnClose(false);
+    storage.setMaxAge(1000);
+
+    s_time = 5000;
+    writeRow(&storage);
+
+    s_time = 5999;
+    TEST_ASSERT_TRUE(storage.service());
+    TEST_ASSERT_EQUAL(0, s_backend.writeLengths.size());
+
+    s_time = 6000;
+    TEST_ASSERT_TRUE(storage.service());
+    TEST_ASSERT_EQUAL(1, s_backend.writeLengths.size());
+    TEST_ASSERT_EQUAL(0, storage.pendingLength());
+}
+
+static void test_ReadsAndOtherFilesSeeBufferedData(void)
+{
+    char line[64];
+
+    BufferedStorage storage(&s_backend, testClock);
+    storage.setFlushOnClose(false);
+
+    writeRow(&storage);
+
+    // Opening another file for write writes out the first
+    FILE_HANDLE file = storage.openFile(OTHER_FILE, true);
+    TEST_ASSERT_EQUAL(1, s_backend.writeLengths.size());
+    storage.write(file, "OTHER\r\n");
+    storage.closeFile(file);
+
+    // Opening for read writes out the buffer
+    file = storage.openFile(OTHER_FILE, false);
+    TEST_ASSERT_EQUAL(2, s_backend.writeLengths.size());
+    storage.readLine(file, line, sizeof(line), true);
+    storage.closeFile(file);
+    TEST_ASSERT_EQUAL_STRING("OTHER", line);
+
+    // Removing a file drops anything buffered for it
+    file = storage.openFile(LOG_FILE, true);
+    storage.write(file, "DROPPED");
+    storage.closeFile(file);
+    storage.removeFile(LOG_FILE);
+    TEST_ASSERT_EQUAL(0, storage.pendingLength());
+    TEST_ASSERT_FALSE(storage.fileExists(LOG_FILE));
+}
+
+static void test_AnHourOfRowsIsWrittenInWholeBlocks(void)
+{
+    uint16_t second;
+    BUFFERED_STORAGE_STATS stats;
+
+    BufferedStorage storage(&s_backend, testClock);
+    storage.setFlushOnClose(false);
+    storage.setMaxAge(60000);
+
+    for (second = 0; second < 3600; ++second)
+    {
+        s_time = second * 1000UL;
+        writeRow(&storage);
+        storage.service();
+    }
+    storage.flush();
+    storage.getStats(&stats);
+
+    // 3600 rows of 34 bytes, in three pieces each
+    TEST_ASSERT_EQUAL(10800, stats.writeCalls);
+    TEST_ASSERT_EQUAL(122400, stats.bytes);
+    TEST_ASSERT_EQUAL(239, stats.fullBlocks);
+    TEST_ASSERT_EQUAL(240, stats.backendWrites);
+    TEST_ASSERT_EQUAL(240, stats.sectors);
+    TEST_ASSERT_TRUE(stats.unbufferedSectors >= stats.writeCalls);
+    TEST_ASSERT_EQUAL(0, stats.droppedBytes);
+    TEST_ASSERT_EQUAL(122400, readFile(LOG_FILE).length());
+}
+
+int main(void)
+{
+    UnityBegin("DLLocalStorage.Buffered.Test.cpp");
+
+    RUN_TEST(test_PiecesOfARowAreWrittenTogetherOnClose);
+    RUN_TEST(test_OnlyWholeBlocksAreWrittenWithoutFlushOnClose);
+    RUN_TEST(test_BlocksStayAlignedAfterAPartialFlush);
+    RUN_TEST(test_BlocksStayAlignedWhenAppendingToAnExistingFile);
+    RUN_TEST(test_OldDataIsWrittenOutByService);
+    RUN_TEST(test_ReadsAndOtherFilesSeeBufferedData);
+    RUN_TEST(test_AnHourOfRowsIsWrittenInWholeBlocks);
+
+    UnityEnd();
+    return 0;
+}
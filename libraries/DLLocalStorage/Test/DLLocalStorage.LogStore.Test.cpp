@@ -0,0 +1,252 @@
+/*
+ * DLLocalStorage.LogStore.Test.cpp
+ *
+ * Tests the LogStore class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Readline.h"
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.Multiplexed.h"
+#include "DLLocalStorage.LogStore.h"
+#include "DLTest.Mock.LocalStorage.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+#define xstr(s) str(s)
+#define str(s) #s
+#define QUOTED_DL_PATH xstr(DL_PATH)
+
+#define LOG_STORE_DIRECTORY QUOTED_DL_PATH "/DLLocalStorage/Test/LogStore"
+#define LOG_FILE LOG_STORE_DIRECTORY "/D15-04-03.LOG"
+#define CSV_FILE LOG_STORE_DIRECTORY "/D15-04-03.CSV"
+
+// Counts the bytes read from files, to check how much of the log is read when it is opened
+class CountingStorage : public TestStorageInterface
+{
+    public:
+        uint32_t readBytes(FILE_HANDLE file, char * buffer, uint32_t n)
+        {
+            uint32_t count = TestStorageInterface::readBytes(file, buffer, n);
+            bytesRead += count;
+            return count;
+        }
+
+        uint32_t readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF)
+        {
+            uint32_t count = TestStorageInterface::readLine(file, buffer, n, stripCRLF);
+            bytesRead += count;
+            return count;
+        }
+
+        uint32_t bytesRead;
+};
+
+static CountingStorage s_storage;
+
+void setUp(void)
+{
+    if (!s_storage.directoryExists(LOG_STORE_DIRECTORY)) { s_storage.mkDir(LOG_STORE_DIRECTORY); }
+    s_storage.removeFile(LOG_FILE);
+    s_storage.removeFile(CSV_FILE);
+    s_storage.bytesRead = 0;
+}
+
+void tearDown(void) {}
+
+static std::string readFile(char const * filename)
+{
+    std::ifstream file(filename);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void appendToFile(char const * filename, std::string const& data)
+{
+    std::ofstream file(filename, std::ios::app);
+    file << data;
+}
+
+static void appendRows(LogStore * pStore, uint16_t first, uint16_t count)
+{
+    char row[32];
+    uint16_t i;
+
+    for (i = first; i < (first + count); ++i)
+    {
+        sprintf(row, "2015-04-03 13:09:34,%u", i);
+        TEST_ASSERT_TRUE(pStore->append(row));
+    }
+}
+
+static void test_AppendedRecordsAreReadBack(void)
+{
+    LOG_STORE_READER reader;
+    LogStore store(&s_storage, 16);
+
+    TEST_ASSERT_TRUE(store.open(LOG_FILE));
+    TEST_ASSERT_EQUAL(0, store.recordCount());
+
+    appendRows(&store, 0, 3);
+    TEST_ASSERT_EQUAL(3, store.recordCount());
+    TEST_ASSERT_FALSE(store.append("TWO\nLINES"));
+
+    TEST_ASSERT_TRUE(store.startReading(&reader, 0));
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34,0", store.next(&reader));
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34,1", store.next(&reader));
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34,2", store.next(&reader));
+    TEST_ASSERT_NULL(store.next(&reader));
+    store.stopReading(&reader);
+
+    TEST_ASSERT_EQUAL(store.size(), readFile(LOG_FILE).length());
+}
+
+static void test_ReadingResumesFromAnOffset(void)
+{
+    LOG_STORE_READER reader;
+    uint32_t offset;
+    LogStore store(&s_storage, 2);
+
+    TEST_ASSERT_TRUE(store.open(LOG_FILE));
+    appendRows(&store, 0, 5);
+
+    TEST_ASSERT_TRUE(store.startReading(&reader, 0));
+    store.next(&reader);
+    store.next(&reader);
+    offset = reader.offset;
+    store.stopReading(&reader);
+
+    // The commit marker after the second record is skipped
+    TEST_ASSERT_TRUE(store.startReading(&reader, offset));
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34,2", store.next(&reader));
+    store.stopReading(&reader);
+}
+
+static void test_OpeningOnlyReadsTheEndOfTheLog(void)
+{
+    LogStore store(&s_storage, 16);
+
+    TEST_ASSERT_TRUE(store.open(LOG_FILE));
+    appendRows(&store, 0, 1000);
+    uint32_t size = store.size();
+
+    LogStore reopened(&s_storage, 16);
+    s_storage.bytesRead = 0;
+    TEST_ASSERT_TRUE(reopened.open(LOG_FILE));
+
+    TEST_ASSERT_EQUAL(1000, reopened.recordCount());
+    TEST_ASSERT_EQUAL(size, reopened.size());
+    TEST_ASSERT_EQUAL(0, reopened.discardedBytes());
+    TEST_ASSERT_TRUE(s_storage.bytesRead < 1024);
+    TEST_ASSERT_TRUE(size > 25000);
+}
+
+static void test_TornWriteIsDiscardedOnOpen(void)
+{
+    LOG_STORE_READER reader;
+    uint8_t count = 0;
+    char const * payload;
+
+    LogStore store(&s_storage, 4);
+    TEST_ASSERT_TRUE(store.open(LOG_FILE));
+    appendRows(&store, 0, 6);
+
+    // Power lost part way through writing a record
+    appendToFile(LOG_FILE, "R0015ABCD 2015-04-03 1");
+
+    LogStore reopened(&s_storage, 4);
+    TEST_ASSERT_TRUE(reopened.open(LOG_FILE));
+    TEST_ASSERT_EQUAL(6, reopened.recordCount());
+    TEST_ASSERT_EQUAL(22, reopened.discardedBytes());
+    TEST_ASSERT_EQUAL(reopened.size(), reopened.committedSize());
+
+    TEST_ASSERT_TRUE(reopened.append("AFTER"));
+
+    TEST_ASSERT_TRUE(reopened.startReading(&reader, 0));
+    while ((payload = reopened.next(&reader)))
+    {
+        count++;
+        if (count == 7) { TEST_ASSERT_EQUAL_STRING("AFTER", payload); }
+    }
+    reopened.stopReading(&reader);
+    TEST_ASSERT_EQUAL(7, count);
+
+    // Opening again finds nothing more to discard
+    LogStore again(&s_storage, 4);
+    TEST_ASSERT_TRUE(again.open(LOG_FILE));
+    TEST_ASSERT_EQUAL(7, again.recordCount());
+    TEST_ASSERT_EQUAL(0, again.discardedBytes());
+}
+
+static void test_CorruptRecordsAreSkipped(void)
+{
+    LOG_STORE_READER reader;
+    LogStore store(&s_storage, 16);
+
+    TEST_ASSERT_TRUE(store.open(LOG_FILE));
+    appendRows(&store, 0, 2);
+    appendToFile(LOG_FILE, "R0003FFFF BAD\n");
+    appendRows(&store, 2, 1);
+
+    TEST_ASSERT_TRUE(store.startReading(&reader, 0));
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34,0", store.next(&reader));
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34,1", store.next(&reader));
+    TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34,2", store.next(&reader));
+    TEST_ASSERT_NULL(store.next(&reader));
+    store.stopReading(&reader);
+}
+
+static void test_LogIsExportedAsCSV(void)
+{
+    MultiplexedStorage storage(&s_storage);
+    LogStore store(&storage, 16);
+
+    TEST_ASSERT_TRUE(store.open(LOG_FILE));
+    appendRows(&store, 0, 2);
+    TEST_ASSERT_TRUE(store.commit());
+
+    TEST_ASSERT_EQUAL(2, store.exportTo(CSV_FILE, 0, "Timestamp, Count"));
+
+    std::string contents = readFile(CSV_FILE);
+    TEST_ASSERT_EQUAL_STRING(
+        "Timestamp, Count\r\n"
+        "2015-04-03 13:09:34,0\r\n"
+        "2015-04-03 13:09:34,1\r\n", contents.c_str());
+}
+
+int main(void)
+{
+    UnityBegin("DLLocalStorage.LogStore.Test.cpp");
+
+    RUN_TEST(test_AppendedRecordsAreReadBack);
+    RUN_TEST(test_ReadingResumesFromAnOffset);
+    RUN_TEST(test_OpeningOnlyReadsTheEndOfTheLog);
+    RUN_TEST(test_TornWriteIsDiscardedOnOpen);
+    RUN_TEST(test_CorruptRecordsAreSkipped);
+    RUN_TEST(test_LogIsExportedAsCSV);
+
+    UnityEnd();
+    return 0;
+}
@@ -0,0 +1,11 @@
+SRC_FILES += DLTest/DLTest.Mock.LocalStorage.cpp DLUtility/DLUtility.Readline.cpp
+SRC_FILES += DLUtility/DLUtility.Strings.cpp DLUtility/DLUtility.CRC.cpp
+SRC_FILES += DLLocalStorage/DLLocalStorage.Multiplexed.cpp
+
+INC_DIRS += -IDLUtility
+
+local_setup:
+	rm -rf ./DLLocalStorage/Test/LogStore
+
+local_teardown:
+	rm -rf ./DLLocalStorage/Test/LogStore
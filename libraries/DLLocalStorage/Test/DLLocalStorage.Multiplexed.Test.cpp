@@ -0,0 +1,194 @@
+/*
+ * DLLocalStorage.Multiplexed.Test.cpp
+ *
+ * Tests the MultiplexedStorage class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLUtility.Readline.h"
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.Multiplexed.h"
+#include "DLTest.Mock.LocalStorage.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+#define xstr(s) str(s)
+#define str(s) #s
+#define QUOTED_DL_PATH xstr(DL_PATH)
+
+#define MULTIPLEXED_DIRECTORY QUOTED_DL_PATH "/DLLocalStorage/Test/Multiplexed"
+#define LOG_FILE MULTIPLEXED_DIRECTORY "/LOG.CSV"
+#define UPLOAD_FILE MULTIPLEXED_DIRECTORY "/UPLOAD.CSV"
+#define OTHER_FILE MULTIPLEXED_DIRECTORY "/OTHER.CSV"
+
+#define ROW "2015-04-03 13:09:34 +0000,12.345\r\n"
+
+static TestStorageInterface s_backend;
+
+void setUp(void)
+{
+    if (!s_backend.directoryExists(MULTIPLEXED_DIRECTORY)) { s_backend.mkDir(MULTIPLEXED_DIRECTORY); }
+    s_backend.removeFile(LOG_FILE);
+    s_backend.removeFile(UPLOAD_FILE);
+    s_backend.removeFile(OTHER_FILE);
+}
+
+void tearDown(void) {}
+
+static std::string readFile(char const * filename)
+{
+    std::ifstream file(filename);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(char const * filename, std::string const& contents)
+{
+    std::ofstream file(filename);
+    file << contents;
+}
+
+static void test_ReadingOneFileWhileAppendingToAnother(void)
+{
+    char line[64];
+    uint16_t i;
+    std::string upload;
+
+    for (i = 0; i < 100; ++i) { upload += ROW; }
+    writeFile(UPLOAD_FILE, upload);
+
+    MultiplexedStorage storage(&s_backend);
+
+    FILE_HANDLE reader = storage.openFile(UPLOAD_FILE, false);
+    FILE_HANDLE writer = storage.openFile(LOG_FILE, true);
+    TEST_ASSERT_TRUE(reader != INVALID_HANDLE);
+    TEST_ASSERT_TRUE(writer != INVALID_HANDLE);
+    TEST_ASSERT_TRUE(reader != writer);
+
+    i = 0;
+    while (!storage.endOfFile(reader))
+    {
+        TEST_ASSERT_EQUAL(32, storage.readLine(reader, line, sizeof(line), true));
+        TEST_ASSERT_EQUAL_STRING("2015-04-03 13:09:34 +0000,12.345", line);
+        storage.write(writer, ROW);
+        i++;
+    }
+    TEST_ASSERT_EQUAL(100, i);
+
+    storage.closeFile(reader);
+    storage.closeFile(writer);
+
+    TEST_ASSERT_TRUE(upload == readFile(LOG_FILE));
+
+    // 3400 bytes each way is 7 blocks each, and so up to 14 switches (rather than 200)
+    TEST_ASSERT_TRUE(storage.switchCount() <= 14);
+}
+
+static void test_ReadHandlesKeepTheirOwnPositions(void)
+{
+    char line[16];
+
+    writeFile(UPLOAD_FILE, "U1\r\nU2\r\nU3\r\n");
+    writeFile(OTHER_FILE, "O1\r\nO2\r\n");
+
+    MultiplexedStorage storage(&s_backend);
+
+    FILE_HANDLE upload = storage.openFile(UPLOAD_FILE, false);
+    FILE_HANDLE other = storage.openFile(OTHER_FILE, false);
+
+    storage.readLine(upload, line, sizeof(line), true);
+    TEST_ASSERT_EQUAL_STRING("U1", line);
+    storage.readLine(other, line, sizeof(line), true);
+    TEST_ASSERT_EQUAL_STRING("O1", line);
+    storage.readLine(upload, line, sizeof(line), true);
+    TEST_ASSERT_EQUAL_STRING("U2", line);
+    storage.readLine(other, line, sizeof(line), true);
+    TEST_ASSERT_EQUAL_STRING("O2", line);
+    TEST_ASSERT_TRUE(storage.endOfFile(other));
+    TEST_ASSERT_FALSE(storage.endOfFile(upload));
+
+    // Seeking a file the backend doesn't have open happens when it is next read
+    TEST_ASSERT_TRUE(storage.seek(upload, 8));
+    TEST_ASSERT_TRUE(storage.seek(other, 4));
+    storage.readLine(upload, line, sizeof(line), true);
+    TEST_ASSERT_EQUAL_STRING("U3", line);
+    storage.readLine(other, line, sizeof(line), true);
+    TEST_ASSERT_EQUAL_STRING("O2", line);
+
+    storage.closeFile(upload);
+    storage.closeFile(other);
+}
+
+static void test_HandlesRunOut(void)
+{
+    FILE_HANDLE files[MULTIPLEXED_STORAGE_MAX_FILES];
+    uint8_t i;
+
+    MultiplexedStorage storage(&s_backend);
+
+    TEST_ASSERT_EQUAL(INVALID_HANDLE, storage.openFile(UPLOAD_FILE, false));
+
+    for (i = 0; i < MULTIPLEXED_STORAGE_MAX_FILES; ++i)
+    {
+        files[i] = storage.openFile(LOG_FILE, true);
+        TEST_ASSERT_TRUE(files[i] != INVALID_HANDLE);
+    }
+    TEST_ASSERT_EQUAL(INVALID_HANDLE, storage.openFile(OTHER_FILE, true));
+
+    storage.closeFile(files[0]);
+    TEST_ASSERT_EQUAL(files[0], storage.openFile(OTHER_FILE, true));
+
+    // Nothing was written, so the backend never opened a file
+    for (i = 0; i < MULTIPLEXED_STORAGE_MAX_FILES; ++i) { storage.closeFile(files[i]); }
+    TEST_ASSERT_EQUAL(0, storage.switchCount());
+}
+
+static void test_RemovingAFileDropsBufferedData(void)
+{
+    MultiplexedStorage storage(&s_backend);
+
+    FILE_HANDLE file = storage.openFile(LOG_FILE, true);
+    storage.write(file, ROW);
+    TEST_ASSERT_TRUE(storage.fileExists(LOG_FILE));
+
+    storage.removeFile(LOG_FILE);
+    TEST_ASSERT_FALSE(storage.fileExists(LOG_FILE));
+
+    storage.write(file, "KEPT");
+    storage.closeFile(file);
+    TEST_ASSERT_EQUAL_STRING("KEPT", readFile(LOG_FILE).c_str());
+}
+
+int main(void)
+{
+    UnityBegin("DLLocalStorage.Multiplexed.Test.cpp");
+
+    RUN_TEST(test_ReadingOneFileWhileAppendingToAnother);
+    RUN_TEST(test_ReadHandlesKeepTheirOwnPositions);
+    RUN_TEST(test_HandlesRunOut);
+    RUN_TEST(test_RemovingAFileDropsBufferedData);
+
+    UnityEnd();
+    return 0;
+}
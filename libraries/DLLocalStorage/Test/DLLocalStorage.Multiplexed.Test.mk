@@ -0,0 +1,10 @@
+SRC_FILES += DLTest/DLTest.Mock.LocalStorage.cpp DLUtility/DLUtility.Readline.cpp
+SRC_FILES += DLUtility/DLUtility.Strings.cpp
+
+INC_DIRS += -IDLUtility
+
+local_setup:
+	rm -rf ./DLLocalStorage/Test/Multiplexed
+
+local_teardown:
+	rm -rf ./DLLocalStorage/Test/Multiplexed
@@ -0,0 +1,193 @@
+/*
+ * DLLocalStorage.UploadCursor.Test.cpp
+ *
+ * Tests the UploadCursor class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * C++ Library Includes
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+/*
+ * Local Application Includes
+ */
+
+#include "DLLocalStorage.h"
+#include "DLLocalStorage.UploadCursor.h"
+#include "DLTest.Mock.LocalStorage.h"
+
+/*
+ * Unity Test Framework
+ */
+
+#include "unity.h"
+
+#define xstr(s) str(s)
+#define str(s) #s
+#define QUOTED_DL_PATH xstr(DL_PATH)
+
+#define CURSOR_DIRECTORY QUOTED_DL_PATH "/DLLocalStorage/Test/UploadCursor"
+#define SLOT_A CURSOR_DIRECTORY "/CURSOR.A"
+#define SLOT_B CURSOR_DIRECTORY "/CURSOR.B"
+#define DAY_ONE CURSOR_DIRECTORY "/D15-04-03.CSV"
+#define DAY_TWO CURSOR_DIRECTORY "/D15-04-04.CSV"
+
+static TestStorageInterface s_storage;
+
+void setUp(void)
+{
+    if (!s_storage.directoryExists(CURSOR_DIRECTORY)) { s_storage.mkDir(CURSOR_DIRECTORY); }
+    s_storage.removeFile(SLOT_A);
+    s_storage.removeFile(SLOT_B);
+    s_storage.removeFile(DAY_ONE);
+    s_storage.removeFile(DAY_TWO);
+}
+
+void tearDown(void) {}
+
+static void writeFile(char const * filename, std::string const& contents)
+{
+    std::ofstream file(filename);
+    file << contents;
+}
+
+static std::string readFile(char const * filename)
+{
+    std::ifstream file(filename);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void test_NothingSavedMeansNoCursor(void)
+{
+    UploadCursor cursor(&s_storage, SLOT_A, SLOT_B);
+
+    TEST_ASSERT_FALSE(cursor.load());
+    TEST_ASSERT_FALSE(cursor.isSet());
+    TEST_ASSERT_EQUAL(INVALID_HANDLE, cursor.openAtCursor());
+}
+
+static void test_SavedCursorIsLoadedAfterRestart(void)
+{
+    UploadCursor cursor(&s_storage, SLOT_A, SLOT_B);
+
+    TEST_ASSERT_TRUE(cursor.save(DAY_ONE, 100, 3));
+    TEST_ASSERT_TRUE(cursor.save(DAY_ONE, 250, 7));
+
+    // The saves went to alternate slots
+    TEST_ASSERT_TRUE(s_storage.fileExists(SLOT_A));
+    TEST_ASSERT_TRUE(s_storage.fileExists(SLOT_B));
+
+    UploadCursor restarted(&s_storage, SLOT_A, SLOT_B);
+    TEST_ASSERT_TRUE(restarted.load());
+    TEST_ASSERT_EQUAL_STRING(DAY_ONE, restarted.filename());
+    TEST_ASSERT_EQUAL(250, restarted.offset());
+    TEST_ASSERT_EQUAL(7, restarted.row());
+    TEST_ASSERT_EQUAL(2, restarted.sequence());
+}
+
+static void test_TornCursorWriteFallsBackToThePreviousSlot(void)
+{
+    UploadCursor cursor(&s_storage, SLOT_A, SLOT_B);
+
+    TEST_ASSERT_TRUE(cursor.save(DAY_ONE, 100, 3));
+    TEST_ASSERT_TRUE(cursor.save(DAY_ONE, 250, 7));
+
+    // Power lost while the second slot was written
+    std::string slot = readFile(SLOT_B);
+    writeFile(SLOT_B, slot.substr(0, 20));
+
+    UploadCursor restarted(&s_storage, SLOT_A, SLOT_B);
+    TEST_ASSERT_TRUE(restarted.load());
+    TEST_ASSERT_EQUAL(100, restarted.offset());
+    TEST_ASSERT_EQUAL(3, restarted.row());
+
+    // The next save replaces the torn slot, keeping the good one
+    TEST_ASSERT_TRUE(restarted.save(DAY_ONE, 180, 5));
+    std::string slotA = readFile(SLOT_A);
+    TEST_ASSERT_TRUE(slotA.find("00000064") != std::string::npos);
+
+    UploadCursor again(&s_storage, SLOT_A, SLOT_B);
+    TEST_ASSERT_TRUE(again.load());
+    TEST_ASSERT_EQUAL(180, again.offset());
+}
+
+static void test_UploadsResumeFromTheCursorAfterRestart(void)
+{
+    char buffer[64];
+    uint32_t length;
+
+    // The last row hasn't been finished
+    writeFile(DAY_ONE, "A,1\r\nB,2\r\nC,3\r\nD,4\r\nE,");
+
+    UploadCursor cursor(&s_storage, SLOT_A, SLOT_B);
+    TEST_ASSERT_TRUE(cursor.save(DAY_ONE, 0, 0));
+
+    TEST_ASSERT_EQUAL(2, cursor.readRows(buffer, sizeof(buffer), 2, &length));
+    TEST_ASSERT_EQUAL_STRING("A,1\r\nB,2\r\n", buffer);
+    TEST_ASSERT_TRUE(cursor.advance(length, 2));
+
+    UploadCursor restarted(&s_storage, SLOT_A, SLOT_B);
+    TEST_ASSERT_TRUE(restarted.load());
+    TEST_ASSERT_EQUAL(10, restarted.offset());
+
+    TEST_ASSERT_EQUAL(2, restarted.readRows(buffer, sizeof(buffer), 10, &length));
+    TEST_ASSERT_EQUAL_STRING("C,3\r\nD,4\r\n", buffer);
+    TEST_ASSERT_TRUE(restarted.advance(length, 2));
+    TEST_ASSERT_EQUAL(4, restarted.row());
+
+    // A row that doesn't fit in the buffer is left for next time
+    TEST_ASSERT_EQUAL(0, restarted.readRows(buffer, 4, 10, &length));
+    TEST_ASSERT_EQUAL(0, length);
+}
+
+static void test_CursorRollsOverToTheNextFile(void)
+{
+    char buffer[64];
+    uint32_t length;
+
+    writeFile(DAY_ONE, "A,1\r\n");
+    writeFile(DAY_TWO, "B,2\r\n");
+
+    UploadCursor cursor(&s_storage, SLOT_A, SLOT_B);
+    TEST_ASSERT_TRUE(cursor.save(DAY_ONE, 0, 0));
+
+    TEST_ASSERT_EQUAL(1, cursor.readRows(buffer, sizeof(buffer), 10, &length));
+    TEST_ASSERT_TRUE(cursor.advance(length, 1));
+    TEST_ASSERT_EQUAL(0, cursor.readRows(buffer, sizeof(buffer), 10, &length));
+
+    TEST_ASSERT_TRUE(cursor.rollover(DAY_TWO));
+    TEST_ASSERT_EQUAL(1, cursor.readRows(buffer, sizeof(buffer), 10, &length));
+    TEST_ASSERT_EQUAL_STRING("B,2\r\n", buffer);
+    TEST_ASSERT_TRUE(cursor.advance(length, 1));
+
+    UploadCursor restarted(&s_storage, SLOT_A, SLOT_B);
+    TEST_ASSERT_TRUE(restarted.load());
+    TEST_ASSERT_EQUAL_STRING(DAY_TWO, restarted.filename());
+    TEST_ASSERT_EQUAL(5, restarted.offset());
+    TEST_ASSERT_EQUAL(2, restarted.row());
+}
+
+int main(void)
+{
+    UnityBegin("DLLocalStorage.UploadCursor.Test.cpp");
+
+    RUN_TEST(test_NothingSavedMeansNoCursor);
+    RUN_TEST(test_SavedCursorIsLoadedAfterRestart);
+    RUN_TEST(test_TornCursorWriteFallsBackToThePreviousSlot);
+    RUN_TEST(test_UploadsResumeFromTheCursorAfterRestart);
+    RUN_TEST(test_CursorRollsOverToTheNextFile);
+
+    UnityEnd();
+    return 0;
+}
@@ -35,7 +35,9 @@
 
 /*
  * Compenstates thermistor readings for 33K+33K divider on
- * ADC inputs
+ * ADC inputs.
+ * The field samples this into its conversion table when it is set up,
+ * so it is not called for every reading.
  */
 
 static float thermistorADCConversion(float in, void * field)
@@ -27,7 +27,7 @@ class ServiceInterface
         virtual uint16_t createPostAPICall(
         	char * buffer, float * data,  uint32_t * channels, uint8_t nFields, uint16_t maxSize, char const * const time) = 0;
         
-        virtual void createBulkUploadCall(
+        virtual bool createBulkUploadCall(
         	char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields) = 0;
 };
 
@@ -16,6 +16,9 @@
 #endif
 
 #include "DLUtility.h"
+#include "DLUtility.Averager.h"
+#include "DLDataField.Types.h"
+#include "DLDataField.h"
 #include "DLService.h"
 #include "DLService.thingspeak.h"
 #include "DLHTTP.h"
@@ -81,6 +84,7 @@ uint16_t Thingspeak::createPostAPICall(
     if (!m_key) { return 0; }
     
     char m_body[maxSize];
+    FixedLengthAccumulator bodyAccumulator(m_body, maxSize);
     
     builder.reset();
     builder.setMethodAndURL("POST", THINGSPEAK_UPDATE_PATH);
@@ -91,28 +95,40 @@ uint16_t Thingspeak::createPostAPICall(
     builder.putHeader("Content-Type", "application/x-www-form-urlencoded");
 
     uint8_t field = 0;
-    uint8_t index = 0;
     for (field = 0; field < nFields; field++)
     {
-        // Make the data string
-        index += sprintf(&m_body[index], "%d=%.5f", channels[field], data[field]);
-        if (!lastinloop(field, nFields))
+        // Rows stored by exception only have data for the fields that changed, so only send those
+        if (data[field] == DATAFIELD_NO_DATA_VALUE) { continue; }
+
+        if (bodyAccumulator.length() > 0)
         {
-            m_body[index++] = '&';
+            bodyAccumulator.writeChar('&');
         }
+
+        // Make the data string
+        bodyAccumulator.appendUInt(channels[field]);
+        bodyAccumulator.writeChar('=');
+        bodyAccumulator.appendFixed(data[field], 5);
     }
 
     // Copy the time into the buffer (if provided)
     if (pTime)
     {
-        index += sprintf(&m_body[index], "created_at=%s", pTime);
+        if (bodyAccumulator.length() > 0)
+        {
+            bodyAccumulator.writeChar('&');
+        }
+        bodyAccumulator.appendLiteral("created_at=");
+        bodyAccumulator.writeString(pTime);
     }
 
     builder.putBody(m_body);
 
-    builder.writeToBuffer(buffer, maxSize, true);
+    // A truncated request must not be sent, so report it as a failure
+    if (bodyAccumulator.truncated()) { return 0; }
+    if (!builder.writeToBuffer(buffer, maxSize, true)) { return 0; }
 
-    return index;
+    return bodyAccumulator.length();
 }
 
 /* Creates a bulk upload call for thingspeak.
@@ -122,12 +138,13 @@ uint16_t Thingspeak::createPostAPICall(
     csvData - a pointer to the CSV data. Expected CSV line format is:
         creation date/time, entry id, field1 data, field2 data... fieldN data\r\n
     filename - The name of the file fro, which the CSV data has been pulled
+ * Returns: false if the request could not be created or did not fit in maxSize
 */
 
-void Thingspeak::createBulkUploadCall(char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields)
+bool Thingspeak::createBulkUploadCall(char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields)
 {
-    if (!buffer) { return; }
-    if (!m_key) { return; }
+    if (!buffer) { return false; }
+    if (!m_key) { return false; }
 
     /* Creates the HTTP headers for the bulk upload */
     if (!s_body)
@@ -148,56 +165,49 @@ void Thingspeak::createBulkUploadCall(char * buffer, uint16_t maxSize, const cha
     builder.putHeader("Content-Type", "multipart/form-data; boundary=" __THINGSPEAK_MULTIPART_BOUNDARY_STR__);
 
     // Write the API key
-    bodyAccumulator.writeString("--");
-    bodyAccumulator.writeLine(THINGSPEAK_MULTIPART_BOUNDARY);
-    bodyAccumulator.writeLine("Content-Disposition: form-data; name=\"api_key\"");
-    bodyAccumulator.writeLine("");
+    bodyAccumulator.appendLiteral(
+        "--" __THINGSPEAK_MULTIPART_BOUNDARY_STR__ CRLF
+        "Content-Disposition: form-data; name=\"api_key\"" CRLF
+        CRLF);
     bodyAccumulator.writeLine(m_key);
-    bodyAccumulator.writeString("--");
-    bodyAccumulator.writeLine(THINGSPEAK_MULTIPART_BOUNDARY);
+    bodyAccumulator.appendLiteral("--" __THINGSPEAK_MULTIPART_BOUNDARY_STR__ CRLF);
 
     // Write the CSV data
-    bodyAccumulator.writeString("Content-Disposition: form-data; name=\"upload[csv]\"; filename=\"");
+    bodyAccumulator.appendLiteral("Content-Disposition: form-data; name=\"upload[csv]\"; filename=\"");
     bodyAccumulator.writeString(filename);
-    bodyAccumulator.writeLine("\"");
-    bodyAccumulator.writeLine("Content-Type: application/octet-stream");
-
-    bodyAccumulator.writeLine("");
+    bodyAccumulator.appendLiteral(
+        "\"" CRLF
+        "Content-Type: application/octet-stream" CRLF
+        CRLF);
 
     putCSVUploadHeaders(&bodyAccumulator, nFields);
     bodyAccumulator.writeString(csvData);
-    bodyAccumulator.writeLine("");
-    bodyAccumulator.writeString("--");
-    bodyAccumulator.writeString(THINGSPEAK_MULTIPART_BOUNDARY);
-    bodyAccumulator.writeString("--");
+    bodyAccumulator.appendLiteral(CRLF "--" __THINGSPEAK_MULTIPART_BOUNDARY_STR__ "--");
 
     builder.putBody(s_body);
 
-    builder.writeToBuffer(buffer, maxSize, true);
+    if (bodyAccumulator.truncated()) { return false; }
+
+    return builder.writeToBuffer(buffer, maxSize, true);
 }
 
 void Thingspeak::putCSVUploadHeaders(FixedLengthAccumulator * accumulator, uint8_t nFields)
 {
     if (!accumulator) { return; }
 
-    accumulator->writeString("created_at,entry_id,");
+    accumulator->appendLiteral("created_at,entry_id,");
 
     uint8_t field = 0;
 
-    char fieldBuffer[5];
-
     for (field = 1; field < nFields + 1; field++)
     {
-        accumulator->writeString("field");
-    
-        sprintf(fieldBuffer, "%d", field);
-
-        accumulator->writeString(fieldBuffer);
+        accumulator->appendLiteral("field");
+        accumulator->appendUInt(field);
 
         if (!lastinloop(field, nFields + 1))
         {
             accumulator->writeChar(',');
         }
     }
-    accumulator->writeString("\r\n");
+    accumulator->appendLiteral(CRLF);
 }
@@ -20,7 +20,7 @@ class Thingspeak : public ServiceInterface
         uint16_t createPostAPICall(
             char * buffer, float * data, uint32_t * channels, uint8_t nFields, uint16_t maxSize, char const * const time);
 
-        void createBulkUploadCall(char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields);
+        bool createBulkUploadCall(char * buffer, uint16_t maxSize, const char * csvData, const char * filename, uint8_t nFields);
 
     private:
 
@@ -35,7 +35,11 @@ int main(int argc, char * argv[])
     
     ServiceInterface * thingspeak = Service_GetService(SERVICE_THINGSPEAK);
 
-    thingspeak->createBulkUploadCall(request_buffer, 1024, csvData, "example.csv", 6);
+    if (!thingspeak->createBulkUploadCall(request_buffer, 1024, csvData, "example.csv", 6))
+    {
+        std::cout << "Request did not fit in the buffer" << std::endl;
+        return 1;
+    }
     std::cout << request_buffer;
     
     return 0;
@@ -39,6 +39,13 @@ static const char * s_channelTypes[] = {
     "temperature_c"
 };
 
+// Derived channel types, in FIELD_TYPE order from DERIVED_PRODUCT
+static const char * s_derivedChannelTypes[] = {
+    "product",
+    "sum",
+    "integral"
+};
+
 /*
  * Private Functions
  */
@@ -123,6 +130,14 @@ FIELD_TYPE Setting_parseSettingAsType(char const * const setting)
         }
     }
 
+    for (i = 0; i < N_ELE(s_derivedChannelTypes); ++i)
+    {
+        if (0 == strncmp(lcaseSetting, s_derivedChannelTypes[i], strlen(s_derivedChannelTypes[i])))
+        {
+            return (FIELD_TYPE)(DERIVED_PRODUCT + i);
+        }
+    }
+
     return INVALID_TYPE;
 }
 
@@ -135,6 +150,40 @@ bool Setting_parseSettingAsInt(int32_t * pResult, char const * const setting)
     return (pStartOfConv != pEndOfConv);
 }
 
+/*
+ * Setting_parseSettingAsChannelList
+ *
+ * Parses a comma-separated list of channel numbers (e.g. "1, 5") into channels.
+ * Returns the number of channels parsed, or 0 if the list is empty, has more than
+ * maxChannels entries or contains anything other than valid channel numbers.
+ */
+uint8_t Setting_parseSettingAsChannelList(uint8_t * channels, uint8_t maxChannels, char const * const setting)
+{
+    uint8_t count = 0;
+    long channel;
+    char * pStartOfConv = (char *)setting;
+    char * pEndOfConv;
+
+    if (!channels || !setting) { return 0; }
+
+    while (*pStartOfConv)
+    {
+        channel = strtol(pStartOfConv, &pEndOfConv, 10);
+        if ((pStartOfConv == pEndOfConv) || (channel < 1) || (channel > 255)) { return 0; }
+        if (count == maxChannels) { return 0; }
+
+        channels[count++] = (uint8_t)channel;
+
+        while (isspace(*pEndOfConv)) { pEndOfConv++; }
+        if (*pEndOfConv == ',') { pEndOfConv++; }
+        else if (*pEndOfConv) { return 0; }
+
+        pStartOfConv = pEndOfConv;
+    }
+
+    return count;
+}
+
 bool Setting_parseSettingAsFloat(float * pResult, char const * const setting)
 {
     char * pStartOfConv = (char *)setting;
@@ -10,5 +10,6 @@ bool Setting_getChannelSettingStr(char * buffer, char const * const setting);
 FIELD_TYPE Setting_parseSettingAsType(char const * const setting);
 bool Setting_parseSettingAsInt(int32_t * pResult, char const * const setting);
 bool Setting_parseSettingAsFloat(float * pResult, char const * const setting);
+uint8_t Setting_parseSettingAsChannelList(uint8_t * channels, uint8_t maxChannels, char const * const setting);
 
 #endif
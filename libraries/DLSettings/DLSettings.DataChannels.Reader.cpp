@@ -22,6 +22,9 @@
 #include "DLLocalStorage.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
 #include "DLDataField.Manager.h"
 #include "DLSettings.Reader.Errors.h"
 #include "DLSettings.DataChannels.h"
@@ -75,7 +78,11 @@ SETTINGS_READER_RESULT Settings_readChannelsFromFile(
 
     if (err == ERR_READER_NONE)
     {
-        pManager->setupAllValidChannels();
+        // Fail at startup if the configuration does not fit in the manager's memory
+        if (!pManager->setupAllValidChannels())
+        {
+            err = noMemoryError(pManager->arenaBytesRequired());
+        }
     }
 
     return err;
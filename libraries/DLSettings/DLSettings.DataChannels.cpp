@@ -26,6 +26,7 @@
  * Local Includes
  */
 
+#include "DLUtility.Arena.h"
 #include "DLDataField.Types.h"
 #include "DLSettings.Reader.Errors.h"
 #include "DLSettings.DataChannels.h"
@@ -56,31 +57,60 @@ static FIELD_TYPE s_fieldTypes[MAX_CHANNELS];
  */
 static uint8_t s_valuesSetBitFields[MAX_CHANNELS];
 
+// Optional for every channel type, so kept apart from the per-type settings (0 if not set)
+static float s_deadbands[MAX_CHANNELS];
+
+// If set, channel settings are allocated from here rather than the heap
+static Arena * s_arena = NULL;
+
 /*
  * Private Functions
  */
 
-static void setupChannel(uint8_t ch, FIELD_TYPE type)
+/*
+ * allocateChannel
+ *
+ * Returns size bytes of zeroed storage for a channel's settings
+ */
+static void * allocateChannel(size_t size)
+{
+    return s_arena ? s_arena->allocate(size) : calloc(1, size);
+}
+
+static size_t channelSettingsSize(FIELD_TYPE type)
 {
-    s_valuesSetBitFields[ch] = 0;
     switch(type)    
     {
     case VOLTAGE:
-        s_channels[ch] = new VOLTAGECHANNEL();
-        break;
+        return sizeof(VOLTAGECHANNEL);
     case CURRENT:
-        s_channels[ch] = new CURRENTCHANNEL();
+        return sizeof(CURRENTCHANNEL);
     case TEMPERATURE_C:
     case TEMPERATURE_F:
     case TEMPERATURE_K:
-        s_channels[ch] = new THERMISTORCHANNEL();
-        break;
+        return sizeof(THERMISTORCHANNEL);
+    case DERIVED_PRODUCT:
+    case DERIVED_SUM:
+    case DERIVED_INTEGRAL:
+        return sizeof(DERIVEDCHANNEL);
     default:
     case INVALID_TYPE:
-        break;
+        return 0;
     }
 }
 
+static bool setupChannel(uint8_t ch, FIELD_TYPE type)
+{
+    size_t size = channelSettingsSize(type);
+
+    s_valuesSetBitFields[ch] = 0;
+
+    if (size == 0) { return true; }
+
+    s_channels[ch] = allocateChannel(size);
+    return s_channels[ch] != NULL;
+}
+
 static bool voltageChannelIsValid(uint8_t channel)
 {
     return s_valuesSetBitFields[channel] == 0x1F; // Voltage needs five values set   
@@ -96,6 +126,15 @@ static bool thermistorChannelIsValid(uint8_t channel)
     return s_valuesSetBitFields[channel] == 0x1F; // Thermistor needs five values set   
 }
 
+static bool derivedChannelIsValid(uint8_t channel)
+{
+    // Products and sums need at least two inputs, integrals need exactly one
+    uint8_t inputCount = ((DERIVEDCHANNEL*)s_channels[channel])->inputCount;
+    bool inputCountValid = (s_fieldTypes[channel] == DERIVED_INTEGRAL) ? (inputCount == 1) : (inputCount >= 2);
+
+    return (s_valuesSetBitFields[channel] == 0x01) && inputCountValid; // Derived channels need their inputs set
+}
+
 static SETTINGS_READER_RESULT tryParseAsVoltageSetting(uint8_t ch, char * pSettingName, char * pValueString, int lineNo)
 {
     float setting;
@@ -226,6 +265,21 @@ static SETTINGS_READER_RESULT tryParseAsThermistorSetting(uint8_t ch, char * pSe
     return unknownSettingError(lineNo, pSettingName);
 }
 
+static SETTINGS_READER_RESULT tryParseAsDerivedSetting(uint8_t ch, char * pSettingName, char * pValueString, int lineNo)
+{
+    DERIVEDCHANNEL * pDerived = (DERIVEDCHANNEL*)s_channels[ch];
+
+    if (0 == strncmp(pSettingName, "inputs", 6))
+    {
+        pDerived->inputCount = Setting_parseSettingAsChannelList(pDerived->inputs, DERIVED_CHANNEL_MAX_INPUTS, pValueString);
+        if (pDerived->inputCount == 0) { return invalidSettingError(lineNo, pSettingName); }
+        s_valuesSetBitFields[ch] |= 0x01;
+        return noError();
+    }
+
+    return unknownSettingError(lineNo, pSettingName);
+}
+
 /*
  * Public Functions
  */
@@ -238,9 +292,20 @@ void Settings_InitDataChannels(void)
         s_channels[i] = NULL;
         s_valuesSetBitFields[i] = 0x00;
         s_fieldTypes[i] = INVALID_TYPE;
+        s_deadbands[i] = 0.0f;
     }
 }
 
+/*
+ * Settings_SetDataChannelArena
+ *
+ * Channel settings parsed after this call are allocated from arena rather than the heap
+ */
+void Settings_SetDataChannelArena(Arena * arena)
+{
+    s_arena = arena;
+}
+
 SETTINGS_READER_RESULT Settings_parseDataChannelSetting(char const * const setting, int lineNo)
 {
     char * pSettingString;
@@ -279,7 +344,24 @@ SETTINGS_READER_RESULT Settings_parseDataChannelSetting(char const * const setti
         s_fieldTypes[ch] = Setting_parseSettingAsType(pValueString);
         if (s_fieldTypes[ch] == INVALID_TYPE) { return unknownTypeError(lineNo, pValueString); }
 
-        setupChannel(ch, s_fieldTypes[ch]);
+        if (!setupChannel(ch, s_fieldTypes[ch]))
+        {
+            return noMemoryError(channelSettingsSize(s_fieldTypes[ch]));
+        }
+        return noError();
+    }
+
+    if (0 == strncmp(pChannelSettingString, "deadband", 8))
+    {
+        if (s_fieldTypes[ch] == INVALID_TYPE) { return channelNotSetError(lineNo, ch); }
+
+        float deadband;
+        if (!Setting_parseSettingAsFloat(&deadband, pValueString) || (deadband < 0.0f))
+        {
+            return invalidSettingError(lineNo, pChannelSettingString);
+        }
+
+        s_deadbands[ch] = deadband;
         return noError();
     }
 
@@ -294,6 +376,10 @@ SETTINGS_READER_RESULT Settings_parseDataChannelSetting(char const * const setti
     case TEMPERATURE_F:
     case TEMPERATURE_K:
         return tryParseAsThermistorSetting(ch, pChannelSettingString, pValueString, lineNo);
+    case DERIVED_PRODUCT:
+    case DERIVED_SUM:
+    case DERIVED_INTEGRAL:
+        return tryParseAsDerivedSetting(ch, pChannelSettingString, pValueString, lineNo);
 
     case INVALID_TYPE:
     default:
@@ -326,6 +412,10 @@ bool Settings_ChannelSettingIsValid(CHANNELNUMBER channel)
     case TEMPERATURE_F:
     case TEMPERATURE_K:
         return thermistorChannelIsValid(channel);
+    case DERIVED_PRODUCT:
+    case DERIVED_SUM:
+    case DERIVED_INTEGRAL:
+        return derivedChannelIsValid(channel);
     default:
         return false;
     }
@@ -352,6 +442,24 @@ CURRENTCHANNEL * Settings_GetDataAsCurrent(CHANNELNUMBER channel)
     return (CURRENTCHANNEL*)s_channels[channel];
 }
 
+DERIVEDCHANNEL * Settings_GetDataAsDerived(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return NULL; }
+    channel--; // Switch from one- to zero-indexing
+    return (DERIVEDCHANNEL*)s_channels[channel];
+}
+
+/*
+ * Settings_GetChannelDeadband
+ *
+ * Returns the channel's deadband setting (in units), or 0 if it has none
+ */
+float Settings_GetChannelDeadband(CHANNELNUMBER channel)
+{
+    if (channel > MAX_CHANNELS || channel == 0) { return 0.0f; }
+    return s_deadbands[channel-1];
+}
+
 uint32_t Settings_GetMaxChannels(void)
 {
     return (uint32_t)MAX_CHANNELS;
@@ -5,11 +5,14 @@
 
 typedef uint32_t CHANNELNUMBER;
 
+class Arena;
+
 /*
  * Public Functions
  */
  
 void Settings_InitDataChannels(void);
+void Settings_SetDataChannelArena(Arena * arena);
 
 SETTINGS_READER_RESULT Settings_parseDataChannelSetting(char const * const setting, int lineNo);
 
@@ -19,6 +22,8 @@ bool Settings_ChannelSettingIsValid(CHANNELNUMBER channel);
 void * Settings_GetData(CHANNELNUMBER channel);
 VOLTAGECHANNEL * Settings_GetDataAsVoltage(CHANNELNUMBER channel);
 CURRENTCHANNEL * Settings_GetDataAsCurrent(CHANNELNUMBER channel);
+DERIVEDCHANNEL * Settings_GetDataAsDerived(CHANNELNUMBER channel);
+float Settings_GetChannelDeadband(CHANNELNUMBER channel);
 
 uint32_t Settings_GetMaxChannels(void);
 
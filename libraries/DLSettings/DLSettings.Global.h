@@ -37,6 +37,7 @@
     INT(UPLOAD_AVERAGING_INTERVAL_SECS) \
     INT(STORAGE_AVERAGING_INTERVAL_SECS) \
     INT(DATA_STORAGE_INTERVAL_SECS) \
+    INT(DATA_MAX_SILENCE_SECS) \
     INT(SERIAL_DATA_INTERVAL_SECS) \
     INT(BATTERY_WARN_INTERVAL_MINUTES) \
     INT(BATTERY_WARN_LEVEL) \
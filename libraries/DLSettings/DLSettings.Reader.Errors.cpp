@@ -43,7 +43,8 @@ static char const * const s_errorStrings[] = {
 	ERROR_STR_UNKNOWN_TYPE,
 	ERROR_STR_UNKNOWN_SETTING,
 	ERROR_STR_INVALID_SETTING,
-	ERROR_STR_CHANNEL_TYPE_NOT_SET
+	ERROR_STR_CHANNEL_TYPE_NOT_SET,
+	ERROR_STR_NO_MEMORY
 };
 
 static char s_errorBuffer[100] = "";
@@ -160,6 +161,13 @@ SETTINGS_READER_RESULT channelNotSetError(int lineNo, int channel)
     return s_lastResult;  
 }
 
+SETTINGS_READER_RESULT noMemoryError(uint32_t bytesRequired)
+{
+    s_lastResult = ERR_READER_NO_MEMORY;
+    sprintf(s_errorBuffer, s_errorStrings[ERR_READER_NO_MEMORY], (unsigned long)bytesRequired);
+    return s_lastResult;
+}
+
 /*
  * Public Functions - Error module result and strings
  */
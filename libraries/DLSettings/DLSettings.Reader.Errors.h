@@ -25,7 +25,8 @@ enum settings_reader_result
     ERR_READER_UNKNOWN_TYPE,			// Channel type was parsed but not recognised
     ERR_READER_UNKNOWN_SETTING,			// Setting name was parsed but not recognised
     ERR_READER_INVALID_SETTING,			// Setting value was not valid
-    ERR_READER_CHANNEL_TYPE_NOT_SET		// Channel type has not been set (channel type must be first setting for that channel)
+    ERR_READER_CHANNEL_TYPE_NOT_SET,	// Channel type has not been set (channel type must be first setting for that channel)
+    ERR_READER_NO_MEMORY				// The channel settings or datafields did not fit in the memory provided
 };
 typedef enum settings_reader_result SETTINGS_READER_RESULT;
 
@@ -46,6 +47,7 @@ typedef enum settings_reader_result SETTINGS_READER_RESULT;
 #define ERROR_STR_UNKNOWN_SETTING		"Error on line %d: Unknown setting name in '%s'."
 #define ERROR_STR_INVALID_SETTING		"Error on line %d: Invalid setting in '%s'."
 #define ERROR_STR_CHANNEL_TYPE_NOT_SET	"Error on line %d: No type set for channel %d."
+#define ERROR_STR_NO_MEMORY				"Not enough memory for channels (%lu bytes required)."
 
 SETTINGS_READER_RESULT noError(void);
 SETTINGS_READER_RESULT noFile(char const * pFilename);
@@ -63,6 +65,7 @@ SETTINGS_READER_RESULT unknownTypeError(int lineNo, char * pType);
 SETTINGS_READER_RESULT unknownSettingError(int lineNo, char * pSetting);
 SETTINGS_READER_RESULT invalidSettingError(int lineNo, char * pSetting);
 SETTINGS_READER_RESULT channelNotSetError(int lineNo, int channel);
+SETTINGS_READER_RESULT noMemoryError(uint32_t bytesRequired);
 
 
 SETTINGS_READER_RESULT Settings_getLastReaderResult(void);
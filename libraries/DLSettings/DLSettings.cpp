@@ -22,6 +22,9 @@
 #include "DLUtility.Averager.h"
 #include "DLDataField.Types.h"
 #include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
 #include "DLDataField.Manager.h"
 #include "DLLocalStorage.h"
 #include "DLSettings.h"
@@ -13,6 +13,9 @@ Reads from "datalogger.settings" and echoes those settings back to the command l
 
 #include "DLUtility.Averager.h"
 #include "DLDataField.h"
+#include "DLUtility.Time.h"
+#include "DLDataField.Store.h"
+#include "DLDataField.Aggregator.h"
 #include "DLDataField.Manager.h"
 #include "DLLocalStorage.h"
 #include "DLSettings.h"
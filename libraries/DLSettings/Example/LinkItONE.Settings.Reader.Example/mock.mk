@@ -1,6 +1,7 @@
 SRC_FILES += DLUtility/DLUtility.Strings.cpp
 SRC_FILES += DLUtility/DLUtility.ArrayFunctions.cpp
 SRC_FILES += DLUtility/DLUtility.Averager.cpp
+SRC_FILES += DLUtility/DLUtility.Arena.cpp
 SRC_FILES += DLUtility/DLUtility.Time.cpp
 
 SRC_FILES += DLSettings/DLSettings.cpp
@@ -206,6 +206,47 @@ void test_ValidCurrentSettingsAreParsedCorrectly(void)
     TEST_ASSERT_EQUAL_FLOAT(0.125, Settings_GetDataAsCurrent(1)->mvPerBit);
 }
 
+void test_ValidDerivedSettingsAreParsedCorrectly(void)
+{
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch16.Type = Product", 17));
+    TEST_ASSERT_EQUAL(DERIVED_PRODUCT, Settings_GetChannelType(16));
+    TEST_ASSERT_FALSE(Settings_ChannelSettingIsValid(16));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch16.inputs = 1, 5", 18));
+    TEST_ASSERT_TRUE(Settings_ChannelSettingIsValid(16));
+    TEST_ASSERT_EQUAL(2, Settings_GetDataAsDerived(16)->inputCount);
+    TEST_ASSERT_EQUAL(1, Settings_GetDataAsDerived(16)->inputs[0]);
+    TEST_ASSERT_EQUAL(5, Settings_GetDataAsDerived(16)->inputs[1]);
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch17.Type = Integral", 19));
+    TEST_ASSERT_EQUAL(DERIVED_INTEGRAL, Settings_GetChannelType(17));
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch17.inputs = 16, 1", 20));
+    TEST_ASSERT_FALSE(Settings_ChannelSettingIsValid(17)); // Integrals have one input
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch17.inputs = 16", 21));
+    TEST_ASSERT_TRUE(Settings_ChannelSettingIsValid(17));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch18.Type = Sum", 22));
+    TEST_ASSERT_EQUAL(DERIVED_SUM, Settings_GetChannelType(18));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch18.inputs = 5, x", 23));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch18.inputs = 1, 2, 3, 4, 5", 24));
+    TEST_ASSERT_FALSE(Settings_ChannelSettingIsValid(18));
+}
+
+void test_DeadbandCanBeSetForAnyChannelType(void)
+{
+    TEST_ASSERT_EQUAL(ERR_READER_CHANNEL_TYPE_NOT_SET, Settings_parseDataChannelSetting("ch20.deadband = 0.5", 25));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch20.Type = Current", 26));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, Settings_GetChannelDeadband(20));
+
+    TEST_ASSERT_EQUAL(ERR_READER_NONE, Settings_parseDataChannelSetting("ch20.deadband = 0.5", 27));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, Settings_GetChannelDeadband(20));
+
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch20.deadband = -1", 28));
+    TEST_ASSERT_EQUAL(ERR_READER_INVALID_SETTING, Settings_parseDataChannelSetting("ch20.deadband = x", 29));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, Settings_GetChannelDeadband(20));
+}
+
 int main(void)
 {
     UnityBegin("DLSettings.DataChannels.Test.cpp");
@@ -229,6 +270,8 @@ int main(void)
 
     RUN_TEST(test_ValidVoltageSettingsAreParsedCorrectly);
     RUN_TEST(test_ValidCurrentSettingsAreParsedCorrectly);
+    RUN_TEST(test_ValidDerivedSettingsAreParsedCorrectly);
+    RUN_TEST(test_DeadbandCanBeSetForAnyChannelType);
 
   	UnityEnd();
   	return 0;
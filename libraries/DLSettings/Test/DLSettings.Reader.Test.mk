@@ -2,7 +2,7 @@ SRC_FILES += ./DLSettings/DLSettings.Global.cpp
 SRC_FILES += ./DLSettings/DLSettings.Reader.Errors.cpp
 
 SRC_FILES += ./DLUtility/DLUtility.Strings.cpp
-SRC_FILES += ./DLTest/DLTest.Mock.LocalStorage.cpp
+SRC_FILES += ./DLTest/DLTest.Mock.LocalStorage.cpp ./DLUtility/DLUtility.Readline.cpp
 
 INC_DIRS += -IDLUtility -IDLLocalStorage
 
@@ -23,9 +23,21 @@
 #include "DLTest.Mock.LocalStorage.h"
 
 #include "DLUtility.Strings.h"
+#include "DLUtility.Readline.h"
 
 static std::fstream s_file;
 
+// Reads are made a block at a time, as on the LinkIt ONE
+static char s_readAheadData[512];
+static READ_AHEAD s_readAhead = {s_readAheadData, sizeof(s_readAheadData), 0, 0, NULL};
+
+static uint32_t readBlockFromFile(char * buffer, uint32_t n, void * context)
+{
+    (void)context; // There is only one file
+    s_file.read(buffer, n);
+    return s_file.gcount();
+}
+
 LocalStorageInterface * LocalStorage_GetLocalStorageInterface(LOCAL_STORAGE_TYPE storage_type)
 {
     (void)storage_type;
@@ -37,6 +49,11 @@ TestStorageInterface::TestStorageInterface()
     m_echo = false;
 }
 
+bool TestStorageInterface::inError()
+{
+    return false;
+}
+
 bool TestStorageInterface::fileExists(char const * const filePath)
 {
     struct stat info;
@@ -75,6 +92,7 @@ FILE_HANDLE TestStorageInterface::openFile(char const * const filename, bool for
 
     if (!filename) { return INVALID_HANDLE; }
 
+    readAheadReset(&s_readAhead);
     s_file.open(filename, forWrite ? std::ios::app : std::ios::in);
 
     return 0;
@@ -99,8 +117,7 @@ uint32_t TestStorageInterface::readBytes(FILE_HANDLE file, char * buffer, uint32
     (void)file;
     if (!s_file.is_open()) { return 0; }
     if (!buffer) { return 0; }
-    s_file.read(buffer, n);
-    return s_file.gcount();
+    return readBytesWithReadAhead(&s_readAhead, readBlockFromFile, buffer, n);
 }
 
 uint32_t TestStorageInterface::readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF)
@@ -110,40 +127,46 @@ uint32_t TestStorageInterface::readLine(FILE_HANDLE file, char * buffer, uint32_
     if (!s_file.is_open()) { return 0; }
     if (!buffer) { return 0; }
 
-    std::string strBuffer;
-    std::getline(s_file, strBuffer);
+    return readLineWithReadAhead(&s_readAhead, readBlockFromFile, buffer, n, stripCRLF);
+}
 
-    strncpy_safe(buffer, strBuffer.c_str(), n);
+bool TestStorageInterface::seek(FILE_HANDLE file, uint32_t position)
+{
+    (void)file;
+    if (!s_file.is_open()) { return false; }
 
-    int32_t count = strBuffer.length();
+    readAheadReset(&s_readAhead);
+    s_file.clear();
+    s_file.seekg(position);
+    return !s_file.fail();
+}
 
-    if (count && stripCRLF)
-    {
-        count--; // Skip back to last char read
-        while((count >= 0) && (buffer[count] == '\r' || buffer[count] == '\n'))
-        {
-            buffer[count--] = '\0';
-        }
-        count+=2; // Undo skip and also include NULL terminator
-    }
-    else
-    {
-        buffer[count++] = '\n'; // Append the \n that was removed by getline
-        buffer[count++] = '\0';
-    }
-    return count;
+uint32_t TestStorageInterface::fileSize(FILE_HANDLE file)
+{
+    (void)file;
+    if (!s_file.is_open()) { return 0; }
+
+    // Find the end without disturbing the read position
+    s_file.clear();
+    std::streampos position = s_file.tellg();
+    s_file.seekg(0, std::ios::end);
+    std::streampos size = s_file.tellg();
+    s_file.seekg(position);
+
+    return (size > 0) ? (uint32_t)size : 0;
 }
 
 void TestStorageInterface::closeFile(FILE_HANDLE file)
 {
     (void)file;
+    readAheadReset(&s_readAhead);
     s_file.close();
 }
 
 bool TestStorageInterface::endOfFile(FILE_HANDLE file)
 {
     (void)file;
-    return s_file.eof();
+    return readAheadIsEmpty(&s_readAhead) && s_file.eof();
 }
 
 void TestStorageInterface::setEcho(bool set)
@@ -5,12 +5,15 @@ class TestStorageInterface : public LocalStorageInterface
 {
     public:
         TestStorageInterface();
+        bool inError();
         bool fileExists(char const * const filePath);
         bool directoryExists(char const * const dirPath);
         bool mkDir(char const * const dirPath);
         void write(FILE_HANDLE file, char const * const toWrite);
         uint32_t readBytes(FILE_HANDLE file, char * buffer, uint32_t n);
         uint32_t readLine(FILE_HANDLE file, char * buffer, uint32_t n, bool stripCRLF);
+        bool seek(FILE_HANDLE file, uint32_t position);
+        uint32_t fileSize(FILE_HANDLE file);
         FILE_HANDLE openFile(char const * const filename, bool forWrite);
         void closeFile(FILE_HANDLE file);
         bool endOfFile(FILE_HANDLE file);
@@ -14,6 +14,7 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -106,10 +107,9 @@ void test_readLine_CanReadLineFromOpenFileWithCRLF(void)
     char actual[30];
     char expected[] = "TEST FILE CONTENT\r\n";
 
-    // Read length is length of expected plus NULL
     uint32_t count = s_testInterface->readLine(s_handle, actual, 30, false);
     TEST_ASSERT_EQUAL_STRING(expected, actual);
-    TEST_ASSERT_EQUAL(strlen(expected) + 1, count);
+    TEST_ASSERT_EQUAL(strlen(expected), count);
 }
 
 void test_readLine_CanReadLineFromOpenFileWithoutCRLF(void)
@@ -122,7 +122,7 @@ void test_readLine_CanReadLineFromOpenFileWithoutCRLF(void)
 
     uint32_t count = s_testInterface->readLine(s_handle, actual, 30, true);
     TEST_ASSERT_EQUAL_STRING(expected, actual);
-    TEST_ASSERT_EQUAL(strlen(expected) + 1, count);
+    TEST_ASSERT_EQUAL(strlen(expected), count);
 }
 
 void test_eof_IsTrueAtEndOfFile(void)
@@ -160,6 +160,54 @@ void test_write_CanWriteBytesToOpenFile(void)
     TEST_ASSERT_EQUAL_STRING(expected, actual);
 }
 
+void test_readLine_ReadsEveryLineAcrossReadBlocks(void)
+{
+    char line[30];
+    char expected[30];
+    uint16_t i;
+
+    // 100 lines of 10 chars is longer than one block read from the file
+    s_handle = s_testInterface->openFile(QUOTED_DL_PATH "/DLTest/Test/LongFile", true);
+    for (i = 0; i < 100; ++i)
+    {
+        sprintf(line, "Line %03d\r\n", i);
+        s_testInterface->write(s_handle, line);
+    }
+    s_testInterface->closeFile(s_handle);
+
+    s_handle = s_testInterface->openFile(QUOTED_DL_PATH "/DLTest/Test/LongFile", false);
+    for (i = 0; i < 100; ++i)
+    {
+        TEST_ASSERT_FALSE(s_testInterface->endOfFile(s_handle));
+        sprintf(expected, "Line %03d", i);
+        s_testInterface->readLine(s_handle, line, 30, true);
+        TEST_ASSERT_EQUAL_STRING(expected, line);
+    }
+    TEST_ASSERT_TRUE(s_testInterface->endOfFile(s_handle));
+}
+
+void test_readLine_LeavesTheRestOfALongLineForTheNextRead(void)
+{
+    char line[30];
+
+    s_handle = s_testInterface->openFile(QUOTED_DL_PATH "/DLTest/Test/TempForRead", false);
+
+    // Only n chars are read, without a terminator
+    memset(line, 'X', sizeof(line));
+    s_testInterface->readLine(s_handle, line, 4, false);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("TESTX", line, 5);
+
+    s_testInterface->readLine(s_handle, line, 30, true);
+    TEST_ASSERT_EQUAL_STRING(" FILE CONTENT", line);
+
+    // readBytes continues from the same place
+    s_testInterface->closeFile(s_handle);
+    s_handle = s_testInterface->openFile(QUOTED_DL_PATH "/DLTest/Test/TempForRead", false);
+    s_testInterface->readLine(s_handle, line, 5, false);
+    TEST_ASSERT_EQUAL(4, s_testInterface->readBytes(s_handle, line, 4));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("FILE", line, 4);
+}
+
 int main(void)
 {
     UnityBegin("DLTest.LocalStorage.Mock.Test.cpp");
@@ -177,6 +225,8 @@ int main(void)
     RUN_TEST(test_readLine_CanReadLineFromOpenFileWithCRLF);
     RUN_TEST(test_readLine_CanReadLineFromOpenFileWithoutCRLF);
     RUN_TEST(test_eof_IsTrueAtEndOfFile);
+    RUN_TEST(test_readLine_ReadsEveryLineAcrossReadBlocks);
+    RUN_TEST(test_readLine_LeavesTheRestOfALongLineForTheNextRead);
     
     RUN_TEST(test_openFile_CanOpenNewFileForWrite);
     RUN_TEST(test_write_CanWriteBytesToOpenFile);
@@ -0,0 +1,183 @@
+/*
+ * DLUtility.Arena.cpp
+ * 
+ * Provides a fixed-size region for startup allocations
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+ 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Generic Library Includes
+ */
+
+#include "DLUtility.Arena.h"
+
+/*
+ * Arena Class Definition
+ */
+
+Arena::Arena()
+{
+	m_buffer = NULL;
+	m_ownsBuffer = false;
+	m_size = 0;
+	m_used = 0;
+	m_highWater = 0;
+	m_failed = false;
+}
+
+Arena::~Arena()
+{
+	freeBuffer();
+}
+
+/*
+ * setSize
+ *
+ * Allocates the region as a single block of size bytes.
+ * Any previous region (and everything allocated from it) is released.
+ * Returns true if the region was allocated.
+ */
+bool Arena::setSize(uint32_t size)
+{
+	freeBuffer();
+
+	if (size == 0) { return false; }
+
+	m_buffer = new uint8_t[size];
+	if (!m_buffer) { return false; }
+
+	m_ownsBuffer = true;
+	m_size = size;
+	return true;
+}
+
+/*
+ * setBuffer
+ *
+ * Uses a caller-owned buffer of size bytes as the region.
+ * The buffer must be aligned to ARENA_ALIGNMENT and outlive the arena's allocations.
+ */
+bool Arena::setBuffer(void * buffer, uint32_t size)
+{
+	freeBuffer();
+
+	if (!buffer || (size == 0)) { return false; }
+
+	m_buffer = (uint8_t*)buffer;
+	m_ownsBuffer = false;
+	m_size = size;
+	return true;
+}
+
+/*
+ * allocate
+ *
+ * Returns size zeroed bytes (aligned to ARENA_ALIGNMENT) from the region,
+ * or NULL if there is not enough space left. A refused allocation is recorded
+ * so that startup code can check failed() once all allocations are made.
+ */
+void * Arena::allocate(uint32_t size)
+{
+	uint32_t alignedBytes = alignedSize(size);
+
+	if (!m_buffer || (size == 0) || (alignedBytes > available()))
+	{
+		m_failed = true;
+		return NULL;
+	}
+
+	void * p = &m_buffer[m_used];
+	memset(p, 0, alignedBytes);
+
+	m_used += alignedBytes;
+	if (m_used > m_highWater) { m_highWater = m_used; }
+
+	return p;
+}
+
+/*
+ * reset
+ *
+ * Releases every allocation at once. Objects constructed in the region
+ * are not destroyed, so they must not be used afterwards.
+ * The high-water mark is kept.
+ */
+void Arena::reset(void)
+{
+	m_used = 0;
+	m_failed = false;
+}
+
+/*
+ * owns
+ *
+ * Returns true if p points into the region (so must not be passed to delete)
+ */
+bool Arena::owns(void const * p)
+{
+	uint8_t const * pByte = (uint8_t const *)p;
+	return m_buffer && (pByte >= m_buffer) && (pByte < (m_buffer + m_size));
+}
+
+uint32_t Arena::size(void)
+{
+	return m_size;
+}
+
+uint32_t Arena::used(void)
+{
+	return m_used;
+}
+
+uint32_t Arena::available(void)
+{
+	return m_size - m_used;
+}
+
+uint32_t Arena::highWater(void)
+{
+	return m_highWater;
+}
+
+bool Arena::failed(void)
+{
+	return m_failed;
+}
+
+/*
+ * alignedSize
+ *
+ * Returns the number of bytes an allocation of size bytes takes from the region
+ */
+uint32_t Arena::alignedSize(uint32_t size)
+{
+	return (size + (ARENA_ALIGNMENT - 1)) & ~(uint32_t)(ARENA_ALIGNMENT - 1);
+}
+
+/*
+ * Private Class Functions
+ */
+
+void Arena::freeBuffer(void)
+{
+	if (m_ownsBuffer) { delete[] m_buffer; }
+
+	m_buffer = NULL;
+	m_ownsBuffer = false;
+	m_size = 0;
+	m_used = 0;
+	m_highWater = 0;
+	m_failed = false;
+}
@@ -0,0 +1,52 @@
+#ifndef _DL_ARENA_H_
+#define _DL_ARENA_H_
+
+/*
+ * Arena
+ *
+ * A fixed-size region for the allocations made once at startup
+ * (channel settings, datafields, averagers and conversion tables).
+ * Allocations are taken from the region in order and are never freed individually;
+ * reset() releases everything at once. This keeps long-running nodes free of heap
+ * fragmentation and makes the memory used by a configuration deterministic.
+ *
+ * The region is either a caller-owned buffer (e.g. a static array) or a single
+ * block allocated by setSize. Allocated memory is zeroed.
+ * Objects are constructed in arena memory with placement new (#include <new>).
+ */
+
+#define ARENA_ALIGNMENT (8)
+
+class Arena
+{
+	public:
+		Arena();
+		~Arena();
+
+		bool setSize(uint32_t size);
+		bool setBuffer(void * buffer, uint32_t size);
+
+		void * allocate(uint32_t size);
+		void reset(void);
+		bool owns(void const * p);
+
+		uint32_t size(void);
+		uint32_t used(void);
+		uint32_t available(void);
+		uint32_t highWater(void);
+		bool failed(void);
+
+		static uint32_t alignedSize(uint32_t size);
+
+	private:
+		void freeBuffer(void);
+
+		uint8_t * m_buffer;
+		bool m_ownsBuffer;
+		uint32_t m_size;
+		uint32_t m_used;
+		uint32_t m_highWater;
+		bool m_failed;
+};
+
+#endif
@@ -21,6 +21,7 @@
  * Generic Library Includes
  */
 
+#include "DLUtility.Arena.h"
 #include "DLUtility.Averager.h"
 #include "DLUtility.HelperMacros.h"
 #include "DLUtility.ArrayFunctions.h"
@@ -34,12 +35,46 @@
  */
 
 template <typename T>
-Averager<T>::Averager(uint16_t size)
+Averager<T>::Averager(uint16_t size, AVERAGER_MODE mode)
 {
-	m_data = new T[size];
+	init(size, mode, NULL);
+}
+
+template <typename T>
+Averager<T>::Averager(uint16_t size, AVERAGER_MODE mode, Arena * arena)
+{
+	init(size, mode, arena);
+}
+
+template <typename T>
+void Averager<T>::init(uint16_t size, AVERAGER_MODE mode, Arena * arena)
+{
+	m_arena = arena;
+	m_data = arena ? (T*)arena->allocate(size * sizeof(T)) : new T[size];
 	m_write = 0;
 	m_maxIndex = size -1;
 	m_full = false;
+	m_mode = mode;
+	m_sum = 0;
+	resetStatistics();
+}
+
+template <typename T>
+Averager<T>::~Averager()
+{
+	// Arena memory is released with the arena
+	if (!m_arena) { delete[] m_data; }
+}
+
+/*
+ * arenaBytesRequired
+ *
+ * Returns the arena space taken by an averager of the given size (object and samples)
+ */
+template <typename T>
+uint32_t Averager<T>::arenaBytesRequired(uint16_t size)
+{
+	return Arena::alignedSize(sizeof(Averager<T>)) + Arena::alignedSize(size * sizeof(T));
 }
 
 template <typename T>
@@ -70,6 +105,17 @@ void Averager<T>::reset(T * value)
 
 	m_write = 0;
 	m_full = (value != NULL); 
+
+	resetStatistics();
+
+	if (value)
+	{
+		m_sum = (typename AveragerSumType<T>::type)(*value) * size();
+		m_min = *value;
+		m_max = *value;
+		m_mean = (float)(*value);
+		m_statsN = size();
+	}
 }
 
 template <typename T>
@@ -84,6 +130,12 @@ float Averager<T>::getFloatAverage(void)
 	float sum = 0;
 	uint16_t count = 0;
 
+	if (m_mode == AVERAGER_MODE_RUNNING_SUM)
+	{
+		count = this->count();
+		return count ? (float)m_sum / (float)count : 0.0f;
+	}
+
 	if (m_write || m_full)
 	{
 		uint16_t n = 0;
@@ -108,6 +160,13 @@ T Averager<T>::getAverage(void)
 	int64_t sum = 0;
 	uint16_t count = 0;
 
+	if (m_mode == AVERAGER_MODE_RUNNING_SUM)
+	{
+		count = this->count();
+		sum = (int64_t)m_sum;
+		return count ? (T)(div_round(sum, count)) : 0;
+	}
+
 	if (m_write || m_full)
 	{
 		uint16_t n = 0;
@@ -129,11 +188,105 @@ T Averager<T>::getAverage(void)
 template <typename T>
 void Averager<T>::newData(T newData)
 {
+	if (m_mode == AVERAGER_MODE_RUNNING_SUM)
+	{
+		// Once the window has wrapped, the oldest sample leaves the sum
+		if (m_full) { m_sum -= m_data[m_write]; }
+		m_sum += newData;
+		updateStatistics(newData);
+	}
+
 	m_data[m_write] = newData;
 	m_full |= (m_write == m_maxIndex);
 	incrementwithrollover(m_write, m_maxIndex);
 }
 
+/*
+ * getStatistics
+ *
+ * Copies the mean, minimum, maximum and variance of all samples
+ * added since the last reset into pStats.
+ * Only available in AVERAGER_MODE_RUNNING_SUM: returns false otherwise.
+ */
+template <typename T>
+bool Averager<T>::getStatistics(AVERAGER_STATS * pStats)
+{
+	if (!pStats || (m_mode != AVERAGER_MODE_RUNNING_SUM)) { return false; }
+
+	pStats->n = m_statsN;
+	pStats->mean = m_mean;
+	pStats->minimum = (float)m_min;
+	pStats->maximum = (float)m_max;
+	pStats->variance = m_statsN ? (m_m2 / m_statsN) : 0.0f;
+
+	return true;
+}
+
+/*
+ * sampleCount, getSample
+ *
+ * Allow the samples in the window to be saved and replayed (e.g. across a restart).
+ * Index 0 is the oldest sample.
+ */
+template <typename T>
+uint16_t Averager<T>::sampleCount(void)
+{
+	return count();
+}
+
+template <typename T>
+T Averager<T>::getSample(uint16_t index)
+{
+	if (index >= count()) { return 0; }
+
+	return m_full ? m_data[(m_write + index) % size()] : m_data[index];
+}
+
+/*
+ * Private Functions
+ */
+
+template <typename T>
+uint16_t Averager<T>::count(void)
+{
+	return m_full ? size() : m_write;
+}
+
+template <typename T>
+void Averager<T>::resetStatistics(void)
+{
+	m_sum = 0;
+	m_min = 0;
+	m_max = 0;
+	m_mean = 0.0f;
+	m_m2 = 0.0f;
+	m_statsN = 0;
+}
+
+template <typename T>
+void Averager<T>::updateStatistics(T newData)
+{
+	// Welford's online algorithm for mean and variance
+	float x = (float)newData;
+	float delta;
+
+	if (m_statsN == 0)
+	{
+		m_min = newData;
+		m_max = newData;
+	}
+	else
+	{
+		m_min = min(m_min, newData);
+		m_max = max(m_max, newData);
+	}
+
+	m_statsN++;
+	delta = x - m_mean;
+	m_mean += delta / m_statsN;
+	m_m2 += delta * (x - m_mean);
+}
+
 #ifdef TEST
 template <typename T>
 void Averager<T>::fillFromArray(T * array, uint16_t size)
@@ -5,11 +5,51 @@
  * Defines and Typedefs
  */
 
+/*
+ * AVERAGER_MODE
+ *
+ * AVERAGER_MODE_WINDOW: The average is recalculated from every sample in the window on request.
+ * AVERAGER_MODE_RUNNING_SUM: A running sum is kept as samples arrive, so the average is O(1).
+ *  In this mode, the minimum, maximum and variance of the samples since the last reset
+ *  are also tracked (see getStatistics).
+ */
+enum averager_mode
+{
+	AVERAGER_MODE_WINDOW,
+	AVERAGER_MODE_RUNNING_SUM
+};
+typedef enum averager_mode AVERAGER_MODE;
+
+/*
+ * AVERAGER_STATS
+ *
+ * Spread statistics for the samples added since the last reset.
+ * The variance is the population variance of those samples.
+ */
+struct averager_stats
+{
+	float mean;
+	float minimum;
+	float maximum;
+	float variance;
+	uint16_t n;
+};
+typedef struct averager_stats AVERAGER_STATS;
+
+// Integer samples are summed exactly in 64 bits, floats are summed as floats.
+template <typename T> struct AveragerSumType { typedef int64_t type; };
+template <> struct AveragerSumType<float> { typedef float type; };
+
+class Arena;
+
 template <typename T>
 class Averager
 {
 	public:
-		Averager(uint16_t size);
+		Averager(uint16_t size, AVERAGER_MODE mode = AVERAGER_MODE_WINDOW);
+		/* The sample buffer is taken from arena rather than the heap */
+		Averager(uint16_t size, AVERAGER_MODE mode, Arena * arena);
+		~Averager();
 		void reset(T * value);
 		uint16_t size(void);
 		float getFloatAverage(void);
@@ -17,16 +57,43 @@ class Averager
 		void newData(T NewData);
 		uint16_t N(void);
 		bool full(void);
-		
+		bool getStatistics(AVERAGER_STATS * pStats);
+
+		/* The samples currently in the window, oldest first */
+		uint16_t sampleCount(void);
+		T getSample(uint16_t index);
+
 		#ifdef TEST
 		void fillFromArray(T * array, uint16_t size);
 		#endif
 
+		static uint32_t arenaBytesRequired(uint16_t size);
+
 	private:
+		// Not copyable: the copy would free the same sample buffer again
+		Averager(Averager<T> const& other);
+		Averager<T>& operator=(Averager<T> const& other);
+
+		void init(uint16_t size, AVERAGER_MODE mode, Arena * arena);
+		uint16_t count(void);
+		void resetStatistics(void);
+		void updateStatistics(T newData);
+
 		T * m_data;
+		Arena * m_arena;
 		uint16_t m_write;
 		uint16_t m_maxIndex;
 		bool m_full;
+
+		AVERAGER_MODE m_mode;
+		typename AveragerSumType<T>::type m_sum;
+
+		// Running statistics (AVERAGER_MODE_RUNNING_SUM only)
+		T m_min;
+		T m_max;
+		float m_mean;
+		float m_m2;
+		uint16_t m_statsN;
 };
 
 #endif
@@ -0,0 +1,39 @@
+/*
+ * DLUtility.CRC.cpp
+ * 
+ * Cyclic redundancy checks for stored data
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard library includes
+ */
+#include <stdint.h>
+#include "DLUtility.CRC.h"
+
+/*
+ * crc16Update
+ *
+ * Returns crc updated with length bytes of data
+ */
+uint16_t crc16Update(uint16_t crc, void const * data, uint32_t length)
+{
+    uint8_t const * pData = (uint8_t const *)data;
+    uint8_t bit;
+
+    if (!pData) { return crc; }
+
+    while (length--)
+    {
+        crc ^= (uint16_t)(*pData++) << 8;
+        for (bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
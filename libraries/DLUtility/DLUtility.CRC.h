@@ -0,0 +1,17 @@
+#ifndef _UTILITY_CRC_H_
+#define _UTILITY_CRC_H_
+
+/*
+ * CRC16
+ *
+ * CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF).
+ * Data can be checked in pieces: pass the result of one call as crc to the next,
+ * starting from CRC16_INITIAL_VALUE.
+ * Calculated bitwise rather than from a table, to keep flash usage down on small targets.
+ */
+
+#define CRC16_INITIAL_VALUE (0xFFFF)
+
+uint16_t crc16Update(uint16_t crc, void const * data, uint32_t length);
+
+#endif
@@ -28,17 +28,17 @@
 #define lastinloop(i, loopmax) ((i == (loopmax - 1)))
 
 // Increment towards a maximum and rollover to zero
-#define incrementwithrollover(var, max) (var = (var < max) ? var + 1 : 0)
+#define incrementwithrollover(var, max) ((var) = ((var) < (max)) ? (var) + 1 : 0)
 // Decrement towards zero and rollover to a maximum
-#define decrementwithrollover(var, max) (var = (var > 0) ? var - 1 : max)
+#define decrementwithrollover(var, max) ((var) = ((var) > 0) ? (var) - 1 : (max))
 
 // Increment towards a maximum and rollover to a minimum
 // e.g repeating incrementwithminmax(x, 5, 10) gives x values 5, 6, 7, 8, 9, 10, 5, 6...
-#define incrementwithminmax(var, min, max) (var = (var < max) ? var + 1 : min)
+#define incrementwithminmax(var, min, max) ((var) = ((var) < (max)) ? (var) + 1 : (min))
 
 // Decrement towards a minimum and rollover to a minimum
 // e.g repeating decrementwithminmax(x, 5, 10) gives x values 10, 9, 8, 7, 6, 5, 10, 9...
-#define decrementwithminmax(var, max) (var = (var > 0) ? var - 1 : max)
+#define decrementwithminmax(var, max) ((var) = ((var) > 0) ? (var) - 1 : (max))
 
 // Set or clear individual register bits
 #define bset(reg, bit) (reg |= (1 << bit))
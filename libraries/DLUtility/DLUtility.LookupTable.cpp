@@ -0,0 +1,142 @@
+/*
+ * DLUtility.LookupTable.cpp
+ * 
+ * Provides an evenly spaced lookup table with linear interpolation
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+ 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Generic Library Includes
+ */
+
+#include "DLUtility.Arena.h"
+#include "DLUtility.LookupTable.h"
+
+/*
+ * LookupTable Class Definition
+ */
+
+LookupTable::LookupTable()
+{
+	m_y = NULL;
+	m_arena = NULL;
+	m_size = 0;
+	m_minX = 0.0f;
+	m_maxX = 0.0f;
+	m_step = 0.0f;
+}
+
+LookupTable::~LookupTable()
+{
+	freeTable();
+}
+
+/*
+ * setSize
+ *
+ * Allocates space for size points, evenly spaced from minX to maxX inclusive.
+ * The y values must then be filled in with setY.
+ * If arena is not NULL, the points are taken from it rather than the heap.
+ * Returns true if the table was allocated.
+ */
+bool LookupTable::setSize(uint16_t size, float minX, float maxX)
+{
+	return setSize(size, minX, maxX, NULL);
+}
+
+bool LookupTable::setSize(uint16_t size, float minX, float maxX, Arena * arena)
+{
+	freeTable();
+
+	if ((size < 2) || (maxX <= minX)) { return false; }
+
+	m_arena = arena;
+	m_y = arena ? (float*)arena->allocate(size * sizeof(float)) : new float[size];
+
+	if (m_y)
+	{
+		m_size = size;
+		m_minX = minX;
+		m_maxX = maxX;
+		m_step = (maxX - minX) / (size - 1);
+	}
+
+	return m_y != NULL;
+}
+
+/*
+ * arenaBytesRequired
+ *
+ * Returns the arena space taken by a table of size points (object and points)
+ */
+uint32_t LookupTable::arenaBytesRequired(uint16_t size)
+{
+	return Arena::alignedSize(sizeof(LookupTable)) + Arena::alignedSize(size * sizeof(float));
+}
+
+uint16_t LookupTable::size(void)
+{
+	return m_size;
+}
+
+/*
+ * xAt
+ *
+ * Returns the x value that the point at index represents
+ */
+float LookupTable::xAt(uint16_t index)
+{
+	return m_minX + (m_step * index);
+}
+
+void LookupTable::setY(uint16_t index, float y)
+{
+	if (index < m_size) { m_y[index] = y; }
+}
+
+/*
+ * interpolate
+ *
+ * Returns y for the given x by linear interpolation between the two nearest points.
+ * x values outside the table are clamped to the first or last point.
+ */
+float LookupTable::interpolate(float x)
+{
+	if (m_size == 0) { return x; }
+
+	if (x <= m_minX) { return m_y[0]; }
+	if (x >= m_maxX) { return m_y[m_size - 1]; }
+
+	float position = (x - m_minX) / m_step;
+	uint16_t index = (uint16_t)position;
+
+	if (index >= (m_size - 1)) { return m_y[m_size - 1]; }
+
+	float fraction = position - (float)index;
+	return m_y[index] + (fraction * (m_y[index + 1] - m_y[index]));
+}
+
+/*
+ * Private Class Functions
+ */
+
+void LookupTable::freeTable(void)
+{
+	// Arena memory is released with the arena
+	if (!m_arena) { delete[] m_y; }
+
+	m_y = NULL;
+	m_arena = NULL;
+	m_size = 0;
+}
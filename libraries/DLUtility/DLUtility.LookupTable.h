@@ -0,0 +1,42 @@
+#ifndef _DL_LOOKUPTABLE_H_
+#define _DL_LOOKUPTABLE_H_
+
+/*
+ * LookupTable
+ *
+ * Holds y values for evenly spaced x values between minX and maxX.
+ * interpolate(x) returns a linear interpolation between the two nearest points,
+ * so an expensive function can be sampled once and then evaluated cheaply.
+ */
+
+class Arena;
+
+class LookupTable
+{
+	public:
+		LookupTable();
+		~LookupTable();
+
+		bool setSize(uint16_t size, float minX, float maxX);
+		bool setSize(uint16_t size, float minX, float maxX, Arena * arena);
+		uint16_t size(void);
+
+		float xAt(uint16_t index);
+		void setY(uint16_t index, float y);
+
+		float interpolate(float x);
+
+		static uint32_t arenaBytesRequired(uint16_t size);
+
+	private:
+		void freeTable(void);
+
+		float * m_y;
+		Arena * m_arena;
+		uint16_t m_size;
+		float m_minX;
+		float m_maxX;
+		float m_step;
+};
+
+#endif
@@ -8,22 +8,6 @@
  * www.re-innovation.co.uk
  */
 
-/*
- * PD_GetInputVoltage
- *
- * Assuming that the voltage in is from a potential divider
- * of resistors r1 and r2, calculate the divider input voltage
- *
- * in: The input voltage
- * r1: The "top" resistor in the divider
- * r2: The "bottom" resistor in the divider
- */
-
-float PD_GetInputVoltage(float in, float r1, float r2)
-{
-	return (in * (r1 + r2)) / r2;
-}
-
 /*
  * PD_GetLowerResistance
  *
@@ -1,7 +1,22 @@
 #ifndef _UTILITY_POTENTIALDIVIDER_H_
 #define _UTILITY_POTENTIALDIVIDER_H_
 
-float PD_GetInputVoltage(float in, float r1, float r2);
+/*
+ * PD_GetInputVoltage
+ *
+ * Assuming that the voltage in is from a potential divider
+ * of resistors r1 and r2, calculate the divider input voltage.
+ * Inline because it is part of every voltage channel conversion.
+ *
+ * in: The input voltage
+ * r1: The "top" resistor in the divider
+ * r2: The "bottom" resistor in the divider
+ */
+inline float PD_GetInputVoltage(float in, float r1, float r2)
+{
+	return (in * (r1 + r2)) / r2;
+}
+
 float PD_GetLowerResistance(float upperR, float Vin, float Vmid);
 
 #endif
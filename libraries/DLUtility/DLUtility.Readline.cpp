@@ -73,4 +73,114 @@ uint32_t readLineWithReadFunction(READFN fn, char * buffer, uint32_t n, bool str
 	}
 
 	return readCount;
-}
\ No newline at end of file
+}
+
+void readAheadInit(READ_AHEAD * pReadAhead, char * data, uint16_t size, void * context)
+{
+	if (!pReadAhead) { return; }
+
+	pReadAhead->data = data;
+	pReadAhead->size = data ? size : 0;
+	pReadAhead->context = context;
+	readAheadReset(pReadAhead);
+}
+
+/*
+ * readAheadReset
+ * Discards anything read ahead (call this when the file is opened or closed)
+ */
+void readAheadReset(READ_AHEAD * pReadAhead)
+{
+	if (!pReadAhead) { return; }
+
+	pReadAhead->start = 0;
+	pReadAhead->end = 0;
+}
+
+bool readAheadIsEmpty(READ_AHEAD const * pReadAhead)
+{
+	return !pReadAhead || (pReadAhead->start == pReadAhead->end);
+}
+
+static bool refillReadAhead(READ_AHEAD * pReadAhead, READBLOCKFN fn)
+{
+	if (!fn || (pReadAhead->size == 0)) { return false; }
+
+	pReadAhead->start = 0;
+	pReadAhead->end = fn(pReadAhead->data, pReadAhead->size, pReadAhead->context);
+
+	return pReadAhead->end > 0;
+}
+
+uint32_t readLineWithReadAhead(READ_AHEAD * pReadAhead, READBLOCKFN fn, char * buffer, uint32_t n, bool stripCRLF)
+{
+	uint32_t readCount = 0;
+	uint32_t length;
+	char * pStart;
+	char * pLF = NULL;
+
+	if (!pReadAhead || !buffer) { return 0; }
+
+	while ((readCount < n) && !pLF)
+	{
+		if (readAheadIsEmpty(pReadAhead) && !refillReadAhead(pReadAhead, fn)) { break; }
+
+		pStart = &pReadAhead->data[pReadAhead->start];
+		length = pReadAhead->end - pReadAhead->start;
+		if (length > (n - readCount)) { length = n - readCount; }
+
+		// Copy up to and including the line feed, or everything available if there isn't one
+		pLF = (char *)memchr(pStart, '\n', length);
+		if (pLF) { length = (pLF - pStart) + 1; }
+
+		memcpy(&buffer[readCount], pStart, length);
+		readCount += length;
+		pReadAhead->start += length;
+	}
+
+	if (stripCRLF)
+	{
+		while ((readCount > 0) && ((buffer[readCount - 1] == '\r') || (buffer[readCount - 1] == '\n')))
+		{
+			readCount--;
+		}
+	}
+
+	if (readCount < n)
+	{
+		buffer[readCount] = '\0'; // NULL-terminate if there is room left in the buffer
+	}
+
+	return readCount;
+}
+
+uint32_t readBytesWithReadAhead(READ_AHEAD * pReadAhead, READBLOCKFN fn, char * buffer, uint32_t n)
+{
+	uint32_t readCount = 0;
+	uint32_t length;
+
+	if (!pReadAhead || !buffer) { return 0; }
+
+	while (readCount < n)
+	{
+		if (readAheadIsEmpty(pReadAhead))
+		{
+			// Big reads go straight into the caller's buffer
+			if ((n - readCount) >= pReadAhead->size)
+			{
+				return readCount + (fn ? fn(&buffer[readCount], n - readCount, pReadAhead->context) : 0);
+			}
+
+			if (!refillReadAhead(pReadAhead, fn)) { break; }
+		}
+
+		length = pReadAhead->end - pReadAhead->start;
+		if (length > (n - readCount)) { length = n - readCount; }
+
+		memcpy(&buffer[readCount], &pReadAhead->data[pReadAhead->start], length);
+		readCount += length;
+		pReadAhead->start += length;
+	}
+
+	return readCount;
+}
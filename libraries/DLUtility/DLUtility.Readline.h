@@ -24,4 +24,42 @@ typedef char (*READFN)(void);
  */
 uint32_t readLineWithReadFunction(READFN fn, char * buffer, uint32_t n, bool stripCRLF = false);
 
+/*
+ * READ_AHEAD type
+ * - A buffer of data read from a file ahead of where the caller has got to,
+ *   so that whole blocks can be read from the file instead of one char at a time
+ *
+ * READBLOCKFN should read up to n chars into buffer, returning the number read (0 at EOF).
+ * It is passed the context of the READ_AHEAD being filled (e.g. the object that owns the file).
+ */
+typedef uint32_t (*READBLOCKFN)(char * buffer, uint32_t n, void * context);
+
+struct read_ahead
+{
+	char * data;
+	uint16_t size;
+	uint16_t start; // Next unread char
+	uint16_t end; // One past the last char read from the file
+	void * context; // Passed to READBLOCKFN
+};
+typedef struct read_ahead READ_AHEAD;
+
+void readAheadInit(READ_AHEAD * pReadAhead, char * data, uint16_t size, void * context = NULL);
+void readAheadReset(READ_AHEAD * pReadAhead);
+bool readAheadIsEmpty(READ_AHEAD const * pReadAhead);
+
+/*
+ * readLineWithReadAhead
+ * As readLineWithReadFunction, but takes chars from the read-ahead buffer (refilling it from fn
+ * when it runs out), finding the end of the line with memchr and copying up to it in one go.
+ */
+uint32_t readLineWithReadAhead(READ_AHEAD * pReadAhead, READBLOCKFN fn, char * buffer, uint32_t n, bool stripCRLF = false);
+
+/*
+ * readBytesWithReadAhead
+ * Reads up to n chars into buffer, first from the read-ahead buffer and then from fn.
+ * Returns the number of chars read.
+ */
+uint32_t readBytesWithReadAhead(READ_AHEAD * pReadAhead, READBLOCKFN fn, char * buffer, uint32_t n);
+
 #endif
@@ -28,6 +28,83 @@
 
 #include "DLUtility.Strings.h"
 
+/*
+ * Private Variables
+ */
+
+// "00" to "99", so numbers can be formatted two digits per division
+static char const s_digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static uint32_t const s_powersOfTen[FIXED_FORMAT_MAX_DECIMALS + 1] =
+{
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+/*
+ * Private Functions
+ */
+
+/*
+ * formatUInt
+ *
+ * Writes the digits of value (zero-padded to at least minDigits) so that they end just before end.
+ * There must be space for 10 digits before end. Returns a pointer to the first digit.
+ */
+static char * formatUInt(uint32_t value, char * end, uint8_t minDigits)
+{
+    char * p = end;
+    char * const padTo = end - minDigits;
+    uint32_t pair;
+
+    while (value >= 100)
+    {
+        pair = value % 100;
+        value /= 100;
+        p -= 2;
+        p[0] = s_digitPairs[pair * 2];
+        p[1] = s_digitPairs[(pair * 2) + 1];
+    }
+
+    if (value >= 10)
+    {
+        p -= 2;
+        p[0] = s_digitPairs[value * 2];
+        p[1] = s_digitPairs[(value * 2) + 1];
+    }
+    else
+    {
+        *--p = (char)('0' + value);
+    }
+
+    while (p > padTo) { *--p = '0'; }
+
+    return p;
+}
+
+/*
+ * formatUInt64
+ *
+ * As formatUInt, for values below 1e18 (there must be space for 18 digits before end)
+ */
+static char * formatUInt64(uint64_t value, char * end, uint8_t minDigits)
+{
+    if (value < 1000000000ULL) { return formatUInt((uint32_t)value, end, minDigits); }
+
+    // Split into two 32-bit halves of nine digits, so only one 64-bit division is needed
+    char * p = formatUInt((uint32_t)(value % 1000000000ULL), end, 9);
+    return formatUInt((uint32_t)(value / 1000000000ULL), p, (minDigits > 9) ? (minDigits - 9) : 0);
+}
+
 /*
  * Private Functions 
  */
@@ -128,6 +205,41 @@ bool stringIsWhitespace(char const * str)
     return *str == '\0';
 }
 
+void writeHex(char * buffer, uint32_t value, uint8_t digits)
+{
+    static char const hexChars[] = "0123456789ABCDEF";
+
+    while (digits--)
+    {
+        buffer[digits] = hexChars[value & 0x0F];
+        value >>= 4;
+    }
+}
+
+/*
+ * readHex
+ *
+ * Reads exactly digits upper case hex chars. Returns false (without setting *pValue) on any other char.
+ */
+bool readHex(char const * buffer, uint8_t digits, uint32_t * pValue)
+{
+    uint32_t value = 0;
+    char c;
+
+    while (digits--)
+    {
+        c = *buffer++;
+        value <<= 4;
+
+        if ((c >= '0') && (c <= '9')) { value += c - '0'; }
+        else if ((c >= 'A') && (c <= 'F')) { value += c - 'A' + 10; }
+        else { return false; }
+    }
+
+    *pValue = value;
+    return true;
+}
+
 bool splitAndStripWhiteSpace(char * toSplit, char splitChar, char ** pStartOnLeft, char ** pEndOnLeft, char ** pStartOnRight, char ** pEndOnRight)
 {
     if (!toSplit) { return false; }
@@ -202,6 +314,7 @@ bool FixedLengthAccumulator::writeChar(char c)
         m_buffer[m_writeIndex] = '\0';
         return true;
     }
+    m_truncated = true;
     return false;
 }
 
@@ -216,14 +329,40 @@ bool FixedLengthAccumulator::writeChar(char c)
 bool FixedLengthAccumulator::writeString(const char * s)
 {
     if (!s) { return false; }
-    
-    while(*s && (m_writeIndex < m_maxLength))
+
+    return append(s, strlen(s));
+}
+
+/*
+ * FixedLengthAccumulator::append
+ *
+ * Copies the first length chars of s (with one copy and one terminator write),
+ * or as many as there is space for.
+ * Returns true if ALL of them were copied. If not, truncated() returns true until the next reset.
+ * appendLiteral does the same for a string literal, with its length known at compile time.
+ */
+
+bool FixedLengthAccumulator::append(const char * s, size_t length)
+{
+    if (!s) { return false; }
+
+    size_t space = m_maxLength - m_writeIndex;
+    bool complete = (length <= space);
+
+    if (!complete)
     {
-        m_buffer[m_writeIndex++] = *s++;
+        length = space;
+        m_truncated = true;
+    }
+
+    if (m_buffer)
+    {
+        memcpy(&m_buffer[m_writeIndex], s, length);
+        m_writeIndex += length;
         m_buffer[m_writeIndex] = '\0';
     }
-    
-    return (*s == '\0');
+
+    return complete;
 }
 
 /*
@@ -236,10 +375,96 @@ bool FixedLengthAccumulator::writeLine(const char * s)
 {
     bool success = true;
     success &= writeString(s);
-    success &= writeString("\r\n");
+    success &= appendLiteral(CRLF);
     return success;
 }
 
+/*
+ * FixedLengthAccumulator::appendInt
+ *
+ * Writes value in decimal (as sprintf("%ld"))
+ * Returns true if the number was written, false (writing nothing) if there was not space for all of it
+ */
+
+bool FixedLengthAccumulator::appendInt(int32_t value)
+{
+    char digits[12];
+    char * end = &digits[sizeof(digits)];
+
+    // Negate as unsigned, so INT32_MIN is handled
+    uint32_t magnitude = (value < 0) ? (0UL - (uint32_t)value) : (uint32_t)value;
+
+    char * p = formatUInt(magnitude, end, 1);
+    if (value < 0) { *--p = '-'; }
+
+    return appendWhole(p, (uint8_t)(end - p));
+}
+
+/*
+ * FixedLengthAccumulator::appendUInt
+ *
+ * Writes value in decimal (as sprintf("%lu"))
+ * Returns true if the number was written, false (writing nothing) if there was not space for all of it
+ */
+
+bool FixedLengthAccumulator::appendUInt(uint32_t value)
+{
+    char digits[10];
+    char * end = &digits[sizeof(digits)];
+
+    char * p = formatUInt(value, end, 1);
+
+    return appendWhole(p, (uint8_t)(end - p));
+}
+
+/*
+ * FixedLengthAccumulator::appendFixed
+ *
+ * Writes value with the given number of decimal places (as sprintf("%.<decimals>f"),
+ * including rounding exact halves to even, "-0.0" for small negative values and "nan"/"inf").
+ * Returns true if the number was written, false (writing nothing) if there was not space for all of it,
+ * decimals is more than FIXED_FORMAT_MAX_DECIMALS or the value is too large to format.
+ */
+
+bool FixedLengthAccumulator::appendFixed(float value, uint8_t decimals)
+{
+    char digits[32];
+    char * end = &digits[sizeof(digits)];
+    char * p;
+    bool negative = signbit(value);
+
+    if (decimals > FIXED_FORMAT_MAX_DECIMALS) { return false; }
+
+    if (isnan(value)) { return negative ? appendWhole("-nan", 4) : appendWhole("nan", 3); }
+    if (isinf(value)) { return negative ? appendWhole("-inf", 4) : appendWhole("inf", 3); }
+
+    // A float has 24 significant bits and 10^9 needs 21 (after its factors of 2),
+    // so the scaled value is exact in a double and can be rounded exactly
+    double scaled = fabs((double)value) * (double)s_powersOfTen[decimals];
+    if (scaled >= 1e18) { return false; }
+
+    uint64_t whole = (uint64_t)scaled;
+    double remainder = scaled - (double)whole;
+    if ((remainder > 0.5) || ((remainder == 0.5) && (whole & 1))) { whole++; }
+
+    uint64_t integerPart = whole / s_powersOfTen[decimals];
+
+    if (decimals > 0)
+    {
+        p = formatUInt((uint32_t)(whole - (integerPart * s_powersOfTen[decimals])), end, decimals);
+        *--p = '.';
+        p = formatUInt64(integerPart, p, 1);
+    }
+    else
+    {
+        p = formatUInt64(integerPart, end, 1);
+    }
+
+    if (negative) { *--p = '-'; }
+
+    return appendWhole(p, (uint8_t)(end - p));
+}
+
 /*
  * FixedLengthAccumulator::reset
  *
@@ -249,6 +474,7 @@ bool FixedLengthAccumulator::writeLine(const char * s)
 void FixedLengthAccumulator::reset(void)
 {
     m_writeIndex = 0;
+    m_truncated = false;
     if (m_buffer)
     {
         m_buffer[m_writeIndex] = '\0';
@@ -293,6 +519,17 @@ bool FixedLengthAccumulator::isFull(void)
     return m_writeIndex == m_maxLength;
 }
 
+/*
+ * FixedLengthAccumulator::truncated
+ *
+ * Returns true if anything has failed to fit since the last reset
+ */
+
+bool FixedLengthAccumulator::truncated(void)
+{
+    return m_truncated;
+}
+
 /*
  * FixedLengthAccumulator::detach
  *
@@ -304,6 +541,7 @@ void FixedLengthAccumulator::detach(void)
     m_buffer = NULL;
     m_maxLength = 0;
     m_writeIndex = 0;
+    m_truncated = false;
 }
 
 /*
@@ -336,4 +574,25 @@ void FixedLengthAccumulator::remove(uint32_t chars)
 
     m_buffer[m_writeIndex] = '\0';
 }
-        
\ No newline at end of file
+        
+
+/*
+ * FixedLengthAccumulator::appendWhole
+ *
+ * Copies length chars of s if they all fit, otherwise writes nothing
+ */
+
+bool FixedLengthAccumulator::appendWhole(char const * s, uint8_t length)
+{
+    if (!m_buffer || ((uint32_t)m_writeIndex + length > m_maxLength))
+    {
+        m_truncated = true;
+        return false;
+    }
+
+    memcpy(&m_buffer[m_writeIndex], s, length);
+    m_writeIndex += length;
+    m_buffer[m_writeIndex] = '\0';
+
+    return true;
+}
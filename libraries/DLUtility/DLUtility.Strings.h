@@ -11,13 +11,22 @@ bool splitAndStripWhiteSpace(char * toSplit, char splitChar, char ** pStartOnLef
 
 bool stringIsWhitespace(char const * str);
 
+/* Fixed width, upper case hex without a terminator (e.g. for checksums and offsets in files) */
+void writeHex(char * buffer, uint32_t value, uint8_t digits);
+bool readHex(char const * buffer, uint8_t digits, uint32_t * pValue);
+
 /*
  * FixedLengthAccumulator
  *
  * Wrapper for a char buffer to allow easy creation one char at a time.
  * More control than strncpy, less powerful than full-blown String class
+ * Numbers are formatted two digits at a time from a table, without sprintf.
+ * appendFixed gives the same output as sprintf("%.<decimals>f") for up to
+ * FIXED_FORMAT_MAX_DECIMALS decimals, and magnitudes where value x 10^decimals is below 1e18.
  */
 
+#define FIXED_FORMAT_MAX_DECIMALS (9)
+
 class FixedLengthAccumulator
 {
     public:
@@ -26,6 +35,15 @@ class FixedLengthAccumulator
         bool writeChar(char c);
         bool writeString(const char * s);
         bool writeLine(const char * s);
+
+        /* Copies as much of the length chars of s as fit (see truncated()) */
+        bool append(const char * s, size_t length);
+        template <size_t N> bool appendLiteral(const char (&s)[N]) { return append(s, N - 1); }
+
+        /* Numbers are written whole or not at all (returning false if there is not enough space) */
+        bool appendInt(int32_t value);
+        bool appendUInt(uint32_t value);
+        bool appendFixed(float value, uint8_t decimals);
     
         void remove(uint32_t chars);
                 
@@ -33,14 +51,18 @@ class FixedLengthAccumulator
         char * c_str(void);
         
         bool isFull(void);
+        bool truncated(void);
         void attach(char * buffer, uint16_t length);
         void detach(void);
         uint16_t length(void);
 
     private:
+        bool appendWhole(char const * s, uint8_t length);
+
         char * m_buffer;
         uint16_t m_maxLength;
         uint16_t m_writeIndex;
+        bool m_truncated;
 };
 
 #endif
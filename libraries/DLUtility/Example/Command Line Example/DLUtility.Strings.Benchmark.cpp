@@ -0,0 +1,102 @@
+/*
+ * DLUtility.Strings.Benchmark.cpp
+ *
+ * Times FixedLengthAccumulator number formatting against sprintf,
+ * formatting a Thingspeak-style "channel=value" body of 8 fields
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+/*
+ * Standard Library Includes
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Local Includes
+ */
+
+#include "DLUtility.Strings.h"
+
+/*
+ * Defines and Typedefs
+ */
+
+#define FIELDS (8)
+#define ROWS (100000UL)
+
+/*
+ * Private Variables
+ */
+
+static float s_values[FIELDS] = {12.3456f, -0.25f, 230.1f, 4.99999f, 0.0f, 1023.0f, -40.125f, 65535.0f};
+static char s_body[256];
+
+/*
+ * Private Functions
+ */
+
+static double secondsSince(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static uint32_t formatWithSprintf(uint32_t row)
+{
+    uint8_t field;
+    uint16_t index = 0;
+
+    for (field = 0; field < FIELDS; ++field)
+    {
+        if (index > 0) { s_body[index++] = '&'; }
+        index += sprintf(&s_body[index], "%d=%.5f", (int)(field + 1), s_values[field] + (float)row);
+    }
+
+    return index;
+}
+
+static uint32_t formatWithAccumulator(uint32_t row)
+{
+    uint8_t field;
+    FixedLengthAccumulator accumulator(s_body, sizeof(s_body));
+
+    for (field = 0; field < FIELDS; ++field)
+    {
+        if (accumulator.length() > 0) { accumulator.writeChar('&'); }
+        accumulator.appendUInt(field + 1);
+        accumulator.writeChar('=');
+        accumulator.appendFixed(s_values[field] + (float)row, 5);
+    }
+
+    return accumulator.length();
+}
+
+int main(void)
+{
+    uint32_t row;
+    uint32_t total;
+    clock_t start;
+    double sprintfTime;
+    double accumulatorTime;
+
+    // The totals are printed so the loops cannot be optimised away
+    start = clock();
+    for (total = 0, row = 0; row < ROWS; ++row) { total += formatWithSprintf(row); }
+    sprintfTime = secondsSince(start);
+    printf("sprintf:     %.3fs (%lu chars)\n", sprintfTime, (unsigned long)total);
+
+    start = clock();
+    for (total = 0, row = 0; row < ROWS; ++row) { total += formatWithAccumulator(row); }
+    accumulatorTime = secondsSince(start);
+    printf("accumulator: %.3fs (%lu chars)\n", accumulatorTime, (unsigned long)total);
+
+    printf("%lu rows of %d fields, %.1fx faster\n", (unsigned long)ROWS, FIELDS, sprintfTime / accumulatorTime);
+
+    return 0;
+}
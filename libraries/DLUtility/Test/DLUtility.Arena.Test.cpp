@@ -0,0 +1,134 @@
+/*
+ * DLUtility.Arena.Test.cpp
+ *
+ * Tests the Arena class
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <new>
+
+#include "unity.h"
+
+#include "../DLUtility.Arena.h"
+#include "../DLUtility.Averager.h"
+#include "../DLUtility.LookupTable.h"
+
+static uint64_t s_buffer[32];
+static Arena * s_arena;
+
+void setUp(void)
+{
+	memset(s_buffer, 0xAA, sizeof(s_buffer));
+	s_arena = new Arena();
+	s_arena->setBuffer(s_buffer, sizeof(s_buffer));
+}
+
+void tearDown(void)
+{
+	delete s_arena;
+}
+
+static void test_AllocationsAreAlignedAndZeroed(void)
+{
+	uint8_t * p1 = (uint8_t*)s_arena->allocate(3);
+	uint8_t * p2 = (uint8_t*)s_arena->allocate(5);
+
+	TEST_ASSERT_EQUAL_PTR(s_buffer, p1);
+	TEST_ASSERT_EQUAL(ARENA_ALIGNMENT, p2 - p1);
+	TEST_ASSERT_EQUAL(0, p1[0]);
+	TEST_ASSERT_EQUAL(0, p2[4]);
+	TEST_ASSERT_EQUAL(2 * ARENA_ALIGNMENT, s_arena->used());
+	TEST_ASSERT_EQUAL(sizeof(s_buffer) - (2 * ARENA_ALIGNMENT), s_arena->available());
+	TEST_ASSERT_FALSE(s_arena->failed());
+}
+
+static void test_AllocationFailsWhenArenaIsFull(void)
+{
+	TEST_ASSERT_NOT_NULL(s_arena->allocate(sizeof(s_buffer) - ARENA_ALIGNMENT));
+	TEST_ASSERT_NULL(s_arena->allocate(ARENA_ALIGNMENT + 1));
+	TEST_ASSERT_TRUE(s_arena->failed());
+
+	// A smaller allocation can still succeed, but the failure is remembered
+	TEST_ASSERT_NOT_NULL(s_arena->allocate(ARENA_ALIGNMENT));
+	TEST_ASSERT_TRUE(s_arena->failed());
+	TEST_ASSERT_EQUAL(0, s_arena->available());
+}
+
+static void test_ResetReleasesAllocationsAndKeepsHighWaterMark(void)
+{
+	s_arena->allocate(40);
+	s_arena->allocate(sizeof(s_buffer));
+	s_arena->reset();
+
+	TEST_ASSERT_EQUAL(0, s_arena->used());
+	TEST_ASSERT_EQUAL(40, s_arena->highWater());
+	TEST_ASSERT_FALSE(s_arena->failed());
+
+	s_arena->allocate(8);
+	TEST_ASSERT_EQUAL(40, s_arena->highWater());
+}
+
+static void test_OwnsReportsPointersInsideTheRegion(void)
+{
+	int heap;
+	void * p = s_arena->allocate(8);
+
+	TEST_ASSERT_TRUE(s_arena->owns(p));
+	TEST_ASSERT_FALSE(s_arena->owns(&heap));
+	TEST_ASSERT_FALSE(s_arena->owns(((uint8_t*)s_buffer) + sizeof(s_buffer)));
+}
+
+static void test_ArenaCanAllocateItsOwnRegion(void)
+{
+	Arena arena;
+
+	TEST_ASSERT_FALSE(arena.setSize(0));
+	TEST_ASSERT_TRUE(arena.setSize(96));
+	TEST_ASSERT_EQUAL(96, arena.size());
+	TEST_ASSERT_NOT_NULL(arena.allocate(96));
+	TEST_ASSERT_NULL(arena.allocate(1));
+}
+
+static void test_AveragerAndLookupTableUseArena(void)
+{
+	void * p = s_arena->allocate(sizeof(Averager<int32_t>));
+	Averager<int32_t> * averager = new (p) Averager<int32_t>(4, AVERAGER_MODE_RUNNING_SUM, s_arena);
+
+	averager->newData(2);
+	averager->newData(4);
+	TEST_ASSERT_EQUAL_FLOAT(3.0f, averager->getFloatAverage());
+	TEST_ASSERT_EQUAL(Averager<int32_t>::arenaBytesRequired(4), s_arena->used());
+	averager->~Averager<int32_t>();
+
+	LookupTable table;
+	uint32_t used = s_arena->used();
+	TEST_ASSERT_TRUE(table.setSize(5, 0.0f, 4.0f, s_arena));
+	TEST_ASSERT_EQUAL(Arena::alignedSize(5 * sizeof(float)), s_arena->used() - used);
+
+	TEST_ASSERT_FALSE(table.setSize(64, 0.0f, 4.0f, s_arena));
+	TEST_ASSERT_TRUE(s_arena->failed());
+}
+
+int main(void)
+{
+	UnityBegin("DLUtility.Arena.Test.cpp");
+
+	RUN_TEST(test_AllocationsAreAlignedAndZeroed);
+	RUN_TEST(test_AllocationFailsWhenArenaIsFull);
+	RUN_TEST(test_ResetReleasesAllocationsAndKeepsHighWaterMark);
+	RUN_TEST(test_OwnsReportsPointersInsideTheRegion);
+	RUN_TEST(test_ArenaCanAllocateItsOwnRegion);
+	RUN_TEST(test_AveragerAndLookupTableUseArena);
+
+	UnityEnd();
+	return 0;
+}
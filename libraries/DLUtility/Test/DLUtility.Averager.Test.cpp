@@ -15,7 +15,7 @@
 template <typename T>
 void testReset(T expected_result)
 {
-	Averager<T> averager = Averager<T>(20);
+	Averager<T> averager(20);
 	averager.reset(&expected_result);
 
 	TEST_ASSERT_EQUAL(expected_result, averager.getAverage());
@@ -31,7 +31,16 @@ void testReset(T expected_result)
 template <typename T>
 void testRunning(T * data_ptr, uint16_t size, T expected_result, float expectedFloatResult)
 {
-	Averager<T> averager = Averager<T>(size);
+	Averager<T> averager(size);
+	averager.fillFromArray(data_ptr, size);
+	TEST_ASSERT_EQUAL(expected_result, averager.getAverage());
+	TEST_ASSERT_EQUAL_FLOAT(expectedFloatResult, averager.getFloatAverage());
+}
+
+template <typename T>
+void testRunningSum(T * data_ptr, uint16_t size, T expected_result, float expectedFloatResult)
+{
+	Averager<T> averager(size, AVERAGER_MODE_RUNNING_SUM);
 	averager.fillFromArray(data_ptr, size);
 	TEST_ASSERT_EQUAL(expected_result, averager.getAverage());
 	TEST_ASSERT_EQUAL_FLOAT(expectedFloatResult, averager.getFloatAverage());
@@ -110,7 +119,7 @@ void test_AveragerU32Reset(void) { testReset(u32resetValue); }
 
 void test_AveragerSizeIsCorrect(void)
 {
-	Averager<uint32_t> averager = Averager<uint32_t>(32);
+	Averager<uint32_t> averager(32);
 
 	uint8_t i;
 	for (i = 0; i < 32; i++)
@@ -122,6 +131,83 @@ void test_AveragerSizeIsCorrect(void)
 	TEST_ASSERT_TRUE(averager.full());
 }
 
+void test_AveragerS8RunningSum(void) { testRunningSum(s8data, N_ELE(s8data), s8dataAverage, s8dataFloatAverage); }
+void test_AveragerU8RunningSum(void) { testRunningSum(u8data, N_ELE(u8data), u8dataAverage, u8dataFloatAverage); }
+void test_AveragerS16RunningSum(void) { testRunningSum(s16data, N_ELE(s16data), s16dataAverage, s16dataFloatAverage); }
+void test_AveragerU16RunningSum(void) { testRunningSum(u16data, N_ELE(u16data), u16dataAverage, u16dataFloatAverage); }
+void test_AveragerS32RunningSum(void) { testRunningSum(s32data, N_ELE(s32data), s32dataAverage, s32dataFloatAverage); }
+void test_AveragerU32RunningSum(void) { testRunningSum(u32data, N_ELE(u32data), u32dataAverage, u32dataFloatAverage); }
+
+void test_AveragerRunningSumMatchesWindowWhenPartiallyFilled(void)
+{
+	Averager<int32_t> window(20);
+	Averager<int32_t> running(20, AVERAGER_MODE_RUNNING_SUM);
+
+	window.fillFromArray(s32data, 7);
+	running.fillFromArray(s32data, 7);
+
+	TEST_ASSERT_EQUAL(window.getAverage(), running.getAverage());
+	TEST_ASSERT_EQUAL_FLOAT(window.getFloatAverage(), running.getFloatAverage());
+}
+
+void test_AveragerRunningSumDropsOldestSampleWhenWindowWraps(void)
+{
+	Averager<int32_t> window(8);
+	Averager<int32_t> running(8, AVERAGER_MODE_RUNNING_SUM);
+
+	window.fillFromArray(s32data, N_ELE(s32data));
+	running.fillFromArray(s32data, N_ELE(s32data));
+
+	TEST_ASSERT_EQUAL(window.getAverage(), running.getAverage());
+	TEST_ASSERT_EQUAL_FLOAT(window.getFloatAverage(), running.getFloatAverage());
+}
+
+void test_AveragerRunningSumTracksStatistics(void)
+{
+	int32_t data[] = {2, 4, 4, 4, 5, 5, 7, 9};
+	Averager<int32_t> averager(N_ELE(data), AVERAGER_MODE_RUNNING_SUM);
+	AVERAGER_STATS stats;
+
+	averager.fillFromArray(data, N_ELE(data));
+
+	TEST_ASSERT_TRUE(averager.getStatistics(&stats));
+	TEST_ASSERT_EQUAL(8, stats.n);
+	TEST_ASSERT_EQUAL_FLOAT(5.0f, stats.mean);
+	TEST_ASSERT_EQUAL_FLOAT(2.0f, stats.minimum);
+	TEST_ASSERT_EQUAL_FLOAT(9.0f, stats.maximum);
+	TEST_ASSERT_EQUAL_FLOAT(4.0f, stats.variance);
+
+	averager.reset(NULL);
+	TEST_ASSERT_TRUE(averager.getStatistics(&stats));
+	TEST_ASSERT_EQUAL(0, stats.n);
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, stats.variance);
+	TEST_ASSERT_EQUAL(0, averager.getAverage());
+}
+
+void test_AveragerRunningSumResetToValue(void)
+{
+	int16_t value = -10;
+	Averager<int16_t> averager(20, AVERAGER_MODE_RUNNING_SUM);
+	AVERAGER_STATS stats;
+
+	averager.reset(&value);
+	TEST_ASSERT_EQUAL(-10, averager.getAverage());
+
+	averager.newData(10);
+	TEST_ASSERT_EQUAL_FLOAT(-9.0f, averager.getFloatAverage());
+
+	averager.getStatistics(&stats);
+	TEST_ASSERT_EQUAL_FLOAT(-10.0f, stats.minimum);
+	TEST_ASSERT_EQUAL_FLOAT(10.0f, stats.maximum);
+}
+
+void test_AveragerWindowModeHasNoStatistics(void)
+{
+	Averager<int32_t> averager(4);
+	AVERAGER_STATS stats;
+	TEST_ASSERT_FALSE(averager.getStatistics(&stats));
+}
+
 //=======Test Reset Option=====
 void resetTest()
 {
@@ -149,6 +235,19 @@ int main(void)
 	RUN_TEST(test_AveragerU32Reset);
 
 	RUN_TEST(test_AveragerSizeIsCorrect);
+
+	RUN_TEST(test_AveragerS8RunningSum);
+	RUN_TEST(test_AveragerU8RunningSum);
+	RUN_TEST(test_AveragerS16RunningSum);
+	RUN_TEST(test_AveragerU16RunningSum);
+	RUN_TEST(test_AveragerS32RunningSum);
+	RUN_TEST(test_AveragerU32RunningSum);
+
+	RUN_TEST(test_AveragerRunningSumMatchesWindowWhenPartiallyFilled);
+	RUN_TEST(test_AveragerRunningSumDropsOldestSampleWhenWindowWraps);
+	RUN_TEST(test_AveragerRunningSumTracksStatistics);
+	RUN_TEST(test_AveragerRunningSumResetToValue);
+	RUN_TEST(test_AveragerWindowModeHasNoStatistics);
 	
 	return (UnityEnd());
 }
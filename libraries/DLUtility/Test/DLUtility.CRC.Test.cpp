@@ -0,0 +1,51 @@
+/*
+ * DLUtility.CRC.Test.cpp
+ *
+ * Tests the CRC functions
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "../DLUtility.CRC.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_CRC16MatchesStandardCheckValue(void)
+{
+	char const * data = "123456789";
+	TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16Update(CRC16_INITIAL_VALUE, data, strlen(data)));
+}
+
+static void test_CRC16CanBeCalculatedInPieces(void)
+{
+	char const * data = "123456789";
+	uint16_t crc = crc16Update(CRC16_INITIAL_VALUE, data, 4);
+	crc = crc16Update(crc, &data[4], 5);
+	TEST_ASSERT_EQUAL_HEX16(0x29B1, crc);
+}
+
+static void test_CRC16OfNoDataIsUnchanged(void)
+{
+	TEST_ASSERT_EQUAL_HEX16(CRC16_INITIAL_VALUE, crc16Update(CRC16_INITIAL_VALUE, NULL, 10));
+	TEST_ASSERT_EQUAL_HEX16(0x1234, crc16Update(0x1234, "abc", 0));
+}
+
+int main(void)
+{
+	UnityBegin("DLUtility.CRC.Test.cpp");
+
+	RUN_TEST(test_CRC16MatchesStandardCheckValue);
+	RUN_TEST(test_CRC16CanBeCalculatedInPieces);
+	RUN_TEST(test_CRC16OfNoDataIsUnchanged);
+
+	UnityEnd();
+	return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * DLUtility.LookupTable.Test.cpp
+ *
+ * Tests the LookupTable class, including its accuracy when used
+ * in place of the Thermistor temperature calculation
+ *
+ * Author: James Fowkes
+ *
+ * www.re-innovation.co.uk
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "unity.h"
+
+#include "../DLUtility.LookupTable.h"
+#include "DLSensor.Thermistor.h"
+
+static const float THERMISTOR_B = 3950.0f;
+static const float THERMISTOR_R25 = 10000.0f;
+static const float OTHER_R = 10000.0f;
+static const uint16_t MAX_ADC = 1023;
+
+static void buildThermistorTable(LookupTable& table, Thermistor& thermistor, uint16_t size)
+{
+	uint16_t i;
+
+	table.setSize(size, 0.0f, (float)MAX_ADC);
+	for (i = 0; i < size; ++i)
+	{
+		table.setY(i, thermistor.TemperatureFromADCReading(OTHER_R, table.xAt(i), MAX_ADC));
+	}
+}
+
+/*
+ * Returns the largest difference between the table and the thermistor
+ * calculation for all readings representing -20C to 80C
+ */
+static float maxThermistorError(LookupTable& table, Thermistor& thermistor)
+{
+	float reading;
+	float expected;
+	float error;
+	float maxError = 0.0f;
+
+	for (reading = 1.0f; reading < MAX_ADC; reading += 0.25f)
+	{
+		expected = thermistor.TemperatureFromADCReading(OTHER_R, reading, MAX_ADC);
+		if ((expected < -20.0f) || (expected > 80.0f)) { continue; }
+
+		error = fabs(table.interpolate(reading) - expected);
+		if (error > maxError) { maxError = error; }
+	}
+
+	return maxError;
+}
+
+static void test_TableWithTooFewPointsIsNotAllocated(void)
+{
+	LookupTable table;
+	TEST_ASSERT_FALSE(table.setSize(1, 0.0f, 10.0f));
+	TEST_ASSERT_FALSE(table.setSize(10, 10.0f, 0.0f));
+	TEST_ASSERT_EQUAL(0, table.size());
+}
+
+static void test_TablePointsAreEvenlySpaced(void)
+{
+	LookupTable table;
+	TEST_ASSERT_TRUE(table.setSize(5, 0.0f, 100.0f));
+	TEST_ASSERT_EQUAL(5, table.size());
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, table.xAt(0));
+	TEST_ASSERT_EQUAL_FLOAT(25.0f, table.xAt(1));
+	TEST_ASSERT_EQUAL_FLOAT(100.0f, table.xAt(4));
+}
+
+static void test_TableInterpolatesLinearlyBetweenPoints(void)
+{
+	LookupTable table;
+	table.setSize(3, 0.0f, 10.0f);
+	table.setY(0, 0.0f);
+	table.setY(1, 10.0f);
+	table.setY(2, 0.0f);
+
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, table.interpolate(0.0f));
+	TEST_ASSERT_EQUAL_FLOAT(5.0f, table.interpolate(2.5f));
+	TEST_ASSERT_EQUAL_FLOAT(10.0f, table.interpolate(5.0f));
+	TEST_ASSERT_EQUAL_FLOAT(4.0f, table.interpolate(8.0f));
+	TEST_ASSERT_EQUAL_FLOAT(0.0f, table.interpolate(10.0f));
+}
+
+static void test_TableClampsOutOfRangeValues(void)
+{
+	LookupTable table;
+	table.setSize(2, 0.0f, 10.0f);
+	table.setY(0, 1.0f);
+	table.setY(1, 2.0f);
+
+	TEST_ASSERT_EQUAL_FLOAT(1.0f, table.interpolate(-5.0f));
+	TEST_ASSERT_EQUAL_FLOAT(2.0f, table.interpolate(15.0f));
+}
+
+static void test_ThermistorTableAccuracyImprovesWithSize(void)
+{
+	// Expected worst-case error for each table size for a 3950B, 10K thermistor
+	uint16_t sizes[] = {17, 33, 65, 129, 257};
+	float maxErrors[] = {1.5f, 0.4f, 0.1f, 0.025f, 0.01f};
+
+	Thermistor highside = Thermistor(THERMISTOR_B, THERMISTOR_R25, true);
+	Thermistor lowside = Thermistor(THERMISTOR_B, THERMISTOR_R25, false);
+
+	float lastError = 1000.0f;
+	float error;
+	uint8_t i;
+	char message[64];
+
+	for (i = 0; i < 5; ++i)
+	{
+		LookupTable highsideTable;
+		LookupTable lowsideTable;
+
+		buildThermistorTable(highsideTable, highside, sizes[i]);
+		buildThermistorTable(lowsideTable, lowside, sizes[i]);
+
+		error = maxThermistorError(highsideTable, highside);
+		sprintf(message, "Size %d: highside error %.4fC", sizes[i], error);
+		TEST_ASSERT_TRUE_MESSAGE(error < maxErrors[i], message);
+		TEST_ASSERT_TRUE_MESSAGE(error < lastError, message);
+		lastError = error;
+
+		error = maxThermistorError(lowsideTable, lowside);
+		sprintf(message, "Size %d: lowside error %.4fC", sizes[i], error);
+		TEST_ASSERT_TRUE_MESSAGE(error < maxErrors[i], message);
+	}
+}
+
+int main(void)
+{
+	UnityBegin("DLUtility.LookupTable.Test.cpp");
+
+	RUN_TEST(test_TableWithTooFewPointsIsNotAllocated);
+	RUN_TEST(test_TablePointsAreEvenlySpaced);
+	RUN_TEST(test_TableInterpolatesLinearlyBetweenPoints);
+	RUN_TEST(test_TableClampsOutOfRangeValues);
+	RUN_TEST(test_ThermistorTableAccuracyImprovesWithSize);
+
+	return (UnityEnd());
+}
@@ -0,0 +1,7 @@
+SRC_FILES += DLUtility/DLUtility.Arena.cpp
+SRC_FILES += DLSensor/DLSensor.Thermistor.cpp
+
+INC_DIRS += -IDLSensor
+
+local_setup: ;
+local_teardown: ;
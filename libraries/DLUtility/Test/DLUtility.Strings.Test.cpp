@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <math.h>
 
 #include "unity.h"
 
@@ -259,6 +260,186 @@ void test_SplitAndStripWhitespaceWorksWithStringWithWhitespace(void)
     TEST_ASSERT_EQUAL(0, strncmp(expected4, pREnd+1, strlen(expected4)));
 }
 
+void test_FixedLengthAccumulator_AppendsIntegersAsSprintf(void)
+{
+    char expected[16];
+    int32_t signedValues[] = {0, 1, -1, 9, 10, -99, 100, 12345, -654321, 2147483647, (-2147483647 - 1)};
+    uint32_t unsignedValues[] = {0, 9, 10, 99, 100, 999999999, 1000000000, 4294967295UL};
+    uint8_t i;
+
+    for (i = 0; i < sizeof(signedValues) / sizeof(signedValues[0]); ++i)
+    {
+        accumulator->reset();
+        sprintf(expected, "%ld", (long)signedValues[i]);
+        TEST_ASSERT_TRUE(accumulator->appendInt(signedValues[i]));
+        TEST_ASSERT_EQUAL_STRING(expected, buffer);
+    }
+
+    for (i = 0; i < sizeof(unsignedValues) / sizeof(unsignedValues[0]); ++i)
+    {
+        accumulator->reset();
+        sprintf(expected, "%lu", (unsigned long)unsignedValues[i]);
+        TEST_ASSERT_TRUE(accumulator->appendUInt(unsignedValues[i]));
+        TEST_ASSERT_EQUAL_STRING(expected, buffer);
+    }
+}
+
+static void checkFixedMatchesSprintf(float value, uint8_t decimals)
+{
+    char expected[64];
+
+    sprintf(expected, "%.*f", decimals, value);
+
+    accumulator->reset();
+    TEST_ASSERT_TRUE(accumulator->appendFixed(value, decimals));
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+}
+
+void test_FixedLengthAccumulator_AppendsFixedPointAsSprintfForLoggedRanges(void)
+{
+    int32_t i;
+    uint8_t decimals;
+
+    // Voltages, currents and temperatures, to 5 decimal places as uploaded
+    for (i = -200000; i <= 200000; i += 37)
+    {
+        for (decimals = 0; decimals <= 6; ++decimals)
+        {
+            checkFixedMatchesSprintf((float)i / 1000.0f, decimals);
+        }
+    }
+
+    // Raw ADC counts
+    for (i = 0; i <= 65535; i += 13)
+    {
+        checkFixedMatchesSprintf((float)i, 0);
+        checkFixedMatchesSprintf((float)i, 5);
+    }
+}
+
+void test_FixedLengthAccumulator_AppendsFixedPointAsSprintfForAllMagnitudes(void)
+{
+    uint32_t seed = 12345;
+    uint16_t i;
+    uint8_t magnitude;
+    uint8_t decimals;
+    float value;
+
+    for (magnitude = 0; magnitude < 9; ++magnitude)
+    {
+        for (i = 0; i < 500; ++i)
+        {
+            seed = (seed * 1664525UL) + 1013904223UL;
+            value = (((float)seed / 4294967296.0f) - 0.5f) * 2.0f * powf(10.0f, magnitude);
+
+            for (decimals = 0; decimals <= FIXED_FORMAT_MAX_DECIMALS; ++decimals)
+            {
+                checkFixedMatchesSprintf(value, decimals);
+            }
+        }
+    }
+}
+
+void test_FixedLengthAccumulator_AppendsFixedPointEdgeCasesAsSprintf(void)
+{
+    // Exact halves round to even, as sprintf does
+    checkFixedMatchesSprintf(0.5f, 0);
+    checkFixedMatchesSprintf(1.5f, 0);
+    checkFixedMatchesSprintf(2.5f, 0);
+    checkFixedMatchesSprintf(0.125f, 2);
+    checkFixedMatchesSprintf(0.375f, 2);
+    checkFixedMatchesSprintf(-2.5f, 0);
+
+    checkFixedMatchesSprintf(0.0f, 5);
+    checkFixedMatchesSprintf(-0.0f, 5);
+    checkFixedMatchesSprintf(-0.000001f, 3);
+    checkFixedMatchesSprintf(0.999999f, 3);
+    checkFixedMatchesSprintf(9.9999999f, 5);
+
+    // Largest values that can be formatted
+    checkFixedMatchesSprintf((float)(0xFFFFFFFF), 5);
+    checkFixedMatchesSprintf(1e17f, 0);
+    checkFixedMatchesSprintf(-123456789.0f, 9);
+
+    accumulator->reset();
+    TEST_ASSERT_FALSE(accumulator->appendFixed(2e18f, 0));
+    TEST_ASSERT_FALSE(accumulator->appendFixed(1.0f, FIXED_FORMAT_MAX_DECIMALS + 1));
+    TEST_ASSERT_EQUAL(0, accumulator->length());
+
+    TEST_ASSERT_TRUE(accumulator->appendFixed(NAN, 2));
+    TEST_ASSERT_TRUE(accumulator->appendFixed(-INFINITY, 2));
+    TEST_ASSERT_EQUAL_STRING("nan-inf", buffer);
+}
+
+void test_FixedLengthAccumulator_DoesNotAppendPartialNumbers(void)
+{
+    char smallBuffer[6];
+    FixedLengthAccumulator small(smallBuffer, sizeof(smallBuffer));
+
+    TEST_ASSERT_TRUE(small.appendInt(-123));
+    TEST_ASSERT_FALSE(small.appendUInt(456));
+    TEST_ASSERT_EQUAL_STRING("-123", smallBuffer);
+
+    small.reset();
+    TEST_ASSERT_FALSE(small.appendFixed(3.14159f, 5));
+    TEST_ASSERT_EQUAL_STRING("", smallBuffer);
+    TEST_ASSERT_TRUE(small.appendFixed(3.14159f, 3));
+    TEST_ASSERT_EQUAL_STRING("3.142", smallBuffer);
+}
+
+void test_FixedLengthAccumulator_AppendsGivenLengthOfString(void)
+{
+    char smallBuffer[8];
+    FixedLengthAccumulator small(smallBuffer, sizeof(smallBuffer));
+
+    TEST_ASSERT_TRUE(small.append("ABCDEF", 3));
+    TEST_ASSERT_EQUAL_STRING("ABC", smallBuffer);
+    TEST_ASSERT_TRUE(small.appendLiteral("DE"));
+    TEST_ASSERT_EQUAL_STRING("ABCDE", smallBuffer);
+    TEST_ASSERT_EQUAL(5, small.length());
+    TEST_ASSERT_FALSE(small.truncated());
+}
+
+void test_FixedLengthAccumulator_ReportsTruncationUntilReset(void)
+{
+    char smallBuffer[6];
+    FixedLengthAccumulator small(smallBuffer, sizeof(smallBuffer));
+
+    TEST_ASSERT_FALSE(small.appendLiteral("ABCDEFG"));
+    TEST_ASSERT_EQUAL_STRING("ABCDE", smallBuffer);
+    TEST_ASSERT_TRUE(small.truncated());
+
+    // Later writes that fit do not clear the flag
+    small.remove(2);
+    TEST_ASSERT_TRUE(small.writeChar('X'));
+    TEST_ASSERT_TRUE(small.truncated());
+
+    small.reset();
+    TEST_ASSERT_FALSE(small.truncated());
+    TEST_ASSERT_FALSE(small.appendUInt(123456));
+    TEST_ASSERT_TRUE(small.truncated());
+}
+
+void test_HexIsWrittenAndReadBack(void)
+{
+    char buffer[9] = "........";
+    uint32_t value = 0;
+
+    writeHex(buffer, 0x0012ABCF, 8);
+    TEST_ASSERT_EQUAL_STRING("0012ABCF", buffer);
+    TEST_ASSERT_TRUE(readHex(buffer, 8, &value));
+    TEST_ASSERT_EQUAL(0x0012ABCF, value);
+
+    // Only as many digits as asked for are written
+    writeHex(buffer, 0x12345, 4);
+    TEST_ASSERT_EQUAL_STRING("2345ABCF", buffer);
+
+    value = 7;
+    TEST_ASSERT_FALSE(readHex("12G4", 4, &value));
+    TEST_ASSERT_FALSE(readHex("12a4", 4, &value));
+    TEST_ASSERT_EQUAL(7, value);
+}
+
 //=======MAIN=====
 int main(void)
 {
@@ -285,6 +466,14 @@ int main(void)
   RUN_TEST(test_FixedLengthAccumulator_WritesCRLFUsingWriteLine);
   RUN_TEST(test_FixedLengthAccumulator_CorrectlyReturnsCurrentLength);
   RUN_TEST(test_FixedLengthAccumulator_CorrectlyRemovesAndAddsNewContent);
+  RUN_TEST(test_FixedLengthAccumulator_AppendsIntegersAsSprintf);
+  RUN_TEST(test_FixedLengthAccumulator_AppendsFixedPointAsSprintfForLoggedRanges);
+  RUN_TEST(test_FixedLengthAccumulator_AppendsFixedPointAsSprintfForAllMagnitudes);
+  RUN_TEST(test_FixedLengthAccumulator_AppendsFixedPointEdgeCasesAsSprintf);
+  RUN_TEST(test_FixedLengthAccumulator_DoesNotAppendPartialNumbers);
+  RUN_TEST(test_FixedLengthAccumulator_AppendsGivenLengthOfString);
+  RUN_TEST(test_FixedLengthAccumulator_ReportsTruncationUntilReset);
+  RUN_TEST(test_HexIsWrittenAndReadBack);
 
   RUN_TEST(test_SplitAndStripWhitespaceErrorsWithInvalidStrings);
   RUN_TEST(test_SplitAndStripWhitespaceWorksWithStringWithoutWhitespace);